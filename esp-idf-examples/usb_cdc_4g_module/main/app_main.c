@@ -25,6 +25,9 @@
 #ifdef CONFIG_EXAMPLE_ENABLE_WEB_ROUTER
 #include "modem_http_config.h"
 #endif
+#ifdef CONFIG_EXAMPLE_ENABLE_CONNTRACK
+#include "modem_napt.h"
+#endif
 
 #ifdef CONFIG_EXAMPLE_PING_NETWORK
 #include "ping/ping_sock.h"
@@ -250,6 +253,9 @@ void app_main(void)
     esp_netif_t *ap_netif = modem_wifi_ap_init();
     assert(ap_netif != NULL);
     ESP_ERROR_CHECK(modem_wifi_set(&s_modem_wifi_config));
+#ifdef CONFIG_EXAMPLE_ENABLE_CONNTRACK
+    ESP_ERROR_CHECK(modem_napt_conntrack_init(ap_netif));
+#endif
 
 #ifdef CONFIG_EXAMPLE_PING_NETWORK
     ip_addr_t target_addr;
@@ -310,6 +316,13 @@ void app_main(void)
         esp_ping_start(ping);
 #endif
 
+#ifdef CONFIG_EXAMPLE_ENABLE_CONNTRACK
+        modem_conntrack_stats_t ct_stats;
+        modem_napt_get_stats(&ct_stats);
+        ESP_LOGI(TAG, "connections: %"PRIu32" (max %"PRIu32"), created %"PRIu32", expired %"PRIu32", evicted %"PRIu32,
+                 ct_stats.flows, ct_stats.flows_max, ct_stats.created, ct_stats.expired, ct_stats.evicted);
+#endif
+
 #ifdef CONFIG_DUMP_SYSTEM_STATUS
         _system_dump();
 #endif
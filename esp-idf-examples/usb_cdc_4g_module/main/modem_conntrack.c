@@ -0,0 +1,386 @@
+/*
+ * SPDX-FileCopyrightText: 2024 ShenZhen XinYuan Electronic Technology Co., Ltd
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "modem_conntrack.h"
+
+#define NIL             0xFFFF
+#define NO_STATION      0xFF
+#define WHEEL_MASK      (MODEM_CONNTRACK_WHEEL_SLOTS - 1)
+
+#define IP_PROTO_ICMP   1
+#define IP_PROTO_TCP    6
+#define IP_PROTO_UDP    17
+
+/* time stamps wrap after 49 days, only differences are compared */
+#define TIME_AFTER_EQ(a, b)     ((int32_t)((a) - (b)) >= 0)
+
+static inline uint32_t tuple_hash(const modem_conntrack_tuple_t *t)
+{
+    uint32_t h = t->sta_ip * 0x9E3779B1u ^ t->peer_ip;
+
+    h ^= ((uint32_t)t->sta_port << 16 | t->peer_port) * 0x85EBCA6Bu;
+    h ^= t->proto;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    return h;
+}
+
+static inline int tuple_equal(const modem_conntrack_tuple_t *a, const modem_conntrack_tuple_t *b)
+{
+    return a->sta_ip == b->sta_ip && a->peer_ip == b->peer_ip && a->sta_port == b->sta_port
+           && a->peer_port == b->peer_port && a->proto == b->proto;
+}
+
+static uint32_t flow_timeout(const modem_conntrack_t *ct, const modem_conntrack_flow_t *f)
+{
+    switch (f->key.proto) {
+    case IP_PROTO_TCP:
+        return f->closing ? ct->cfg.tcp_closing_timeout_ms : ct->cfg.tcp_timeout_ms;
+    case IP_PROTO_UDP:
+        return ct->cfg.udp_timeout_ms;
+    default:
+        return ct->cfg.other_timeout_ms;
+    }
+}
+
+/* file the flow under the tick of its deadline, between base + 1 and a turn of the
+ * wheel later; a longer timeout is looked at once per turn until it is reached */
+static void wheel_link(modem_conntrack_t *ct, uint16_t idx, uint32_t deadline_ms, uint32_t base)
+{
+    modem_conntrack_flow_t *f = &ct->flows[idx];
+    uint32_t tick = deadline_ms / MODEM_CONNTRACK_WHEEL_TICK_MS;
+
+    if (TIME_AFTER_EQ(base, tick)) {
+        tick = base + 1;
+    } else if ((int32_t)(tick - base) > MODEM_CONNTRACK_WHEEL_SLOTS - 1) {
+        tick = base + MODEM_CONNTRACK_WHEEL_SLOTS - 1;
+    }
+    f->wslot = tick & WHEEL_MASK;
+    f->wprev = NIL;
+    f->wnext = ct->wheel[f->wslot];
+    if (f->wnext != NIL) {
+        ct->flows[f->wnext].wprev = idx;
+    }
+    ct->wheel[f->wslot] = idx;
+}
+
+static void wheel_unlink(modem_conntrack_t *ct, uint16_t idx)
+{
+    modem_conntrack_flow_t *f = &ct->flows[idx];
+
+    if (f->wprev != NIL) {
+        ct->flows[f->wprev].wnext = f->wnext;
+    } else {
+        ct->wheel[f->wslot] = f->wnext;
+    }
+    if (f->wnext != NIL) {
+        ct->flows[f->wnext].wprev = f->wprev;
+    }
+}
+
+static void flow_free(modem_conntrack_t *ct, uint16_t idx)
+{
+    modem_conntrack_flow_t *f = &ct->flows[idx];
+    uint16_t *link = &ct->buckets[tuple_hash(&f->key) & ct->bucket_mask];
+
+    while (*link != idx) {
+        link = &ct->flows[*link].hnext;
+    }
+    *link = f->hnext;
+    wheel_unlink(ct, idx);
+    ct->stations[f->station].flows--;
+    ct->stats.flows--;
+
+    f->station = NO_STATION;
+    f->hnext = ct->free_head;
+    ct->free_head = idx;
+}
+
+/* the first flow met going round the wheel is about the closest to its deadline */
+static void flow_evict(modem_conntrack_t *ct)
+{
+    for (uint32_t i = 1; i <= MODEM_CONNTRACK_WHEEL_SLOTS; i++) {
+        uint16_t idx = ct->wheel[(ct->tick + i) & WHEEL_MASK];
+        if (idx != NIL) {
+            flow_free(ct, idx);
+            ct->stats.evicted++;
+            return;
+        }
+    }
+}
+
+static int station_find(const modem_conntrack_t *ct, uint32_t ip)
+{
+    for (int i = 0; i < MODEM_CONNTRACK_MAX_STATIONS; i++) {
+        if (ct->stations[i].ip == ip) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* a new station takes an unused entry, or the one without flows that was idle longest */
+static int station_get(modem_conntrack_t *ct, uint32_t ip, uint32_t now_ms)
+{
+    int found = station_find(ct, ip);
+    int i;
+
+    if (found >= 0) {
+        return found;
+    }
+    for (i = 0; i < MODEM_CONNTRACK_MAX_STATIONS; i++) {
+        modem_conntrack_station_t *st = &ct->stations[i];
+        if (st->ip == 0) {
+            found = i;
+            break;
+        }
+        if (st->flows == 0 && (found < 0 || TIME_AFTER_EQ(ct->stations[found].last_ms, st->last_ms))) {
+            found = i;
+        }
+    }
+    if (found >= 0) {
+        memset(&ct->stations[found], 0, sizeof(ct->stations[found]));
+        ct->stations[found].ip = ip;
+        ct->stations[found].last_ms = now_ms;
+    }
+    return found;
+}
+
+int modem_conntrack_init(modem_conntrack_t *ct, const modem_conntrack_config_t *config)
+{
+    uint32_t buckets = 16;
+    uint32_t i;
+
+    if (ct == NULL || config == NULL || config->max_flows == 0 || config->max_flows >= NIL) {
+        return -1;
+    }
+    /* at most one flow per bucket on average */
+    while (buckets < config->max_flows) {
+        buckets <<= 1;
+    }
+    memset(ct, 0, sizeof(*ct));
+    ct->flows = calloc(config->max_flows, sizeof(modem_conntrack_flow_t));
+    ct->buckets = malloc(buckets * sizeof(uint16_t));
+    if (ct->flows == NULL || ct->buckets == NULL) {
+        modem_conntrack_deinit(ct);
+        return -1;
+    }
+    ct->cfg = *config;
+    ct->bucket_mask = buckets - 1;
+    memset(ct->buckets, 0xFF, buckets * sizeof(uint16_t));
+    memset(ct->wheel, 0xFF, sizeof(ct->wheel));
+    for (i = 0; i < config->max_flows; i++) {
+        ct->flows[i].station = NO_STATION;
+        ct->flows[i].hnext = i + 1 < config->max_flows ? i + 1 : NIL;
+    }
+    ct->free_head = 0;
+    return 0;
+}
+
+void modem_conntrack_deinit(modem_conntrack_t *ct)
+{
+    free(ct->flows);
+    free(ct->buckets);
+    ct->flows = NULL;
+    ct->buckets = NULL;
+}
+
+int modem_conntrack_parse_ipv4(const uint8_t *pkt, size_t len, uint32_t lan_ip, uint32_t lan_mask,
+                               modem_conntrack_tuple_t *tuple, int *dir, uint8_t *tcp_flags, uint32_t *bytes)
+{
+    uint32_t src, dst;
+    uint16_t sport = 0, dport = 0;
+    size_t ihl;
+
+    if (len < 20 || (pkt[0] >> 4) != 4) {
+        return -1;
+    }
+    ihl = (pkt[0] & 0x0F) * 4;
+    if (ihl < 20 || len < ihl) {
+        return -1;
+    }
+    memcpy(&src, pkt + 12, 4);
+    memcpy(&dst, pkt + 16, 4);
+    *tcp_flags = 0;
+    *bytes = (uint32_t)pkt[2] << 8 | pkt[3];
+
+    const uint8_t *l4 = pkt + ihl;
+    size_t l4_len = len - ihl;
+    int first_fragment = ((pkt[6] & 0x1F) | pkt[7]) == 0;
+
+    /* a later fragment has no ports, it is counted on the flow without them */
+    if (first_fragment && (pkt[9] == IP_PROTO_TCP || pkt[9] == IP_PROTO_UDP) && l4_len >= 4) {
+        memcpy(&sport, l4, 2);
+        memcpy(&dport, l4 + 2, 2);
+        if (pkt[9] == IP_PROTO_TCP && l4_len >= 14) {
+            *tcp_flags = l4[13];
+        }
+    }
+
+    if ((src & lan_mask) == (lan_ip & lan_mask)) {
+        *dir = MODEM_CONNTRACK_UP;
+        tuple->sta_ip = src;
+        tuple->peer_ip = dst;
+        tuple->sta_port = sport;
+        tuple->peer_port = dport;
+    } else if ((dst & lan_mask) == (lan_ip & lan_mask)) {
+        *dir = MODEM_CONNTRACK_DOWN;
+        tuple->sta_ip = dst;
+        tuple->peer_ip = src;
+        tuple->sta_port = dport;
+        tuple->peer_port = sport;
+    } else {
+        return -1;
+    }
+    tuple->proto = pkt[9];
+
+    /* echo request and reply belong together through their identifier */
+    if (first_fragment && pkt[9] == IP_PROTO_ICMP && l4_len >= 8 && (l4[0] == 0 || l4[0] == 8)) {
+        memcpy(&tuple->sta_port, l4 + 4, 2);
+    }
+    return 0;
+}
+
+int modem_conntrack_update(modem_conntrack_t *ct, const modem_conntrack_tuple_t *tuple, int dir,
+                           uint32_t bytes, uint8_t tcp_flags, uint32_t now_ms)
+{
+    uint16_t *bucket = &ct->buckets[tuple_hash(tuple) & ct->bucket_mask];
+    uint16_t idx = *bucket;
+    modem_conntrack_flow_t *f;
+    int created = 0;
+
+    if (!ct->started) {
+        ct->tick = now_ms / MODEM_CONNTRACK_WHEEL_TICK_MS - 1;
+        ct->started = 1;
+    }
+    ct->stats.lookups++;
+    while (idx != NIL && !tuple_equal(&ct->flows[idx].key, tuple)) {
+        idx = ct->flows[idx].hnext;
+    }
+
+    if (idx == NIL) {
+        int st = station_get(ct, tuple->sta_ip, now_ms);
+        if (st < 0) {
+            ct->stats.no_station++;
+            return -1;
+        }
+        if (ct->free_head == NIL) {
+            flow_evict(ct);
+        }
+        idx = ct->free_head;
+        f = &ct->flows[idx];
+        ct->free_head = f->hnext;
+
+        memset(f, 0, sizeof(*f));
+        f->key = *tuple;
+        f->station = (uint8_t)st;
+        f->hnext = *bucket;
+        *bucket = idx;
+        wheel_link(ct, idx, now_ms + flow_timeout(ct, f), ct->tick);
+        ct->stations[st].flows++;
+        ct->stats.created++;
+        if (++ct->stats.flows > ct->stats.flows_max) {
+            ct->stats.flows_max = ct->stats.flows;
+        }
+        created = 1;
+    }
+
+    f = &ct->flows[idx];
+    modem_conntrack_station_t *st = &ct->stations[f->station];
+    f->last_ms = now_ms;
+    f->bytes[dir] += bytes;
+    f->packets[dir]++;
+    st->last_ms = now_ms;
+    st->bytes[dir] += bytes;
+    st->packets[dir]++;
+
+    /* a closing connection has to go sooner than the slot it was filed under */
+    if (!f->closing && tuple->proto == IP_PROTO_TCP && (tcp_flags & (MODEM_CONNTRACK_TCP_FIN | MODEM_CONNTRACK_TCP_RST))) {
+        f->closing = 1;
+        wheel_unlink(ct, idx);
+        wheel_link(ct, idx, now_ms + flow_timeout(ct, f), ct->tick);
+    }
+    return created;
+}
+
+uint32_t modem_conntrack_expire(modem_conntrack_t *ct, uint32_t now_ms, uint32_t budget)
+{
+    uint32_t now_tick = now_ms / MODEM_CONNTRACK_WHEEL_TICK_MS;
+    uint32_t removed = 0;
+
+    if (!ct->started) {
+        return 0;
+    }
+    /* after a long pause one turn covers every slot */
+    if ((int32_t)(now_tick - ct->tick) > MODEM_CONNTRACK_WHEEL_SLOTS + 1) {
+        ct->tick = now_tick - MODEM_CONNTRACK_WHEEL_SLOTS - 1;
+    }
+    /* a slot is done once its whole tick has passed, every deadline in it is then due */
+    while ((int32_t)(now_tick - (ct->tick + 1)) > 0) {
+        uint32_t tick = ct->tick + 1;
+        uint16_t idx = ct->wheel[tick & WHEEL_MASK];
+
+        while (idx != NIL) {
+            modem_conntrack_flow_t *f = &ct->flows[idx];
+            uint16_t next = f->wnext;
+            uint32_t deadline = f->last_ms + flow_timeout(ct, f);
+
+            if (budget == 0) {
+                return removed;
+            }
+            budget--;
+            if (TIME_AFTER_EQ(now_ms, deadline)) {
+                flow_free(ct, idx);
+                ct->stats.expired++;
+                removed++;
+            } else {
+                wheel_unlink(ct, idx);
+                wheel_link(ct, idx, deadline, tick);
+            }
+            idx = next;
+        }
+        ct->tick = tick;
+    }
+    return removed;
+}
+
+int modem_conntrack_get_station(const modem_conntrack_t *ct, uint32_t ip, modem_conntrack_station_t *station)
+{
+    int i = ip ? station_find(ct, ip) : -1;
+
+    if (i < 0) {
+        return -1;
+    }
+    *station = ct->stations[i];
+    return 0;
+}
+
+uint32_t modem_conntrack_remove_station(modem_conntrack_t *ct, uint32_t ip)
+{
+    int st = ip ? station_find(ct, ip) : -1;
+    uint32_t removed = 0;
+
+    if (st < 0) {
+        return 0;
+    }
+    for (uint32_t i = 0; i < ct->cfg.max_flows && ct->stations[st].flows; i++) {
+        if (ct->flows[i].station == st) {
+            flow_free(ct, (uint16_t)i);
+            removed++;
+        }
+    }
+    ct->stats.removed += removed;
+    memset(&ct->stations[st], 0, sizeof(ct->stations[st]));
+    return removed;
+}
+
+void modem_conntrack_get_stats(const modem_conntrack_t *ct, modem_conntrack_stats_t *stats)
+{
+    *stats = ct->stats;
+}
@@ -0,0 +1,202 @@
+/*
+ * SPDX-FileCopyrightText: 2024 ShenZhen XinYuan Electronic Technology Co., Ltd
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Connection tracking for the NAT router.
+ *
+ * Every packet forwarded between the Wi-Fi stations and the 4G link is looked up by
+ * its 5-tuple, seen from the station side, in a hash table of preallocated flows.
+ * Bytes and packets are counted per flow and per station, so the station list can
+ * be served from here without walking anything.
+ *
+ * Idle flows are removed by a timing wheel: a flow sits in the slot of its deadline
+ * and is only looked at again when the wheel reaches that slot, a packet just
+ * refreshes its time stamp. When the table is full, the flow closest to its
+ * deadline makes room for the new one.
+ *
+ * No locking and no OS calls inside, the caller serializes the accesses.
+ * IP addresses and ports are kept in network order, as they are in the packet.
+ */
+
+#define MODEM_CONNTRACK_MAX_STATIONS    16
+#define MODEM_CONNTRACK_WHEEL_SLOTS     64      /*!< power of two */
+#define MODEM_CONNTRACK_WHEEL_TICK_MS   1000
+
+#define MODEM_CONNTRACK_UP              0       /*!< station to the 4G link */
+#define MODEM_CONNTRACK_DOWN            1       /*!< 4G link to the station */
+
+#define MODEM_CONNTRACK_TCP_FIN         0x01
+#define MODEM_CONNTRACK_TCP_RST         0x04
+
+/**
+ * @brief Flow key, from the station side
+ */
+typedef struct {
+    uint32_t sta_ip;                /*!< station address */
+    uint32_t peer_ip;               /*!< remote address */
+    uint16_t sta_port;              /*!< station port, ICMP echo id */
+    uint16_t peer_port;             /*!< remote port */
+    uint8_t proto;                  /*!< IP protocol number */
+} modem_conntrack_tuple_t;
+
+/**
+ * @brief Table size and idle timeouts
+ */
+typedef struct {
+    uint16_t max_flows;             /*!< preallocated flows, at most 65534 */
+    uint32_t tcp_timeout_ms;        /*!< established TCP */
+    uint32_t tcp_closing_timeout_ms;/*!< TCP after a FIN or a RST */
+    uint32_t udp_timeout_ms;        /*!< UDP */
+    uint32_t other_timeout_ms;      /*!< ICMP and everything else */
+} modem_conntrack_config_t;
+
+/**
+ * @brief Per station accounting
+ */
+typedef struct {
+    uint32_t ip;                    /*!< station address, 0 for an unused entry */
+    uint64_t bytes[2];              /*!< IP bytes, indexed by MODEM_CONNTRACK_UP / DOWN */
+    uint32_t packets[2];            /*!< packets, indexed by MODEM_CONNTRACK_UP / DOWN */
+    uint16_t flows;                 /*!< flows in the table */
+    uint32_t last_ms;               /*!< time of the last packet */
+} modem_conntrack_station_t;
+
+/**
+ * @brief Table counters
+ */
+typedef struct {
+    uint32_t flows;                 /*!< flows in the table */
+    uint32_t flows_max;             /*!< highest number of flows */
+    uint32_t lookups;               /*!< packets looked up */
+    uint32_t created;               /*!< flows created */
+    uint32_t expired;               /*!< flows removed by the idle timeout */
+    uint32_t evicted;               /*!< flows removed to make room */
+    uint32_t removed;               /*!< flows removed with their station */
+    uint32_t no_station;            /*!< packets not counted, the station table was full */
+} modem_conntrack_stats_t;
+
+/**
+ * @brief A tracked flow, treat as opaque
+ */
+typedef struct {
+    modem_conntrack_tuple_t key;
+    uint16_t hnext;                 /*!< hash chain, or free list */
+    uint16_t wprev;                 /*!< wheel slot list */
+    uint16_t wnext;
+    uint8_t wslot;
+    uint8_t station;                /*!< station index, 0xFF when the flow is free */
+    uint8_t closing;                /*!< TCP FIN or RST seen */
+    uint32_t last_ms;
+    uint32_t bytes[2];
+    uint32_t packets[2];
+} modem_conntrack_flow_t;
+
+/**
+ * @brief Table state, treat as opaque
+ */
+typedef struct {
+    modem_conntrack_config_t cfg;
+    modem_conntrack_flow_t *flows;
+    uint16_t *buckets;
+    uint32_t bucket_mask;
+    uint16_t free_head;
+    uint16_t wheel[MODEM_CONNTRACK_WHEEL_SLOTS];
+    uint32_t tick;                  /*!< last wheel tick processed */
+    uint8_t started;
+    modem_conntrack_station_t stations[MODEM_CONNTRACK_MAX_STATIONS];
+    modem_conntrack_stats_t stats;
+} modem_conntrack_t;
+
+/**
+ * @brief Allocate the table
+ *
+ * @param ct table state
+ * @param config size and timeouts, copied
+ * @return 0 on success, -1 on a bad config or out of memory
+ */
+int modem_conntrack_init(modem_conntrack_t *ct, const modem_conntrack_config_t *config);
+
+/**
+ * @brief Free the table
+ */
+void modem_conntrack_deinit(modem_conntrack_t *ct);
+
+/**
+ * @brief Extract the flow key of an IPv4 packet
+ *
+ * @param pkt packet, from the IP header on
+ * @param len bytes available at pkt, the TCP/UDP ports must be in there
+ * @param lan_ip address of the Wi-Fi side, network order
+ * @param lan_mask netmask of the Wi-Fi side, network order
+ * @param tuple flow key
+ * @param dir MODEM_CONNTRACK_UP or MODEM_CONNTRACK_DOWN
+ * @param tcp_flags TCP flags, 0 for other protocols
+ * @param bytes IP length of the packet
+ * @return 0 on success, -1 if the packet is not IPv4 or does not cross the LAN boundary
+ */
+int modem_conntrack_parse_ipv4(const uint8_t *pkt, size_t len, uint32_t lan_ip, uint32_t lan_mask,
+                               modem_conntrack_tuple_t *tuple, int *dir, uint8_t *tcp_flags, uint32_t *bytes);
+
+/**
+ * @brief Account a packet, creating its flow on the first one
+ *
+ * @param ct table state
+ * @param tuple flow key
+ * @param dir MODEM_CONNTRACK_UP or MODEM_CONNTRACK_DOWN
+ * @param bytes IP length of the packet
+ * @param tcp_flags TCP flags of the packet
+ * @param now_ms current time
+ * @return 0 for a known flow, 1 for a new one, -1 if the station table is full
+ */
+int modem_conntrack_update(modem_conntrack_t *ct, const modem_conntrack_tuple_t *tuple, int dir,
+                           uint32_t bytes, uint8_t tcp_flags, uint32_t now_ms);
+
+/**
+ * @brief Turn the wheel up to now and remove the idle flows
+ *
+ * @param ct table state
+ * @param now_ms current time
+ * @param budget most flows to look at, the rest is left for the next call
+ * @return flows removed
+ */
+uint32_t modem_conntrack_expire(modem_conntrack_t *ct, uint32_t now_ms, uint32_t budget);
+
+/**
+ * @brief Get the accounting of a station
+ *
+ * @param ct table state
+ * @param ip station address, network order
+ * @param station copy of the entry
+ * @return 0 on success, -1 if the station has not sent anything yet
+ */
+int modem_conntrack_get_station(const modem_conntrack_t *ct, uint32_t ip, modem_conntrack_station_t *station);
+
+/**
+ * @brief Forget a station and drop its flows, e.g. when it leaves the AP
+ *
+ * @param ct table state
+ * @param ip station address, network order
+ * @return flows removed
+ */
+uint32_t modem_conntrack_remove_station(modem_conntrack_t *ct, uint32_t ip);
+
+/**
+ * @brief Get a copy of the counters
+ */
+void modem_conntrack_get_stats(const modem_conntrack_t *ct, modem_conntrack_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
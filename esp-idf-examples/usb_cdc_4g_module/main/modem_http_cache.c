@@ -0,0 +1,141 @@
+/*
+ * SPDX-FileCopyrightText: 2024 ShenZhen XinYuan Electronic Technology Co., Ltd
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "modem_http_cache.h"
+
+#define BODY_MIN_CAP    256
+
+void modem_http_cache_init(modem_http_cache_t *cache)
+{
+    memset(cache, 0, sizeof(*cache));
+}
+
+void modem_http_cache_deinit(modem_http_cache_t *cache)
+{
+    for (int i = 0; i < MODEM_HTTP_CACHE_MAX_ENTRIES; i++) {
+        free(cache->entries[i].body);
+    }
+    memset(cache, 0, sizeof(*cache));
+}
+
+void modem_http_cache_set_max_age(modem_http_cache_t *cache, int key, uint32_t max_age_ms)
+{
+    cache->entries[key].max_age_ms = max_age_ms;
+}
+
+void modem_http_cache_invalidate(modem_http_cache_t *cache, int key)
+{
+    __atomic_add_fetch(&cache->gen[key], 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&cache->stats.invalidations, 1, __ATOMIC_RELAXED);
+}
+
+const modem_http_cache_entry_t *modem_http_cache_lookup(modem_http_cache_t *cache, int key, uint32_t now_ms)
+{
+    const modem_http_cache_entry_t *entry = &cache->entries[key];
+
+    if (!entry->valid || entry->gen != __atomic_load_n(&cache->gen[key], __ATOMIC_ACQUIRE)
+            || (entry->max_age_ms && now_ms - entry->rendered_ms >= entry->max_age_ms)) {
+        return NULL;
+    }
+    cache->stats.hits++;
+    return entry;
+}
+
+modem_http_cache_entry_t *modem_http_cache_begin(modem_http_cache_t *cache, int key)
+{
+    modem_http_cache_entry_t *entry = &cache->entries[key];
+
+    /* an invalidation that comes in while rendering leaves the result stale */
+    entry->gen = __atomic_load_n(&cache->gen[key], __ATOMIC_ACQUIRE);
+    entry->valid = false;
+    entry->failed = false;
+    entry->len = 0;
+    return entry;
+}
+
+int modem_http_cache_printf(modem_http_cache_entry_t *entry, const char *fmt, ...)
+{
+    va_list ap;
+    int n;
+
+    if (entry->failed) {
+        return -1;
+    }
+    for (;;) {
+        size_t room = entry->cap - entry->len;
+        va_start(ap, fmt);
+        n = vsnprintf(entry->body ? entry->body + entry->len : NULL, room, fmt, ap);
+        va_end(ap);
+        if (n < 0) {
+            break;
+        }
+        if ((size_t)n < room) {
+            entry->len += n;
+            return 0;
+        }
+        /* the buffer is kept across renders, it only grows */
+        size_t cap = entry->cap ? entry->cap : BODY_MIN_CAP;
+        while (cap - entry->len <= (size_t)n) {
+            cap *= 2;
+        }
+        char *body = realloc(entry->body, cap);
+        if (body == NULL) {
+            break;
+        }
+        entry->body = body;
+        entry->cap = cap;
+    }
+    entry->failed = true;
+    return -1;
+}
+
+const modem_http_cache_entry_t *modem_http_cache_commit(modem_http_cache_t *cache, modem_http_cache_entry_t *entry, uint32_t now_ms)
+{
+    uint32_t hash = 2166136261u;
+
+    if (entry->failed || entry->body == NULL) {
+        return NULL;
+    }
+    for (size_t i = 0; i < entry->len; i++) {
+        hash = (hash ^ (uint8_t)entry->body[i]) * 16777619u;
+    }
+    snprintf(entry->etag, sizeof(entry->etag), "\"%08x\"", (unsigned)hash);
+    entry->rendered_ms = now_ms;
+    entry->valid = true;
+    cache->stats.renders++;
+    return entry;
+}
+
+bool modem_http_cache_not_modified(modem_http_cache_t *cache, const char *if_none_match, const char *etag)
+{
+    const char *p = if_none_match;
+    size_t etag_len = strlen(etag);
+
+    while (p && *p) {
+        while (*p == ' ' || *p == ',') {
+            p++;
+        }
+        /* weak comparison, as RFC 9110 asks for If-None-Match */
+        if (p[0] == 'W' && p[1] == '/') {
+            p += 2;
+        }
+        if (*p == '*' || (strncmp(p, etag, etag_len) == 0 && (p[etag_len] == '\0' || p[etag_len] == ',' || p[etag_len] == ' '))) {
+            cache->stats.not_modified++;
+            return true;
+        }
+        p = strchr(p, ',');
+    }
+    return false;
+}
+
+void modem_http_cache_get_stats(const modem_http_cache_t *cache, modem_http_cache_stats_t *stats)
+{
+    *stats = cache->stats;
+}
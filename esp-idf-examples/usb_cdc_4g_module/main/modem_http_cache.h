@@ -0,0 +1,141 @@
+/*
+ * SPDX-FileCopyrightText: 2024 ShenZhen XinYuan Electronic Technology Co., Ltd
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Rendered responses of the router web server, one entry per endpoint.
+ *
+ * A GET handler looks its entry up and only renders the body when it is stale:
+ * invalidated since it was rendered, or older than its max age for data that keeps
+ * changing such as traffic counters. Invalidation just bumps a generation number,
+ * so it can be called from any task, e.g. the event loop when a station joins;
+ * the entries themselves belong to the httpd task.
+ *
+ * Every body carries an ETag, so a client that already has it gets a 304.
+ */
+
+#define MODEM_HTTP_CACHE_MAX_ENTRIES    8
+#define MODEM_HTTP_CACHE_ETAG_LEN       12  /*!< "xxxxxxxx" and the terminator */
+
+/**
+ * @brief A rendered response
+ */
+typedef struct {
+    char *body;                     /*!< not NUL terminated past len */
+    size_t len;
+    size_t cap;
+    uint32_t gen;                   /*!< generation the body was rendered for */
+    uint32_t rendered_ms;
+    uint32_t max_age_ms;            /*!< 0 to keep until invalidated */
+    bool valid;
+    bool failed;                    /*!< out of memory while rendering */
+    char etag[MODEM_HTTP_CACHE_ETAG_LEN];
+} modem_http_cache_entry_t;
+
+/**
+ * @brief Cache counters
+ */
+typedef struct {
+    uint32_t hits;                  /*!< served from the cache */
+    uint32_t renders;               /*!< rendered again */
+    uint32_t not_modified;          /*!< answered with a 304 */
+    uint32_t invalidations;
+} modem_http_cache_stats_t;
+
+/**
+ * @brief Cache state, treat as opaque
+ */
+typedef struct {
+    modem_http_cache_entry_t entries[MODEM_HTTP_CACHE_MAX_ENTRIES];
+    volatile uint32_t gen[MODEM_HTTP_CACHE_MAX_ENTRIES];
+    modem_http_cache_stats_t stats;
+} modem_http_cache_t;
+
+/**
+ * @brief Prepare an empty cache
+ */
+void modem_http_cache_init(modem_http_cache_t *cache);
+
+/**
+ * @brief Free the rendered bodies
+ */
+void modem_http_cache_deinit(modem_http_cache_t *cache);
+
+/**
+ * @brief Let an entry go stale on its own after a while, besides invalidation
+ *
+ * @param cache cache state
+ * @param key entry, below MODEM_HTTP_CACHE_MAX_ENTRIES
+ * @param max_age_ms 0 to keep it until invalidated
+ */
+void modem_http_cache_set_max_age(modem_http_cache_t *cache, int key, uint32_t max_age_ms);
+
+/**
+ * @brief Mark an entry stale, callable from any task
+ */
+void modem_http_cache_invalidate(modem_http_cache_t *cache, int key);
+
+/**
+ * @brief Get an entry that is still fresh
+ *
+ * @param cache cache state
+ * @param key entry
+ * @param now_ms current time
+ * @return the entry, or NULL when it has to be rendered
+ */
+const modem_http_cache_entry_t *modem_http_cache_lookup(modem_http_cache_t *cache, int key, uint32_t now_ms);
+
+/**
+ * @brief Start rendering an entry, its previous body is dropped
+ *
+ * @return the entry to append to with modem_http_cache_printf()
+ */
+modem_http_cache_entry_t *modem_http_cache_begin(modem_http_cache_t *cache, int key);
+
+/**
+ * @brief Append to the body being rendered
+ *
+ * @return 0 on success, -1 out of memory, the entry is then not committed
+ */
+int modem_http_cache_printf(modem_http_cache_entry_t *entry, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Finish rendering, compute the ETag
+ *
+ * @param cache cache state
+ * @param entry entry from modem_http_cache_begin()
+ * @param now_ms current time
+ * @return the entry, or NULL if rendering ran out of memory
+ */
+const modem_http_cache_entry_t *modem_http_cache_commit(modem_http_cache_t *cache, modem_http_cache_entry_t *entry, uint32_t now_ms);
+
+/**
+ * @brief Compare the ETag a client sent in If-None-Match, counts a 304
+ *
+ * @param cache cache state
+ * @param if_none_match header value, may list several tags or be "*"
+ * @param etag ETag of the current body
+ * @return true if the client copy is current
+ */
+bool modem_http_cache_not_modified(modem_http_cache_t *cache, const char *if_none_match, const char *etag);
+
+/**
+ * @brief Get a copy of the counters
+ */
+void modem_http_cache_get_stats(const modem_http_cache_t *cache, modem_http_cache_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -5,10 +5,12 @@
  */
 
 #include <fcntl.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/param.h>
+#include <sys/stat.h>
 #include "esp_eth.h"
 #include "esp_mac.h"
 #include "esp_netif.h"
@@ -24,6 +26,11 @@
 #include "esp_log.h"
 #include "esp_wifi.h"
 #include "modem_http_config.h"
+#include "modem_conntrack.h"
+#include "modem_http_cache.h"
+#ifdef CONFIG_EXAMPLE_ENABLE_CONNTRACK
+#include "modem_napt.h"
+#endif
 
 /* A simple example that demonstrates how to create GET and POST
  * handlers for the web server.
@@ -41,9 +48,23 @@ static const char *TAG = "4g_router_server";
 
 #define FILE_PATH_MAX (ESP_VFS_PATH_MAX + 128)
 #define SCRATCH_BUFSIZE (10240)
+#define WEB_ETAGS_FILE "/etags"     /* written by tools/gzip_assets.py */
 
 #define CHECK_FILE_EXTENSION(filename, ext) (strcasecmp(&filename[strlen(filename) - strlen(ext)], ext) == 0)
 
+/**
+ * @brief Rendered responses, rendered again after the matching POST or station event
+ *
+ */
+enum {
+    HTTP_CACHE_WLAN_GENERAL = 0,
+    HTTP_CACHE_WLAN_ADVANCE,
+    HTTP_CACHE_STATION_LIST,
+};
+/* the station list carries traffic counters, they may be that old */
+#define HTTP_CACHE_STATION_MAX_AGE_MS 1000
+static modem_http_cache_t s_http_cache;
+
 /**
  * @brief Store the currently connected sta
  *
@@ -84,11 +105,13 @@ static void delete_char(char *str, char target)
 
 typedef struct rest_server_context {
     char base_path[ESP_VFS_PATH_MAX + 1];
+    char *etags;    /* "<path> <content hash>" lines of the web assets, NULL without */
     char scratch[SCRATCH_BUFSIZE];
 } rest_server_context_t;
 typedef struct {
     char *username;
     char *password;
+    char *digest;   /* "Basic <base64>", computed once */
 } basic_auth_info_t;
 
 typedef struct {
@@ -144,7 +167,7 @@ static esp_err_t basic_auth_get(httpd_req_t *req)
             ESP_LOGE(TAG, "No auth value received");
         }
 
-        char *auth_credentials = http_auth_basic(basic_auth_info->username, basic_auth_info->password);
+        const char *auth_credentials = basic_auth_info->digest;
         if (!auth_credentials) {
             ESP_LOGE(TAG, "No enough memory for basic authorization credentials");
             free(buf);
@@ -160,7 +183,6 @@ static esp_err_t basic_auth_get(httpd_req_t *req)
             httpd_resp_set_hdr(req, "Connection", "keep-alive");
             httpd_resp_set_hdr(req, "WWW-Authenticate", "Basic realm=\"router\"");
             httpd_resp_send(req, NULL, 0);
-            free(auth_credentials);
             free(buf);
             return ESP_FAIL;
         } else {
@@ -168,7 +190,6 @@ static esp_err_t basic_auth_get(httpd_req_t *req)
             httpd_resp_set_status(req, HTTPD_200);
             httpd_resp_set_type(req, "application/json");
             httpd_resp_set_hdr(req, "Connection", "keep-alive");
-            free(auth_credentials);
             free(buf);
             return ESP_OK;
         }
@@ -185,6 +206,50 @@ static esp_err_t basic_auth_get(httpd_req_t *req)
     return ESP_OK;
 }
 
+static uint32_t http_now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+/* Answer with a 304 and no body when the client already has this version */
+static bool http_resp_not_modified(httpd_req_t *req, const char *etag)
+{
+    char if_none_match[64];
+    esp_err_t err = httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match));
+    if (err != ESP_OK || !modem_http_cache_not_modified(&s_http_cache, if_none_match, etag)) {
+        return false;
+    }
+    httpd_resp_set_status(req, "304 Not Modified");
+    httpd_resp_send(req, NULL, 0);
+    return true;
+}
+
+static bool http_accepts_gzip(httpd_req_t *req)
+{
+    char accept_encoding[64];
+    esp_err_t err = httpd_req_get_hdr_value_str(req, "Accept-Encoding", accept_encoding, sizeof(accept_encoding));
+    /* a truncated value still holds its first encodings */
+    return (err == ESP_OK || err == ESP_ERR_HTTPD_RESULT_TRUNC) && strstr(accept_encoding, "gzip") != NULL;
+}
+
+/* Send a cached JSON body, the client revalidates it with its ETag */
+static esp_err_t http_send_cached(httpd_req_t *req, const modem_http_cache_entry_t *entry)
+{
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "*");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "*");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    httpd_resp_set_hdr(req, "ETag", entry->etag);
+    if (http_resp_not_modified(req, entry->etag)) {
+        return ESP_OK;
+    }
+    esp_err_t ret = httpd_resp_set_status(req, HTTPD_200);
+    ESP_ERROR_CHECK(ret);
+    ret = httpd_resp_set_type(req, HTTPD_TYPE_JSON);
+    ESP_ERROR_CHECK(ret);
+    return httpd_resp_send(req, entry->body, entry->len);
+}
+
 void nvs_get_str_log(esp_err_t err, char *key, char *value)
 {
     switch (err) {
@@ -260,6 +325,7 @@ static esp_err_t stalist_update()
             sprintf(mac_addr, "%02x%02x%02x%02x%02x%02x", node->mac[0], node->mac[1], node->mac[2], node->mac[3], node->mac[4], node->mac[5]);
             from_nvs_get_value(mac_addr, node->name, &name_size);
         }
+        modem_http_cache_invalidate(&s_http_cache, HTTP_CACHE_STATION_LIST);
         if (!(pdTRUE == xSemaphoreGive(s_sta_node_mutex))) {
             ESP_LOGE(TAG, "give semaphore failed");
         };
@@ -268,11 +334,49 @@ static esp_err_t stalist_update()
     return ESP_OK;
 }
 
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+static esp_err_t stalist_set_ip(uint8_t mac[6], esp_ip4_addr_t ip)
+{
+    struct modem_netif_sta_info *node;
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    STA_CHECK(pdTRUE == xSemaphoreTake(s_sta_node_mutex, STA_NODE_MUTEX_TICKS_TO_WAIT), "take semaphore timeout", ESP_ERR_TIMEOUT);
+    SLIST_FOREACH(node, &s_sta_list_head, field) {
+        if (!memcmp(node->mac, mac, 6)) {
+            node->ip = ip;
+            ESP_LOGI(TAG, "MAC is " MACSTR ", IP is " IPSTR, MAC2STR(node->mac), IP2STR(&node->ip));
+            ret = ESP_OK;
+            break;
+        }
+    }
+    modem_http_cache_invalidate(&s_http_cache, HTTP_CACHE_STATION_LIST);
+    STA_CHECK(pdTRUE == xSemaphoreGive(s_sta_node_mutex), "give semaphore failed", ESP_FAIL);
+    return ret;
+}
+#endif
+
 modem_http_list_head_t *modem_http_get_stalist()
 {
     return &s_sta_list_head;
 }
 
+/* The name a station got on the web page, the key is the MAC without colons */
+static esp_err_t stalist_set_name(const char *mac_key, const char *name)
+{
+    struct modem_netif_sta_info *node;
+    char node_key[13];
+    STA_CHECK(pdTRUE == xSemaphoreTake(s_sta_node_mutex, STA_NODE_MUTEX_TICKS_TO_WAIT), "take semaphore timeout", ESP_ERR_TIMEOUT);
+    SLIST_FOREACH(node, &s_sta_list_head, field) {
+        snprintf(node_key, sizeof(node_key), "%02x%02x%02x%02x%02x%02x", node->mac[0], node->mac[1], node->mac[2], node->mac[3], node->mac[4], node->mac[5]);
+        if (!strcasecmp(node_key, mac_key)) {
+            strlcpy(node->name, name, sizeof(node->name));
+            break;
+        }
+    }
+    modem_http_cache_invalidate(&s_http_cache, HTTP_CACHE_STATION_LIST);
+    STA_CHECK(pdTRUE == xSemaphoreGive(s_sta_node_mutex), "give semaphore failed", ESP_FAIL);
+    return ESP_OK;
+}
+
 static esp_err_t stalist_add_node(uint8_t mac[6])
 {
     // STA_CHECK(sta != NULL, "sta pointer can not be NULL", ESP_ERR_INVALID_ARG);
@@ -297,6 +401,7 @@ static esp_err_t stalist_add_node(uint8_t mac[6])
     dhcp_search_ip_on_mac(node->mac, (ip4_addr_t *)&node->ip);
 #endif
     SLIST_INSERT_HEAD(&s_sta_list_head, node, field);
+    modem_http_cache_invalidate(&s_http_cache, HTTP_CACHE_STATION_LIST);
     STA_CHECK_GOTO(pdTRUE == xSemaphoreGive(s_sta_node_mutex), "give semaphore failed", cleanupnode);
     return ESP_OK;
 cleanupnode:
@@ -313,15 +418,19 @@ static esp_err_t sta_remove_node(uint8_t mac[6])
             ESP_LOGI(TAG, "remove MAC is " MACSTR ", IP is " IPSTR ", start_time is %lld ", MAC2STR(node->mac),
                      IP2STR(&node->ip), node->start_time);
             SLIST_REMOVE(&s_sta_list_head, node, modem_netif_sta_info, field);
+#ifdef CONFIG_EXAMPLE_ENABLE_CONNTRACK
+            modem_napt_station_leave(node->ip);
+#endif
             free(node);
             break;
         }
     }
+    modem_http_cache_invalidate(&s_http_cache, HTTP_CACHE_STATION_LIST);
     STA_CHECK(pdTRUE == xSemaphoreGive(s_sta_node_mutex), "give semaphore failed", ESP_FAIL);
     return ESP_OK;
 }
 
-static esp_err_t wlan_general_get_handler(httpd_req_t *req)
+static esp_err_t wlan_general_render(modem_http_cache_entry_t *entry)
 {
     const char *user_ssid = s_modem_wifi_config->ssid;
     const char *user_password = s_modem_wifi_config->password;
@@ -355,38 +464,29 @@ static esp_err_t wlan_general_get_handler(httpd_req_t *req)
         break;
     }
 
+    modem_http_cache_printf(entry,
+                            "{\"status\":\"200\", \"ssid\":\"%s\", \"if_hide_ssid\":\"%s\", "
+                            "\"auth_mode\":\"%s\", \"password\":\"%s\"}",
+                            user_ssid, user_hide_ssid, user_auth_mode, user_password);
+    return ESP_OK;
+}
+
+static esp_err_t wlan_general_get_handler(httpd_req_t *req)
+{
     esp_err_t err = basic_auth_get(req);
     REST_CHECK(err == ESP_OK, "not login yet", end);
 
-    char *json_str = NULL;
-    size_t size = 0;
-    size = asprintf(&json_str,
-                    "{\"status\":\"200\", \"ssid\":\"%s\", \"if_hide_ssid\":\"%s\", "
-                    "\"auth_mode\":\"%s\", \"password\":\"%s\"}",
-                    user_ssid, user_hide_ssid, user_auth_mode, user_password);
-
-    /**
-     * @brief Set the HTTP status code
-     */
-    esp_err_t ret = httpd_resp_set_status(req, HTTPD_200);
-    ESP_ERROR_CHECK(ret);
-    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-    httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "*");
-    httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "*");
-    /**
-     * @brief Set the HTTP content type
-     */
-    ret = httpd_resp_set_type(req, HTTPD_TYPE_JSON);
-    ESP_ERROR_CHECK(ret);
-
-    /**
-     * @brief Set some custom headers
-     */
-
-    ret = httpd_resp_send(req, json_str, size);
-    free(json_str);
-    ESP_ERROR_CHECK(ret);
-    return ESP_OK;
+    const modem_http_cache_entry_t *entry = modem_http_cache_lookup(&s_http_cache, HTTP_CACHE_WLAN_GENERAL, http_now_ms());
+    if (entry == NULL) {
+        modem_http_cache_entry_t *render = modem_http_cache_begin(&s_http_cache, HTTP_CACHE_WLAN_GENERAL);
+        wlan_general_render(render);
+        entry = modem_http_cache_commit(&s_http_cache, render, http_now_ms());
+    }
+    if (entry == NULL) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "No enough memory");
+        return ESP_FAIL;
+    }
+    return http_send_cached(req, entry);
 end:
     return ESP_OK;
 }
@@ -490,6 +590,7 @@ static esp_err_t wlan_general_post_handler(httpd_req_t *req)
     ESP_ERROR_CHECK(from_nvs_set_value("hide_ssid", user_hide_ssid));
     ESP_ERROR_CHECK(from_nvs_set_value("auth_mode", user_auth_mode));
     ESP_ERROR_CHECK(from_nvs_set_value("password", user_password));
+    modem_http_cache_invalidate(&s_http_cache, HTTP_CACHE_WLAN_GENERAL);
 
     restart();
     return ESP_OK;
@@ -497,44 +598,35 @@ end:
     return ESP_OK;
 }
 
-static esp_err_t wlan_advance_get_handler(httpd_req_t *req)
+static esp_err_t wlan_advance_render(modem_http_cache_entry_t *entry)
 {
-    esp_err_t err = basic_auth_get(req);
-    REST_CHECK(err == ESP_OK, "not login yet", end);
-
-    char *json_str = NULL;
-    size_t size;
-    size_t user_bandwidth;
+    int user_bandwidth;
     if (s_modem_wifi_config->bandwidth == WIFI_BW_HT20) {
         user_bandwidth = 20;
     } else {
         user_bandwidth = 40;
     }
-    size = asprintf(&json_str, "{\"status\":\"200\", \"bandwidth\":\"%d\", \"channel\":\"%d\"}", user_bandwidth,
-                    s_modem_wifi_config->channel);
-    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-    httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "*");
-    httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "*");
-    /**
-     * @brief Set the HTTP status code
-     */
-    esp_err_t ret = httpd_resp_set_status(req, HTTPD_200);
-    ESP_ERROR_CHECK(ret);
-
-    /**
-     * @brief Set the HTTP content type
-     */
-    ret = httpd_resp_set_type(req, HTTPD_TYPE_JSON);
-    ESP_ERROR_CHECK(ret);
+    modem_http_cache_printf(entry, "{\"status\":\"200\", \"bandwidth\":\"%d\", \"channel\":\"%d\"}", user_bandwidth,
+                            s_modem_wifi_config->channel);
+    return ESP_OK;
+}
 
-    /**
-     * @brief Set some custom headers
-     */
+static esp_err_t wlan_advance_get_handler(httpd_req_t *req)
+{
+    esp_err_t err = basic_auth_get(req);
+    REST_CHECK(err == ESP_OK, "not login yet", end);
 
-    ret = httpd_resp_send(req, json_str, size);
-    free(json_str);
-    ESP_ERROR_CHECK(ret);
-    return ESP_OK;
+    const modem_http_cache_entry_t *entry = modem_http_cache_lookup(&s_http_cache, HTTP_CACHE_WLAN_ADVANCE, http_now_ms());
+    if (entry == NULL) {
+        modem_http_cache_entry_t *render = modem_http_cache_begin(&s_http_cache, HTTP_CACHE_WLAN_ADVANCE);
+        wlan_advance_render(render);
+        entry = modem_http_cache_commit(&s_http_cache, render, http_now_ms());
+    }
+    if (entry == NULL) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "No enough memory");
+        return ESP_FAIL;
+    }
+    return http_send_cached(req, entry);
 end:
     return ESP_OK;
 }
@@ -616,6 +708,7 @@ static esp_err_t wlan_advance_post_handler(httpd_req_t *req)
 
     ESP_ERROR_CHECK(from_nvs_set_value("channel", user_channel));
     ESP_ERROR_CHECK(from_nvs_set_value("bandwidth", user_bandwidth));
+    modem_http_cache_invalidate(&s_http_cache, HTTP_CACHE_WLAN_ADVANCE);
     restart();
 
     return ESP_OK;
@@ -657,32 +750,55 @@ static esp_err_t login_post_handler(httpd_req_t *req)
     return ESP_OK;
 }
 
+static esp_err_t station_list_render(modem_http_cache_entry_t *entry)
+{
+    struct modem_netif_sta_info *node;
+    STA_CHECK(pdTRUE == xSemaphoreTake(s_sta_node_mutex, STA_NODE_MUTEX_TICKS_TO_WAIT), "take semaphore timeout", ESP_ERR_TIMEOUT);
+    modem_http_cache_printf(entry, "{\"station_list\":[");
+    SLIST_FOREACH(node, &s_sta_list_head, field) {
+        /* traffic counters come from the connection table, zero until the station sends */
+        modem_conntrack_station_t traffic = { 0 };
+#ifdef CONFIG_EXAMPLE_ENABLE_CONNTRACK
+        modem_napt_get_station(node->ip, &traffic);
+#endif
+        modem_http_cache_printf(entry,
+                                "{\"name_str\":\"%s\",\"mac_str\":\"" MACSTR "\",\"ip_str\":\"" IPSTR
+                                "\",\"online_time_s\":\"%lld\",\"tx_bytes\":%llu,\"rx_bytes\":%llu"
+                                ",\"tx_packets\":%" PRIu32 ",\"rx_packets\":%" PRIu32 ",\"connections\":%u}%s",
+                                node->name, MAC2STR(node->mac), IP2STR(&node->ip), node->start_time,
+                                traffic.bytes[MODEM_CONNTRACK_UP], traffic.bytes[MODEM_CONNTRACK_DOWN],
+                                traffic.packets[MODEM_CONNTRACK_UP], traffic.packets[MODEM_CONNTRACK_DOWN],
+                                traffic.flows, node->field.sle_next ? "," : "");
+    }
+    STA_CHECK(pdTRUE == xSemaphoreGive(s_sta_node_mutex), "give semaphore failed", ESP_FAIL);
+    return ESP_OK;
+}
+
 static esp_err_t system_station_get_handler(httpd_req_t *req)
 {
     esp_err_t err = basic_auth_get(req);
     REST_CHECK(err == ESP_OK, "not login yet", end);
-    char *json_str = NULL;
-    char *json_str_old = NULL;
-    size_t size = 0;
-    struct modem_netif_sta_info *node;
-    size = asprintf(&json_str, "{\"station_list\":[");
-    SLIST_FOREACH(node, &s_sta_list_head, field) {
-        asprintf(&json_str_old, "%s", json_str);
-        free(json_str);
-        json_str = NULL;
-        size = asprintf(&json_str,
-                        "%s{\"name_str\":\"%s\",\"mac_str\":\"" MACSTR "\",\"ip_str\":\"" IPSTR
-                        "\",\"online_time_s\":\"%lld\"}%c",
-                        json_str_old, node->name, MAC2STR(node->mac), IP2STR(&node->ip),
-                        node->start_time, node->field.sle_next ? ',' : '\0');
-        free(json_str_old);
-        json_str_old = NULL;
-    }
-    size = asprintf(&json_str_old, "%s],\"now_time\":\"%lld\"}", json_str, esp_timer_get_time());
+
+    const modem_http_cache_entry_t *entry = modem_http_cache_lookup(&s_http_cache, HTTP_CACHE_STATION_LIST, http_now_ms());
+    if (entry == NULL) {
+        modem_http_cache_entry_t *render = modem_http_cache_begin(&s_http_cache, HTTP_CACHE_STATION_LIST);
+        if (station_list_render(render) == ESP_OK) {
+            entry = modem_http_cache_commit(&s_http_cache, render, http_now_ms());
+        }
+    }
+    if (entry == NULL) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to list stations");
+        return ESP_FAIL;
+    }
+
+    /* now_time changes on every request, it is appended to the cached list */
+    char tail[48];
+    size_t tail_len = snprintf(tail, sizeof(tail), "],\"now_time\":\"%lld\"}", esp_timer_get_time());
 
     httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
     httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "*");
     httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "*");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
     /**
      * @brief Set the HTTP status code
      */
@@ -695,16 +811,22 @@ static esp_err_t system_station_get_handler(httpd_req_t *req)
     ret = httpd_resp_set_type(req, HTTPD_TYPE_JSON);
     ESP_ERROR_CHECK(ret);
 
-    /**
-     * @brief Set some custom headers
-     */
-
-    ret = httpd_resp_send(req, json_str_old, size);
-    ESP_LOGD(TAG, "%s", json_str_old);
-    free(json_str);
-    free(json_str_old);
-    ESP_ERROR_CHECK(ret);
-    return ESP_OK;
+    /* one send in the common case, the scratch buffer is free in a GET handler */
+    ctx_info_t *ctx_info = (ctx_info_t *)req->user_ctx;
+    char *scratch = ctx_info->rest_context->scratch;
+    if (entry->len + tail_len <= SCRATCH_BUFSIZE) {
+        memcpy(scratch, entry->body, entry->len);
+        memcpy(scratch + entry->len, tail, tail_len);
+        return httpd_resp_send(req, scratch, entry->len + tail_len);
+    }
+    ret = httpd_resp_send_chunk(req, entry->body, entry->len);
+    if (ret == ESP_OK) {
+        ret = httpd_resp_send_chunk(req, tail, tail_len);
+    }
+    if (ret == ESP_OK) {
+        ret = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    return ret;
 end:
     return ESP_OK;
 }
@@ -870,7 +992,7 @@ static esp_err_t system_station_change_name_post_handler(httpd_req_t *req)
     ESP_ERROR_CHECK(ret);
     ret = httpd_resp_send(req, NULL, 0);
     ESP_ERROR_CHECK(ret);
-    stalist_update();
+    stalist_set_name(mac_str, name_str);
     return ESP_OK;
 end:
     return ESP_OK;
@@ -887,6 +1009,8 @@ static esp_err_t set_content_type_from_file(httpd_req_t *req, const char *filepa
         type = "text/css";
     } else if (CHECK_FILE_EXTENSION(filepath, ".png")) {
         type = "image/png";
+    } else if (CHECK_FILE_EXTENSION(filepath, ".jpg")) {
+        type = "image/jpeg";
     } else if (CHECK_FILE_EXTENSION(filepath, ".ico")) {
         type = "image/x-icon";
     } else if (CHECK_FILE_EXTENSION(filepath, ".svg")) {
@@ -895,6 +1019,54 @@ static esp_err_t set_content_type_from_file(httpd_req_t *req, const char *filepa
     return httpd_resp_set_type(req, type);
 }
 
+/* Load the content hashes of the files in the image, the ETags of the web assets */
+static char *web_etags_load(const char *base_path)
+{
+    char path[FILE_PATH_MAX];
+    struct stat file_stat;
+    snprintf(path, sizeof(path), "%s" WEB_ETAGS_FILE, base_path);
+    if (stat(path, &file_stat) != 0) {
+        ESP_LOGW(TAG, "No %s, the web assets are sent without ETag", path);
+        return NULL;
+    }
+    char *etags = malloc(file_stat.st_size + 1);
+    int fd = open(path, O_RDONLY, 0);
+    if (etags == NULL || fd == -1) {
+        ESP_LOGE(TAG, "Failed to load %s", path);
+        free(etags);
+        if (fd != -1) {
+            close(fd);
+        }
+        return NULL;
+    }
+    ssize_t total = 0, read_bytes;
+    while (total < file_stat.st_size && (read_bytes = read(fd, etags + total, file_stat.st_size - total)) > 0) {
+        total += read_bytes;
+    }
+    close(fd);
+    etags[total] = '\0';
+    return etags;
+}
+
+/* The quoted ETag of a file of the image, by its path from the mount point */
+static bool web_etag_find(const char *etags, const char *name, char *etag, size_t size)
+{
+    size_t name_len = strlen(name);
+    const char *line = etags;
+    while (line != NULL && *line != '\0') {
+        const char *end = strchr(line, '\n');
+        if (end == NULL) {
+            end = line + strlen(line);
+        }
+        if ((size_t)(end - line) > name_len && strncmp(line, name, name_len) == 0 && line[name_len] == ' ') {
+            int hash_len = (int)(end - line - name_len - 1);
+            return (size_t)snprintf(etag, size, "\"%.*s\"", hash_len, line + name_len + 1) < size;
+        }
+        line = *end == '\n' ? end + 1 : end;
+    }
+    return false;
+}
+
 static esp_err_t rest_common_get_handler(httpd_req_t *req)
 {
     esp_err_t err = basic_auth_get(req);
@@ -912,6 +1084,40 @@ static esp_err_t rest_common_get_handler(httpd_req_t *req)
     } else {
         strlcat(filepath, req->uri, sizeof(filepath));
     }
+    set_content_type_from_file(req, filepath);
+
+    /* the build puts a gzip copy next to the text assets, see tools/gzip_assets.py */
+    struct stat file_stat;
+    bool gzip = false;
+    size_t path_len = strlen(filepath);
+    if (http_accepts_gzip(req) && path_len + 3 < sizeof(filepath)) {
+        strcpy(filepath + path_len, ".gz");
+        gzip = stat(filepath, &file_stat) == 0;
+        if (!gzip) {
+            filepath[path_len] = '\0';
+        }
+    }
+    if (!gzip && stat(filepath, &file_stat) != 0) {
+        ESP_LOGE(TAG, "Failed to open file : %s", filepath);
+        /* Respond with 500 Internal Server Error */
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to read existing file");
+        return ESP_FAIL;
+    }
+
+    /* the hash of the bytes sent, the .gz copy has its own */
+    char etag[48];
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+    if (web_etag_find(rest_context->etags, filepath + strlen(rest_context->base_path), etag, sizeof(etag))) {
+        httpd_resp_set_hdr(req, "ETag", etag);
+        if (http_resp_not_modified(req, etag)) {
+            return ESP_OK;
+        }
+    }
+    if (gzip) {
+        httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    }
+
     int fd = open(filepath, O_RDONLY, 0);
     if (fd == -1) {
         ESP_LOGE(TAG, "Failed to open file : %s", filepath);
@@ -920,10 +1126,22 @@ static esp_err_t rest_common_get_handler(httpd_req_t *req)
         return ESP_FAIL;
     }
 
-    set_content_type_from_file(req, filepath);
-
     char *chunk = rest_context->scratch;
     ssize_t read_bytes;
+    /* a file that fits the scratch buffer goes out in one send, with a Content-Length */
+    if (file_stat.st_size <= SCRATCH_BUFSIZE) {
+        ssize_t total = 0;
+        while (total < file_stat.st_size && (read_bytes = read(fd, chunk + total, SCRATCH_BUFSIZE - total)) > 0) {
+            total += read_bytes;
+        }
+        close(fd);
+        if (total != file_stat.st_size) {
+            ESP_LOGE(TAG, "Failed to read file : %s", filepath);
+            httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to read existing file");
+            return ESP_FAIL;
+        }
+        return httpd_resp_send(req, chunk, total);
+    }
     do {
         /* Read file in chunks into the scratch buffer */
         read_bytes = read(fd, chunk, SCRATCH_BUFSIZE);
@@ -1031,10 +1249,13 @@ static httpd_handle_t start_webserver(const char *base_path)
     ctx_info->rest_context = calloc(1, sizeof(rest_server_context_t));
     REST_CHECK(ctx_info->rest_context, "No memory for rest context", err);
     strlcpy(ctx_info->rest_context->base_path, base_path, sizeof(ctx_info->rest_context->base_path));
+    ctx_info->rest_context->etags = web_etags_load(base_path);
 
     ctx_info->basic_auth_info = calloc(1, sizeof(basic_auth_info_t));
     ctx_info->basic_auth_info->username = CONFIG_EXAMPLE_WEB_USERNAME;
     ctx_info->basic_auth_info->password = CONFIG_EXAMPLE_WEB_PASSWORD;
+    ctx_info->basic_auth_info->digest = http_auth_basic(ctx_info->basic_auth_info->username,
+                                                        ctx_info->basic_auth_info->password);
 
     httpd_handle_t server = NULL;
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
@@ -1204,7 +1425,15 @@ static void event_handler(void *arg, esp_event_base_t event_base,
                  MAC2STR(event->mac), event->aid);
         stalist_add_node(event->mac);
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_AP_STAIPASSIGNED) {
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+        /* the event names the station, no need to ask DHCP for every node again */
+        ip_event_ap_staipassigned_t *event = (ip_event_ap_staipassigned_t *)event_data;
+        if (stalist_set_ip(event->mac, event->ip) == ESP_ERR_NOT_FOUND) {
+            stalist_update();
+        }
+#else
         stalist_update();
+#endif
     }
 }
 
@@ -1215,6 +1444,7 @@ esp_err_t modem_http_deinit(httpd_handle_t server)
     if (s_if_init == true) {
         s_modem_wifi_config = NULL;
         stop_webserver(server);
+        modem_http_cache_deinit(&s_http_cache);
         s_if_init = false;
         return ESP_OK;
     }
@@ -1226,6 +1456,8 @@ esp_err_t modem_http_init(modem_wifi_config_t *wifi_config)
     if (s_if_init == false) {
         s_modem_wifi_config = wifi_config;
         SLIST_INIT(&s_sta_list_head);
+        modem_http_cache_init(&s_http_cache);
+        modem_http_cache_set_max_age(&s_http_cache, HTTP_CACHE_STATION_LIST, HTTP_CACHE_STATION_MAX_AGE_MS);
         /* Start the server for the first time */
         ESP_ERROR_CHECK(init_fs());
         ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_AP_STAIPASSIGNED, &event_handler, NULL));
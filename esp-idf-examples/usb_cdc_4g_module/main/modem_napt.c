@@ -0,0 +1,118 @@
+/*
+ * SPDX-FileCopyrightText: 2024 ShenZhen XinYuan Electronic Technology Co., Ltd
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "lwip/pbuf.h"
+#include "modem_napt.h"
+#include "modem_napt_hook.h"
+
+static const char *TAG = "modem_napt";
+
+/* flows looked at per forwarded packet, keeps the time spent with the lock held short */
+#define CONNTRACK_EXPIRE_BUDGET     16
+
+static modem_conntrack_t s_conntrack;
+static portMUX_TYPE s_conntrack_lock = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool s_conntrack_ready = false;
+static uint32_t s_lan_ip = 0;
+static uint32_t s_lan_mask = 0;
+
+static inline uint32_t conntrack_now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+esp_err_t modem_napt_conntrack_init(esp_netif_t *ap_netif)
+{
+#ifdef CONFIG_EXAMPLE_ENABLE_CONNTRACK
+    esp_netif_ip_info_t ip_info;
+    modem_conntrack_config_t config = {
+        .max_flows = CONFIG_EXAMPLE_CONNTRACK_MAX_FLOWS,
+        .tcp_timeout_ms = CONFIG_EXAMPLE_CONNTRACK_TCP_TIMEOUT * 1000,
+        .tcp_closing_timeout_ms = 10 * 1000,
+        .udp_timeout_ms = CONFIG_EXAMPLE_CONNTRACK_UDP_TIMEOUT * 1000,
+        .other_timeout_ms = 10 * 1000,
+    };
+
+    ESP_RETURN_ON_FALSE(ap_netif != NULL, ESP_ERR_INVALID_ARG, TAG, "ap netif can not be NULL");
+    ESP_RETURN_ON_FALSE(!s_conntrack_ready, ESP_ERR_INVALID_STATE, TAG, "conntrack already initialized");
+    ESP_RETURN_ON_ERROR(esp_netif_get_ip_info(ap_netif, &ip_info), TAG, "get ap ip info failed");
+    ESP_RETURN_ON_FALSE(modem_conntrack_init(&s_conntrack, &config) == 0, ESP_ERR_NO_MEM, TAG, "conntrack table alloc failed");
+    s_lan_ip = ip_info.ip.addr;
+    s_lan_mask = ip_info.netmask.addr;
+    s_conntrack_ready = true;
+    ESP_LOGI(TAG, "tracking up to %d connections from " IPSTR "/" IPSTR, config.max_flows,
+             IP2STR(&ip_info.ip), IP2STR(&ip_info.netmask));
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+int modem_napt_ip4_canforward(struct pbuf *p, uint32_t dest)
+{
+    modem_conntrack_tuple_t tuple;
+    uint32_t bytes;
+    uint8_t tcp_flags;
+    int dir;
+
+    if (s_conntrack_ready && modem_conntrack_parse_ipv4((const uint8_t *)p->payload, p->len, s_lan_ip, s_lan_mask,
+                                                        &tuple, &dir, &tcp_flags, &bytes) == 0) {
+        uint32_t now = conntrack_now_ms();
+        portENTER_CRITICAL(&s_conntrack_lock);
+        modem_conntrack_update(&s_conntrack, &tuple, dir, bytes, tcp_flags, now);
+        modem_conntrack_expire(&s_conntrack, now, CONNTRACK_EXPIRE_BUDGET);
+        portEXIT_CRITICAL(&s_conntrack_lock);
+    }
+    return -1;
+}
+
+esp_err_t modem_napt_get_station(esp_ip4_addr_t ip, modem_conntrack_station_t *station)
+{
+    int ret;
+
+    ESP_RETURN_ON_FALSE(station != NULL, ESP_ERR_INVALID_ARG, TAG, "station can not be NULL");
+    if (!s_conntrack_ready) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    portENTER_CRITICAL(&s_conntrack_lock);
+    ret = modem_conntrack_get_station(&s_conntrack, ip.addr, station);
+    portEXIT_CRITICAL(&s_conntrack_lock);
+    return ret == 0 ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t modem_napt_station_leave(esp_ip4_addr_t ip)
+{
+    uint32_t removed;
+
+    if (!s_conntrack_ready) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    portENTER_CRITICAL(&s_conntrack_lock);
+    removed = modem_conntrack_remove_station(&s_conntrack, ip.addr);
+    portEXIT_CRITICAL(&s_conntrack_lock);
+    ESP_LOGD(TAG, "station " IPSTR " left, %" PRIu32 " connections dropped", IP2STR(&ip), removed);
+    return ESP_OK;
+}
+
+esp_err_t modem_napt_get_stats(modem_conntrack_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(stats != NULL, ESP_ERR_INVALID_ARG, TAG, "stats can not be NULL");
+    if (!s_conntrack_ready) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    /* the wheel also has to turn while nothing is forwarded */
+    portENTER_CRITICAL(&s_conntrack_lock);
+    modem_conntrack_expire(&s_conntrack, conntrack_now_ms(), CONNTRACK_EXPIRE_BUDGET * 4);
+    modem_conntrack_get_stats(&s_conntrack, stats);
+    portEXIT_CRITICAL(&s_conntrack_lock);
+    return ESP_OK;
+}
@@ -0,0 +1,53 @@
+/*
+ * SPDX-FileCopyrightText: 2024 ShenZhen XinYuan Electronic Technology Co., Ltd
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "esp_err.h"
+#include "esp_netif.h"
+#include "modem_conntrack.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Start tracking the connections forwarded between the soft AP and the 4G link
+ *
+ * @param ap_netif soft AP interface, its subnet tells the stations apart
+ * @return esp_err_t
+ */
+esp_err_t modem_napt_conntrack_init(esp_netif_t *ap_netif);
+
+/**
+ * @brief Get the traffic counters of a station
+ *
+ * @param ip station address
+ * @param station copy of the counters
+ * @return ESP_ERR_NOT_FOUND if the station has not sent anything yet
+ */
+esp_err_t modem_napt_get_station(esp_ip4_addr_t ip, modem_conntrack_station_t *station);
+
+/**
+ * @brief Drop the connections and the counters of a station that left
+ *
+ * @param ip station address
+ * @return esp_err_t
+ */
+esp_err_t modem_napt_station_leave(esp_ip4_addr_t ip);
+
+/**
+ * @brief Get the connection table counters
+ *
+ * @param stats copy of the counters
+ * @return esp_err_t
+ */
+esp_err_t modem_napt_get_stats(modem_conntrack_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,36 @@
+/*
+ * SPDX-FileCopyrightText: 2024 ShenZhen XinYuan Electronic Technology Co., Ltd
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * lwIP hooks of the router, included by lwipopts.h through ESP_IDF_LWIP_HOOK_FILENAME
+ * (see main/CMakeLists.txt), so nothing from lwIP can be included here.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct pbuf;
+
+/**
+ * @brief Account a packet lwIP is about to forward, the NAT has already rewritten
+ *        the destination of the ones coming back from the 4G link
+ *
+ * @param p packet, from the IP header on
+ * @param dest destination address, host order
+ * @return -1, the forwarding decision is left to lwIP
+ */
+int modem_napt_ip4_canforward(struct pbuf *p, uint32_t dest);
+
+#define LWIP_HOOK_IP4_CANFORWARD(p, dest)   modem_napt_ip4_canforward(p, dest)
+
+#ifdef __cplusplus
+}
+#endif
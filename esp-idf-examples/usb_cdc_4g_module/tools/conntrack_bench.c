@@ -0,0 +1,136 @@
+/*
+ * SPDX-FileCopyrightText: 2024 ShenZhen XinYuan Electronic Technology Co., Ltd
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Linux benchmark of the connection table in main/modem_conntrack.c, with synthetic
+ * flows from a few stations to random peers: insert, lookup, expire, and a churn run
+ * with more flows than the table holds.
+ *
+ * build:  cc -O2 -I../main -o conntrack_bench conntrack_bench.c ../main/modem_conntrack.c
+ * usage:  conntrack_bench [table size] [flows]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "modem_conntrack.h"
+
+#define STATIONS    8
+#define LOOKUPS     10000000
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint32_t rnd(void)
+{
+    static uint32_t x = 2463534242u;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+static void make_flow(modem_conntrack_tuple_t *t, uint32_t i)
+{
+    memset(t, 0, sizeof(*t));
+    t->sta_ip = 0xC0A80402u + i % STATIONS;
+    t->peer_ip = rnd();
+    t->sta_port = (uint16_t)(10000 + i);
+    t->peer_port = i & 1 ? 443 : 53;
+    t->proto = i & 1 ? 6 : 17;
+}
+
+static void report(const char *what, uint32_t n, uint64_t ns)
+{
+    printf("%-8s %9u ops %8.1f ns/op %8.2f Mops/s\n", what, n, (double)ns / n, n * 1000.0 / ns);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t size = argc > 1 ? (uint32_t)atoi(argv[1]) : 4096;
+    uint32_t flows = argc > 2 ? (uint32_t)atoi(argv[2]) : size * 3 / 4;
+    modem_conntrack_config_t config = {
+        .max_flows = (uint16_t)size,
+        .tcp_timeout_ms = 300000,
+        .tcp_closing_timeout_ms = 10000,
+        .udp_timeout_ms = 30000,
+        .other_timeout_ms = 10000,
+    };
+    modem_conntrack_t ct;
+    modem_conntrack_stats_t stats;
+    modem_conntrack_tuple_t *tuples;
+    uint32_t i, now = 1000, removed = 0;
+    uint64_t t;
+
+    if (flows == 0 || flows > size || modem_conntrack_init(&ct, &config) != 0) {
+        fprintf(stderr, "usage: %s [table size < 65535] [flows <= table size]\n", argv[0]);
+        return 1;
+    }
+    tuples = malloc(flows * sizeof(*tuples));
+    for (i = 0; i < flows; i++) {
+        make_flow(&tuples[i], i);
+    }
+    printf("table %u, flows %u, %u stations, %zu bytes per flow\n", size, flows, STATIONS, sizeof(modem_conntrack_flow_t));
+
+    t = now_ns();
+    for (i = 0; i < flows; i++) {
+        modem_conntrack_update(&ct, &tuples[i], MODEM_CONNTRACK_UP, 60, 0, now);
+    }
+    report("insert", flows, now_ns() - t);
+
+    /* packets in random order over the whole table, the time moves 1 ms per 1000 */
+    t = now_ns();
+    for (i = 0; i < LOOKUPS; i++) {
+        modem_conntrack_update(&ct, &tuples[rnd() % flows], i & 1, 1400, 0, now + i / 1000);
+        if ((i & 1023) == 0) {
+            modem_conntrack_expire(&ct, now + i / 1000, 16);
+        }
+    }
+    report("lookup", LOOKUPS, now_ns() - t);
+
+    /* everything goes idle, the UDP flows and then the TCP ones time out */
+    now += LOOKUPS / 1000;
+    t = now_ns();
+    for (i = 0; i <= 400; i++) {
+        removed += modem_conntrack_expire(&ct, now + i * 1000, 0xFFFFFFFF);
+    }
+    report("expire", removed, now_ns() - t);
+
+    /* four times the table size of short UDP flows, the full table evicts */
+    now += 401 * 1000;
+    t = now_ns();
+    for (i = 0; i < size * 4; i++) {
+        modem_conntrack_tuple_t tuple;
+        make_flow(&tuple, i);
+        tuple.proto = 17;
+        modem_conntrack_update(&ct, &tuple, MODEM_CONNTRACK_UP, 100, 0, now + i / 100);
+        modem_conntrack_update(&ct, &tuple, MODEM_CONNTRACK_DOWN, 100, 0, now + i / 100);
+        modem_conntrack_expire(&ct, now + i / 100, 16);
+    }
+    report("churn", size * 4, now_ns() - t);
+
+    modem_conntrack_get_stats(&ct, &stats);
+    printf("flows %u (max %u), lookups %u, created %u, expired %u, evicted %u, no station %u\n",
+           stats.flows, stats.flows_max, stats.lookups, stats.created, stats.expired, stats.evicted, stats.no_station);
+    for (i = 0; i < STATIONS; i++) {
+        modem_conntrack_station_t st;
+        if (modem_conntrack_get_station(&ct, 0xC0A80402u + i, &st) == 0) {
+            printf("station %u: up %llu bytes %u packets, down %llu bytes %u packets, %u flows\n", i,
+                   (unsigned long long)st.bytes[MODEM_CONNTRACK_UP], st.packets[MODEM_CONNTRACK_UP],
+                   (unsigned long long)st.bytes[MODEM_CONNTRACK_DOWN], st.packets[MODEM_CONNTRACK_DOWN], st.flows);
+        }
+    }
+    free(tuples);
+    modem_conntrack_deinit(&ct);
+    return 0;
+}
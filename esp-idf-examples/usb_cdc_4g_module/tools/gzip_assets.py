@@ -0,0 +1,64 @@
+#!/usr/bin/env python
+#
+# SPDX-FileCopyrightText: 2024 ShenZhen XinYuan Electronic Technology Co., Ltd
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Copy the web pages to the directory the SPIFFS image is built from and add a gzip
+# copy next to every text asset, the web server sends it to the browsers that take
+# gzip. The etags file lists a hash of the content of every file, the server sends
+# it as the ETag, so a page is fetched again only when its bytes change.
+#
+# usage: gzip_assets.py <web dir> <image dir>
+
+import gzip
+import hashlib
+import os
+import shutil
+import sys
+
+COMPRESS = ('.html', '.js', '.css', '.svg', '.json', '.ico')
+SPIFFS_OBJ_NAME_LEN = 32
+ETAGS = 'etags'      # WEB_ETAGS_FILE in main/modem_http_config.c
+
+
+def main(src, dst):
+    if os.path.isdir(dst):
+        shutil.rmtree(dst)
+    shutil.copytree(src, dst)
+    for root, _, files in os.walk(dst):
+        for name in files:
+            if not name.endswith(COMPRESS):
+                continue
+            path = os.path.join(root, name)
+            with open(path, 'rb') as f:
+                data = f.read()
+            packed = gzip.compress(data, 9, mtime=0)
+            if len(packed) >= len(data):
+                continue
+            gz_name = '/' + os.path.relpath(path, dst).replace(os.sep, '/') + '.gz'
+            if len(gz_name) >= SPIFFS_OBJ_NAME_LEN:
+                print('gzip_assets: %s is too long for SPIFFS, not compressed' % gz_name)
+                continue
+            with open(path + '.gz', 'wb') as f:
+                f.write(packed)
+            print('gzip_assets: %s %d -> %d bytes' % (gz_name, len(data), len(packed)))
+    write_etags(dst)
+
+
+def write_etags(dst):
+    lines = []
+    for root, _, files in os.walk(dst):
+        for name in files:
+            path = os.path.join(root, name)
+            with open(path, 'rb') as f:
+                digest = hashlib.sha256(f.read()).hexdigest()[:16]
+            lines.append('/%s %s\n' % (os.path.relpath(path, dst).replace(os.sep, '/'), digest))
+    with open(os.path.join(dst, ETAGS), 'w') as f:
+        f.writelines(sorted(lines))
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        sys.exit('usage: gzip_assets.py <web dir> <image dir>')
+    main(sys.argv[1], sys.argv[2])
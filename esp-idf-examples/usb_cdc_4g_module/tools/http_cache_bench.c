@@ -0,0 +1,178 @@
+/*
+ * SPDX-FileCopyrightText: 2024 ShenZhen XinYuan Electronic Technology Co., Ltd
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Linux benchmark of the response cache in main/modem_http_cache.c: the time the
+ * station list handler spends building its body, the way it did before (a new
+ * asprintf of the whole string per station), rendered into a cache entry, served
+ * from the cache, and answered with a 304.
+ *
+ * build:  cc -O2 -I../main -o http_cache_bench http_cache_bench.c ../main/modem_http_cache.c
+ * usage:  http_cache_bench [stations]
+ */
+
+#define _GNU_SOURCE
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "modem_http_cache.h"
+
+#define MACSTR      "%02x:%02x:%02x:%02x:%02x:%02x"
+#define MAC2STR(a)  (a)[0], (a)[1], (a)[2], (a)[3], (a)[4], (a)[5]
+#define IPSTR       "%d.%d.%d.%d"
+#define IP2STR(a)   (a)[0], (a)[1], (a)[2], (a)[3]
+#define ROUNDS      100000
+
+struct station {
+    uint8_t mac[6];
+    uint8_t ip[4];
+    char name[32];
+    long long start_time;
+    unsigned long long bytes[2];
+    uint32_t packets[2];
+    unsigned flows;
+};
+
+static struct station stations[10];
+static int station_num = 10;
+static volatile size_t sink;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* the list as the handler used to build it */
+static void render_asprintf(void)
+{
+    char *json_str = NULL, *json_str_old = NULL;
+    int size = asprintf(&json_str, "{\"station_list\":[");
+
+    for (int i = 0; i < station_num; i++) {
+        struct station *s = &stations[i];
+        size = asprintf(&json_str_old, "%s", json_str);
+        free(json_str);
+        size = asprintf(&json_str,
+                        "%s{\"name_str\":\"%s\",\"mac_str\":\"" MACSTR "\",\"ip_str\":\"" IPSTR
+                        "\",\"online_time_s\":\"%lld\",\"tx_bytes\":%llu,\"rx_bytes\":%llu"
+                        ",\"tx_packets\":%" PRIu32 ",\"rx_packets\":%" PRIu32 ",\"connections\":%u}%s",
+                        json_str_old, s->name, MAC2STR(s->mac), IP2STR(s->ip), s->start_time,
+                        s->bytes[0], s->bytes[1], s->packets[0], s->packets[1], s->flows,
+                        i + 1 < station_num ? "," : "");
+        free(json_str_old);
+    }
+    size = asprintf(&json_str_old, "%s],\"now_time\":\"%lld\"}", json_str, 123456789LL);
+    sink += size;
+    free(json_str);
+    free(json_str_old);
+}
+
+static const modem_http_cache_entry_t *render_cache(modem_http_cache_t *cache)
+{
+    modem_http_cache_entry_t *entry = modem_http_cache_begin(cache, 0);
+
+    modem_http_cache_printf(entry, "{\"station_list\":[");
+    for (int i = 0; i < station_num; i++) {
+        struct station *s = &stations[i];
+        modem_http_cache_printf(entry,
+                                "{\"name_str\":\"%s\",\"mac_str\":\"" MACSTR "\",\"ip_str\":\"" IPSTR
+                                "\",\"online_time_s\":\"%lld\",\"tx_bytes\":%llu,\"rx_bytes\":%llu"
+                                ",\"tx_packets\":%" PRIu32 ",\"rx_packets\":%" PRIu32 ",\"connections\":%u}%s",
+                                s->name, MAC2STR(s->mac), IP2STR(s->ip), s->start_time,
+                                s->bytes[0], s->bytes[1], s->packets[0], s->packets[1], s->flows,
+                                i + 1 < station_num ? "," : "");
+    }
+    return modem_http_cache_commit(cache, entry, 0);
+}
+
+/* what the handler does with a cached list: append now_time into the scratch buffer */
+static void serve(const modem_http_cache_entry_t *entry, char *scratch)
+{
+    char tail[48];
+    size_t tail_len = snprintf(tail, sizeof(tail), "],\"now_time\":\"%lld\"}", 123456789LL);
+
+    memcpy(scratch, entry->body, entry->len);
+    memcpy(scratch + entry->len, tail, tail_len);
+    sink += entry->len + tail_len;
+}
+
+static void report(const char *what, uint64_t ns)
+{
+    printf("%-10s %8.0f ns per request\n", what, (double)ns / ROUNDS);
+}
+
+int main(int argc, char **argv)
+{
+    modem_http_cache_t cache;
+    modem_http_cache_stats_t stats;
+    const modem_http_cache_entry_t *entry;
+    static char scratch[10240];
+    uint64_t t;
+    int i;
+
+    if (argc > 1) {
+        station_num = atoi(argv[1]);
+    }
+    if (station_num < 0 || station_num > 10) {
+        fprintf(stderr, "usage: %s [stations, 0 to 10]\n", argv[0]);
+        return 1;
+    }
+    for (i = 0; i < station_num; i++) {
+        struct station *s = &stations[i];
+        uint8_t mac[6] = { 0x7c, 0xdf, 0xa1, 0xe0, 0x91, (uint8_t)i };
+        memcpy(s->mac, mac, 6);
+        s->ip[0] = 192, s->ip[1] = 168, s->ip[2] = 4, s->ip[3] = (uint8_t)(2 + i);
+        snprintf(s->name, sizeof(s->name), "phone-%d", i);
+        s->start_time = 1000000LL * i;
+        s->bytes[0] = 123456789ULL * i;
+        s->bytes[1] = 987654321ULL * i;
+        s->packets[0] = 100000u * i;
+        s->packets[1] = 200000u * i;
+        s->flows = i * 3;
+    }
+    modem_http_cache_init(&cache);
+
+    t = now_ns();
+    for (i = 0; i < ROUNDS; i++) {
+        render_asprintf();
+    }
+    report("asprintf", now_ns() - t);
+
+    t = now_ns();
+    for (i = 0; i < ROUNDS; i++) {
+        modem_http_cache_invalidate(&cache, 0);
+        entry = render_cache(&cache);
+        serve(entry, scratch);
+    }
+    report("render", now_ns() - t);
+
+    t = now_ns();
+    for (i = 0; i < ROUNDS; i++) {
+        entry = modem_http_cache_lookup(&cache, 0, 0);
+        serve(entry, scratch);
+    }
+    report("hit", now_ns() - t);
+
+    char if_none_match[MODEM_HTTP_CACHE_ETAG_LEN + 8];
+    snprintf(if_none_match, sizeof(if_none_match), "W/%s", entry->etag);
+    t = now_ns();
+    for (i = 0; i < ROUNDS; i++) {
+        entry = modem_http_cache_lookup(&cache, 0, 0);
+        sink += modem_http_cache_not_modified(&cache, if_none_match, entry->etag);
+    }
+    report("304", now_ns() - t);
+
+    modem_http_cache_get_stats(&cache, &stats);
+    printf("%d stations, %zu byte body, hits %u, renders %u, 304 %u, invalidations %u\n", station_num, entry->len,
+           stats.hits, stats.renders, stats.not_modified, stats.invalidations);
+    modem_http_cache_deinit(&cache);
+    return 0;
+}
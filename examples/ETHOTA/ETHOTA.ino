@@ -13,6 +13,14 @@
  * 
  * Different flash sizes use different partition tables. For details, please refer to https://docs.espressif.com/projects/esp-idf/en/stable/esp32/api-guides/partition-tables.html
  * 
+ * Besides ArduinoOTA, which pushes the whole image, the sketch can pull a delta patch
+ * over HTTP (send 'u' on the serial port). Make the patch from the image currently
+ * running and the new one, and serve it from a server with range request support:
+ *
+ *      cc -O2 -o delta_patch_tool tools/delta_patch_tool.c delta_patch.c
+ *      ./delta_patch_tool diff old/ETHOTA.ino.bin new/ETHOTA.ino.bin firmware.patch
+ *      python3 tools/range_server.py --port 8000
+ *
  */
 
 #include <WiFi.h>
@@ -26,6 +34,10 @@
 #include <ETH.h>
 #endif
 #include "utilities.h"          //Board PinMap
+#include "delta_ota.h"
+
+// Patch from the running firmware to the new one, see tools/delta_patch_tool.c
+#define DELTA_OTA_URL       "http://192.168.1.100:8000/firmware.patch"
 
 
 static bool eth_connected = false;
@@ -140,7 +152,38 @@ void setup()
     Serial.println("Ready");
 }
 
+void deltaProgress(uint32_t patchReceived, uint32_t patchSize, uint32_t imageWritten, uint32_t imageSize)
+{
+    Serial.printf("Patch %u/%u bytes, image %u/%u bytes\r",
+                  (unsigned)patchReceived, (unsigned)patchSize, (unsigned)imageWritten, (unsigned)imageSize);
+}
+
+void deltaUpdate()
+{
+    struct delta_ota_stats_s stats;
+
+    Serial.println("Start delta update from " DELTA_OTA_URL);
+    int ret = delta_ota_update(DELTA_OTA_URL, deltaProgress, &stats);
+    Serial.println();
+    Serial.printf("Patch %u bytes -> image %u bytes in %u ms, %u requests, %u retries\n",
+                  (unsigned)stats.patch_received, (unsigned)stats.image_size,
+                  (unsigned)stats.elapsed_ms, (unsigned)stats.requests, (unsigned)stats.retries);
+    if (ret != DELTA_OTA_SUCCESS) {
+        Serial.printf("Delta update failed: %d, patch error: %d\n", ret, stats.patch_error);
+        return;
+    }
+    Serial.println("Delta update done, restarting");
+    delay(100);
+    ESP.restart();
+}
+
 void loop()
 {
     ArduinoOTA.handle();
+
+    if (Serial.available()) {
+        if (Serial.read() == 'u' && eth_connected) {
+            deltaUpdate();
+        }
+    }
 }
\ No newline at end of file
@@ -0,0 +1,221 @@
+/**
+ * @file      delta_ota.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-08
+ * @note      Delta firmware update over HTTP, see delta_ota.h
+ */
+#include <HTTPClient.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include "delta_ota.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE TYPES -------------------------------------------------------- */
+
+struct ota_partitions_s {
+    const esp_partition_t   *running;   /* old image, source of the patch */
+    const esp_partition_t   *next;      /* receives the new image */
+    esp_ota_handle_t        handle;
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+static struct delta_patch_s patch;      /* ~9KB, kept off the stack */
+static uint8_t read_buff[DELTA_OTA_READ_BUFF_SIZE];
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static int read_running(void *arg, uint32_t offset, uint8_t *buf, size_t len)
+{
+    struct ota_partitions_s *parts = (struct ota_partitions_s *)arg;
+
+    if (offset + len > parts->running->size) {
+        return -1;
+    }
+    return esp_partition_read(parts->running, offset, buf, len) == ESP_OK ? 0 : -1;
+}
+
+static int write_next(void *arg, const uint8_t *buf, size_t len)
+{
+    struct ota_partitions_s *parts = (struct ota_partitions_s *)arg;
+
+    return esp_ota_write(parts->handle, buf, len) == ESP_OK ? 0 : -1;
+}
+
+/* total size from "Content-Range: bytes first-last/total" */
+static uint32_t content_range_total(const String &value)
+{
+    int slash = value.lastIndexOf('/');
+
+    if (slash < 0 || value[slash + 1] == '*') {
+        return 0;
+    }
+    return strtoul(value.c_str() + slash + 1, NULL, 10);
+}
+
+/* Request the next chunk of the patch, starting where the applier stopped, and
+ * feed it. *complete is false when the request failed or the connection was lost
+ * before the end of the chunk; the bytes received up to then are applied anyway. */
+static int fetch_chunk(HTTPClient &http, const char *url, struct delta_ota_stats_s *st, bool *complete)
+{
+    static const char *headers[] = { "Content-Range" };
+    uint32_t offset = delta_patch_offset(&patch);
+    uint32_t last = offset + DELTA_OTA_CHUNK_SIZE - 1;
+    uint32_t skip = 0, left, last_rx, drop;
+    size_t n;
+    int code, size, rc = DELTA_PATCH_OK;
+    char range[32];
+    WiFiClient *stream;
+
+    *complete = false;
+    if (st->patch_size && last >= st->patch_size) {
+        last = st->patch_size - 1;
+    }
+    snprintf(range, sizeof(range), "bytes=%lu-%lu", (unsigned long)offset, (unsigned long)last);
+
+    if (!http.begin(url)) {
+        return rc;
+    }
+    http.setTimeout(DELTA_OTA_TIMEOUT_MS);
+    http.collectHeaders(headers, 1);
+    http.addHeader("Range", range);
+    st->requests++;
+
+    code = http.GET();
+    size = http.getSize();
+    if (code == HTTP_CODE_PARTIAL_CONTENT && size > 0) {
+        st->patch_size = content_range_total(http.header("Content-Range"));
+    } else if (code == HTTP_CODE_OK && size > 0) {
+        /* no range support on the server, skip what has been applied already */
+        st->patch_size = size;
+        skip = offset;
+    } else {
+        log_w("GET %s: %d", range, code);
+        http.end();
+        return rc;
+    }
+
+    stream = http.getStreamPtr();
+    left = size;
+    last_rx = millis();
+    while (left > 0 && rc == DELTA_PATCH_OK) {
+        n = stream->available();
+        if (n == 0) {
+            if (!stream->connected() || millis() - last_rx > DELTA_OTA_TIMEOUT_MS) {
+                break;
+            }
+            delay(1);
+            continue;
+        }
+        n = stream->read(read_buff, min(min(n, sizeof(read_buff)), (size_t)left));
+        if (n == 0 || n > sizeof(read_buff)) {
+            continue;
+        }
+        last_rx = millis();
+        left -= n;
+        drop = min((uint32_t)n, skip);
+        skip -= drop;
+        if (drop < n) {
+            rc = delta_patch_feed(&patch, read_buff + drop, n - drop);
+        }
+    }
+    http.end();
+
+    *complete = left == 0 || rc != DELTA_PATCH_OK;
+    if (!*complete) {
+        log_w("chunk at %lu interrupted, %lu bytes missing", (unsigned long)offset, (unsigned long)left);
+    }
+    return rc;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS DEFINITION ------------------------------------------ */
+
+int delta_ota_update(const char *url, delta_ota_progress_cb progress, struct delta_ota_stats_s *stats)
+{
+    struct ota_partitions_s parts;
+    struct delta_ota_stats_s st;
+    HTTPClient http;
+    uint32_t start = millis();
+    uint32_t retry_ms = DELTA_OTA_RETRY_MIN_MS;
+    uint32_t offset, failures = 0;
+    bool complete;
+    int rc = DELTA_PATCH_OK;
+    int ret = DELTA_OTA_ERR_DOWNLOAD;
+
+    memset(&st, 0, sizeof(st));
+    parts.running = esp_ota_get_running_partition();
+    parts.next = esp_ota_get_next_update_partition(NULL);
+    if (parts.running == NULL || parts.next == NULL ||
+            esp_ota_begin(parts.next, OTA_WITH_SEQUENTIAL_WRITES, &parts.handle) != ESP_OK) {
+        if (stats) {
+            *stats = st;
+        }
+        return DELTA_OTA_ERR_PARTITION;
+    }
+
+    delta_patch_init(&patch, read_running, write_next, &parts);
+    while (rc == DELTA_PATCH_OK) {
+        offset = delta_patch_offset(&patch);
+        rc = fetch_chunk(http, url, &st, &complete);
+
+        if (delta_patch_target_size(&patch) > parts.next->size) {
+            log_e("new image of %lu bytes does not fit", (unsigned long)delta_patch_target_size(&patch));
+            ret = DELTA_OTA_ERR_PARTITION;
+            break;
+        }
+        if (progress && delta_patch_offset(&patch) != offset) {
+            progress(delta_patch_offset(&patch), st.patch_size,
+                     delta_patch_written(&patch), delta_patch_target_size(&patch));
+        }
+        if (rc == DELTA_PATCH_OK && st.patch_size && delta_patch_offset(&patch) >= st.patch_size) {
+            /* whole file received but the image is not complete */
+            rc = DELTA_PATCH_ERR_FORMAT;
+        }
+        if (rc != DELTA_PATCH_OK || complete) {
+            failures = 0;
+            retry_ms = DELTA_OTA_RETRY_MIN_MS;
+            continue;
+        }
+
+        /* resume at the applier offset, back off while the link makes no progress */
+        st.retries++;
+        if (delta_patch_offset(&patch) != offset) {
+            failures = 0;
+            retry_ms = DELTA_OTA_RETRY_MIN_MS;
+        }
+        if (++failures > DELTA_OTA_MAX_RETRIES) {
+            break;
+        }
+        delay(retry_ms);
+        retry_ms = min(retry_ms * 2, (uint32_t)DELTA_OTA_RETRY_MAX_MS);
+    }
+
+    st.patch_received = delta_patch_offset(&patch);
+    st.image_size = delta_patch_written(&patch);
+    st.patch_error = rc < 0 ? rc : DELTA_PATCH_OK;
+
+    if (rc == DELTA_PATCH_DONE) {
+        if (esp_ota_end(parts.handle) != ESP_OK) {
+            ret = DELTA_OTA_ERR_IMAGE;
+        } else if (esp_ota_set_boot_partition(parts.next) != ESP_OK) {
+            ret = DELTA_OTA_ERR_PARTITION;
+        } else {
+            ret = DELTA_OTA_SUCCESS;
+        }
+    } else {
+        esp_ota_abort(parts.handle);
+        if (rc < 0 && ret != DELTA_OTA_ERR_PARTITION) {
+            ret = DELTA_OTA_ERR_PATCH;
+        }
+    }
+
+    st.elapsed_ms = millis() - start;
+    if (stats) {
+        *stats = st;
+    }
+    return ret;
+}
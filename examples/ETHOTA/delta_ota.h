@@ -0,0 +1,67 @@
+/**
+ * @file      delta_ota.h
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-08
+ * @note      Delta firmware update over HTTP. The patch is downloaded in range
+ *            requests and applied on the fly against the running partition, the new
+ *            image goes straight into the next OTA partition. A dropped connection
+ *            only costs the bytes in flight, the download continues at the offset
+ *            the applier has reached. Patches are made with tools/delta_patch_tool.
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "delta_patch.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC CONSTANTS ----------------------------------------------------- */
+
+#define DELTA_OTA_SUCCESS           0
+#define DELTA_OTA_ERR_PARTITION     -1      /* no OTA partition or the new image does not fit */
+#define DELTA_OTA_ERR_DOWNLOAD      -2      /* server unreachable, retries exhausted */
+#define DELTA_OTA_ERR_PATCH         -3      /* applier error, see delta_ota_stats_s.patch_error */
+#define DELTA_OTA_ERR_IMAGE         -4      /* new image rejected by esp_ota_end */
+
+#define DELTA_OTA_CHUNK_SIZE        (64 * 1024) /* bytes per range request */
+#define DELTA_OTA_READ_BUFF_SIZE    1460        /* one TCP segment */
+#define DELTA_OTA_TIMEOUT_MS        10000       /* no data for this long aborts the request */
+#define DELTA_OTA_MAX_RETRIES       8           /* failed requests in a row before giving up */
+#define DELTA_OTA_RETRY_MIN_MS      500         /* first retry delay, doubled up to DELTA_OTA_RETRY_MAX_MS */
+#define DELTA_OTA_RETRY_MAX_MS      16000
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC TYPES --------------------------------------------------------- */
+
+/**
+@struct delta_ota_stats_s
+@brief Result of an update
+*/
+struct delta_ota_stats_s {
+    uint32_t    patch_size;         /*!> size of the patch file */
+    uint32_t    patch_received;     /*!> patch bytes applied */
+    uint32_t    image_size;         /*!> size of the new image */
+    uint32_t    requests;           /*!> range requests sent */
+    uint32_t    retries;            /*!> requests that failed or ended early */
+    uint32_t    elapsed_ms;         /*!> duration of the update */
+    int         patch_error;        /*!> DELTA_PATCH_ code of the applier */
+};
+
+/**
+@brief Called after every chunk with the patch and image progress
+*/
+typedef void (*delta_ota_progress_cb)(uint32_t patch_received, uint32_t patch_size,
+                                      uint32_t image_written, uint32_t image_size);
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS PROTOTYPES ------------------------------------------ */
+
+/**
+@brief Download a patch and apply it to the running firmware
+On success the new image is selected as boot partition, restart to run it.
+@param url http url of the patch, the server should support range requests
+@param progress progress callback, can be NULL
+@param stats pointer to receive the result, can be NULL
+@return DELTA_OTA_SUCCESS or a DELTA_OTA_ERR_ code
+*/
+int delta_ota_update(const char *url, delta_ota_progress_cb progress, struct delta_ota_stats_s *stats);
@@ -0,0 +1,484 @@
+/**
+ * @file      delta_patch.c
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-08
+ * @note      Streaming applier for bsdiff style delta patches, see delta_patch.h
+ */
+#include <string.h>
+#include "delta_patch.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+enum {
+    ST_MAGIC,
+    ST_SOURCE_SIZE,
+    ST_TARGET_SIZE,
+    ST_TARGET_SHA,
+    ST_SOURCE_SHA,
+    ST_COPY_LEN,
+    ST_ZERO_RUN,
+    ST_LIT_LEN,
+    ST_LIT,
+    ST_EXTRA_LEN,
+    ST_EXTRA,
+    ST_SEEK,
+    ST_DONE,
+    ST_ERROR
+};
+
+#define VARINT_MAX_SHIFT    35      /* 5 bytes, all sizes are 32 bit */
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static int fail(struct delta_patch_s *p, int error)
+{
+    p->state = ST_ERROR;
+    p->error = error;
+    return error;
+}
+
+/* return 1 once the varint is complete and stored in *value */
+static int get_varint(struct delta_patch_s *p, uint8_t b, uint64_t *value)
+{
+    p->varint |= (uint64_t)(b & 0x7F) << p->varint_shift;
+    if (b & 0x80) {
+        p->varint_shift += 7;
+        if (p->varint_shift >= VARINT_MAX_SHIFT) {
+            return -1;
+        }
+        return 0;
+    }
+    *value = p->varint;
+    p->varint = 0;
+    p->varint_shift = 0;
+    return 1;
+}
+
+static int flush_out(struct delta_patch_s *p)
+{
+    if (p->out_len == 0) {
+        return 0;
+    }
+    delta_sha256_update(&p->sha, p->out_buff, p->out_len);
+    if (p->write(p->arg, p->out_buff, p->out_len) != 0) {
+        return -1;
+    }
+    p->out_len = 0;
+    return 0;
+}
+
+/* make src_pos available in src_buff, return the number of bytes from there on */
+static uint32_t source_window(struct delta_patch_s *p)
+{
+    uint32_t len;
+
+    if (p->src_pos < p->src_buff_pos || p->src_pos >= p->src_buff_pos + p->src_buff_len) {
+        len = p->source_size - p->src_pos;
+        if (len > DELTA_PATCH_SRC_BUFF_SIZE) {
+            len = DELTA_PATCH_SRC_BUFF_SIZE;
+        }
+        if (p->read(p->arg, p->src_pos, p->src_buff, len) != 0) {
+            return 0;
+        }
+        p->src_buff_pos = p->src_pos;
+        p->src_buff_len = len;
+    }
+    return p->src_buff_pos + p->src_buff_len - p->src_pos;
+}
+
+/* produce n bytes of old image, plus diff if given */
+static int emit_copy(struct delta_patch_s *p, const uint8_t *diff, uint32_t n)
+{
+    uint32_t avail, room, i;
+    const uint8_t *src;
+    uint8_t *out;
+
+    while (n > 0) {
+        avail = source_window(p);
+        if (avail == 0) {
+            return DELTA_PATCH_ERR_SOURCE;
+        }
+        room = DELTA_PATCH_OUT_BUFF_SIZE - p->out_len;
+        if (avail > room) {
+            avail = room;
+        }
+        if (avail > n) {
+            avail = n;
+        }
+        src = p->src_buff + (p->src_pos - p->src_buff_pos);
+        out = p->out_buff + p->out_len;
+        if (diff) {
+            for (i = 0; i < avail; i++) {
+                out[i] = src[i] + diff[i];
+            }
+            diff += avail;
+        } else {
+            memcpy(out, src, avail);
+        }
+        p->out_len += avail;
+        p->src_pos += avail;
+        p->written += avail;
+        n -= avail;
+        if (p->out_len == DELTA_PATCH_OUT_BUFF_SIZE && flush_out(p) != 0) {
+            return DELTA_PATCH_ERR_WRITE;
+        }
+    }
+    return DELTA_PATCH_OK;
+}
+
+static int emit_extra(struct delta_patch_s *p, const uint8_t *data, uint32_t n)
+{
+    uint32_t room;
+
+    while (n > 0) {
+        room = DELTA_PATCH_OUT_BUFF_SIZE - p->out_len;
+        if (room > n) {
+            room = n;
+        }
+        memcpy(p->out_buff + p->out_len, data, room);
+        p->out_len += room;
+        p->written += room;
+        data += room;
+        n -= room;
+        if (p->out_len == DELTA_PATCH_OUT_BUFF_SIZE && flush_out(p) != 0) {
+            return DELTA_PATCH_ERR_WRITE;
+        }
+    }
+    return DELTA_PATCH_OK;
+}
+
+static int verify_source(struct delta_patch_s *p)
+{
+    struct delta_sha256_s sha;
+    uint8_t digest[32];
+    uint32_t pos, len;
+
+    delta_sha256_init(&sha);
+    for (pos = 0; pos < p->source_size; pos += len) {
+        len = p->source_size - pos;
+        if (len > DELTA_PATCH_SRC_BUFF_SIZE) {
+            len = DELTA_PATCH_SRC_BUFF_SIZE;
+        }
+        if (p->read(p->arg, pos, p->src_buff, len) != 0) {
+            return -1;
+        }
+        delta_sha256_update(&sha, p->src_buff, len);
+    }
+    delta_sha256_final(&sha, digest);
+    p->src_buff_len = 0;
+    return memcmp(digest, p->source_sha256, sizeof(digest)) == 0 ? 0 : -1;
+}
+
+static int finish(struct delta_patch_s *p)
+{
+    uint8_t digest[32];
+
+    if (flush_out(p) != 0) {
+        return fail(p, DELTA_PATCH_ERR_WRITE);
+    }
+    delta_sha256_final(&p->sha, digest);
+    if (memcmp(digest, p->target_sha256, sizeof(digest)) != 0) {
+        return fail(p, DELTA_PATCH_ERR_HASH);
+    }
+    p->state = ST_DONE;
+    return DELTA_PATCH_DONE;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS DEFINITION ------------------------------------------ */
+
+void delta_patch_init(struct delta_patch_s *p, delta_patch_read_cb read, delta_patch_write_cb write, void *arg)
+{
+    memset(p, 0, offsetof(struct delta_patch_s, src_buff));
+    p->read = read;
+    p->write = write;
+    p->arg = arg;
+    p->state = ST_MAGIC;
+    delta_sha256_init(&p->sha);
+}
+
+int delta_patch_feed(struct delta_patch_s *p, const uint8_t *data, size_t len)
+{
+    uint64_t value;
+    uint32_t n;
+    int64_t pos;
+    int rc;
+
+    while (len > 0) {
+        switch (p->state) {
+        case ST_DONE:
+            return DELTA_PATCH_DONE;
+        case ST_ERROR:
+            return p->error;
+
+        case ST_MAGIC:
+            if (*data != (uint8_t)DELTA_PATCH_MAGIC[p->header_pos]) {
+                return fail(p, DELTA_PATCH_ERR_FORMAT);
+            }
+            if (++p->header_pos == 4) {
+                p->header_pos = 0;
+                p->state = ST_SOURCE_SIZE;
+            }
+            n = 1;
+            break;
+
+        case ST_TARGET_SHA:
+        case ST_SOURCE_SHA:
+            n = 32 - p->header_pos;
+            if (n > len) {
+                n = len;
+            }
+            memcpy((p->state == ST_TARGET_SHA ? p->target_sha256 : p->source_sha256) + p->header_pos, data, n);
+            p->header_pos += n;
+            if (p->header_pos < 32) {
+                break;
+            }
+            p->header_pos = 0;
+            if (p->state == ST_TARGET_SHA) {
+                p->state = ST_SOURCE_SHA;
+                break;
+            }
+            if (verify_source(p) != 0) {
+                return fail(p, DELTA_PATCH_ERR_SOURCE);
+            }
+            p->state = ST_COPY_LEN;
+            if (p->target_size == 0) {
+                p->patch_pos += n;
+                return finish(p);
+            }
+            break;
+
+        case ST_LIT:
+        case ST_EXTRA:
+            n = p->run_left;
+            if (n > len) {
+                n = len;
+            }
+            rc = p->state == ST_LIT ? emit_copy(p, data, n) : emit_extra(p, data, n);
+            if (rc != DELTA_PATCH_OK) {
+                return fail(p, rc);
+            }
+            p->run_left -= n;
+            if (p->run_left > 0) {
+                break;
+            }
+            if (p->state == ST_EXTRA) {
+                p->state = ST_SEEK;
+            } else {
+                p->state = p->copy_left > 0 ? ST_ZERO_RUN : ST_EXTRA_LEN;
+            }
+            break;
+
+        default:
+            /* every other state is a varint */
+            n = 1;
+            rc = get_varint(p, *data, &value);
+            if (rc < 0) {
+                return fail(p, DELTA_PATCH_ERR_FORMAT);
+            }
+            if (rc == 0) {
+                break;
+            }
+            switch (p->state) {
+            case ST_SOURCE_SIZE:
+                if (value > UINT32_MAX) {
+                    return fail(p, DELTA_PATCH_ERR_FORMAT);
+                }
+                p->source_size = (uint32_t)value;
+                p->state = ST_TARGET_SIZE;
+                break;
+            case ST_TARGET_SIZE:
+                if (value > UINT32_MAX) {
+                    return fail(p, DELTA_PATCH_ERR_FORMAT);
+                }
+                p->target_size = (uint32_t)value;
+                p->state = ST_TARGET_SHA;
+                break;
+            case ST_COPY_LEN:
+                if (value > p->target_size - p->written || value > p->source_size - p->src_pos) {
+                    return fail(p, DELTA_PATCH_ERR_FORMAT);
+                }
+                p->copy_left = (uint32_t)value;
+                p->state = p->copy_left > 0 ? ST_ZERO_RUN : ST_EXTRA_LEN;
+                break;
+            case ST_ZERO_RUN:
+                if (value > p->copy_left) {
+                    return fail(p, DELTA_PATCH_ERR_FORMAT);
+                }
+                rc = emit_copy(p, NULL, (uint32_t)value);
+                if (rc != DELTA_PATCH_OK) {
+                    return fail(p, rc);
+                }
+                p->copy_left -= (uint32_t)value;
+                p->state = ST_LIT_LEN;
+                break;
+            case ST_LIT_LEN:
+                if (value > p->copy_left) {
+                    return fail(p, DELTA_PATCH_ERR_FORMAT);
+                }
+                p->copy_left -= (uint32_t)value;
+                p->run_left = (uint32_t)value;
+                if (p->run_left > 0) {
+                    p->state = ST_LIT;
+                } else {
+                    p->state = p->copy_left > 0 ? ST_ZERO_RUN : ST_EXTRA_LEN;
+                }
+                break;
+            case ST_EXTRA_LEN:
+                if (value > p->target_size - p->written) {
+                    return fail(p, DELTA_PATCH_ERR_FORMAT);
+                }
+                p->run_left = (uint32_t)value;
+                p->state = p->run_left > 0 ? ST_EXTRA : ST_SEEK;
+                break;
+            case ST_SEEK:
+                pos = (int64_t)p->src_pos + (int64_t)((value >> 1) ^ (~(value & 1) + 1));
+                if (pos < 0 || pos > p->source_size) {
+                    return fail(p, DELTA_PATCH_ERR_FORMAT);
+                }
+                p->src_pos = (uint32_t)pos;
+                p->state = ST_COPY_LEN;
+                if (p->written == p->target_size) {
+                    p->patch_pos += n;
+                    return finish(p);
+                }
+                break;
+            default:
+                return fail(p, DELTA_PATCH_ERR_FORMAT);
+            }
+            break;
+        }
+        p->patch_pos += n;
+        data += n;
+        len -= n;
+    }
+    return p->state == ST_ERROR ? p->error : (p->state == ST_DONE ? DELTA_PATCH_DONE : DELTA_PATCH_OK);
+}
+
+uint32_t delta_patch_offset(const struct delta_patch_s *p)
+{
+    return p->patch_pos;
+}
+
+uint32_t delta_patch_target_size(const struct delta_patch_s *p)
+{
+    return p->state > ST_TARGET_SIZE ? p->target_size : 0;
+}
+
+uint32_t delta_patch_written(const struct delta_patch_s *p)
+{
+    return p->written;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- SHA-256 (FIPS 180-4) ------------------------------------------------- */
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define ROR(x, n)   (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void sha256_block(struct delta_sha256_s *ctx, const uint8_t *block)
+{
+    uint32_t w[64], s[8], t1, t2;
+    int i;
+
+    for (i = 0; i < 16; i++) {
+        w[i] = (uint32_t)block[i * 4] << 24 | (uint32_t)block[i * 4 + 1] << 16 |
+               (uint32_t)block[i * 4 + 2] << 8 | block[i * 4 + 3];
+    }
+    for (i = 16; i < 64; i++) {
+        w[i] = w[i - 16] + (ROR(w[i - 15], 7) ^ ROR(w[i - 15], 18) ^ (w[i - 15] >> 3)) +
+               w[i - 7] + (ROR(w[i - 2], 17) ^ ROR(w[i - 2], 19) ^ (w[i - 2] >> 10));
+    }
+    memcpy(s, ctx->state, sizeof(s));
+    for (i = 0; i < 64; i++) {
+        t1 = s[7] + (ROR(s[4], 6) ^ ROR(s[4], 11) ^ ROR(s[4], 25)) +
+             ((s[4] & s[5]) ^ (~s[4] & s[6])) + sha256_k[i] + w[i];
+        t2 = (ROR(s[0], 2) ^ ROR(s[0], 13) ^ ROR(s[0], 22)) +
+             ((s[0] & s[1]) ^ (s[0] & s[2]) ^ (s[1] & s[2]));
+        s[7] = s[6];
+        s[6] = s[5];
+        s[5] = s[4];
+        s[4] = s[3] + t1;
+        s[3] = s[2];
+        s[2] = s[1];
+        s[1] = s[0];
+        s[0] = t1 + t2;
+    }
+    for (i = 0; i < 8; i++) {
+        ctx->state[i] += s[i];
+    }
+}
+
+void delta_sha256_init(struct delta_sha256_s *ctx)
+{
+    static const uint32_t iv[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    memcpy(ctx->state, iv, sizeof(iv));
+    ctx->length = 0;
+    ctx->block_len = 0;
+}
+
+void delta_sha256_update(struct delta_sha256_s *ctx, const uint8_t *data, size_t len)
+{
+    size_t n;
+
+    ctx->length += len;
+    if (ctx->block_len) {
+        n = 64 - ctx->block_len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(ctx->block + ctx->block_len, data, n);
+        ctx->block_len += n;
+        data += n;
+        len -= n;
+        if (ctx->block_len < 64) {
+            return;
+        }
+        sha256_block(ctx, ctx->block);
+        ctx->block_len = 0;
+    }
+    for (; len >= 64; data += 64, len -= 64) {
+        sha256_block(ctx, data);
+    }
+    memcpy(ctx->block, data, len);
+    ctx->block_len = len;
+}
+
+void delta_sha256_final(struct delta_sha256_s *ctx, uint8_t digest[32])
+{
+    uint64_t bits = ctx->length * 8;
+    int i;
+
+    ctx->block[ctx->block_len++] = 0x80;
+    if (ctx->block_len > 56) {
+        memset(ctx->block + ctx->block_len, 0, 64 - ctx->block_len);
+        sha256_block(ctx, ctx->block);
+        ctx->block_len = 0;
+    }
+    memset(ctx->block + ctx->block_len, 0, 56 - ctx->block_len);
+    for (i = 0; i < 8; i++) {
+        ctx->block[56 + i] = (uint8_t)(bits >> (56 - i * 8));
+    }
+    sha256_block(ctx, ctx->block);
+    for (i = 0; i < 8; i++) {
+        digest[i * 4] = (uint8_t)(ctx->state[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t)(ctx->state[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t)(ctx->state[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t)ctx->state[i];
+    }
+}
@@ -0,0 +1,155 @@
+/**
+ * @file      delta_patch.h
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-08
+ * @note      Streaming applier for bsdiff style delta patches. The patch is fed in
+ *            arbitrary sized pieces as it arrives from the network, the old image is
+ *            read through a callback and the new image is written sequentially, so
+ *            neither image nor the patch has to fit in RAM. Plain C without any
+ *            platform dependency, tools/delta_patch_tool.c runs it on a PC against
+ *            image files.
+ *
+ * Patch format, integers are unsigned LEB128 varints unless noted:
+ *
+ *   "EDP1"                      magic
+ *   source_size, target_size
+ *   target_sha256[32]           SHA-256 of the new image
+ *   source_sha256[32]           SHA-256 of the first source_size bytes of the old image
+ *   records until target_size bytes are produced:
+ *     copy_len                  bytes produced as old[pos + i] + diff[i]
+ *       { zero_run, lit_len, lit_len diff bytes } until copy_len bytes are covered
+ *     extra_len, extra bytes    bytes copied to the new image as they are
+ *     seek                      zigzag encoded, old position moved after the copy
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC CONSTANTS ----------------------------------------------------- */
+
+#define DELTA_PATCH_MAGIC           "EDP1"
+
+#define DELTA_PATCH_OK              0       /* more patch data expected */
+#define DELTA_PATCH_DONE            1       /* new image complete and hash verified */
+#define DELTA_PATCH_ERR_FORMAT      -1      /* malformed patch */
+#define DELTA_PATCH_ERR_SOURCE      -2      /* old image can not be read or is not the one the patch was made for */
+#define DELTA_PATCH_ERR_WRITE       -3      /* write callback failed */
+#define DELTA_PATCH_ERR_HASH        -4      /* new image does not match target_sha256 */
+
+#define DELTA_PATCH_SRC_BUFF_SIZE   4096    /* window of the old image kept in RAM */
+#define DELTA_PATCH_OUT_BUFF_SIZE   4096    /* new image bytes handed to the write callback at once */
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC TYPES --------------------------------------------------------- */
+
+/**
+@brief Read len bytes of the old image at offset
+@return 0 on success
+*/
+typedef int (*delta_patch_read_cb)(void *arg, uint32_t offset, uint8_t *buf, size_t len);
+
+/**
+@brief Append len bytes to the new image
+@return 0 on success
+*/
+typedef int (*delta_patch_write_cb)(void *arg, const uint8_t *buf, size_t len);
+
+/**
+@struct delta_sha256_s
+@brief Incremental SHA-256
+*/
+struct delta_sha256_s {
+    uint32_t    state[8];
+    uint64_t    length;
+    uint8_t     block[64];
+    uint8_t     block_len;
+};
+
+/**
+@struct delta_patch_s
+@brief State of the applier, only changed by delta_patch_feed
+*/
+struct delta_patch_s {
+    delta_patch_read_cb     read;
+    delta_patch_write_cb    write;
+    void                    *arg;
+
+    uint8_t     state;
+    int         error;              /*!> sticky error code */
+    uint64_t    varint;             /*!> varint being decoded */
+    uint8_t     varint_shift;
+    uint8_t     header_pos;         /*!> bytes received of the fixed size header fields */
+
+    uint32_t    source_size;
+    uint32_t    target_size;
+    uint8_t     target_sha256[32];
+    uint8_t     source_sha256[32];
+
+    uint32_t    copy_left;          /*!> bytes left in the current copy section */
+    uint32_t    run_left;           /*!> bytes left in the current zero run, literal or extra section */
+    uint32_t    src_pos;            /*!> position in the old image */
+    uint32_t    patch_pos;          /*!> patch bytes consumed, offset to resume the download at */
+    uint32_t    written;            /*!> bytes of the new image produced */
+
+    uint32_t    src_buff_pos;       /*!> old image offset of src_buff */
+    uint32_t    src_buff_len;
+    uint16_t    out_len;
+    uint8_t     src_buff[DELTA_PATCH_SRC_BUFF_SIZE];
+    uint8_t     out_buff[DELTA_PATCH_OUT_BUFF_SIZE];
+
+    struct delta_sha256_s sha;
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS PROTOTYPES ------------------------------------------ */
+
+/**
+@brief Prepare the applier for a new patch
+@param p applier state
+@param read callback reading the old image
+@param write callback receiving the new image
+@param arg passed to the callbacks
+*/
+void delta_patch_init(struct delta_patch_s *p, delta_patch_read_cb read, delta_patch_write_cb write, void *arg);
+
+/**
+@brief Apply the next piece of the patch
+The old image is hashed and checked against source_sha256 as soon as the header
+is complete, before anything is written.
+@param p applier state
+@param data patch bytes following the ones already fed
+@param len number of bytes
+@return DELTA_PATCH_OK, DELTA_PATCH_DONE or a DELTA_PATCH_ERR_ code
+*/
+int delta_patch_feed(struct delta_patch_s *p, const uint8_t *data, size_t len);
+
+/**
+@brief Number of patch bytes consumed so far
+After an interrupted download the transfer continues at this offset.
+*/
+uint32_t delta_patch_offset(const struct delta_patch_s *p);
+
+/**
+@brief Size of the new image, 0 until the header has been received
+*/
+uint32_t delta_patch_target_size(const struct delta_patch_s *p);
+
+/**
+@brief Bytes of the new image written so far
+*/
+uint32_t delta_patch_written(const struct delta_patch_s *p);
+
+void delta_sha256_init(struct delta_sha256_s *ctx);
+void delta_sha256_update(struct delta_sha256_s *ctx, const uint8_t *data, size_t len);
+void delta_sha256_final(struct delta_sha256_s *ctx, uint8_t digest[32]);
+
+#ifdef __cplusplus
+}
+#endif
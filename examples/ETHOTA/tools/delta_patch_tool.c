@@ -0,0 +1,501 @@
+/**
+ * @file      delta_patch_tool.c
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-08
+ * @note      PC side of the ETHOTA delta update. Creates patches with the bsdiff
+ *            algorithm (suffix array of the old image, approximate matches) in the
+ *            format described in delta_patch.h, and applies them with the same
+ *            streaming applier the firmware uses, against image files.
+ *
+ * build:  cc -O2 -o delta_patch_tool delta_patch_tool.c ../delta_patch.c
+ * usage:  delta_patch_tool diff  old.bin new.bin patch.bin
+ *         delta_patch_tool apply old.bin patch.bin new.bin [max_chunk]
+ */
+#ifndef ARDUINO     /* PC tool, PlatformIO compiles every file below src_dir */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../delta_patch.h"
+
+#define MIN(a, b)           ((a) < (b) ? (a) : (b))
+#define LITERAL_MIN_ZEROS   4       /* zeros inside a diff literal that are worth a new zero run */
+
+/* -------------------------------------------------------------------------- */
+/* --- FILE HELPERS --------------------------------------------------------- */
+
+static uint8_t *load_file(const char *path, int64_t *size)
+{
+    FILE *f = fopen(path, "rb");
+    uint8_t *buf;
+    long len;
+
+    if (f == NULL || fseek(f, 0, SEEK_END) != 0 || (len = ftell(f)) < 0) {
+        fprintf(stderr, "can not read %s\n", path);
+        exit(1);
+    }
+    rewind(f);
+    buf = malloc(len + 1);
+    if (buf == NULL || fread(buf, 1, len, f) != (size_t)len) {
+        fprintf(stderr, "can not read %s\n", path);
+        exit(1);
+    }
+    fclose(f);
+    *size = len;
+    return buf;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- SUFFIX SORT (Larsson & Sadakane, as in bsdiff) ----------------------- */
+
+static void split(int64_t *I, int64_t *V, int64_t start, int64_t len, int64_t h)
+{
+    int64_t i, j, k, x, tmp, jj, kk;
+
+    if (len < 16) {
+        for (k = start; k < start + len; k += j) {
+            j = 1;
+            x = V[I[k] + h];
+            for (i = 1; k + i < start + len; i++) {
+                if (V[I[k + i] + h] < x) {
+                    x = V[I[k + i] + h];
+                    j = 0;
+                }
+                if (V[I[k + i] + h] == x) {
+                    tmp = I[k + j];
+                    I[k + j] = I[k + i];
+                    I[k + i] = tmp;
+                    j++;
+                }
+            }
+            for (i = 0; i < j; i++) {
+                V[I[k + i]] = k + j - 1;
+            }
+            if (j == 1) {
+                I[k] = -1;
+            }
+        }
+        return;
+    }
+
+    x = V[I[start + len / 2] + h];
+    jj = 0;
+    kk = 0;
+    for (i = start; i < start + len; i++) {
+        if (V[I[i] + h] < x) {
+            jj++;
+        }
+        if (V[I[i] + h] == x) {
+            kk++;
+        }
+    }
+    jj += start;
+    kk += jj;
+
+    i = start;
+    j = 0;
+    k = 0;
+    while (i < jj) {
+        if (V[I[i] + h] < x) {
+            i++;
+        } else if (V[I[i] + h] == x) {
+            tmp = I[i];
+            I[i] = I[jj + j];
+            I[jj + j] = tmp;
+            j++;
+        } else {
+            tmp = I[i];
+            I[i] = I[kk + k];
+            I[kk + k] = tmp;
+            k++;
+        }
+    }
+    while (jj + j < kk) {
+        if (V[I[jj + j] + h] == x) {
+            j++;
+        } else {
+            tmp = I[jj + j];
+            I[jj + j] = I[kk + k];
+            I[kk + k] = tmp;
+            k++;
+        }
+    }
+
+    if (jj > start) {
+        split(I, V, start, jj - start, h);
+    }
+    for (i = 0; i < kk - jj; i++) {
+        V[I[jj + i]] = kk - 1;
+    }
+    if (jj == kk - 1) {
+        I[jj] = -1;
+    }
+    if (start + len > kk) {
+        split(I, V, kk, start + len - kk, h);
+    }
+}
+
+static void qsufsort(int64_t *I, int64_t *V, const uint8_t *old, int64_t oldsize)
+{
+    int64_t buckets[256];
+    int64_t i, h, len;
+
+    memset(buckets, 0, sizeof(buckets));
+    for (i = 0; i < oldsize; i++) {
+        buckets[old[i]]++;
+    }
+    for (i = 1; i < 256; i++) {
+        buckets[i] += buckets[i - 1];
+    }
+    for (i = 255; i > 0; i--) {
+        buckets[i] = buckets[i - 1];
+    }
+    buckets[0] = 0;
+
+    for (i = 0; i < oldsize; i++) {
+        I[++buckets[old[i]]] = i;
+    }
+    I[0] = oldsize;
+    for (i = 0; i < oldsize; i++) {
+        V[i] = buckets[old[i]];
+    }
+    V[oldsize] = 0;
+    for (i = 1; i < 256; i++) {
+        if (buckets[i] == buckets[i - 1] + 1) {
+            I[buckets[i]] = -1;
+        }
+    }
+    I[0] = -1;
+
+    for (h = 1; I[0] != -(oldsize + 1); h += h) {
+        len = 0;
+        for (i = 0; i < oldsize + 1;) {
+            if (I[i] < 0) {
+                len -= I[i];
+                i -= I[i];
+            } else {
+                if (len) {
+                    I[i - len] = -len;
+                }
+                len = V[I[i]] + 1 - i;
+                split(I, V, i, len, h);
+                i += len;
+                len = 0;
+            }
+        }
+        if (len) {
+            I[i - len] = -len;
+        }
+    }
+
+    for (i = 0; i < oldsize + 1; i++) {
+        I[V[i]] = i;
+    }
+}
+
+static int64_t matchlen(const uint8_t *old, int64_t oldsize, const uint8_t *new, int64_t newsize)
+{
+    int64_t i;
+
+    for (i = 0; i < oldsize && i < newsize; i++) {
+        if (old[i] != new[i]) {
+            break;
+        }
+    }
+    return i;
+}
+
+static int64_t search(const int64_t *I, const uint8_t *old, int64_t oldsize,
+                      const uint8_t *new, int64_t newsize, int64_t st, int64_t en, int64_t *pos)
+{
+    int64_t x, y;
+
+    while (en - st >= 2) {
+        x = st + (en - st) / 2;
+        if (memcmp(old + I[x], new, MIN(oldsize - I[x], newsize)) < 0) {
+            st = x;
+        } else {
+            en = x;
+        }
+    }
+    x = matchlen(old + I[st], oldsize - I[st], new, newsize);
+    y = matchlen(old + I[en], oldsize - I[en], new, newsize);
+    if (x > y) {
+        *pos = I[st];
+        return x;
+    }
+    *pos = I[en];
+    return y;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- PATCH WRITER --------------------------------------------------------- */
+
+static void put_varint(FILE *f, uint64_t v)
+{
+    while (v >= 0x80) {
+        fputc((int)(v & 0x7F) | 0x80, f);
+        v >>= 7;
+    }
+    fputc((int)v, f);
+}
+
+/* diff bytes as { zero_run, lit_len, literal } pairs, short zero runs stay in the literal */
+static void put_diff(FILE *f, const uint8_t *diff, int64_t len)
+{
+    int64_t i = 0, zeros, lit, z;
+
+    while (i < len) {
+        for (zeros = 0; i + zeros < len && diff[i + zeros] == 0; zeros++);
+        i += zeros;
+        for (lit = 0; i + lit < len; lit++) {
+            for (z = 0; i + lit + z < len && diff[i + lit + z] == 0 && z < LITERAL_MIN_ZEROS; z++);
+            if (z == LITERAL_MIN_ZEROS || (z > 0 && i + lit + z == len)) {
+                break;
+            }
+            lit += z;
+        }
+        put_varint(f, zeros);
+        put_varint(f, lit);
+        fwrite(diff + i, 1, lit, f);
+        i += lit;
+    }
+}
+
+static void put_record(FILE *f, const uint8_t *old, int64_t oldpos, const uint8_t *new, int64_t newpos,
+                       int64_t copy_len, int64_t extra_len, int64_t seek, uint8_t *diff)
+{
+    int64_t i;
+
+    for (i = 0; i < copy_len; i++) {
+        diff[i] = new[newpos + i] - old[oldpos + i];
+    }
+    put_varint(f, copy_len);
+    put_diff(f, diff, copy_len);
+    put_varint(f, extra_len);
+    fwrite(new + newpos + copy_len, 1, extra_len, f);
+    put_varint(f, seek < 0 ? ((uint64_t)(-seek) << 1) - 1 : (uint64_t)seek << 1);
+}
+
+static int cmd_diff(const char *old_path, const char *new_path, const char *patch_path)
+{
+    int64_t oldsize, newsize;
+    uint8_t *old = load_file(old_path, &oldsize);
+    uint8_t *new = load_file(new_path, &newsize);
+    int64_t *I = malloc((oldsize + 1) * sizeof(int64_t));
+    int64_t *V = malloc((oldsize + 1) * sizeof(int64_t));
+    uint8_t *diff = malloc(newsize + 1);
+    struct delta_sha256_s sha;
+    uint8_t digest[32];
+    int64_t scan, pos = 0, len, lastscan, lastpos, lastoffset;
+    int64_t oldscore, scsc, s, Sf, lenf, Sb, lenb, overlap, Ss, lens, i;
+    int64_t records = 0;
+    long patch_size;
+    FILE *f;
+
+    if (I == NULL || V == NULL || diff == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    f = fopen(patch_path, "wb");
+    if (f == NULL) {
+        fprintf(stderr, "can not write %s\n", patch_path);
+        return 1;
+    }
+
+    fwrite(DELTA_PATCH_MAGIC, 1, 4, f);
+    put_varint(f, oldsize);
+    put_varint(f, newsize);
+    delta_sha256_init(&sha);
+    delta_sha256_update(&sha, new, newsize);
+    delta_sha256_final(&sha, digest);
+    fwrite(digest, 1, 32, f);
+    delta_sha256_init(&sha);
+    delta_sha256_update(&sha, old, oldsize);
+    delta_sha256_final(&sha, digest);
+    fwrite(digest, 1, 32, f);
+
+    qsufsort(I, V, old, oldsize);
+
+    scan = 0;
+    len = 0;
+    lastscan = 0;
+    lastpos = 0;
+    lastoffset = 0;
+    while (scan < newsize) {
+        oldscore = 0;
+        for (scsc = scan += len; scan < newsize; scan++) {
+            len = search(I, old, oldsize, new + scan, newsize - scan, 0, oldsize, &pos);
+            for (; scsc < scan + len; scsc++) {
+                if (scsc + lastoffset < oldsize && old[scsc + lastoffset] == new[scsc]) {
+                    oldscore++;
+                }
+            }
+            if ((len == oldscore && len != 0) || len > oldscore + 8) {
+                break;
+            }
+            if (scan + lastoffset < oldsize && old[scan + lastoffset] == new[scan]) {
+                oldscore--;
+            }
+        }
+
+        if (len == oldscore && scan != newsize) {
+            continue;
+        }
+
+        /* extend the previous match forwards and the new one backwards */
+        s = 0;
+        Sf = 0;
+        lenf = 0;
+        for (i = 0; lastscan + i < scan && lastpos + i < oldsize;) {
+            if (old[lastpos + i] == new[lastscan + i]) {
+                s++;
+            }
+            i++;
+            if (s * 2 - i > Sf * 2 - lenf) {
+                Sf = s;
+                lenf = i;
+            }
+        }
+
+        lenb = 0;
+        if (scan < newsize) {
+            s = 0;
+            Sb = 0;
+            for (i = 1; scan >= lastscan + i && pos >= i; i++) {
+                if (old[pos - i] == new[scan - i]) {
+                    s++;
+                }
+                if (s * 2 - i > Sb * 2 - lenb) {
+                    Sb = s;
+                    lenb = i;
+                }
+            }
+        }
+
+        if (lastscan + lenf > scan - lenb) {
+            overlap = (lastscan + lenf) - (scan - lenb);
+            s = 0;
+            Ss = 0;
+            lens = 0;
+            for (i = 0; i < overlap; i++) {
+                if (new[lastscan + lenf - overlap + i] == old[lastpos + lenf - overlap + i]) {
+                    s++;
+                }
+                if (new[scan - lenb + i] == old[pos - lenb + i]) {
+                    s--;
+                }
+                if (s > Ss) {
+                    Ss = s;
+                    lens = i + 1;
+                }
+            }
+            lenf += lens - overlap;
+            lenb -= lens;
+        }
+
+        put_record(f, old, lastpos, new, lastscan, lenf, (scan - lenb) - (lastscan + lenf),
+                   (pos - lenb) - (lastpos + lenf), diff);
+        records++;
+
+        lastscan = scan - lenb;
+        lastpos = pos - lenb;
+        lastoffset = pos - scan;
+    }
+
+    patch_size = ftell(f);
+    fclose(f);
+    printf("%s: %ld bytes, %lld records, %.1f%% of the new image\n", patch_path, patch_size,
+           (long long)records, newsize ? 100.0 * patch_size / newsize : 0.0);
+
+    free(old);
+    free(new);
+    free(I);
+    free(V);
+    free(diff);
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- PATCH APPLY, FILE BACKED PARTITIONS ---------------------------------- */
+
+struct file_partitions_s {
+    FILE        *source;
+    FILE        *target;
+};
+
+static int file_read(void *arg, uint32_t offset, uint8_t *buf, size_t len)
+{
+    struct file_partitions_s *parts = arg;
+
+    if (fseek(parts->source, offset, SEEK_SET) != 0) {
+        return -1;
+    }
+    return fread(buf, 1, len, parts->source) == len ? 0 : -1;
+}
+
+static int file_write(void *arg, const uint8_t *buf, size_t len)
+{
+    struct file_partitions_s *parts = arg;
+
+    return fwrite(buf, 1, len, parts->target) == len ? 0 : -1;
+}
+
+static int cmd_apply(const char *old_path, const char *patch_path, const char *new_path, long max_chunk)
+{
+    static struct delta_patch_s patch;
+    struct file_partitions_s parts;
+    int64_t patch_size, pos = 0;
+    uint8_t *data = load_file(patch_path, &patch_size);
+    size_t n;
+    int rc = DELTA_PATCH_OK;
+
+    parts.source = fopen(old_path, "rb");
+    parts.target = fopen(new_path, "wb");
+    if (parts.source == NULL || parts.target == NULL) {
+        fprintf(stderr, "can not open %s or %s\n", old_path, new_path);
+        return 1;
+    }
+
+    /* feed in pieces of random size, the way the patch comes in from the network */
+    srand(1);
+    delta_patch_init(&patch, file_read, file_write, &parts);
+    while (pos < patch_size && rc == DELTA_PATCH_OK) {
+        n = max_chunk > 1 ? 1 + rand() % max_chunk : 1;
+        if (n > (size_t)(patch_size - pos)) {
+            n = patch_size - pos;
+        }
+        rc = delta_patch_feed(&patch, data + pos, n);
+        pos += n;
+    }
+    fclose(parts.source);
+    fclose(parts.target);
+    free(data);
+
+    if (rc != DELTA_PATCH_DONE) {
+        fprintf(stderr, "apply failed: %d at patch offset %lu\n", rc, (unsigned long)delta_patch_offset(&patch));
+        return 1;
+    }
+    if (pos != patch_size || delta_patch_offset(&patch) != patch_size) {
+        fprintf(stderr, "apply failed: trailing data after offset %lu\n", (unsigned long)delta_patch_offset(&patch));
+        return 1;
+    }
+    printf("%s: %lu bytes, SHA-256 verified\n", new_path, (unsigned long)delta_patch_written(&patch));
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc == 5 && strcmp(argv[1], "diff") == 0) {
+        return cmd_diff(argv[2], argv[3], argv[4]);
+    }
+    if ((argc == 5 || argc == 6) && strcmp(argv[1], "apply") == 0) {
+        return cmd_apply(argv[2], argv[3], argv[4], argc == 6 ? atol(argv[5]) : 4096);
+    }
+    fprintf(stderr, "usage: %s diff old.bin new.bin patch.bin\n"
+            "       %s apply old.bin patch.bin new.bin [max_chunk]\n", argv[0], argv[0]);
+    return 2;
+}
+
+#endif /* ARDUINO */
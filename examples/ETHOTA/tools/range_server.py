@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+# Static file server with HTTP range requests, for the ETHOTA delta update.
+# python3 -m http.server ignores the Range header, this one answers with
+# 206 Partial Content. --drop-every N closes every N-th connection halfway
+# through the response to try out the download resume.
+#
+# usage: python3 range_server.py [--port 8000] [--dir .] [--drop-every N]
+
+import argparse
+import http.server
+import os
+import re
+
+parser = argparse.ArgumentParser()
+parser.add_argument("--port", type=int, default=8000)
+parser.add_argument("--dir", default=".")
+parser.add_argument("--drop-every", type=int, default=0,
+                    help="cut every N-th response in the middle, 0 to disable")
+args = parser.parse_args()
+
+responses = 0
+
+
+class RangeHandler(http.server.SimpleHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def __init__(self, *a, **kw):
+        super().__init__(*a, directory=args.dir, **kw)
+
+    def do_GET(self):
+        global responses
+        path = self.translate_path(self.path)
+        if not os.path.isfile(path):
+            self.send_error(404)
+            return
+        size = os.path.getsize(path)
+        first, last = 0, size - 1
+        status = 200
+
+        m = re.match(r"bytes=(\d*)-(\d*)$", self.headers.get("Range", ""))
+        if m and (m.group(1) or m.group(2)):
+            if m.group(1):
+                first = int(m.group(1))
+                if m.group(2):
+                    last = min(int(m.group(2)), size - 1)
+            else:
+                first = max(size - int(m.group(2)), 0)
+            if first > last:
+                self.send_response(416)
+                self.send_header("Content-Range", "bytes */%d" % size)
+                self.send_header("Content-Length", "0")
+                self.end_headers()
+                return
+            status = 206
+
+        length = last - first + 1
+        self.send_response(status)
+        self.send_header("Content-Type", "application/octet-stream")
+        self.send_header("Content-Length", str(length))
+        self.send_header("Accept-Ranges", "bytes")
+        if status == 206:
+            self.send_header("Content-Range", "bytes %d-%d/%d" % (first, last, size))
+        self.end_headers()
+
+        responses += 1
+        if args.drop_every and responses % args.drop_every == 0:
+            length //= 2
+            self.close_connection = True
+            print("dropping after %d bytes" % length)
+
+        with open(path, "rb") as f:
+            f.seek(first)
+            self.wfile.write(f.read(length))
+
+
+print("serving %s on port %d" % (os.path.abspath(args.dir), args.port))
+http.server.ThreadingHTTPServer(("0.0.0.0", args.port), RangeHandler).serve_forever()
@@ -7,6 +7,7 @@ void loop() {}
 #include <PPP.h>
 #include <WiFi.h>
 #include "utilities.h"
+#include "qos_netif.h"
 
 
 #define PPP_MODEM_APN "You APN"
@@ -32,6 +33,70 @@ IPAddress ap_mask(255, 255, 255, 0);
 IPAddress ap_leaseStart(192, 168, 4, 2);
 IPAddress ap_dns(8, 8, 4, 4);
 
+// Per client traffic shaping, keeps one client's bulk transfer from starving the others.
+// Set the rates a little below what the cellular link really does, so the queue builds
+// in the bridge, where it is kept short, instead of in the modem
+#define QOS_ENABLE          1
+#define QOS_UPLINK_KBPS     1800
+#define QOS_DOWNLINK_KBPS   7000
+
+// Optional per client limits in kbit/s, 0 for only the link limit. Clients not listed share evenly
+struct qos_rule {
+    uint8_t mac[6];
+    uint32_t up_kbps;
+    uint32_t down_kbps;
+    uint8_t weight;
+};
+static const qos_rule qos_rules[] = {
+    // { {0x7c, 0xdf, 0xa1, 0x00, 0x00, 0x01}, 500, 2000, 1 },
+    { {0}, 0, 0, 0 }    // end of the list
+};
+
+static void qosBegin()
+{
+    struct qos_shaper_config_s up = {
+        .link_rate = QOS_UPLINK_KBPS * 125,
+        .link_burst = 2 * QOS_SHAPER_MTU,
+        .client_rate = QOS_SHAPER_NO_LIMIT,
+        .client_burst = 0,
+        .quantum = QOS_SHAPER_MTU,
+        .queue_limit = 16,
+        .pool_size = 32,            // frames are copied to the heap while they wait
+        .codel_target_us = 5000,
+        .codel_interval_us = 100000,
+        .drop = NULL,               // set by qos_netif_start
+        .drop_arg = NULL,
+    };
+    struct qos_shaper_config_s down = up;
+    down.link_rate = QOS_DOWNLINK_KBPS * 125;
+    down.queue_limit = 24;
+    down.pool_size = 48;
+
+    if (qos_netif_start(WiFi.AP.netif(), &up, &down) != QOS_SHAPER_SUCCESS) {
+        Serial.println("Failed to start traffic shaping!");
+        return;
+    }
+    for (const qos_rule *rule = qos_rules; rule->weight; rule++) {
+        qos_netif_set_client(rule->mac, rule->up_kbps * 125, rule->down_kbps * 125, rule->weight);
+    }
+}
+
+static void qosPrintStats()
+{
+    struct qos_client_stats_s st;
+    for (int dir = QOS_NETIF_UP; dir <= QOS_NETIF_DOWN; dir++) {
+        for (int i = 0; i < QOS_SHAPER_MAX_CLIENTS; i++) {
+            if (qos_netif_get_stats(dir, i, &st) != QOS_SHAPER_SUCCESS || st.queued == 0) {
+                continue;
+            }
+            Serial.printf("QoS %s %02x:%02x:%02x:%02x:%02x:%02x%s: %u pkts, %u dropped, %u queued, %u ms max wait\n",
+                          dir == QOS_NETIF_UP ? "up  " : "down", st.mac[0], st.mac[1], st.mac[2], st.mac[3], st.mac[4], st.mac[5],
+                          st.configured ? " (rule)" : "", (unsigned)st.sent, (unsigned)(st.drop_codel + st.drop_overflow),
+                          (unsigned)st.backlog, (unsigned)(st.sojourn_max_us / 1000));
+        }
+    }
+}
+
 void setup()
 {
     Serial.begin(115200);
@@ -48,6 +113,9 @@ void setup()
         Serial.println("Failed to start AP!");
         return;
     }
+#if QOS_ENABLE
+    qosBegin();
+#endif
 
     // Configure the modem
     PPP.setApn(PPP_MODEM_APN);
@@ -114,6 +182,9 @@ void setup()
 void loop()
 {
     delay(20000);
+#if QOS_ENABLE
+    qosPrintStats();
+#endif
 }
 
 void onEvent(arduino_event_id_t event, arduino_event_info_t info)
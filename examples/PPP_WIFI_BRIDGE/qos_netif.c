@@ -0,0 +1,295 @@
+/**
+ * @file      qos_netif.c
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      Per client shaping on the soft AP interface, see qos_netif.h
+ */
+#include <string.h>
+#include "esp_netif_net_stack.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "lwip/netif.h"
+#include "lwip/pbuf.h"
+#include "lwip/tcpip.h"
+#include "lwip/prot/ethernet.h"
+#include "lwip/prot/ip4.h"
+#include "qos_netif.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define TIMER_MIN_US        100     /* shortest wait for the token buckets */
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+static struct netif *ap;
+static netif_input_fn orig_input;
+static netif_linkoutput_fn orig_linkoutput;
+static struct qos_shaper_s shapers[2];
+static SemaphoreHandle_t lock;
+static esp_timer_handle_t timer;
+static volatile bool running;
+static volatile bool down_posted;   /* a drain of the downlink waits in the tcpip thread */
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static void drop_pbuf(void *pkt, void *arg)
+{
+    (void)arg;
+    pbuf_free((struct pbuf *)pkt);
+}
+
+/* station MAC of an IPv4 frame between a station and the outside, NULL for the rest */
+static const uint8_t *classify(struct pbuf *p, int dir)
+{
+    const struct eth_hdr *eth = (const struct eth_hdr *)p->payload;
+    const struct ip_hdr *iph;
+    uint32_t mask, addr;
+
+    if (p->len < SIZEOF_ETH_HDR + IP_HLEN || eth->type != PP_HTONS(ETHTYPE_IP)) {
+        return NULL;
+    }
+    iph = (const struct ip_hdr *)((const uint8_t *)p->payload + SIZEOF_ETH_HDR);
+    addr = dir == QOS_NETIF_UP ? iph->dest.addr : iph->src.addr;
+    mask = netif_ip4_netmask(ap)->addr;
+    if ((addr & mask) == (netif_ip4_addr(ap)->addr & mask) || addr == IPADDR_BROADCAST
+            || IP_MULTICAST(lwip_ntohl(addr))) {
+        return NULL;
+    }
+    return dir == QOS_NETIF_UP ? eth->src.addr : eth->dest.addr;
+}
+
+/* wake up when a token bucket lets the next frame go, a pending wake up is early enough:
+   a new frame that may go at once is sent by the enqueue path */
+static void schedule(void)
+{
+    uint64_t now = esp_timer_get_time(), next, down;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    if (running && !esp_timer_is_active(timer)) {
+        next = qos_shaper_next_us(&shapers[QOS_NETIF_UP], now);
+        if (!down_posted) {
+            down = qos_shaper_next_us(&shapers[QOS_NETIF_DOWN], now);
+            if (down && (!next || down < next)) {
+                next = down;
+            }
+        }
+        if (next) {
+            esp_timer_start_once(timer, next > now + TIMER_MIN_US ? next - now : TIMER_MIN_US);
+        }
+    }
+    xSemaphoreGive(lock);
+}
+
+static struct pbuf *dequeue(int dir)
+{
+    struct pbuf *p = NULL;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    if (running) {
+        p = (struct pbuf *)qos_shaper_dequeue(&shapers[dir], esp_timer_get_time(), NULL);
+    }
+    xSemaphoreGive(lock);
+    return p;
+}
+
+/* tcpip_input only posts to the tcpip thread, any task can call it */
+static void drain_up(void)
+{
+    struct pbuf *p;
+
+    while ((p = dequeue(QOS_NETIF_UP)) != NULL) {
+        if (orig_input(p, ap) != ERR_OK) {
+            pbuf_free(p);
+        }
+    }
+}
+
+/* the link output belongs to the tcpip thread */
+static void drain_down(void)
+{
+    struct pbuf *p;
+
+    while ((p = dequeue(QOS_NETIF_DOWN)) != NULL) {
+        orig_linkoutput(ap, p);
+        pbuf_free(p);
+    }
+}
+
+static void drain_down_cb(void *ctx)
+{
+    (void)ctx;
+    down_posted = false;
+    drain_down();
+    schedule();
+}
+
+static void timer_cb(void *arg)
+{
+    (void)arg;
+    drain_up();
+    if (!down_posted) {
+        down_posted = true;
+        if (tcpip_try_callback(drain_down_cb, NULL) != ERR_OK) {
+            down_posted = false;
+        }
+    }
+    schedule();
+}
+
+static bool enqueue(int dir, const uint8_t *mac, struct pbuf *p)
+{
+    bool queued = false;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    if (running) {
+        qos_shaper_enqueue(&shapers[dir], mac, p, p->tot_len, esp_timer_get_time());
+        queued = true;
+    }
+    xSemaphoreGive(lock);
+    return queued;
+}
+
+/* called by the Wi-Fi driver task for every frame a station sends */
+static err_t qos_input(struct pbuf *p, struct netif *inp)
+{
+    const uint8_t *src = classify(p, QOS_NETIF_UP);
+    uint8_t mac[6];
+    struct pbuf *q;
+
+    if (src == NULL) {
+        return orig_input(p, inp);
+    }
+    /* a queued frame must not hold one of the few receive buffers of the driver */
+    memcpy(mac, src, sizeof(mac));
+    q = pbuf_clone(PBUF_RAW, PBUF_RAM, p);
+    if (q != NULL) {
+        pbuf_free(p);
+        p = q;
+    }
+    if (!enqueue(QOS_NETIF_UP, mac, p)) {
+        return orig_input(p, inp);
+    }
+    drain_up();
+    schedule();
+    return ERR_OK;
+}
+
+/* called in the tcpip thread for every frame to a station */
+static err_t qos_linkoutput(struct netif *netif, struct pbuf *p)
+{
+    const uint8_t *mac = classify(p, QOS_NETIF_DOWN);
+
+    if (mac == NULL) {
+        return orig_linkoutput(netif, p);
+    }
+    /* the caller frees its reference when this returns */
+    pbuf_ref(p);
+    if (!enqueue(QOS_NETIF_DOWN, mac, p)) {
+        pbuf_free(p);
+        return orig_linkoutput(netif, p);
+    }
+    drain_down();
+    schedule();
+    return ERR_OK;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS DEFINITION ------------------------------------------ */
+
+int qos_netif_start(esp_netif_t *ap_netif, const struct qos_shaper_config_s *up_cfg,
+                    const struct qos_shaper_config_s *down_cfg)
+{
+    struct qos_shaper_config_s cfg[2] = { *up_cfg, *down_cfg };
+    const esp_timer_create_args_t timer_args = {
+        .callback = timer_cb,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "qos",
+    };
+    struct netif *n = (struct netif *)esp_netif_get_netif_impl(ap_netif);
+
+    if (running || n == NULL) {
+        return QOS_SHAPER_ERROR;
+    }
+    if (lock == NULL && (lock = xSemaphoreCreateMutex()) == NULL) {
+        return QOS_SHAPER_ERROR;
+    }
+    if (timer == NULL && esp_timer_create(&timer_args, &timer) != ESP_OK) {
+        return QOS_SHAPER_ERROR;
+    }
+    for (int dir = QOS_NETIF_UP; dir <= QOS_NETIF_DOWN; dir++) {
+        cfg[dir].drop = drop_pbuf;
+        if (qos_shaper_init(&shapers[dir], &cfg[dir]) != QOS_SHAPER_SUCCESS) {
+            if (dir == QOS_NETIF_DOWN) {
+                qos_shaper_deinit(&shapers[QOS_NETIF_UP]);
+            }
+            return QOS_SHAPER_ERROR;
+        }
+    }
+
+    ap = n;
+    orig_input = n->input;
+    orig_linkoutput = n->linkoutput;
+    running = true;
+    n->input = qos_input;
+    n->linkoutput = qos_linkoutput;
+    return QOS_SHAPER_SUCCESS;
+}
+
+void qos_netif_stop(void)
+{
+    if (!running) {
+        return;
+    }
+    ap->input = orig_input;
+    ap->linkoutput = orig_linkoutput;
+
+    /* the wrappers still running see the flag and pass their frame on */
+    xSemaphoreTake(lock, portMAX_DELAY);
+    running = false;
+    esp_timer_stop(timer);
+    qos_shaper_deinit(&shapers[QOS_NETIF_UP]);
+    qos_shaper_deinit(&shapers[QOS_NETIF_DOWN]);
+    xSemaphoreGive(lock);
+}
+
+int qos_netif_set_client(const uint8_t mac[6], uint32_t up_rate, uint32_t down_rate, uint8_t weight)
+{
+    const uint32_t rates[2] = { up_rate, down_rate };
+    int ret = QOS_SHAPER_ERROR;
+
+    if (lock == NULL) {
+        return QOS_SHAPER_ERROR;
+    }
+    xSemaphoreTake(lock, portMAX_DELAY);
+    if (running) {
+        ret = QOS_SHAPER_SUCCESS;
+        for (int dir = QOS_NETIF_UP; dir <= QOS_NETIF_DOWN; dir++) {
+            uint32_t burst = rates[dir] / 10 > 2 * QOS_SHAPER_MTU ? rates[dir] / 10 : 2 * QOS_SHAPER_MTU;
+            if (qos_shaper_set_client(&shapers[dir], mac, rates[dir], burst, weight) != QOS_SHAPER_SUCCESS) {
+                ret = QOS_SHAPER_ERROR;
+            }
+        }
+    }
+    xSemaphoreGive(lock);
+    return ret;
+}
+
+int qos_netif_get_stats(int dir, int index, struct qos_client_stats_s *stats)
+{
+    int ret = QOS_SHAPER_ERROR;
+
+    if (lock == NULL || (dir != QOS_NETIF_UP && dir != QOS_NETIF_DOWN)) {
+        return QOS_SHAPER_ERROR;
+    }
+    xSemaphoreTake(lock, portMAX_DELAY);
+    if (running) {
+        ret = qos_shaper_get_stats(&shapers[dir], index, stats);
+    }
+    xSemaphoreGive(lock);
+    return ret;
+}
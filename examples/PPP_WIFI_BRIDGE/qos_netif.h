@@ -0,0 +1,70 @@
+/**
+ * @file      qos_netif.h
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      Per client shaping of the traffic between the soft AP and the PPP
+ *            uplink. The input and link output functions of the AP interface are
+ *            wrapped: frames a station sends out of its subnet are queued by source
+ *            MAC before they reach NAT, frames coming back are queued by destination
+ *            MAC after NAT has found the station. Everything else passes untouched.
+ *            One qos_shaper per direction, an esp_timer releases what the rates
+ *            hold back.
+ */
+#pragma once
+
+#include <stdint.h>
+#include "esp_netif.h"
+#include "qos_shaper.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC CONSTANTS ----------------------------------------------------- */
+
+#define QOS_NETIF_UP                0       /* stations to the uplink */
+#define QOS_NETIF_DOWN              1       /* uplink to the stations */
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS PROTOTYPES ------------------------------------------ */
+
+/**
+@brief Start shaping on the soft AP interface, it must be started
+@param ap_netif soft AP interface, WiFi.AP.netif()
+@param up_cfg shaper settings towards the uplink, the drop callback is set here
+@param down_cfg shaper settings towards the stations
+@return QOS_SHAPER_SUCCESS or QOS_SHAPER_ERROR
+*/
+int qos_netif_start(esp_netif_t *ap_netif, const struct qos_shaper_config_s *up_cfg,
+                    const struct qos_shaper_config_s *down_cfg);
+
+/**
+@brief Give the interface its functions back and drop what is still queued
+*/
+void qos_netif_stop(void);
+
+/**
+@brief Set the limits of a station in both directions
+The bucket holds a tenth of a second of traffic, at least two frames.
+@param mac station address
+@param up_rate bytes per second towards the uplink, QOS_SHAPER_NO_LIMIT for only the link limit
+@param down_rate bytes per second towards the station
+@param weight share against the other busy stations, 1 for the default
+@return QOS_SHAPER_SUCCESS or QOS_SHAPER_ERROR when every slot is configured
+*/
+int qos_netif_set_client(const uint8_t mac[6], uint32_t up_rate, uint32_t down_rate, uint8_t weight);
+
+/**
+@brief Get the counters of a slot
+@param dir QOS_NETIF_UP or QOS_NETIF_DOWN
+@param index slot, below QOS_SHAPER_MAX_CLIENTS
+@param stats pointer to receive the counters
+@return QOS_SHAPER_SUCCESS, QOS_SHAPER_ERROR if the slot is not used
+*/
+int qos_netif_get_stats(int dir, int index, struct qos_client_stats_s *stats);
+
+#ifdef __cplusplus
+}
+#endif
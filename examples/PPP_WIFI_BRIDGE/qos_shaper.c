@@ -0,0 +1,448 @@
+/**
+ * @file      qos_shaper.c
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      Per client traffic shaper: CoDel queues, deficit round robin and token
+ *            buckets, see qos_shaper.h
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "qos_shaper.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define LIST_IDLE           0
+#define LIST_NEW            1
+#define LIST_OLD            2
+#define NONE                0xFF
+
+#define US_PER_S            1000000LL   /* token buckets count bytes * US_PER_S */
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static uint64_t isqrt(uint64_t x)
+{
+    uint64_t r = 0, bit = 1ULL << 62;
+
+    while (bit > x) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (x >= r + bit) {
+            x -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return r;
+}
+
+/* next drop time, the drop rate grows with the square root of the drop count */
+static uint64_t control_law(const struct qos_shaper_s *s, uint64_t t, uint32_t count)
+{
+    return t + (uint64_t)s->cfg.codel_interval_us * 1024 / isqrt((uint64_t)count << 20);
+}
+
+static void refill(int64_t *tokens, uint64_t *refill_us, uint32_t rate, uint32_t burst, uint64_t now_us)
+{
+    if (now_us > *refill_us) {
+        *tokens += (int64_t)(now_us - *refill_us) * rate;
+        if (*tokens > (int64_t)burst * US_PER_S) {
+            *tokens = (int64_t)burst * US_PER_S;
+        }
+    }
+    *refill_us = now_us;
+}
+
+/* time the bucket is back to zero */
+static uint64_t bucket_ready_us(int64_t tokens, uint32_t rate, uint64_t now_us)
+{
+    if (tokens >= 0) {
+        return now_us;
+    }
+    return now_us + (uint64_t)((-tokens + rate - 1) / rate);
+}
+
+static void pool_put(struct qos_shaper_s *s, struct qos_pkt_s *n)
+{
+    n->next = s->free_list;
+    s->free_list = n;
+    s->pool_free++;
+}
+
+static void drop_pkt(struct qos_shaper_s *s, struct qos_pkt_s *n)
+{
+    if (s->cfg.drop) {
+        s->cfg.drop(n->pkt, s->cfg.drop_arg);
+    }
+    pool_put(s, n);
+}
+
+static struct qos_pkt_s *queue_pop(struct qos_client_s *c)
+{
+    struct qos_pkt_s *n = c->head;
+
+    if (n) {
+        c->head = n->next;
+        if (c->head == NULL) {
+            c->tail = NULL;
+        }
+        c->stats.backlog--;
+        c->stats.backlog_bytes -= n->len;
+    }
+    return n;
+}
+
+static void list_push(struct qos_shaper_s *s, uint8_t list, uint8_t index)
+{
+    uint8_t *head = list == LIST_NEW ? &s->new_head : &s->old_head;
+    uint8_t *tail = list == LIST_NEW ? &s->new_tail : &s->old_tail;
+
+    s->clients[index].list = list;
+    s->clients[index].next = NONE;
+    if (*head == NONE) {
+        *head = index;
+    } else {
+        s->clients[*tail].next = index;
+    }
+    *tail = index;
+}
+
+/* the client at the head of its list leaves it */
+static void list_pop(struct qos_shaper_s *s, struct qos_client_s *c)
+{
+    uint8_t *head = c->list == LIST_NEW ? &s->new_head : &s->old_head;
+    uint8_t *tail = c->list == LIST_NEW ? &s->new_tail : &s->old_tail;
+
+    *head = c->next;
+    if (*head == NONE) {
+        *tail = NONE;
+    }
+    c->list = LIST_IDLE;
+    c->next = NONE;
+}
+
+static void client_reset(struct qos_shaper_s *s, struct qos_client_s *c, const uint8_t mac[6])
+{
+    memset(c, 0, sizeof(*c));
+    memcpy(c->mac, mac, 6);
+    c->in_use = 1;
+    c->next = NONE;
+    c->quantum = s->cfg.quantum;
+    c->rate = s->cfg.client_rate;
+    c->burst = s->cfg.client_burst;
+    c->tokens = (int64_t)c->burst * US_PER_S;
+}
+
+/* slot of a MAC, a new one gets a free slot or the slot of an idle unconfigured client */
+static struct qos_client_s *find_client(struct qos_shaper_s *s, const uint8_t mac[6], int configure)
+{
+    struct qos_client_s *free_slot = NULL, *idle_slot = NULL;
+
+    for (int i = 1; i < QOS_SHAPER_MAX_CLIENTS; i++) {
+        struct qos_client_s *c = &s->clients[i];
+        if (!c->in_use) {
+            if (!free_slot) {
+                free_slot = c;
+            }
+        } else if (!memcmp(c->mac, mac, 6)) {
+            return c;
+        } else if (!c->configured && c->list == LIST_IDLE && !idle_slot) {
+            idle_slot = c;
+        }
+    }
+    if (!free_slot) {
+        free_slot = idle_slot;
+    }
+    if (free_slot) {
+        client_reset(s, free_slot, mac);
+        return free_slot;
+    }
+    return configure ? NULL : &s->clients[0];
+}
+
+/* take the head packet and tell whether it waited long enough, for long enough, to drop (RFC 8289) */
+static struct qos_pkt_s *codel_pop(struct qos_shaper_s *s, struct qos_client_s *c, uint64_t now_us, int *ok_to_drop)
+{
+    struct qos_pkt_s *n = queue_pop(c);
+
+    *ok_to_drop = 0;
+    if (n == NULL) {
+        c->first_above_us = 0;
+        return NULL;
+    }
+    if (now_us - n->enqueue_us < s->cfg.codel_target_us || c->stats.backlog_bytes <= QOS_SHAPER_MTU) {
+        c->first_above_us = 0;
+    } else if (c->first_above_us == 0) {
+        c->first_above_us = now_us + s->cfg.codel_interval_us;
+    } else if (now_us >= c->first_above_us) {
+        *ok_to_drop = 1;
+    }
+    return n;
+}
+
+static struct qos_pkt_s *codel_dequeue(struct qos_shaper_s *s, struct qos_client_s *c, uint64_t now_us)
+{
+    int ok_to_drop;
+    struct qos_pkt_s *n = codel_pop(s, c, now_us, &ok_to_drop);
+
+    if (n == NULL) {
+        c->dropping = 0;
+        return NULL;
+    }
+    if (c->dropping) {
+        if (!ok_to_drop) {
+            c->dropping = 0;
+        }
+        while (c->dropping && now_us >= c->drop_next_us) {
+            drop_pkt(s, n);
+            c->stats.drop_codel++;
+            c->count++;
+            n = codel_pop(s, c, now_us, &ok_to_drop);
+            if (!ok_to_drop) {
+                c->dropping = 0;
+            } else {
+                c->drop_next_us = control_law(s, c->drop_next_us, c->count);
+            }
+        }
+    } else if (ok_to_drop) {
+        drop_pkt(s, n);
+        c->stats.drop_codel++;
+        n = codel_pop(s, c, now_us, &ok_to_drop);
+        c->dropping = 1;
+        /* start near the drop rate of the last episode if it was recent */
+        uint32_t delta = c->count - c->lastcount;
+        if (delta > 1 && (int64_t)(now_us - c->drop_next_us) < 16LL * s->cfg.codel_interval_us) {
+            c->count = delta;
+        } else {
+            c->count = 1;
+        }
+        c->drop_next_us = control_law(s, now_us, c->count);
+        c->lastcount = c->count;
+    }
+    return n;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS DEFINITION ------------------------------------------ */
+
+int qos_shaper_init(struct qos_shaper_s *s, const struct qos_shaper_config_s *cfg)
+{
+    static const uint8_t shared_mac[6] = { 0 };
+
+    if (cfg->pool_size == 0 || cfg->queue_limit == 0 || cfg->quantum == 0) {
+        return QOS_SHAPER_ERROR;
+    }
+    memset(s, 0, sizeof(*s));
+    s->cfg = *cfg;
+    s->pool = calloc(cfg->pool_size, sizeof(struct qos_pkt_s));
+    if (s->pool == NULL) {
+        return QOS_SHAPER_ERROR;
+    }
+    for (int i = 0; i < cfg->pool_size; i++) {
+        pool_put(s, &s->pool[i]);
+    }
+    s->new_head = s->new_tail = NONE;
+    s->old_head = s->old_tail = NONE;
+    s->tokens = (int64_t)cfg->link_burst * US_PER_S;
+    client_reset(s, &s->clients[0], shared_mac);
+    return QOS_SHAPER_SUCCESS;
+}
+
+void qos_shaper_deinit(struct qos_shaper_s *s)
+{
+    for (int i = 0; i < QOS_SHAPER_MAX_CLIENTS; i++) {
+        struct qos_pkt_s *n;
+        while ((n = queue_pop(&s->clients[i])) != NULL) {
+            drop_pkt(s, n);
+        }
+    }
+    free(s->pool);
+    memset(s, 0, sizeof(*s));
+}
+
+int qos_shaper_set_client(struct qos_shaper_s *s, const uint8_t mac[6], uint32_t rate, uint32_t burst, uint8_t weight)
+{
+    struct qos_client_s *c = find_client(s, mac, 1);
+
+    if (c == NULL) {
+        return QOS_SHAPER_ERROR;
+    }
+    c->configured = 1;
+    c->rate = rate;
+    c->burst = burst;
+    c->quantum = (uint32_t)s->cfg.quantum * (weight ? weight : 1);
+    if (c->tokens > (int64_t)burst * US_PER_S) {
+        c->tokens = (int64_t)burst * US_PER_S;
+    }
+    return QOS_SHAPER_SUCCESS;
+}
+
+int qos_shaper_enqueue(struct qos_shaper_s *s, const uint8_t mac[6], void *pkt, uint32_t len, uint64_t now_us)
+{
+    struct qos_client_s *c = find_client(s, mac, 0);
+    struct qos_pkt_s *n;
+
+    if (c->stats.backlog >= s->cfg.queue_limit) {
+        drop_pkt(s, queue_pop(c));
+        c->stats.drop_overflow++;
+    } else if (s->free_list == NULL) {
+        /* the pool is shared, the client with the most bytes queued pays for the room */
+        struct qos_client_s *fat = NULL;
+        for (int i = 0; i < QOS_SHAPER_MAX_CLIENTS; i++) {
+            struct qos_client_s *f = &s->clients[i];
+            if (f->stats.backlog && (!fat || f->stats.backlog_bytes > fat->stats.backlog_bytes)) {
+                fat = f;
+            }
+        }
+        drop_pkt(s, queue_pop(fat));
+        fat->stats.drop_overflow++;
+    }
+
+    n = s->free_list;
+    s->free_list = n->next;
+    s->pool_free--;
+    n->next = NULL;
+    n->pkt = pkt;
+    n->len = len;
+    n->enqueue_us = now_us;
+    if (c->tail) {
+        c->tail->next = n;
+    } else {
+        c->head = n;
+    }
+    c->tail = n;
+    c->stats.backlog++;
+    c->stats.backlog_bytes += len;
+    c->stats.queued++;
+
+    /* a client that was idle goes first, that keeps light traffic ahead of bulk transfers */
+    if (c->list == LIST_IDLE) {
+        c->deficit = c->quantum;
+        list_push(s, LIST_NEW, (uint8_t)(c - s->clients));
+    }
+    return QOS_SHAPER_SUCCESS;
+}
+
+void *qos_shaper_dequeue(struct qos_shaper_s *s, uint64_t now_us, uint32_t *len)
+{
+    int active = 0, blocked = 0;
+
+    if (s->cfg.link_rate != QOS_SHAPER_NO_LIMIT) {
+        refill(&s->tokens, &s->refill_us, s->cfg.link_rate, s->cfg.link_burst, now_us);
+        if (s->tokens < 0) {
+            return NULL;
+        }
+    }
+    for (int i = 0; i < QOS_SHAPER_MAX_CLIENTS; i++) {
+        active += s->clients[i].list != LIST_IDLE;
+    }
+
+    while (active) {
+        uint8_t index = s->new_head != NONE ? s->new_head : s->old_head;
+        struct qos_client_s *c = &s->clients[index];
+
+        /* over its own rate, it waits at the end of the line */
+        if (c->rate != QOS_SHAPER_NO_LIMIT) {
+            refill(&c->tokens, &c->refill_us, c->rate, c->burst, now_us);
+            if (c->tokens < 0) {
+                list_pop(s, c);
+                list_push(s, LIST_OLD, index);
+                if (++blocked >= active) {
+                    return NULL;
+                }
+                continue;
+            }
+        }
+        if (c->deficit <= 0) {
+            c->deficit += c->quantum;
+            list_pop(s, c);
+            list_push(s, LIST_OLD, index);
+            blocked = 0;
+            continue;
+        }
+
+        struct qos_pkt_s *n = codel_dequeue(s, c, now_us);
+        if (n == NULL) {
+            /* an emptied new client still has to come round in the old list before it
+               can be new again, it cannot jump the line by sending one packet at a time */
+            uint8_t was = c->list;
+            list_pop(s, c);
+            if (was == LIST_NEW) {
+                list_push(s, LIST_OLD, index);
+            } else {
+                active--;
+            }
+            continue;
+        }
+
+        uint32_t sojourn = (uint32_t)(now_us - n->enqueue_us);
+        void *pkt = n->pkt;
+        c->deficit -= n->len;
+        if (c->rate != QOS_SHAPER_NO_LIMIT) {
+            c->tokens -= (int64_t)n->len * US_PER_S;
+        }
+        if (s->cfg.link_rate != QOS_SHAPER_NO_LIMIT) {
+            s->tokens -= (int64_t)n->len * US_PER_S;
+        }
+        c->stats.sent++;
+        c->stats.sent_bytes += n->len;
+        if (sojourn > c->stats.sojourn_max_us) {
+            c->stats.sojourn_max_us = sojourn;
+        }
+        if (len) {
+            *len = n->len;
+        }
+        pool_put(s, n);
+        return pkt;
+    }
+    return NULL;
+}
+
+uint64_t qos_shaper_next_us(struct qos_shaper_s *s, uint64_t now_us)
+{
+    uint64_t next = 0;
+
+    for (int i = 0; i < QOS_SHAPER_MAX_CLIENTS; i++) {
+        struct qos_client_s *c = &s->clients[i];
+        uint64_t ready = now_us;
+        if (c->stats.backlog == 0) {
+            continue;
+        }
+        if (c->rate != QOS_SHAPER_NO_LIMIT) {
+            refill(&c->tokens, &c->refill_us, c->rate, c->burst, now_us);
+            ready = bucket_ready_us(c->tokens, c->rate, now_us);
+        }
+        if (next == 0 || ready < next) {
+            next = ready;
+        }
+    }
+    if (next && s->cfg.link_rate != QOS_SHAPER_NO_LIMIT) {
+        refill(&s->tokens, &s->refill_us, s->cfg.link_rate, s->cfg.link_burst, now_us);
+        uint64_t ready = bucket_ready_us(s->tokens, s->cfg.link_rate, now_us);
+        if (ready > next) {
+            next = ready;
+        }
+    }
+    return next;
+}
+
+int qos_shaper_get_stats(struct qos_shaper_s *s, int index, struct qos_client_stats_s *stats)
+{
+    const struct qos_client_s *c;
+
+    if (index < 0 || index >= QOS_SHAPER_MAX_CLIENTS || !s->clients[index].in_use) {
+        return QOS_SHAPER_ERROR;
+    }
+    c = &s->clients[index];
+    *stats = c->stats;
+    memcpy(stats->mac, c->mac, 6);
+    stats->configured = c->configured;
+    stats->rate = c->rate;
+    return QOS_SHAPER_SUCCESS;
+}
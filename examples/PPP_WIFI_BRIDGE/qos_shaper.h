@@ -0,0 +1,195 @@
+/**
+ * @file      qos_shaper.h
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      Per client traffic shaper for a shared, slow uplink. Every client (MAC)
+ *            has its own packet queue managed by CoDel, the backlogged clients take
+ *            turns by deficit round robin, clients that just became active go first,
+ *            and token buckets limit each client and the whole link. The link rate is
+ *            set a bit below the real one so the queue builds here, where it is
+ *            managed, instead of in the modem.
+ *            Packets are opaque pointers, the caller sends what qos_shaper_dequeue
+ *            returns and the drop callback frees what the shaper discards.
+ *            No platform dependencies, tools/qos_sim.c runs it on a PC.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC CONSTANTS ----------------------------------------------------- */
+
+#define QOS_SHAPER_SUCCESS          0
+#define QOS_SHAPER_ERROR            -1
+
+#define QOS_SHAPER_MAX_CLIENTS      16      /* classes, the first one is shared by the MACs that find no free slot */
+#define QOS_SHAPER_MTU              1514    /* a queue holding less than one frame is never dropped from */
+#define QOS_SHAPER_NO_LIMIT         0       /* rate that only the link limits */
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC TYPES --------------------------------------------------------- */
+
+/**
+@struct qos_shaper_config_s
+@brief Link settings and the defaults of clients that are not configured
+*/
+struct qos_shaper_config_s {
+    uint32_t    link_rate;          /*!> bytes per second for all clients, QOS_SHAPER_NO_LIMIT to only share */
+    uint32_t    link_burst;         /*!> bytes the link may send at once after being idle */
+    uint32_t    client_rate;        /*!> bytes per second of a client that has no rule */
+    uint32_t    client_burst;
+    uint16_t    quantum;            /*!> bytes a client may send per round, a weight of 1 */
+    uint16_t    queue_limit;        /*!> packets per client */
+    uint16_t    pool_size;          /*!> packets queued at most, all clients together */
+    uint32_t    codel_target_us;    /*!> acceptable standing queue delay, 5 ms */
+    uint32_t    codel_interval_us;  /*!> about a round trip time, 100 ms */
+    void (*drop)(void *pkt, void *arg); /*!> frees a packet the shaper discards */
+    void        *drop_arg;
+};
+
+/**
+@struct qos_client_stats_s
+@brief Counters of one client
+*/
+struct qos_client_stats_s {
+    uint8_t     mac[6];
+    uint8_t     configured;         /*!> set by qos_shaper_set_client, otherwise defaults */
+    uint32_t    rate;               /*!> bytes per second */
+    uint32_t    queued;             /*!> packets accepted */
+    uint32_t    sent;               /*!> packets dequeued */
+    uint64_t    sent_bytes;
+    uint32_t    drop_codel;         /*!> dropped because they waited too long */
+    uint32_t    drop_overflow;      /*!> dropped to make room */
+    uint16_t    backlog;            /*!> packets in the queue now */
+    uint32_t    backlog_bytes;
+    uint32_t    sojourn_max_us;     /*!> longest wait of a sent packet */
+};
+
+/**
+@struct qos_pkt_s
+@brief Queue entry, from the shaper pool
+*/
+struct qos_pkt_s {
+    struct qos_pkt_s *next;
+    void        *pkt;
+    uint32_t    len;
+    uint64_t    enqueue_us;
+};
+
+/**
+@struct qos_client_s
+@brief One class: the queue, the CoDel state and the token bucket
+*/
+struct qos_client_s {
+    uint8_t     mac[6];
+    uint8_t     in_use;
+    uint8_t     configured;
+    uint8_t     list;               /*!> 0 idle, 1 new, 2 old */
+    uint8_t     next;               /*!> next client in the same list */
+    uint32_t    quantum;            /*!> cfg quantum times the weight, up to 255 * 65535 */
+    int32_t     deficit;
+    uint32_t    rate;
+    uint32_t    burst;
+    int64_t     tokens;             /*!> may go negative by one packet */
+    uint64_t    refill_us;
+    struct qos_pkt_s *head;
+    struct qos_pkt_s *tail;
+    /* CoDel, RFC 8289 */
+    uint64_t    first_above_us;
+    uint64_t    drop_next_us;
+    uint32_t    count;
+    uint32_t    lastcount;
+    uint8_t     dropping;
+    struct qos_client_stats_s stats;
+};
+
+/**
+@struct qos_shaper_s
+@brief Shaper state, one per direction
+*/
+struct qos_shaper_s {
+    struct qos_shaper_config_s cfg;
+    struct qos_client_s clients[QOS_SHAPER_MAX_CLIENTS];
+    struct qos_pkt_s *pool;
+    struct qos_pkt_s *free_list;
+    uint16_t    pool_free;
+    uint8_t     new_head, new_tail;  /*!> clients that just became active */
+    uint8_t     old_head, old_tail;  /*!> the other backlogged clients */
+    int64_t     tokens;
+    uint64_t    refill_us;
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS PROTOTYPES ------------------------------------------ */
+
+/**
+@brief Allocate the packet pool
+@param s instance
+@param cfg link settings, copied
+@return QOS_SHAPER_SUCCESS or QOS_SHAPER_ERROR
+*/
+int qos_shaper_init(struct qos_shaper_s *s, const struct qos_shaper_config_s *cfg);
+
+/**
+@brief Drop everything queued and free the pool
+*/
+void qos_shaper_deinit(struct qos_shaper_s *s);
+
+/**
+@brief Set the limits of one client, it keeps its slot from now on
+@param s instance
+@param mac client address
+@param rate bytes per second, QOS_SHAPER_NO_LIMIT for only the link limit
+@param burst bytes it may send at once after being idle
+@param weight share of the link against the other backlogged clients, 1 is the default quantum
+@return QOS_SHAPER_SUCCESS or QOS_SHAPER_ERROR when every slot is configured
+*/
+int qos_shaper_set_client(struct qos_shaper_s *s, const uint8_t mac[6], uint32_t rate, uint32_t burst, uint8_t weight);
+
+/**
+@brief Queue a packet of a client
+When the client queue or the pool is full, the oldest packet of the client with
+the largest backlog is dropped to make room, so a bulk transfer loses its packets
+before a light client does.
+@param s instance
+@param mac client address
+@param pkt packet, the shaper owns it until it is dequeued or dropped
+@param len bytes
+@param now_us current time
+@return QOS_SHAPER_SUCCESS, the new packet is always queued
+*/
+int qos_shaper_enqueue(struct qos_shaper_s *s, const uint8_t mac[6], void *pkt, uint32_t len, uint64_t now_us);
+
+/**
+@brief Take the next packet the rates allow
+@param s instance
+@param now_us current time
+@param len receives the packet length, may be NULL
+@return packet to send, NULL when nothing may go now, see qos_shaper_next_us
+*/
+void *qos_shaper_dequeue(struct qos_shaper_s *s, uint64_t now_us, uint32_t *len);
+
+/**
+@brief When qos_shaper_dequeue should be called again
+@return time a token bucket allows the next packet, 0 when nothing is queued
+*/
+uint64_t qos_shaper_next_us(struct qos_shaper_s *s, uint64_t now_us);
+
+/**
+@brief Get the counters of a slot
+@param s instance
+@param index slot, below QOS_SHAPER_MAX_CLIENTS
+@param stats pointer to receive the counters
+@return QOS_SHAPER_SUCCESS, QOS_SHAPER_ERROR if the slot was never used
+*/
+int qos_shaper_get_stats(struct qos_shaper_s *s, int index, struct qos_client_stats_s *stats);
+
+#ifdef __cplusplus
+}
+#endif
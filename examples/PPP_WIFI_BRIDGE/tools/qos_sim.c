@@ -0,0 +1,372 @@
+/**
+ * @file      qos_sim.c
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      PC simulation of the bridge uplink under load, with and without
+ *            qos_shaper in front of the modem. Four Wi-Fi clients share a slow
+ *            cellular uplink: one with two bulk TCP uploads, one with a single
+ *            upload, one sending telemetry every 100 ms and one with a 50 packet/s
+ *            voice stream. The uploads follow a simple Reno model, the modem has a
+ *            deep FIFO like most cellular modules. Prints throughput, latency from
+ *            the client to the end of the uplink, and drops per client, then the
+ *            cost of the shaper per packet.
+ *
+ * build:  cc -O2 -o qos_sim qos_sim.c ../qos_shaper.c
+ * usage:  qos_sim [uplink kbit/s] [modem buffer packets] [seconds]
+ */
+#ifndef ARDUINO     /* PC tool, PlatformIO compiles every file below src_dir */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../qos_shaper.h"
+
+#define STEP_US         100
+#define WARMUP_US       5000000ULL
+#define BASE_RTT_US     60000       /* cellular round trip without queueing */
+#define MSS             1500
+#define CLIENTS         4
+#define FLOWS           5
+#define HIST_MS         5000
+#define POOL_PKTS       4096
+#define EVENTS          1024
+
+enum { MODE_FIFO, MODE_SHAPER, MODE_SHAPER_LIMIT };
+
+struct sim_pkt {
+    struct sim_pkt *next;
+    int flow;
+    uint32_t len;
+    uint64_t born_us;
+};
+
+/* Reno sender, acks and losses reach it one base RTT after the uplink */
+struct flow {
+    int client;
+    int bulk;
+    uint32_t len;
+    uint32_t period_us;     /* constant rate flows */
+    uint64_t next_us;
+    double cwnd;
+    double ssthresh;
+    int inflight;
+    uint64_t recover_us;
+    uint64_t ev_us[EVENTS];
+    uint8_t ev_loss[EVENTS];
+    int ev_head, ev_tail;
+};
+
+struct client {
+    const char *name;
+    uint8_t mac[6];
+    uint64_t bytes;
+    uint32_t drops;
+    uint32_t pkts;
+    uint32_t hist[HIST_MS + 1];
+    uint64_t max_us;
+};
+
+static struct sim_pkt pkt_pool[POOL_PKTS];
+static struct sim_pkt *pkt_free;
+static struct flow flows[FLOWS];
+static struct client clients[CLIENTS];
+static uint64_t now;
+
+static struct sim_pkt *modem_head, *modem_tail;
+static int modem_len;
+static uint64_t modem_busy_us;
+
+static struct sim_pkt *pkt_alloc(void)
+{
+    struct sim_pkt *p = pkt_free;
+
+    if (p) {
+        pkt_free = p->next;
+    }
+    return p;
+}
+
+static void pkt_free_one(struct sim_pkt *p)
+{
+    p->next = pkt_free;
+    pkt_free = p;
+}
+
+static void flow_event(struct flow *f, uint64_t at, int loss)
+{
+    f->ev_us[f->ev_tail] = at;
+    f->ev_loss[f->ev_tail] = (uint8_t)loss;
+    f->ev_tail = (f->ev_tail + 1) % EVENTS;
+}
+
+static void lost(struct sim_pkt *p)
+{
+    struct flow *f = &flows[p->flow];
+
+    if (now >= WARMUP_US) {
+        clients[f->client].drops++;
+    }
+    if (f->bulk) {
+        flow_event(f, now + BASE_RTT_US, 1);
+    }
+    pkt_free_one(p);
+}
+
+static void shaper_drop(void *pkt, void *arg)
+{
+    (void)arg;
+    lost(pkt);
+}
+
+static void modem_push(struct sim_pkt *p, int limit)
+{
+    if (modem_len >= limit) {
+        lost(p);
+        return;
+    }
+    p->next = NULL;
+    if (modem_tail) {
+        modem_tail->next = p;
+    } else {
+        modem_head = p;
+    }
+    modem_tail = p;
+    modem_len++;
+}
+
+/* serialize onto the uplink, the packet arrives when its last byte is out */
+static void modem_run(uint32_t rate)
+{
+    if (modem_busy_us < now && modem_head == NULL) {
+        modem_busy_us = now;
+    }
+    while (modem_head && modem_busy_us <= now) {
+        struct sim_pkt *p = modem_head;
+        struct flow *f = &flows[p->flow];
+        struct client *c = &clients[f->client];
+
+        modem_head = p->next;
+        if (modem_head == NULL) {
+            modem_tail = NULL;
+        }
+        modem_len--;
+        if (modem_busy_us < now - STEP_US) {
+            modem_busy_us = now - STEP_US;
+        }
+        modem_busy_us += (uint64_t)p->len * 1000000 / rate;
+        if (now >= WARMUP_US) {
+            uint64_t lat = modem_busy_us - p->born_us;
+            c->bytes += p->len;
+            c->pkts++;
+            c->hist[lat / 1000 < HIST_MS ? lat / 1000 : HIST_MS]++;
+            if (lat > c->max_us) {
+                c->max_us = lat;
+            }
+        }
+        if (f->bulk) {
+            flow_event(f, modem_busy_us + BASE_RTT_US, 0);
+        }
+        pkt_free_one(p);
+    }
+}
+
+static void flow_acks(struct flow *f)
+{
+    while (f->ev_head != f->ev_tail && f->ev_us[f->ev_head] <= now) {
+        f->inflight--;
+        if (f->ev_loss[f->ev_head]) {
+            /* one halving per round trip */
+            if (now >= f->recover_us) {
+                f->ssthresh = f->cwnd / 2 > 2 ? f->cwnd / 2 : 2;
+                f->cwnd = f->ssthresh;
+                f->recover_us = now + BASE_RTT_US * 2;
+            }
+        } else if (f->cwnd < f->ssthresh) {
+            f->cwnd += 1;
+        } else {
+            f->cwnd += 1 / f->cwnd;
+        }
+        f->ev_head = (f->ev_head + 1) % EVENTS;
+    }
+}
+
+static uint32_t percentile(const struct client *c, double q)
+{
+    uint64_t want = (uint64_t)(c->pkts * q), seen = 0;
+
+    for (int i = 0; i <= HIST_MS; i++) {
+        seen += c->hist[i];
+        if (seen > want) {
+            return i;
+        }
+    }
+    return HIST_MS;
+}
+
+static void setup(void)
+{
+    static const char *names[CLIENTS] = { "bulk x2", "bulk", "telemetry", "voice" };
+
+    memset(flows, 0, sizeof(flows));
+    memset(clients, 0, sizeof(clients));
+    for (int i = 0; i < CLIENTS; i++) {
+        uint8_t mac[6] = { 0x7c, 0xdf, 0xa1, 0x00, 0x00, (uint8_t)(i + 1) };
+        clients[i].name = names[i];
+        memcpy(clients[i].mac, mac, 6);
+    }
+    for (int i = 0; i < FLOWS; i++) {
+        flows[i].cwnd = 2;
+        flows[i].ssthresh = 1000;
+        flows[i].len = MSS;
+        flows[i].bulk = 1;
+    }
+    flows[0].client = 0;
+    flows[1].client = 0;
+    flows[2].client = 1;
+    flows[3].client = 2, flows[3].bulk = 0, flows[3].len = 120, flows[3].period_us = 100000;
+    flows[4].client = 3, flows[4].bulk = 0, flows[4].len = 200, flows[4].period_us = 20000;
+
+    pkt_free = NULL;
+    for (int i = 0; i < POOL_PKTS; i++) {
+        pkt_free_one(&pkt_pool[i]);
+    }
+    modem_head = modem_tail = NULL;
+    modem_len = 0;
+    modem_busy_us = 0;
+}
+
+static void run(int mode, uint32_t rate, int modem_limit, uint64_t duration_us)
+{
+    static const char *mode_names[] = { "fifo", "shaper", "shaper+cap" };
+    struct qos_shaper_config_s cfg = {
+        .link_rate = rate / 100 * 95,      /* below the modem, the queue stays here */
+        .link_burst = 2 * MSS,
+        .client_rate = QOS_SHAPER_NO_LIMIT,
+        .client_burst = 0,
+        .quantum = MSS,
+        .queue_limit = 256,
+        .pool_size = 512,
+        .codel_target_us = 5000,
+        .codel_interval_us = 100000,
+        .drop = shaper_drop,
+    };
+    struct qos_shaper_s shaper;
+
+    setup();
+    if (mode != MODE_FIFO) {
+        qos_shaper_init(&shaper, &cfg);
+        if (mode == MODE_SHAPER_LIMIT) {
+            /* the double upload gets a quarter of the link */
+            qos_shaper_set_client(&shaper, clients[0].mac, rate / 4, 4 * MSS, 1);
+        }
+    }
+
+    for (now = 0; now < duration_us; now += STEP_US) {
+        for (int i = 0; i < FLOWS; i++) {
+            struct flow *f = &flows[i];
+            struct sim_pkt *p;
+            flow_acks(f);
+            while (f->bulk ? f->inflight < (int)f->cwnd : now >= f->next_us) {
+                if ((p = pkt_alloc()) == NULL) {
+                    break;
+                }
+                p->flow = i;
+                p->len = f->len;
+                p->born_us = now;
+                if (f->bulk) {
+                    f->inflight++;
+                } else {
+                    f->next_us += f->period_us;
+                }
+                if (mode == MODE_FIFO) {
+                    modem_push(p, modem_limit);
+                } else {
+                    qos_shaper_enqueue(&shaper, clients[f->client].mac, p, p->len, now);
+                }
+            }
+        }
+        if (mode != MODE_FIFO) {
+            struct sim_pkt *p;
+            while ((p = qos_shaper_dequeue(&shaper, now, NULL)) != NULL) {
+                modem_push(p, modem_limit);
+            }
+        }
+        modem_run(rate);
+    }
+
+    double seconds = (duration_us - WARMUP_US) / 1e6;
+    for (int i = 0; i < CLIENTS; i++) {
+        struct client *c = &clients[i];
+        printf("%-11s %-10s %8.0f %8u %8u %8.0f %8u\n", mode_names[mode], c->name, c->bytes * 8 / 1000 / seconds,
+               percentile(c, 0.5), percentile(c, 0.99), c->max_us / 1000.0, c->drops);
+    }
+    if (mode != MODE_FIFO) {
+        qos_shaper_deinit(&shaper);
+    }
+}
+
+static void null_drop(void *pkt, void *arg)
+{
+    (void)pkt;
+    (void)arg;
+}
+
+/* enqueue plus dequeue of one packet with all slots busy */
+static void bench(void)
+{
+    struct qos_shaper_config_s cfg = {
+        .link_rate = QOS_SHAPER_NO_LIMIT,
+        .client_rate = 1000000000,
+        .client_burst = 1000000,
+        .quantum = MSS,
+        .queue_limit = 64,
+        .pool_size = 512,
+        .codel_target_us = 5000,
+        .codel_interval_us = 100000,
+        .drop = null_drop,
+    };
+    struct qos_shaper_s shaper;
+    struct timespec t0, t1;
+    const uint32_t n = 10000000;
+    uint8_t mac[6] = { 0x7c, 0xdf, 0xa1, 0, 0, 0 };
+
+    qos_shaper_init(&shaper, &cfg);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (uint32_t i = 0; i < n; i++) {
+        mac[5] = (uint8_t)(i % QOS_SHAPER_MAX_CLIENTS);
+        qos_shaper_enqueue(&shaper, mac, &shaper, 64 + i % MSS, i);
+        if (i >= 4 * QOS_SHAPER_MAX_CLIENTS) {
+            qos_shaper_dequeue(&shaper, i, NULL);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    printf("shaper cost %.1f ns per packet, %u slots busy\n",
+           ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / n, QOS_SHAPER_MAX_CLIENTS);
+    qos_shaper_deinit(&shaper);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t kbps = argc > 1 ? (uint32_t)atoi(argv[1]) : 2000;
+    int modem_limit = argc > 2 ? atoi(argv[2]) : 128;
+    uint64_t seconds = argc > 3 ? (uint64_t)atoi(argv[3]) : 60;
+    uint32_t rate = kbps * 125;
+
+    if (kbps < 100 || modem_limit < 1 || seconds * 1000000 <= WARMUP_US) {
+        fprintf(stderr, "usage: %s [uplink kbit/s >= 100] [modem buffer packets] [seconds > 5]\n", argv[0]);
+        return 1;
+    }
+    printf("uplink %u kbit/s, modem buffer %d packets, base RTT %d ms, %llu s\n\n", kbps, modem_limit,
+           BASE_RTT_US / 1000, (unsigned long long)seconds);
+    printf("%-11s %-10s %8s %8s %8s %8s %8s\n", "mode", "client", "kbit/s", "p50 ms", "p99 ms", "max ms", "drops");
+    for (int mode = MODE_FIFO; mode <= MODE_SHAPER_LIMIT; mode++) {
+        run(mode, rate, modem_limit, seconds * 1000000);
+    }
+    printf("\n");
+    bench();
+    return 0;
+}
+
+#endif
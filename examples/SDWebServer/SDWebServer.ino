@@ -19,6 +19,7 @@
 #include <WebServer.h>
 #include <ESPmDNS.h>
 #include "utilities.h"          //Board PinMap
+#include "file_serving.h"
 #include <WiFi.h>
 
 #ifdef LILYGO_T_ETH_POE_PRO
@@ -26,11 +27,51 @@
 #endif
 
 
+// Uploads are collected in sector aligned buffers and written by a separate
+// task, so the next buffer fills from the network while one goes to the card
+#define UPLOAD_BUFFER_SIZE  (32 * SD_SECTOR_SIZE)
+#define UPLOAD_BUFFER_COUNT 2
+
 static bool eth_connected = false;
 
 WebServer server(80);
 //holds the current upload
-File fsUploadFile;
+typedef struct {
+    File file;
+    String filename;
+    uint8_t *fill;              //buffer being filled from the network, NULL if none
+    size_t fillLen;
+    QueueHandle_t freeBuffers;  //buffers handed back by the writer task
+    bool writeError;
+    uint32_t startMillis;
+    uint32_t writes;
+    uint32_t writeMicros;       //time spent in SD writes
+    uint32_t writeMicrosMax;
+    uint32_t waitMicros;        //time the web server waited for a free buffer
+} UploadPipeline;
+
+typedef struct {
+    UploadPipeline *pipeline;
+    uint8_t *data;
+    size_t len;
+} UploadJob;
+
+typedef struct {
+    String filename;
+    size_t size;
+    uint32_t millis;
+    uint32_t writes;
+    uint32_t writeMicrosAvg;
+    uint32_t writeMicrosMax;
+    uint32_t waitMicros;
+    bool ok;
+} UploadStats;
+
+//the web server handles one request at a time, a form with several files
+//is uploaded one file after the other
+static UploadPipeline uploadPipeline;
+static UploadStats lastUpload;
+static QueueHandle_t uploadJobs;
 
 
 //format bytes
@@ -47,68 +88,92 @@ String formatBytes(size_t bytes)
     }
 }
 
-String getContentType(String filename)
+static void uploadWriterTask(void *arg)
 {
-    if (server.hasArg("download")) {
-        return "application/octet-stream";
-    } else if (filename.endsWith(".htm")) {
-        return "text/html";
-    } else if (filename.endsWith(".html")) {
-        return "text/html";
-    } else if (filename.endsWith(".css")) {
-        return "text/css";
-    } else if (filename.endsWith(".js")) {
-        return "application/javascript";
-    } else if (filename.endsWith(".png")) {
-        return "image/png";
-    } else if (filename.endsWith(".gif")) {
-        return "image/gif";
-    } else if (filename.endsWith(".jpg")) {
-        return "image/jpeg";
-    } else if (filename.endsWith(".ico")) {
-        return "image/x-icon";
-    } else if (filename.endsWith(".xml")) {
-        return "text/xml";
-    } else if (filename.endsWith(".pdf")) {
-        return "application/x-pdf";
-    } else if (filename.endsWith(".zip")) {
-        return "application/x-zip";
-    } else if (filename.endsWith(".gz")) {
-        return "application/x-gzip";
+    UploadJob job;
+    while (1) {
+        xQueueReceive(uploadJobs, &job, portMAX_DELAY);
+        UploadPipeline *p = job.pipeline;
+        uint32_t t = micros();
+        if (!p->writeError && p->file.write(job.data, job.len) != job.len) {
+            p->writeError = true;
+        }
+        t = micros() - t;
+        p->writes++;
+        p->writeMicros += t;
+        if (t > p->writeMicrosMax) {
+            p->writeMicrosMax = t;
+        }
+        xQueueSend(p->freeBuffers, &job.data, portMAX_DELAY);
     }
-    return "text/plain";
 }
 
-bool exists(String path)
+bool uploadBegin(UploadPipeline *p)
 {
-    bool yes = false;
-    File file = SD.open(path, "r");
-    if (!file.isDirectory()) {
-        yes = true;
+    p->freeBuffers = xQueueCreate(UPLOAD_BUFFER_COUNT, sizeof(uint8_t *));
+    if (!p->freeBuffers) {
+        return false;
     }
-    file.close();
-    return yes;
+    for (int i = 0; i < UPLOAD_BUFFER_COUNT; i++) {
+        uint8_t *buf = (uint8_t *)malloc(UPLOAD_BUFFER_SIZE);
+        if (!buf) {
+            return false;
+        }
+        xQueueSend(p->freeBuffers, &buf, 0);
+    }
+    p->fill = NULL;
+    return true;
 }
 
-bool handleFileRead(String path)
+void uploadSubmit(UploadPipeline *p)
 {
-    Serial.println("handleFileRead: " + path);
-    if (path.endsWith("/")) {
-        path += "index.htm";
-    }
-    String contentType = getContentType(path);
-    String pathWithGz = path + ".gz";
-    if (exists(pathWithGz) || exists(path)) {
-        if (exists(pathWithGz)) {
-            path += ".gz";
+    UploadJob job = {p, p->fill, p->fillLen};
+    xQueueSend(uploadJobs, &job, portMAX_DELAY);
+    p->fill = NULL;
+}
+
+void uploadAppend(UploadPipeline *p, const uint8_t *data, size_t len)
+{
+    while (len) {
+        if (!p->fill) {
+            uint32_t t = micros();
+            xQueueReceive(p->freeBuffers, &p->fill, portMAX_DELAY);
+            p->waitMicros += micros() - t;
+            p->fillLen = 0;
+        }
+        size_t n = UPLOAD_BUFFER_SIZE - p->fillLen;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(p->fill + p->fillLen, data, n);
+        p->fillLen += n;
+        data += n;
+        len -= n;
+        if (p->fillLen == UPLOAD_BUFFER_SIZE) {
+            uploadSubmit(p);
         }
-        Serial.println("--> handleFileRead " + path);
-        File file = SD.open(path, "r");
-        server.streamFile(file, contentType);
-        file.close();
-        return true;
     }
-    return false;
+}
+
+//sends the last partial buffer and waits until the writer task is done
+bool uploadFinish(UploadPipeline *p)
+{
+    if (p->fill && p->fillLen) {
+        uploadSubmit(p);
+    } else if (p->fill) {
+        xQueueSend(p->freeBuffers, &p->fill, 0);
+        p->fill = NULL;
+    }
+    uint8_t *buffers[UPLOAD_BUFFER_COUNT];
+    for (int i = 0; i < UPLOAD_BUFFER_COUNT; i++) {
+        xQueueReceive(p->freeBuffers, &buffers[i], portMAX_DELAY);
+    }
+    for (int i = 0; i < UPLOAD_BUFFER_COUNT; i++) {
+        xQueueSend(p->freeBuffers, &buffers[i], 0);
+    }
+    bool ok = !p->writeError;
+    p->file.close();
+    return ok;
 }
 
 void handleFileUpload()
@@ -123,21 +188,56 @@ void handleFileUpload()
             filename = "/" + filename;
         }
         Serial.print("handleFileUpload Name: "); Serial.println(filename);
-        fsUploadFile = SD.open(filename, "w");
+        uploadPipeline.file = SD.open(filename, "w");
+        uploadPipeline.filename = filename;
+        uploadPipeline.writeError = !uploadPipeline.file;
+        uploadPipeline.startMillis = millis();
+        uploadPipeline.writes = uploadPipeline.writeMicros = uploadPipeline.writeMicrosMax = uploadPipeline.waitMicros = 0;
         filename = String();
     } else if (upload.status == UPLOAD_FILE_WRITE) {
         //Serial.print("handleFileUpload Data: "); Serial.println(upload.currentSize);
-        if (fsUploadFile) {
-            fsUploadFile.write(upload.buf, upload.currentSize);
+        if (uploadPipeline.file) {
+            uploadAppend(&uploadPipeline, upload.buf, upload.currentSize);
+        }
+    } else if (upload.status == UPLOAD_FILE_END || upload.status == UPLOAD_FILE_ABORTED) {
+        if (!uploadPipeline.file) {
+            return;
         }
-    } else if (upload.status == UPLOAD_FILE_END) {
-        if (fsUploadFile) {
-            fsUploadFile.close();
+        UploadStats &stats = lastUpload;
+        stats.ok = uploadFinish(&uploadPipeline) && upload.status == UPLOAD_FILE_END;
+        stats.filename = uploadPipeline.filename;
+        stats.size = upload.totalSize;
+        stats.millis = millis() - uploadPipeline.startMillis;
+        stats.writes = uploadPipeline.writes;
+        stats.writeMicrosAvg = uploadPipeline.writes ? uploadPipeline.writeMicros / uploadPipeline.writes : 0;
+        stats.writeMicrosMax = uploadPipeline.writeMicrosMax;
+        stats.waitMicros = uploadPipeline.waitMicros;
+        if (!stats.ok) {
+            SD.remove(stats.filename);
         }
-        Serial.print("handleFileUpload Size: "); Serial.println(upload.totalSize);
+        Serial.printf("handleFileUpload Size: %u, %s, %.1f KB/s, %u writes, avg %u us, max %u us, waited %u us\n",
+                      (unsigned)stats.size, stats.ok ? "ok" : "failed",
+                      stats.millis ? stats.size / 1.024 / stats.millis : 0.0,
+                      (unsigned)stats.writes, (unsigned)stats.writeMicrosAvg,
+                      (unsigned)stats.writeMicrosMax, (unsigned)stats.waitMicros);
     }
 }
 
+void handleUploadStats()
+{
+    String json = "{";
+    json += "\"name\":\"" + lastUpload.filename + "\"";
+    json += ", \"ok\":" + String(lastUpload.ok ? "true" : "false");
+    json += ", \"size\":" + String(lastUpload.size);
+    json += ", \"ms\":" + String(lastUpload.millis);
+    json += ", \"writes\":" + String(lastUpload.writes);
+    json += ", \"write_avg_us\":" + String(lastUpload.writeMicrosAvg);
+    json += ", \"write_max_us\":" + String(lastUpload.writeMicrosMax);
+    json += ", \"wait_us\":" + String(lastUpload.waitMicros);
+    json += "}";
+    server.send(200, "text/json", json);
+}
+
 void handleFileDelete()
 {
     if (server.args() == 0) {
@@ -306,7 +406,20 @@ void setup()
         Serial.println("Wait for network connect ..."); delay(500);
     }
 
+    //upload pipeline, the writer task waits for filled buffers
+    uploadJobs = xQueueCreate(UPLOAD_BUFFER_COUNT, sizeof(UploadJob));
+    if (!uploadJobs || !uploadBegin(&uploadPipeline)) {
+        Serial.println("Upload buffers allocation failed!");
+        while (1) {
+            delay(1000);
+        }
+    }
+    xTaskCreate(uploadWriterTask, "sd_writer", 4096, NULL, 2, NULL);
+
     //SERVER INIT
+    //request headers used by handleFileRead
+    const char *headerKeys[] = {"Range", "If-Range", "If-None-Match", "If-Modified-Since", "Accept-Encoding"};
+    server.collectHeaders(headerKeys, sizeof(headerKeys) / sizeof(headerKeys[0]));
     //list directory
     server.on("/list", HTTP_GET, handleFileList);
     //load editor
@@ -324,6 +437,8 @@ void setup()
     server.on("/edit", HTTP_POST, []() {
         server.send(200, "text/plain", "");
     }, handleFileUpload);
+    //throughput and SD write latency of the last upload
+    server.on("/upload/stats", HTTP_GET, handleUploadStats);
 
     //called when the url is not defined here
     //use it to load content from SD
@@ -0,0 +1,204 @@
+/**
+ * @file      file_serving.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      See file_serving.h
+ */
+#include "file_serving.h"
+
+String getContentType(String filename)
+{
+    if (server.hasArg("download")) {
+        return "application/octet-stream";
+    } else if (filename.endsWith(".htm")) {
+        return "text/html";
+    } else if (filename.endsWith(".html")) {
+        return "text/html";
+    } else if (filename.endsWith(".css")) {
+        return "text/css";
+    } else if (filename.endsWith(".js")) {
+        return "application/javascript";
+    } else if (filename.endsWith(".png")) {
+        return "image/png";
+    } else if (filename.endsWith(".gif")) {
+        return "image/gif";
+    } else if (filename.endsWith(".jpg")) {
+        return "image/jpeg";
+    } else if (filename.endsWith(".ico")) {
+        return "image/x-icon";
+    } else if (filename.endsWith(".xml")) {
+        return "text/xml";
+    } else if (filename.endsWith(".pdf")) {
+        return "application/x-pdf";
+    } else if (filename.endsWith(".zip")) {
+        return "application/x-zip";
+    } else if (filename.endsWith(".gz")) {
+        return "application/x-gzip";
+    }
+    return "text/plain";
+}
+
+bool exists(String path)
+{
+    bool yes = false;
+    File file = SD.open(path, "r");
+    if (file && !file.isDirectory()) {
+        yes = true;
+    }
+    file.close();
+    return yes;
+}
+
+String httpDate(time_t t)
+{
+    char buf[32];
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    return String(buf);
+}
+
+int parseRange(const char *header, size_t size, size_t *start, size_t *end)
+{
+    if (strncmp(header, "bytes=", 6) != 0 || strchr(header, ',')) {
+        return 0;
+    }
+    const char *p = header + 6;
+    char *next;
+    if (*p == '-') {
+        unsigned long suffix = strtoul(p + 1, &next, 10);
+        if (next == p + 1 || *next) {
+            return 0;
+        }
+        if (suffix == 0 || size == 0) {
+            return -1;
+        }
+        *start = suffix < size ? size - suffix : 0;
+        *end = size - 1;
+        return 1;
+    }
+    unsigned long first = strtoul(p, &next, 10);
+    if (next == p || *next != '-') {
+        return 0;
+    }
+    p = next + 1;
+    unsigned long last = size - 1;
+    if (*p) {
+        last = strtoul(p, &next, 10);
+        if (*next || last < first) {
+            return 0;
+        }
+        if (last >= size) {
+            last = size - 1;
+        }
+    }
+    if (first >= size) {
+        return -1;
+    }
+    *start = first;
+    *end = last;
+    return 1;
+}
+
+// Sends length bytes from offset. The first read ends on a sector boundary
+// so all following reads are whole, aligned sectors.
+bool sendFileRange(File &file, size_t offset, size_t length)
+{
+    static uint8_t buffer[FILE_CHUNK_SIZE];
+    if (!file.seek(offset)) {
+        return false;
+    }
+    while (length) {
+        size_t n = FILE_CHUNK_SIZE - (offset % SD_SECTOR_SIZE);
+        if (n > length) {
+            n = length;
+        }
+        n = file.read(buffer, n);
+        if (!n || server.client().write(buffer, n) != n) {
+            return false;
+        }
+        offset += n;
+        length -= n;
+    }
+    return true;
+}
+
+bool handleFileRead(String path)
+{
+    Serial.println("handleFileRead: " + path);
+    if (path.endsWith("/")) {
+        path += "index.htm";
+    }
+    String contentType = getContentType(path);
+    String pathWithGz = path + ".gz";
+    bool acceptGzip = server.header("Accept-Encoding").indexOf("gzip") >= 0;
+    bool gzipped = false;
+    if (exists(pathWithGz) && (acceptGzip || !exists(path))) {
+        path = pathWithGz;
+        gzipped = true;
+    } else if (!exists(path)) {
+        return false;
+    }
+    Serial.println("--> handleFileRead " + path);
+    File file = SD.open(path, "r");
+    if (!file) {
+        return false;
+    }
+
+    // Validators for conditional requests, they change whenever the file is rewritten
+    size_t size = file.size();
+    time_t lastWrite = file.getLastWrite();
+    String etag = "\"" + String(size, HEX) + "-" + String((uint32_t)lastWrite, HEX) + (gzipped ? "-gz\"" : "\"");
+    String lastModified = httpDate(lastWrite);
+
+    server.sendHeader("ETag", etag);
+    server.sendHeader("Last-Modified", lastModified);
+    server.sendHeader("Cache-Control", "no-cache");     // revalidate, files can change through /edit
+    server.sendHeader("Accept-Ranges", "bytes");
+    server.sendHeader("Vary", "Accept-Encoding");
+    if (gzipped) {
+        server.sendHeader("Content-Encoding", "gzip");
+    }
+
+    bool notModified;
+    if (server.hasHeader("If-None-Match")) {
+        String match = server.header("If-None-Match");
+        notModified = match == "*" || match.indexOf(etag) >= 0;
+    } else {
+        notModified = server.header("If-Modified-Since") == lastModified;
+    }
+    if (notModified) {
+        file.close();
+        server.send(304);
+        return true;
+    }
+
+    int code = 200;
+    size_t start = 0, end = size - 1;
+    String ifRange = server.header("If-Range");
+    if (server.hasHeader("Range") && (ifRange.length() == 0 || ifRange == etag || ifRange == lastModified)) {
+        int ret = parseRange(server.header("Range").c_str(), size, &start, &end);
+        if (ret < 0) {
+            file.close();
+            server.sendHeader("Content-Range", "bytes */" + String(size));
+            server.send(416, "text/plain", "");
+            return true;
+        }
+        if (ret > 0) {
+            code = 206;
+            server.sendHeader("Content-Range", "bytes " + String(start) + "-" + String(end) + "/" + String(size));
+        }
+    }
+
+    size_t length = size ? end - start + 1 : 0;
+    server.setContentLength(length);
+    server.send(code, contentType, "");
+    if (server.method() != HTTP_HEAD && length) {
+        if (!sendFileRange(file, start, length)) {
+            Serial.println("--> handleFileRead aborted " + path);
+        }
+    }
+    file.close();
+    return true;
+}
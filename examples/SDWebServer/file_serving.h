@@ -0,0 +1,40 @@
+/**
+ * @file      file_serving.h
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      Serving SD card files over the web server: ETag/Last-Modified with
+ *            304 answers, single byte ranges and .gz variants. Uses the sketch's
+ *            server object, tools/host_bench in UnitTestExample runs it on a PC
+ *            against a directory backed SD and a recording WebServer.
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <SD.h>
+#include <WebServer.h>
+
+// SD reads are done in whole sectors, 4KB per chunk when streaming files
+#define SD_SECTOR_SIZE      512
+#define FILE_CHUNK_SIZE     (8 * SD_SECTOR_SIZE)
+
+extern WebServer server;
+
+String getContentType(String filename);
+
+// A regular file, not a directory
+bool exists(String path);
+
+// RFC 7231 date, as used by Last-Modified and If-Modified-Since
+String httpDate(time_t t);
+
+// Parses a single range "bytes=first-last", "bytes=first-" or "bytes=-suffix".
+// Returns 1 with start/end set, 0 if the header is ignored (bad syntax or
+// several ranges, the whole file is sent) and -1 if it can't be satisfied.
+int parseRange(const char *header, size_t size, size_t *start, size_t *end);
+
+// Sends length bytes from offset to the current client
+bool sendFileRange(File &file, size_t offset, size_t length);
+
+// Answers the current request with the file at path, false if there is none
+bool handleFileRead(String path);
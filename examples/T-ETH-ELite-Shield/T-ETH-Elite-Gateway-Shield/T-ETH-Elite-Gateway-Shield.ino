@@ -4,15 +4,26 @@
  * @license   MIT
  * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
  * @date      2024-04-18
- * @note      It is only used to test whether SX1302 is connected and whether GPS is working properly.
+ * @note      It is used to test whether SX1302 is connected and whether GPS is working properly,
+ *            and runs the Semtech UDP packet forwarder (see pkt_fwd.h) over Ethernet.
  *            If the message "No GPS data received" appears, please check whether the GPS switch on the back of the T-ETH-Elite-Gateway-Shield board has been turned to the ON side.
+ *            The uplink source is simulated unless the SX1302 HAL receive/send functions are linked in,
+ *            run mock_network_server.py on the PC to measure the forwarding rate.
  */
 #include <Arduino.h>
+#if ESP_ARDUINO_VERSION < ESP_ARDUINO_VERSION_VAL(3,0,0)
+#include <ETHClass2.h>       //Is to use the modified ETHClass
+#define ETH  ETH2
+#else
+#include <ETH.h>
+#endif
+#include <WiFi.h>
 #include <SPI.h>
 #include "utilities.h"
 #include "loragw_reg.h"
 #include "loragw_hal.h"
 #include "loragw_spi.h"
+#include "pkt_fwd.h"
 
 #include <TinyGPS++.h>
 TinyGPSPlus gps;
@@ -27,11 +38,159 @@ extern const struct lgw_reg_s loregs[LGW_TOTALREGS + 1];
 #define GPS_BAUD        9600
 #define GPSSerial       Serial1
 
+// Network server running the Semtech UDP protocol, e.g. mock_network_server.py
+const IPAddress serverAddress(192, 168, 36, 76);
+const uint16_t serverPort = PKT_FWD_DEFAULT_PORT;
+
+// Gateway EUI, the upper bytes of the Ethernet MAC address are used if left at 0
+uint64_t gatewayEUI = 0;
+
+// Uplinks wait at most this long to be sent together in one PUSH_DATA
+#define PUSH_FLUSH_MS           100
+
+// Simulated uplink rate, in packets per second
+#define SIM_PACKET_RATE         50
+
+// Print the forwarder counters at this interval
+#define STATS_INTERVAL_MS       10000
+
 void test_loragw_reg();
 
+static bool eth_connected = false;
+static bool fwd_started = false;
+
+void WiFiEvent(arduino_event_id_t event)
+{
+    switch (event) {
+    case ARDUINO_EVENT_ETH_START:
+        Serial.println("ETH Started");
+        //set eth hostname here
+        ETH.setHostname("esp32-gateway");
+        break;
+    case ARDUINO_EVENT_ETH_CONNECTED:
+        Serial.println("ETH Connected");
+        break;
+    case ARDUINO_EVENT_ETH_GOT_IP:
+        Serial.print("ETH MAC: ");
+        Serial.print(ETH.macAddress());
+        Serial.print(", IPv4: ");
+        Serial.println(ETH.localIP());
+        eth_connected = true;
+        break;
+    case ARDUINO_EVENT_ETH_DISCONNECTED:
+        Serial.println("ETH Disconnected");
+        eth_connected = false;
+        break;
+    case ARDUINO_EVENT_ETH_STOP:
+        Serial.println("ETH Stopped");
+        eth_connected = false;
+        break;
+    default:
+        break;
+    }
+}
+
+/*
+ * Simulated concentrator, generates LoRa uplinks at SIM_PACKET_RATE
+ * and uses micros() as the concentrator counter.
+ */
+static uint32_t sim_next_us = 0;
+static uint32_t sim_fcnt = 0;
+
+static int sim_receive(uint8_t max_pkt, struct lgw_pkt_rx_s *pkt_data)
+{
+    uint32_t now = micros();
+    int nb_pkt = 0;
+
+    while ((nb_pkt < max_pkt) && ((int32_t)(now - sim_next_us) >= 0)) {
+        struct lgw_pkt_rx_s *p = &pkt_data[nb_pkt++];
+        memset(p, 0, sizeof * p);
+        p->freq_hz = 868100000 + (sim_fcnt % 3) * 200000;
+        p->if_chain = sim_fcnt % 3;
+        p->status = STAT_CRC_OK;
+        p->count_us = sim_next_us;
+        p->modulation = MOD_LORA;
+        p->bandwidth = BW_125KHZ;
+        p->datarate = DR_LORA_SF7 + (sim_fcnt % 6);
+        p->coderate = CR_LORA_4_5;
+        p->rssic = -60 - (int)(sim_fcnt % 40);
+        p->rssis = p->rssic - 1;
+        p->snr = 9.5;
+        p->size = 23;
+        p->payload[0] = 0x40;       /* unconfirmed data up */
+        memcpy(&p->payload[6], &sim_fcnt, sizeof sim_fcnt);
+        sim_fcnt++;
+        sim_next_us += 1000000UL / SIM_PACKET_RATE;
+    }
+    return nb_pkt;
+}
+
+static int sim_send(struct lgw_pkt_tx_s *pkt_data)
+{
+    Serial.printf("TX %u Hz, SF%u, %u bytes at %u\n", pkt_data->freq_hz, pkt_data->datarate, pkt_data->size, pkt_data->count_us);
+    return LGW_HAL_SUCCESS;
+}
+
+static int sim_get_instcnt(uint32_t *inst_cnt_us)
+{
+    *inst_cnt_us = micros();
+    return LGW_HAL_SUCCESS;
+}
+
+static void startForwarder()
+{
+    struct pkt_fwd_conf_s conf;
+    uint8_t mac[6];
+
+    if (gatewayEUI == 0) {
+        ETH.macAddress(mac);
+        gatewayEUI = ((uint64_t)mac[0] << 56) | ((uint64_t)mac[1] << 48) | ((uint64_t)mac[2] << 40) | 0xFFFEULL << 24 |
+                     ((uint64_t)mac[3] << 16) | ((uint64_t)mac[4] << 8) | mac[5];
+    }
+
+    pkt_fwd_default_conf(&conf);
+    conf.gateway_id = gatewayEUI;
+    conf.server = serverAddress;
+    conf.port_up = serverPort;
+    conf.port_down = serverPort;
+    conf.push_flush_ms = PUSH_FLUSH_MS;
+    // Replace with lgw_receive, lgw_send and lgw_get_instcnt when the full SX1302 HAL is linked in
+    conf.receive = sim_receive;
+    conf.send = sim_send;
+    conf.get_instcnt = sim_get_instcnt;
+
+    if (pkt_fwd_begin(&conf) != PKT_FWD_SUCCESS) {
+        Serial.println("Packet forwarder start failed!");
+        return;
+    }
+    sim_next_us = micros();
+    fwd_started = true;
+    Serial.printf("Packet forwarder started, gateway EUI %08X%08X\n", (uint32_t)(gatewayEUI >> 32), (uint32_t)gatewayEUI);
+}
+
+static void serviceForwarder()
+{
+    static uint32_t last_stats = 0;
+
+    if (eth_connected && !fwd_started) {
+        startForwarder();
+    } else if (!eth_connected && fwd_started) {
+        pkt_fwd_end();
+        fwd_started = false;
+    }
+    if (!fwd_started) {
+        return;
+    }
+    pkt_fwd_loop();
+    if (millis() - last_stats > STATS_INTERVAL_MS) {
+        last_stats = millis();
+        pkt_fwd_print_stats(Serial);
+    }
+}
+
 
 // This custom version of delay() ensures that the gps object
-// is being "fed".
+// is being "fed" and the packet forwarder keeps running.
 static void smartDelay(unsigned long ms)
 {
     unsigned long start = millis();
@@ -41,6 +200,7 @@ static void smartDelay(unsigned long ms)
             // Serial.write(GPSSerial.read());
             gps.encode(GPSSerial.read());
         }
+        serviceForwarder();
     } while (millis() - start < ms);
 }
 
@@ -119,6 +279,14 @@ void setup()
     }
     test_loragw_reg();
 
+    WiFi.onEvent(WiFiEvent);
+
+    if (!ETH.begin(ETH_PHY_W5500, 1, ETH_CS_PIN, ETH_INT_PIN, ETH_RST_PIN,
+                   SPI3_HOST,
+                   ETH_SCLK_PIN, ETH_MISO_PIN, ETH_MOSI_PIN)) {
+        Serial.println("ETH start Failed!");
+    }
+
     Serial.println("-----------------");
     Serial.println("GPS Start ......");
 }
@@ -164,6 +332,9 @@ void test_loragw_reg()
 
     uint8_t data = 0;
 
+    /* The test must see the chip, not the register shadow */
+    lgw_reg_cache_enable(false);
+
     /* The following registers cannot be tested this way */
     memset(reg_ignored, 0, sizeof reg_ignored);
     reg_ignored[SX1302_REG_COMMON_CTRL0_CLK32_RIF_CTRL] = true; /* all test fails if we set this one to 1 */
@@ -238,5 +409,8 @@ void test_loragw_reg()
     Serial.printf("------------------\n");
     Serial.printf(" TEST#2 %s\n", (error_found == false) ? "PASSED" : "FAILED");
     Serial.printf("------------------\n\n");
+
+    /* The register values changed, start the cache again from the chip */
+    lgw_reg_cache_enable(true);
     delay(2000);
 }
\ No newline at end of file
@@ -22,6 +22,7 @@ License: Revised BSD License, see LICENSE.TXT file include in the project
 #include <stdint.h>     /* C99 types */
 #include <stdbool.h>    /* bool type */
 #include <stdio.h>      /* printf fprintf */
+#include <string.h>     /* memset */
 
 #include "loragw_spi.h"
 #include "loragw_reg.h"
@@ -29,6 +30,9 @@ License: Revised BSD License, see LICENSE.TXT file include in the project
 /* -------------------------------------------------------------------------- */
 /* --- PRIVATE MACROS ------------------------------------------------------- */
 
+#define BIT_GET(map, i)     (((map)[(i) >> 3] >> ((i) & 7)) & 1)
+#define BIT_SET(map, i)     ((map)[(i) >> 3] |= (uint8_t)(1 << ((i) & 7)))
+#define BIT_CLR(map, i)     ((map)[(i) >> 3] &= (uint8_t)~(1 << ((i) & 7)))
 
 /* -------------------------------------------------------------------------- */
 /* --- PRIVATE CONSTANTS ---------------------------------------------------- */
@@ -50,6 +54,14 @@ License: Revised BSD License, see LICENSE.TXT file include in the project
 #define SX1302_REG_TIMESTAMP_BASE_ADDR 0x6100
 #define SX1302_REG_OTP_BASE_ADDR 0x6180
 
+/* address window covered by the register shadow cache */
+#define REG_CACHE_BASE          SX1302_REG_TX_TOP_A_BASE_ADDR
+#define REG_CACHE_SIZE          (SX1302_REG_OTP_BASE_ADDR + 0x80 - REG_CACHE_BASE)
+
+#define REG_CACHE_LINE          32      /* cache misses read the cacheable neighbours within this aligned window */
+#define REG_COALESCE_GAP        3       /* clean bytes bridged between dirty ones, cheaper than a new SPI header */
+#define REG_BURST_MAX           1024    /* largest SPI burst */
+
 const struct lgw_reg_s loregs[LGW_TOTALREGS+1] = {
     {0,SX1302_REG_COMMON_BASE_ADDR+0,0,0,2,0,1,0}, // COMMON_PAGE_PAGE
     {0,SX1302_REG_COMMON_BASE_ADDR+1,4,0,1,0,1,0}, // COMMON_CTRL0_CLK32_RIF_CTRL
@@ -1098,9 +1110,40 @@ const struct lgw_reg_s loregs[LGW_TOTALREGS+1] = {
     {0,0,0,0,0,0,0,0}
 };
 
+/* Address ranges never shadowed, whatever the flags of their registers say:
+   the AGC and ARB MCU firmwares change them behind the host (RF_EN, PA_GAIN,
+   mailboxes), or the hardware does (TX triggers, capture start, timestamp,
+   OTP access sequence) */
+static const struct {
+    uint16_t addr;
+    uint16_t size;
+} reg_uncached[] = {
+    {SX1302_REG_TX_TOP_A_BASE_ADDR + 0, 1},     /* TX_TRIG, cleared by the TX state machine */
+    {SX1302_REG_TX_TOP_A_BASE_ADDR + 7, 1},     /* TX_CTRL */
+    {SX1302_REG_TX_TOP_B_BASE_ADDR + 0, 1},
+    {SX1302_REG_TX_TOP_B_BASE_ADDR + 7, 1},
+    {SX1302_REG_AGC_MCU_BASE_ADDR, SX1302_REG_CLK_CTRL_BASE_ADDR - SX1302_REG_AGC_MCU_BASE_ADDR},
+    {SX1302_REG_CAPTURE_RAM_BASE_ADDR, SX1302_REG_ARB_MCU_BASE_ADDR - SX1302_REG_CAPTURE_RAM_BASE_ADDR},
+    {SX1302_REG_ARB_MCU_BASE_ADDR, SX1302_REG_TIMESTAMP_BASE_ADDR - SX1302_REG_ARB_MCU_BASE_ADDR},
+    {SX1302_REG_TIMESTAMP_BASE_ADDR, SX1302_REG_OTP_BASE_ADDR - SX1302_REG_TIMESTAMP_BASE_ADDR},
+    {SX1302_REG_OTP_BASE_ADDR, 0x80},
+};
+
 /* -------------------------------------------------------------------------- */
 /* --- PRIVATE VARIABLES ---------------------------------------------------- */
 
+static uint8_t reg_shadow[REG_CACHE_SIZE];          /* last known content of the register file */
+static uint8_t reg_defined[REG_CACHE_SIZE / 8];     /* byte holds at least one register */
+static uint8_t reg_cacheable[REG_CACHE_SIZE / 8];   /* byte only holds registers that read back what was written */
+static uint8_t reg_valid[REG_CACHE_SIZE / 8];       /* shadow byte is up to date */
+static uint8_t reg_dirty[REG_CACHE_SIZE / 8];       /* shadow byte must be written to the chip */
+static uint16_t reg_dirty_min = REG_CACHE_SIZE;     /* offsets bounding the dirty bytes */
+static uint16_t reg_dirty_max = 0;
+static bool reg_cache_on = true;
+static bool reg_cache_built = false;
+static bool reg_batch = false;
+static struct lgw_reg_stats_s reg_stats;
+
 /* -------------------------------------------------------------------------- */
 /* --- INTERNAL SHARED VARIABLES -------------------------------------------- */
 
@@ -1109,6 +1152,281 @@ void *lgw_spi_target = NULL; /*! generic pointer to the SPI device */
 /* -------------------------------------------------------------------------- */
 /* --- PRIVATE FUNCTIONS ---------------------------------------------------- */
 
+/* SPI accessors, counting the transactions */
+
+static int spi_w(void *spi_target, uint8_t spi_mux_target, uint16_t address, uint8_t data) {
+    reg_stats.spi_write += 1;
+    return lgw_spi_w(spi_target, spi_mux_target, address, data);
+}
+
+static int spi_r(void *spi_target, uint8_t spi_mux_target, uint16_t address, uint8_t *data) {
+    reg_stats.spi_read += 1;
+    return lgw_spi_r(spi_target, spi_mux_target, address, data);
+}
+
+static int spi_wb(void *spi_target, uint8_t spi_mux_target, uint16_t address, const uint8_t *data, uint16_t size) {
+    reg_stats.spi_write += 1;
+    return lgw_spi_wb(spi_target, spi_mux_target, address, data, size);
+}
+
+static int spi_rb(void *spi_target, uint8_t spi_mux_target, uint16_t address, uint8_t *data, uint16_t size) {
+    reg_stats.spi_read += 1;
+    return lgw_spi_rb(spi_target, spi_mux_target, address, data, size);
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* Mark the bytes of the register file that can be shadowed */
+static void reg_cache_build(void) {
+    int i, k, n, off;
+
+    memset(reg_defined, 0, sizeof reg_defined);
+    memset(reg_cacheable, 0, sizeof reg_cacheable);
+    for (i = 0; i < LGW_TOTALREGS; i++) {
+        n = (loregs[i].offs + loregs[i].leng + 7) / 8;
+        for (k = 0; k < n; k++) {
+            off = loregs[i].addr + k - REG_CACHE_BASE;
+            if ((off >= 0) && (off < REG_CACHE_SIZE)) {
+                BIT_SET(reg_defined, off);
+                BIT_SET(reg_cacheable, off);
+            }
+        }
+    }
+    /* a single volatile register makes the whole byte volatile */
+    for (i = 0; i < LGW_TOTALREGS; i++) {
+        if ((loregs[i].rdon == 0) && (loregs[i].chck == 1)) {
+            continue;
+        }
+        n = (loregs[i].offs + loregs[i].leng + 7) / 8;
+        for (k = 0; k < n; k++) {
+            off = loregs[i].addr + k - REG_CACHE_BASE;
+            if ((off >= 0) && (off < REG_CACHE_SIZE)) {
+                BIT_CLR(reg_cacheable, off);
+            }
+        }
+    }
+    for (i = 0; i < (int)(sizeof reg_uncached / sizeof reg_uncached[0]); i++) {
+        for (k = 0; k < reg_uncached[i].size; k++) {
+            BIT_CLR(reg_cacheable, reg_uncached[i].addr + k - REG_CACHE_BASE);
+        }
+    }
+    reg_cache_built = true;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* Check that every byte of a register is shadowed, returns its cache offset or -1 */
+static int reg_cache_offset(struct lgw_reg_s r, int size_byte) {
+    int off = (int)r.addr - REG_CACHE_BASE;
+    int k;
+
+    if ((reg_cache_on == false) || (off < 0) || ((off + size_byte) > REG_CACHE_SIZE)) {
+        return -1;
+    }
+    for (k = 0; k < size_byte; k++) {
+        if (BIT_GET(reg_cacheable, off + k) == 0) {
+            return -1;
+        }
+    }
+    return off;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* Read a cache miss together with its cacheable neighbours in a single burst */
+static int reg_cache_fill(int off, int size_byte) {
+    uint8_t buf[2 * REG_CACHE_LINE];
+    int first = off & ~(REG_CACHE_LINE - 1);
+    int last = (off + size_byte - 1) | (REG_CACHE_LINE - 1);
+    int start = off;
+    int end = off + size_byte - 1;
+    int i, spi_stat;
+
+    if (last >= REG_CACHE_SIZE) {
+        last = REG_CACHE_SIZE - 1;
+    }
+    /* grow over bytes that are shadowed or hold no register, stop at volatile ones */
+    while ((start > first) && ((BIT_GET(reg_cacheable, start - 1) == 1) || (BIT_GET(reg_defined, start - 1) == 0))) {
+        start--;
+    }
+    while ((end < last) && ((BIT_GET(reg_cacheable, end + 1) == 1) || (BIT_GET(reg_defined, end + 1) == 0))) {
+        end++;
+    }
+    /* no point reading holes at the edges */
+    while (BIT_GET(reg_defined, start) == 0) {
+        start++;
+    }
+    while (BIT_GET(reg_defined, end) == 0) {
+        end--;
+    }
+
+    spi_stat = spi_rb(lgw_spi_target, LGW_SPI_MUX_TARGET_SX1302, REG_CACHE_BASE + start, buf, end - start + 1);
+    if (spi_stat != LGW_SPI_SUCCESS) {
+        return spi_stat;
+    }
+    for (i = start; i <= end; i++) {
+        /* bytes already valid may hold writes not sent yet */
+        if ((BIT_GET(reg_cacheable, i) == 1) && (BIT_GET(reg_valid, i) == 0)) {
+            reg_shadow[i] = buf[i - start];
+            BIT_SET(reg_valid, i);
+        }
+    }
+    return LGW_SPI_SUCCESS;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static int reg_cache_load(int off, int size_byte) {
+    int k;
+
+    for (k = 0; k < size_byte; k++) {
+        if (BIT_GET(reg_valid, off + k) == 0) {
+            reg_stats.cache_miss += 1;
+            return reg_cache_fill(off, size_byte);
+        }
+    }
+    reg_stats.cache_hit += 1;
+    return LGW_SPI_SUCCESS;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* Send the writes held back, contiguous dirty bytes go in one burst */
+static int reg_cache_flush(void) {
+    int spi_stat = LGW_SPI_SUCCESS;
+    int i, k, start, end;
+
+    i = reg_dirty_min;
+    while (i <= reg_dirty_max) {
+        if (BIT_GET(reg_dirty, i) == 0) {
+            i++;
+            continue;
+        }
+        start = i;
+        end = i;
+        for (i = start + 1; (i <= reg_dirty_max) && ((i - start) < REG_BURST_MAX); i++) {
+            if (BIT_GET(reg_dirty, i) == 1) {
+                end = i;
+            } else if ((BIT_GET(reg_cacheable, i) == 0) || (BIT_GET(reg_valid, i) == 0) || ((i - end) > REG_COALESCE_GAP)) {
+                /* only bridge short runs of bytes we know the value of */
+                break;
+            }
+        }
+        spi_stat += spi_wb(lgw_spi_target, LGW_SPI_MUX_TARGET_SX1302, REG_CACHE_BASE + start, &reg_shadow[start], end - start + 1);
+        for (k = start; k <= end; k++) {
+            BIT_CLR(reg_dirty, k);
+        }
+        i = end + 1;
+    }
+    reg_dirty_min = REG_CACHE_SIZE;
+    reg_dirty_max = 0;
+
+    return (spi_stat == LGW_SPI_SUCCESS) ? LGW_REG_SUCCESS : LGW_REG_ERROR;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* Update the shadow after the chip was written directly */
+static void reg_cache_update(uint16_t addr, const uint8_t *data, uint16_t size) {
+    int i, off;
+
+    for (i = 0; i < size; i++) {
+        off = (int)addr + i - REG_CACHE_BASE;
+        if ((off >= 0) && (off < REG_CACHE_SIZE) && (BIT_GET(reg_cacheable, off) == 1)) {
+            reg_shadow[off] = data[i];
+            BIT_SET(reg_valid, off);
+        }
+    }
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static int reg_w_cached(int off, struct lgw_reg_s r, int32_t reg_value) {
+    uint8_t buf[4];
+    uint8_t mask;
+    int i, size_byte;
+    bool changed = false;
+
+    if ((r.offs + r.leng) <= 8) {
+        size_byte = 1;
+        if (r.leng == 8) {
+            buf[0] = (uint8_t)reg_value;
+        } else {
+            /* read-modify-write on the shadow */
+            if (reg_cache_load(off, 1) != LGW_SPI_SUCCESS) {
+                return LGW_REG_ERROR;
+            }
+            mask = ((1 << r.leng) - 1) << r.offs;
+            buf[0] = (~mask & reg_shadow[off]) | (mask & (((uint8_t)reg_value) << r.offs));
+        }
+    } else {
+        size_byte = (r.leng + 7) / 8;
+        for (i = 0; i < size_byte; ++i) {
+            buf[i] = (uint8_t)(0x000000FF & reg_value);
+            reg_value = (reg_value >> 8);
+        }
+    }
+
+    for (i = 0; i < size_byte; i++) {
+        if ((BIT_GET(reg_valid, off + i) == 0) || (reg_shadow[off + i] != buf[i])) {
+            changed = true;
+        }
+        reg_shadow[off + i] = buf[i];
+        BIT_SET(reg_valid, off + i);
+    }
+    if (changed == false) {
+        reg_stats.write_skipped += 1;
+        return LGW_REG_SUCCESS;
+    }
+
+    if (reg_batch == true) {
+        for (i = 0; i < size_byte; i++) {
+            BIT_SET(reg_dirty, off + i);
+        }
+        if (off < reg_dirty_min) {
+            reg_dirty_min = off;
+        }
+        if ((off + size_byte - 1) > reg_dirty_max) {
+            reg_dirty_max = off + size_byte - 1;
+        }
+        reg_stats.write_deferred += 1;
+        return LGW_REG_SUCCESS;
+    }
+
+    if (size_byte == 1) {
+        return spi_w(lgw_spi_target, LGW_SPI_MUX_TARGET_SX1302, r.addr, buf[0]);
+    }
+    return spi_wb(lgw_spi_target, LGW_SPI_MUX_TARGET_SX1302, r.addr, buf, size_byte);
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static int reg_r_cached(int off, struct lgw_reg_s r, int32_t *reg_value) {
+    int i, size_byte;
+    uint32_t u = 0;
+
+    size_byte = ((r.offs + r.leng) <= 8) ? 1 : (r.leng + 7) / 8;
+    if (reg_cache_load(off, size_byte) != LGW_SPI_SUCCESS) {
+        return LGW_REG_ERROR;
+    }
+
+    for (i = (size_byte - 1); i >= 0; --i) {
+        u = (uint32_t)reg_shadow[off + i] + (u << 8);
+    }
+    u = u >> r.offs;
+    if (r.sign == true) {
+        u = u << (32 - r.leng); /* left-align the data */
+        *reg_value = (int32_t)u >> (32 - r.leng); /* right-align the data with sign extension */
+    } else if (r.leng < 32) {
+        *reg_value = (int32_t)(u & ((1UL << r.leng) - 1));
+    } else {
+        *reg_value = (int32_t)u;
+    }
+    return LGW_REG_SUCCESS;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
 int reg_w_align32(void *spi_target, uint8_t spi_mux_target, struct lgw_reg_s r, int32_t reg_value) {
     int spi_stat = LGW_REG_SUCCESS;
     int i, size_byte;
@@ -1116,14 +1434,14 @@ int reg_w_align32(void *spi_target, uint8_t spi_mux_target, struct lgw_reg_s r,
 
     if ((r.leng == 8) && (r.offs == 0)) {
         /* direct write */
-        spi_stat += lgw_spi_w(spi_target, spi_mux_target, r.addr, (uint8_t)reg_value);
+        spi_stat += spi_w(spi_target, spi_mux_target, r.addr, (uint8_t)reg_value);
     } else if ((r.offs + r.leng) <= 8) {
         /* single-byte read-modify-write, offs:[0-7], leng:[1-7] */
-        spi_stat += lgw_spi_r(spi_target, spi_mux_target, r.addr, &buf[0]);
+        spi_stat += spi_r(spi_target, spi_mux_target, r.addr, &buf[0]);
         buf[1] = ((1 << r.leng) - 1) << r.offs; /* bit mask */
         buf[2] = ((uint8_t)reg_value) << r.offs; /* new data offsetted */
         buf[3] = (~buf[1] & buf[0]) | (buf[1] & buf[2]); /* mixing old & new data */
-        spi_stat += lgw_spi_w(spi_target, spi_mux_target, r.addr, buf[3]);
+        spi_stat += spi_w(spi_target, spi_mux_target, r.addr, buf[3]);
     } else if ((r.offs == 0) && (r.leng > 0) && (r.leng <= 32)) {
         /* multi-byte direct write routine */
         size_byte = (r.leng + 7) / 8; /* add a byte if it's not an exact multiple of 8 */
@@ -1133,7 +1451,7 @@ int reg_w_align32(void *spi_target, uint8_t spi_mux_target, struct lgw_reg_s r,
             buf[i] = (uint8_t)(0x000000FF & reg_value);
             reg_value = (reg_value >> 8);
         }
-        spi_stat += lgw_spi_wb(spi_target, spi_mux_target, r.addr, buf, size_byte); /* write the register in one burst */
+        spi_stat += spi_wb(spi_target, spi_mux_target, r.addr, buf, size_byte); /* write the register in one burst */
     } else {
         /* register spanning multiple memory bytes but with an offset */
         DEBUG_MSG("ERROR: REGISTER SIZE AND OFFSET ARE NOT SUPPORTED\n");
@@ -1154,7 +1472,7 @@ int reg_r_align32(void *spi_target, uint8_t spi_mux_target, struct lgw_reg_s r,
 
     if ((r.offs + r.leng) <= 8) {
         /* read one byte, then shift and mask bits to get reg value with sign extension if needed */
-        spi_stat += lgw_spi_r(spi_target, spi_mux_target, r.addr, &bufu[0]);
+        spi_stat += spi_r(spi_target, spi_mux_target, r.addr, &bufu[0]);
         bufu[1] = bufu[0] << (8 - r.leng - r.offs); /* left-align the data */
         if (r.sign == true) {
             bufs[2] = bufs[1] >> (8 - r.leng); /* right align the data with sign extension (ARITHMETIC right shift) */
@@ -1165,7 +1483,7 @@ int reg_r_align32(void *spi_target, uint8_t spi_mux_target, struct lgw_reg_s r,
         }
     } else if ((r.offs == 0) && (r.leng > 0) && (r.leng <= 32)) {
         size_byte = (r.leng + 7) / 8; /* add a byte if it's not an exact multiple of 8 */
-        spi_stat += lgw_spi_rb(spi_target, spi_mux_target, r.addr, bufu, size_byte);
+        spi_stat += spi_rb(spi_target, spi_mux_target, r.addr, bufu, size_byte);
         u = 0;
         for (i=(size_byte-1); i>=0; --i) {
             u = (uint32_t)bufu[i] + (u << 8); /* transform a 4-byte array into a 32 bit word */
@@ -1212,7 +1530,7 @@ int lgw_connect(const char * spidev_path) {
     }
 
     /* check SX1302 version */
-    spi_stat = lgw_spi_r(lgw_spi_target, LGW_SPI_MUX_TARGET_SX1302, loregs[SX1302_REG_COMMON_VERSION_VERSION].addr, &u);
+    spi_stat = spi_r(lgw_spi_target, LGW_SPI_MUX_TARGET_SX1302, loregs[SX1302_REG_COMMON_VERSION_VERSION].addr, &u);
     if (spi_stat != LGW_SPI_SUCCESS) {
         DEBUG_MSG("ERROR READING CHIP VERSION REGISTER\n");
         return LGW_REG_ERROR;
@@ -1225,6 +1543,12 @@ int lgw_connect(const char * spidev_path) {
 
     DEBUG_PRINTF("Note: chip version is 0x%02X (v%u.%u)\n", u, (u >> 4) & 0x0F, u & 0x0F) ;
 
+    /* the chip was reset, start with an empty shadow */
+    if (reg_cache_built == false) {
+        reg_cache_build();
+    }
+    lgw_reg_cache_invalidate();
+
     DEBUG_MSG("Note: success connecting the concentrator\n");
 
     return LGW_REG_SUCCESS;
@@ -1235,6 +1559,8 @@ int lgw_connect(const char * spidev_path) {
 /* Concentrator disconnect */
 int lgw_disconnect(void) {
     if (lgw_spi_target != NULL) {
+        reg_cache_flush();
+        lgw_reg_cache_invalidate();
         lgw_spi_close(lgw_spi_target);
         lgw_spi_target = NULL;
         DEBUG_MSG("Note: success disconnecting the concentrator\n");
@@ -1251,6 +1577,7 @@ int lgw_disconnect(void) {
 int lgw_reg_w(uint16_t register_id, int32_t reg_value) {
     int spi_stat = LGW_SPI_SUCCESS;
     struct lgw_reg_s r;
+    int off;
 
     /* check input parameters */
     if (register_id >= LGW_TOTALREGS) {
@@ -1273,7 +1600,14 @@ int lgw_reg_w(uint16_t register_id, int32_t reg_value) {
         return LGW_REG_ERROR;
     }
 
-    spi_stat += reg_w_align32(lgw_spi_target, LGW_SPI_MUX_TARGET_SX1302, r, reg_value);
+    off = reg_cache_offset(r, ((r.offs + r.leng) <= 8) ? 1 : (r.leng + 7) / 8);
+    if ((off >= 0) && (((r.offs + r.leng) <= 8) || (r.offs == 0))) {
+        spi_stat += reg_w_cached(off, r, reg_value);
+    } else {
+        /* keep the order with the writes held back */
+        spi_stat += reg_cache_flush();
+        spi_stat += reg_w_align32(lgw_spi_target, LGW_SPI_MUX_TARGET_SX1302, r, reg_value);
+    }
 
     if (spi_stat != LGW_SPI_SUCCESS) {
         DEBUG_MSG("ERROR: SPI ERROR DURING REGISTER WRITE\n");
@@ -1289,6 +1623,7 @@ int lgw_reg_w(uint16_t register_id, int32_t reg_value) {
 int lgw_reg_r(uint16_t register_id, int32_t *reg_value) {
     int spi_stat = LGW_SPI_SUCCESS;
     struct lgw_reg_s r;
+    int off;
 
     /* check input parameters */
     CHECK_NULL(reg_value);
@@ -1306,7 +1641,13 @@ int lgw_reg_r(uint16_t register_id, int32_t *reg_value) {
     /* get register struct from the struct array */
     r = loregs[register_id];
 
-    spi_stat += reg_r_align32(lgw_spi_target, LGW_SPI_MUX_TARGET_SX1302, r, reg_value);
+    off = reg_cache_offset(r, ((r.offs + r.leng) <= 8) ? 1 : (r.leng + 7) / 8);
+    if ((off >= 0) && (((r.offs + r.leng) <= 8) || (r.offs == 0))) {
+        spi_stat += reg_r_cached(off, r, reg_value);
+    } else {
+        spi_stat += reg_cache_flush();
+        spi_stat += reg_r_align32(lgw_spi_target, LGW_SPI_MUX_TARGET_SX1302, r, reg_value);
+    }
 
     if (spi_stat != LGW_SPI_SUCCESS) {
         DEBUG_MSG("ERROR: SPI ERROR DURING REGISTER WRITE\n");
@@ -1350,7 +1691,9 @@ int lgw_reg_wb(uint16_t register_id, uint8_t *data, uint16_t size) {
     }
 
     /* do the burst write */
-    spi_stat += lgw_spi_wb(lgw_spi_target, LGW_SPI_MUX_TARGET_SX1302, r.addr, data, size);
+    spi_stat += reg_cache_flush();
+    spi_stat += spi_wb(lgw_spi_target, LGW_SPI_MUX_TARGET_SX1302, r.addr, data, size);
+    reg_cache_update(r.addr, data, size);
 
     if (spi_stat != LGW_SPI_SUCCESS) {
         DEBUG_MSG("ERROR: SPI ERROR DURING REGISTER BURST WRITE\n");
@@ -1388,7 +1731,8 @@ int lgw_reg_rb(uint16_t register_id, uint8_t *data, uint16_t size) {
     r = loregs[register_id];
 
     /* do the burst read */
-    spi_stat += lgw_spi_rb(lgw_spi_target, LGW_SPI_MUX_TARGET_SX1302, r.addr, data, size);
+    spi_stat += reg_cache_flush();
+    spi_stat += spi_rb(lgw_spi_target, LGW_SPI_MUX_TARGET_SX1302, r.addr, data, size);
 
     if (spi_stat != LGW_SPI_SUCCESS) {
         DEBUG_MSG("ERROR: SPI ERROR DURING REGISTER BURST READ\n");
@@ -1421,13 +1765,16 @@ int lgw_mem_wb(uint16_t mem_addr, const uint8_t *data, uint16_t size) {
         return LGW_REG_ERROR;
     }
 
+    spi_stat += reg_cache_flush();
+
     /* write memory by chunks */
     while (sz_todo > 0) {
         /* full or partial chunk ? */
         chunk_size = (sz_todo > CHUNK_SIZE_MAX) ? CHUNK_SIZE_MAX : sz_todo;
 
         /* do the burst write */
-        spi_stat += lgw_spi_wb(lgw_spi_target, LGW_SPI_MUX_TARGET_SX1302, addr, &data[chunk_cnt * CHUNK_SIZE_MAX], chunk_size);
+        spi_stat += spi_wb(lgw_spi_target, LGW_SPI_MUX_TARGET_SX1302, addr, &data[chunk_cnt * CHUNK_SIZE_MAX], chunk_size);
+        reg_cache_update(addr, &data[chunk_cnt * CHUNK_SIZE_MAX], chunk_size);
 
         /* prepare for next write */
         addr += chunk_size;
@@ -1466,13 +1813,15 @@ int lgw_mem_rb(uint16_t mem_addr, uint8_t *data, uint16_t size, bool fifo_mode)
         return LGW_REG_ERROR;
     }
 
+    spi_stat += reg_cache_flush();
+
     /* read memory by chunks */
     while (sz_todo > 0) {
         /* full or partial chunk ? */
         chunk_size = (sz_todo > CHUNK_SIZE_MAX) ? CHUNK_SIZE_MAX : sz_todo;
 
         /* do the burst read */
-        spi_stat += lgw_spi_rb(lgw_spi_target, LGW_SPI_MUX_TARGET_SX1302, addr, &data[chunk_cnt * CHUNK_SIZE_MAX], chunk_size);
+        spi_stat += spi_rb(lgw_spi_target, LGW_SPI_MUX_TARGET_SX1302, addr, &data[chunk_cnt * CHUNK_SIZE_MAX], chunk_size);
 
         /* do not increment the address when the target memory is in FIFO mode (auto-increment) */
         if (fifo_mode == false) {
@@ -1492,4 +1841,66 @@ int lgw_mem_rb(uint16_t mem_addr, uint8_t *data, uint16_t size, bool fifo_mode)
     }
 }
 
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+int lgw_reg_cache_enable(bool enable) {
+    int x = LGW_REG_SUCCESS;
+
+    if ((enable == false) && (lgw_spi_target != NULL)) {
+        x = reg_cache_flush();
+    }
+    lgw_reg_cache_invalidate();
+    reg_cache_on = enable;
+    return x;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+void lgw_reg_cache_invalidate(void) {
+    memset(reg_valid, 0, sizeof reg_valid);
+    memset(reg_dirty, 0, sizeof reg_dirty);
+    reg_dirty_min = REG_CACHE_SIZE;
+    reg_dirty_max = 0;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+int lgw_reg_batch_begin(void) {
+    if (lgw_spi_target == NULL) {
+        DEBUG_MSG("ERROR: CONCENTRATOR UNCONNECTED\n");
+        return LGW_REG_ERROR;
+    }
+    reg_batch = true;
+    return LGW_REG_SUCCESS;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+int lgw_reg_batch_end(void) {
+    reg_batch = false;
+    if (lgw_spi_target == NULL) {
+        DEBUG_MSG("ERROR: CONCENTRATOR UNCONNECTED\n");
+        return LGW_REG_ERROR;
+    }
+    if (reg_cache_flush() != LGW_REG_SUCCESS) {
+        DEBUG_MSG("ERROR: SPI ERROR DURING REGISTER BATCH WRITE\n");
+        return LGW_REG_ERROR;
+    }
+    return LGW_REG_SUCCESS;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+void lgw_reg_get_stats(struct lgw_reg_stats_s *stats) {
+    if (stats != NULL) {
+        *stats = reg_stats;
+    }
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+void lgw_reg_reset_stats(void) {
+    memset(&reg_stats, 0, sizeof reg_stats);
+}
+
 /* --- EOF ------------------------------------------------------------------ */
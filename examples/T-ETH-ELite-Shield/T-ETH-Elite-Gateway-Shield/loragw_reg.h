@@ -1441,6 +1441,22 @@ int reg_r_align32(void *spi_target, uint8_t spi_mux_target, struct lgw_reg_s r,
     #define CHECK_NULL(a)               if(a==NULL){return LGW_REG_ERROR;}
 #endif
 
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC TYPES --------------------------------------------------------- */
+
+/**
+@struct lgw_reg_stats_s
+@brief Counters of the register access layer
+*/
+struct lgw_reg_stats_s {
+    uint32_t spi_read;          /*!> SPI read transactions */
+    uint32_t spi_write;         /*!> SPI write transactions */
+    uint32_t cache_hit;         /*!> register accesses served by the shadow cache */
+    uint32_t cache_miss;        /*!> register accesses that needed a read from the chip */
+    uint32_t write_deferred;    /*!> register writes held back by a batch */
+    uint32_t write_skipped;     /*!> register writes dropped because the value did not change */
+};
+
 /* -------------------------------------------------------------------------- */
 /* --- PUBLIC FUNCTIONS PROTOTYPES ------------------------------------------ */
 #ifdef __cplusplus
@@ -1507,6 +1523,52 @@ TODO
 */
 int lgw_mem_rb(uint16_t mem_addr, uint8_t *data, uint16_t size, bool fifo_mode);
 
+/**
+@brief Enable or disable the register shadow cache (enabled by default)
+Registers that read back what was written (not read-only, not pulse/w0clr/w1clr)
+are kept in a shadow: reads and read-modify-writes are served from it and
+cache misses fetch the neighbouring registers in the same SPI burst.
+The AGC_MCU, ARB_MCU, CAPTURE_RAM, TIMESTAMP and OTP blocks and the TX_TRIG and
+TX_CTRL registers always go to the chip, the MCUs or the hardware change them.
+Disabling flushes pending writes and empties the cache.
+@param enable true to use the cache
+@return status of register operation (LGW_REG_SUCCESS/LGW_REG_ERROR)
+*/
+int lgw_reg_cache_enable(bool enable);
+
+/**
+@brief Drop the content of the register shadow cache, including pending writes
+Must be called after the concentrator was reset.
+*/
+void lgw_reg_cache_invalidate(void);
+
+/**
+@brief Start a batch of register writes
+Until lgw_reg_batch_end, writes to cached registers only update the shadow.
+Any other access to the chip flushes them first, so the order between
+configuration and pulse/status registers is kept.
+@return status of register operation (LGW_REG_SUCCESS/LGW_REG_ERROR)
+*/
+int lgw_reg_batch_begin(void);
+
+/**
+@brief End a batch of register writes
+Writes held back are sent in bursts of contiguous addresses.
+@return status of register operation (LGW_REG_SUCCESS/LGW_REG_ERROR)
+*/
+int lgw_reg_batch_end(void);
+
+/**
+@brief Get the counters of the register access layer
+@param stats pointer to receive the counters
+*/
+void lgw_reg_get_stats(struct lgw_reg_stats_s *stats);
+
+/**
+@brief Reset the counters of the register access layer
+*/
+void lgw_reg_reset_stats(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+# Minimal network server for the Semtech UDP protocol (GWMP v2).
+# Acknowledges PUSH_DATA / PULL_DATA, prints the uplink rate once per second
+# and can answer uplinks with a downlink in the RX1 window.
+#
+# usage: python3 mock_network_server.py [--port 1700] [--downlink-every N]
+
+import argparse
+import base64
+import json
+import socket
+import time
+
+PUSH_DATA = 0
+PUSH_ACK = 1
+PULL_DATA = 2
+PULL_RESP = 3
+PULL_ACK = 4
+TX_ACK = 5
+
+parser = argparse.ArgumentParser()
+parser.add_argument("--port", type=int, default=1700)
+parser.add_argument("--downlink-every", type=int, default=0,
+                    help="send a downlink for every N-th uplink, 0 to disable")
+args = parser.parse_args()
+
+s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+s.bind(("0.0.0.0", args.port))
+s.settimeout(0.2)
+print("listening on UDP port %d" % args.port)
+
+pull_addr = None
+total_pkts = 0
+window_pkts = 0
+window_dgrams = 0
+window_start = time.time()
+tx_results = {}
+
+while True:
+    try:
+        data, addr = s.recvfrom(65535)
+    except socket.timeout:
+        data = None
+
+    if data and len(data) >= 12 and data[0] == 2:
+        token = data[1:3]
+        ident = data[3]
+        eui = data[4:12].hex().upper()
+
+        if ident == PUSH_DATA:
+            s.sendto(bytes([2]) + token + bytes([PUSH_ACK]), addr)
+            body = json.loads(data[12:].decode())
+            if "stat" in body:
+                print("[%s] stat %s" % (eui, body["stat"]))
+            rxpk = body.get("rxpk", [])
+            window_dgrams += 1
+            window_pkts += len(rxpk)
+            for pkt in rxpk:
+                total_pkts += 1
+                if args.downlink_every and pull_addr and total_pkts % args.downlink_every == 0:
+                    txpk = {
+                        "imme": False,
+                        "tmst": (pkt["tmst"] + 1000000) & 0xFFFFFFFF,
+                        "freq": pkt["freq"],
+                        "rfch": 0,
+                        "powe": 14,
+                        "modu": pkt["modu"],
+                        "datr": pkt["datr"],
+                        "codr": pkt.get("codr", "4/5"),
+                        "ipol": True,
+                        "size": 4,
+                        "data": base64.b64encode(total_pkts.to_bytes(4, "little")).decode(),
+                    }
+                    s.sendto(bytes([2, 0, 0, PULL_RESP]) + json.dumps({"txpk": txpk}).encode(), pull_addr)
+
+        elif ident == PULL_DATA:
+            pull_addr = addr
+            s.sendto(bytes([2]) + token + bytes([PULL_ACK]), addr)
+
+        elif ident == TX_ACK:
+            error = "NONE"
+            if len(data) > 12:
+                error = json.loads(data[12:].decode())["txpk_ack"].get("error", "NONE")
+            tx_results[error] = tx_results.get(error, 0) + 1
+
+    now = time.time()
+    if now - window_start >= 1.0:
+        if window_dgrams:
+            print("%.1f pkt/s, %d datagrams, %.1f pkt/datagram, total %d, tx_ack %s" %
+                  (window_pkts / (now - window_start), window_dgrams,
+                   window_pkts / window_dgrams, total_pkts, tx_results))
+        window_pkts = 0
+        window_dgrams = 0
+        window_start = now
@@ -0,0 +1,798 @@
+/**
+ * @file      pkt_fwd.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-06-28
+ * @note      Semtech UDP packet forwarder (GWMP protocol v2), see PROTOCOL.TXT of the
+ *            Semtech packet_forwarder for the datagram and JSON formats.
+ */
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <mbedtls/base64.h>
+#include "pkt_fwd.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define PROTOCOL_VERSION    2
+
+#define PKT_PUSH_DATA       0
+#define PKT_PUSH_ACK        1
+#define PKT_PULL_DATA       2
+#define PKT_PULL_RESP       3
+#define PKT_PULL_ACK        4
+#define PKT_TX_ACK          5
+
+#define GWMP_HEADER_SIZE    12      /* version + token + id + gateway EUI */
+#define PUSH_TRACK_NB       4       /* number of PUSH_DATA waiting for their acknowledge */
+#define STD_LORA_PREAMBLE   8
+#define STD_FSK_PREAMBLE    5
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE TYPES -------------------------------------------------------- */
+
+struct push_track_s {
+    uint16_t    token;
+    uint16_t    nb_pkt;
+    uint32_t    first_fetch_us;     /* fetch time of the oldest packet of the datagram */
+    uint64_t    sum_fetch_us;       /* sum of the fetch times, for the average latency */
+    bool        pending;
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+static struct pkt_fwd_conf_s fwd_conf;
+static struct pkt_fwd_stats_s fwd_stats;
+static bool fwd_running = false;
+
+static WiFiUDP sock_up;
+static WiFiUDP sock_down;
+
+/* uplink batch, the header is written when the datagram is sent */
+static uint8_t push_buff[PKT_FWD_PUSH_BUFF_SIZE];
+static uint16_t push_len;
+static uint8_t push_nb_pkt;
+static uint32_t push_first_fetch_us;
+static uint64_t push_sum_fetch_us;
+static uint32_t push_start_ms;
+static struct push_track_s push_track[PUSH_TRACK_NB];
+static uint8_t push_track_next;
+
+static uint8_t pull_buff[PKT_FWD_PULL_BUFF_SIZE + 1];
+static uint32_t last_pull_ms;
+static uint32_t last_stat_ms;
+static uint32_t stat_rx_nb, stat_rx_ok, stat_rx_fw, stat_push_nb, stat_push_ack, stat_dw_nb, stat_tx_nb;
+
+/* just-in-time downlink queue, sorted by due time, immediate packets first */
+static struct lgw_pkt_tx_s jit_queue[PKT_FWD_JIT_QUEUE_MAX];
+static uint32_t jit_toa[PKT_FWD_JIT_QUEUE_MAX];
+static uint8_t jit_nb;
+
+static struct lgw_pkt_rx_s rx_pkt[PKT_FWD_NB_PKT_MAX];
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS ---------------------------------------------------- */
+
+static void gwmp_header(uint8_t *buff, uint16_t token, uint8_t id)
+{
+    int i;
+
+    buff[0] = PROTOCOL_VERSION;
+    buff[1] = (uint8_t)(token >> 8);
+    buff[2] = (uint8_t)token;
+    buff[3] = id;
+    for (i = 0; i < 8; i++) {
+        buff[4 + i] = (uint8_t)(fwd_conf.gateway_id >> (56 - 8 * i));
+    }
+}
+
+static uint16_t gwmp_token(void)
+{
+    return (uint16_t)esp_random();
+}
+
+static bool send_datagram(WiFiUDP &sock, uint16_t port, const uint8_t *buff, size_t size)
+{
+    if (sock.beginPacket(fwd_conf.server, port) == 0) {
+        return false;
+    }
+    sock.write(buff, size);
+    return sock.endPacket() == 1;
+}
+
+/* Append printf formatted text to the uplink batch, false if it does not fit.
+   Room is kept for the closing "]}" of the datagram. */
+static bool push_append(const char *fmt, ...)
+{
+    va_list args;
+    int n;
+    size_t room = sizeof push_buff - push_len - 2;
+
+    va_start(args, fmt);
+    n = vsnprintf((char *)push_buff + push_len, room, fmt, args);
+    va_end(args);
+    if ((n < 0) || ((size_t)n >= room)) {
+        return false;
+    }
+    push_len += n;
+    return true;
+}
+
+static void push_reset(void)
+{
+    push_len = GWMP_HEADER_SIZE;
+    push_nb_pkt = 0;
+    push_sum_fetch_us = 0;
+}
+
+static void push_flush(void)
+{
+    struct push_track_s *track;
+    uint16_t token;
+
+    if (push_nb_pkt == 0) {
+        return;
+    }
+
+    /* close the rxpk array and the JSON object */
+    push_buff[push_len++] = ']';
+    push_buff[push_len++] = '}';
+
+    token = gwmp_token();
+    gwmp_header(push_buff, token, PKT_PUSH_DATA);
+    if (send_datagram(sock_up, fwd_conf.port_up, push_buff, push_len)) {
+        fwd_stats.push_nb += 1;
+        fwd_stats.push_bytes += push_len;
+        fwd_stats.rx_fw += push_nb_pkt;
+
+        /* remember the datagram to measure the latency when its PUSH_ACK comes back */
+        track = &push_track[push_track_next];
+        push_track_next = (push_track_next + 1) % PUSH_TRACK_NB;
+        track->token = token;
+        track->nb_pkt = push_nb_pkt;
+        track->first_fetch_us = push_first_fetch_us;
+        track->sum_fetch_us = push_sum_fetch_us;
+        track->pending = true;
+    }
+    push_reset();
+}
+
+static const char *bw_str(uint8_t bandwidth)
+{
+    switch (bandwidth) {
+    case BW_125KHZ: return "125";
+    case BW_250KHZ: return "250";
+    case BW_500KHZ: return "500";
+    default:        return NULL;
+    }
+}
+
+/* Serialize one received packet as an rxpk object into the uplink batch,
+   returns 1 if it was appended, 0 if it can not be forwarded, -1 if the batch is full */
+static int push_rxpk(const struct lgw_pkt_rx_s *p)
+{
+    char b64[344];
+    size_t b64_len = 0;
+    const char *bw = NULL;
+    uint16_t mark = push_len;
+    bool ok;
+    int stat;
+
+    switch (p->status) {
+    case STAT_CRC_OK:   stat = 1;  break;
+    case STAT_CRC_BAD:  stat = -1; break;
+    case STAT_NO_CRC:   stat = 0;  break;
+    default:            return 0;
+    }
+    if (p->modulation == MOD_LORA) {
+        bw = bw_str(p->bandwidth);
+        if ((bw == NULL) || (p->coderate < CR_LORA_4_5) || (p->coderate > CR_LORA_4_8)) {
+            return 0;
+        }
+    } else if (p->modulation != MOD_FSK) {
+        return 0;
+    }
+    if (mbedtls_base64_encode((unsigned char *)b64, sizeof b64, &b64_len, p->payload, p->size) != 0) {
+        return 0;
+    }
+
+    ok = push_append("%s{\"tmst\":%u,\"chan\":%u,\"rfch\":%u,\"freq\":%.6f,\"stat\":%d,",
+                     (push_nb_pkt == 0) ? "" : ",", p->count_us, p->if_chain, p->rf_chain,
+                     (double)p->freq_hz / 1e6, stat);
+    if (ok && (p->modulation == MOD_LORA)) {
+        ok = push_append("\"modu\":\"LORA\",\"datr\":\"SF%uBW%s\",\"codr\":\"4/%u\",\"lsnr\":%.1f,",
+                         p->datarate, bw, p->coderate + 4, p->snr);
+    } else if (ok) {
+        ok = push_append("\"modu\":\"FSK\",\"datr\":%u,", p->datarate);
+    }
+    ok = ok && push_append("\"rssi\":%.0f,\"rssis\":%.0f,\"size\":%u,\"data\":\"%.*s\"}",
+                           p->rssic, p->rssis, p->size, (int)b64_len, b64);
+    if (!ok) {
+        push_len = mark;
+        return -1;
+    }
+    return 1;
+}
+
+static void push_open(uint32_t fetch_us)
+{
+    push_append("{\"rxpk\":[");
+    push_first_fetch_us = fetch_us;
+    push_start_ms = millis();
+}
+
+static void push_packet(const struct lgw_pkt_rx_s *p, uint32_t fetch_us)
+{
+    int x;
+
+    if (push_nb_pkt == 0) {
+        push_open(fetch_us);
+    }
+    x = push_rxpk(p);
+    if ((x < 0) && (push_nb_pkt > 0)) {
+        /* batch is full, send it and start a new one with this packet */
+        push_flush();
+        push_open(fetch_us);
+        x = push_rxpk(p);
+    }
+    if (x <= 0) {
+        if (push_nb_pkt == 0) {
+            push_reset();
+        }
+        return;
+    }
+    push_nb_pkt += 1;
+    push_sum_fetch_us += fetch_us;
+    if (push_nb_pkt >= fwd_conf.push_max_pkt) {
+        push_flush();
+    }
+}
+
+static void send_stat(void)
+{
+    uint8_t buff[GWMP_HEADER_SIZE + 256];
+    int n;
+    float ackr;
+
+    ackr = (stat_push_nb > 0) ? 100.0f * stat_push_ack / stat_push_nb : 0.0f;
+    n = snprintf((char *)buff + GWMP_HEADER_SIZE, sizeof buff - GWMP_HEADER_SIZE,
+                 "{\"stat\":{\"rxnb\":%u,\"rxok\":%u,\"rxfw\":%u,\"ackr\":%.1f,\"dwnb\":%u,\"txnb\":%u}}",
+                 stat_rx_nb, stat_rx_ok, stat_rx_fw, ackr, stat_dw_nb, stat_tx_nb);
+    if ((n < 0) || ((size_t)n >= sizeof buff - GWMP_HEADER_SIZE)) {
+        return;
+    }
+    gwmp_header(buff, gwmp_token(), PKT_PUSH_DATA);
+    send_datagram(sock_up, fwd_conf.port_up, buff, GWMP_HEADER_SIZE + n);
+
+    /* the report covers one interval */
+    stat_rx_nb = fwd_stats.rx_nb;
+    stat_rx_ok = fwd_stats.rx_ok;
+    stat_rx_fw = fwd_stats.rx_fw;
+    stat_push_nb = fwd_stats.push_nb;
+    stat_push_ack = fwd_stats.push_ack;
+    stat_dw_nb = fwd_stats.dw_nb;
+    stat_tx_nb = fwd_stats.tx_nb;
+}
+
+static void send_pull_data(void)
+{
+    uint8_t buff[GWMP_HEADER_SIZE];
+
+    gwmp_header(buff, gwmp_token(), PKT_PULL_DATA);
+    if (send_datagram(sock_down, fwd_conf.port_down, buff, sizeof buff)) {
+        fwd_stats.pull_nb += 1;
+    }
+}
+
+static void send_tx_ack(uint16_t token, const char *error)
+{
+    uint8_t buff[GWMP_HEADER_SIZE + 48];
+    size_t size = GWMP_HEADER_SIZE;
+
+    gwmp_header(buff, token, PKT_TX_ACK);
+    if (error != NULL) {
+        size += snprintf((char *)buff + size, sizeof buff - size, "{\"txpk_ack\":{\"error\":\"%s\"}}", error);
+    }
+    send_datagram(sock_down, fwd_conf.port_down, buff, size);
+}
+
+/* Return the value following "key": in a JSON text, NULL if the key is absent */
+static const char *json_value(const char *json, const char *key)
+{
+    char pattern[12];
+    const char *p;
+
+    snprintf(pattern, sizeof pattern, "\"%s\"", key);
+    p = strstr(json, pattern);
+    if (p == NULL) {
+        return NULL;
+    }
+    p += strlen(pattern);
+    while ((*p == ' ') || (*p == '\t') || (*p == '\r') || (*p == '\n')) {
+        p++;
+    }
+    if (*p != ':') {
+        return NULL;
+    }
+    p++;
+    while ((*p == ' ') || (*p == '\t') || (*p == '\r') || (*p == '\n')) {
+        p++;
+    }
+    return p;
+}
+
+static bool json_bool(const char *json, const char *key, bool dflt)
+{
+    const char *v = json_value(json, key);
+
+    if (v == NULL) {
+        return dflt;
+    }
+    return strncmp(v, "true", 4) == 0;
+}
+
+static bool json_number(const char *json, const char *key, double *out)
+{
+    const char *v = json_value(json, key);
+    char *end;
+
+    if (v == NULL) {
+        return false;
+    }
+    *out = strtod(v, &end);
+    return end != v;
+}
+
+/* Copy a JSON string value (without quotes), false if absent or too long */
+static bool json_string(const char *json, const char *key, char *out, size_t size)
+{
+    const char *v = json_value(json, key);
+    const char *end;
+
+    if ((v == NULL) || (*v != '"')) {
+        return false;
+    }
+    v++;
+    end = strchr(v, '"');
+    if ((end == NULL) || ((size_t)(end - v) >= size)) {
+        return false;
+    }
+    memcpy(out, v, end - v);
+    out[end - v] = '\0';
+    return true;
+}
+
+/* Parse the txpk object of a PULL_RESP, returns NULL on success or the TX_ACK error */
+static const char *parse_txpk(const char *json, struct lgw_pkt_tx_s *pkt)
+{
+    char str[352];
+    double num;
+    size_t len;
+    unsigned sf, bw, cr;
+
+    json = json_value(json, "txpk");
+    if ((json == NULL) || (*json != '{')) {
+        return "JSON_ERROR";
+    }
+    memset(pkt, 0, sizeof *pkt);
+
+    if (json_bool(json, "imme", false)) {
+        pkt->tx_mode = IMMEDIATE;
+    } else if (json_number(json, "tmst", &num)) {
+        pkt->tx_mode = TIMESTAMPED;
+        pkt->count_us = (uint32_t)num;
+    } else {
+        /* GPS scheduled downlinks (tmms) need the PPS synchronised time reference */
+        return "GPS_UNLOCKED";
+    }
+
+    if (!json_number(json, "freq", &num)) {
+        return "TX_FREQ";
+    }
+    pkt->freq_hz = (uint32_t)(num * 1e6 + 0.5);
+    if (json_number(json, "rfch", &num)) {
+        pkt->rf_chain = (uint8_t)num;
+    }
+    if (json_number(json, "powe", &num)) {
+        pkt->rf_power = (int8_t)num;
+    }
+    pkt->invert_pol = json_bool(json, "ipol", false);
+    pkt->no_crc = json_bool(json, "ncrc", false);
+    pkt->no_header = json_bool(json, "nhdr", false);
+
+    if (!json_string(json, "modu", str, sizeof str)) {
+        return "JSON_ERROR";
+    }
+    if (strcmp(str, "LORA") == 0) {
+        pkt->modulation = MOD_LORA;
+        if (!json_string(json, "datr", str, sizeof str) || (sscanf(str, "SF%uBW%u", &sf, &bw) != 2)) {
+            return "JSON_ERROR";
+        }
+        if ((sf < DR_LORA_SF5) || (sf > DR_LORA_SF12)) {
+            return "JSON_ERROR";
+        }
+        pkt->datarate = sf;
+        switch (bw) {
+        case 125: pkt->bandwidth = BW_125KHZ; break;
+        case 250: pkt->bandwidth = BW_250KHZ; break;
+        case 500: pkt->bandwidth = BW_500KHZ; break;
+        default:  return "JSON_ERROR";
+        }
+        if (!json_string(json, "codr", str, sizeof str) || (sscanf(str, "4/%u", &cr) != 1) || (cr < 5) || (cr > 8)) {
+            return "JSON_ERROR";
+        }
+        pkt->coderate = cr - 4;
+        pkt->preamble = json_number(json, "prea", &num) ? (uint16_t)num : STD_LORA_PREAMBLE;
+    } else if (strcmp(str, "FSK") == 0) {
+        pkt->modulation = MOD_FSK;
+        if (!json_number(json, "datr", &num) || (num < DR_FSK_MIN) || (num > DR_FSK_MAX)) {
+            return "JSON_ERROR";
+        }
+        pkt->datarate = (uint32_t)num;
+        if (json_number(json, "fdev", &num)) {
+            pkt->f_dev = (uint8_t)(num / 1000.0);
+        }
+        pkt->preamble = json_number(json, "prea", &num) ? (uint16_t)num : STD_FSK_PREAMBLE;
+    } else {
+        return "JSON_ERROR";
+    }
+
+    if (!json_string(json, "data", str, sizeof str) ||
+            (mbedtls_base64_decode(pkt->payload, sizeof pkt->payload, &len,
+                                   (const unsigned char *)str, strlen(str)) != 0)) {
+        return "JSON_ERROR";
+    }
+    pkt->size = len;
+    if (json_number(json, "size", &num) && ((size_t)num != len)) {
+        return "JSON_ERROR";
+    }
+    return NULL;
+}
+
+static uint32_t concentrator_time(void)
+{
+    uint32_t now = 0;
+
+    if (fwd_conf.get_instcnt(&now) != LGW_HAL_SUCCESS) {
+        return 0;
+    }
+    return now;
+}
+
+/* Insert a downlink in the JIT queue, returns NULL on success or the TX_ACK error */
+static const char *jit_enqueue(const struct lgw_pkt_tx_s *pkt)
+{
+    uint32_t now = concentrator_time();
+    uint32_t toa = pkt_fwd_time_on_air(pkt);
+    int32_t ahead;
+    int i, pos;
+
+    if (jit_nb >= PKT_FWD_JIT_QUEUE_MAX) {
+        return "COLLISION_PACKET";
+    }
+
+    if (pkt->tx_mode == TIMESTAMPED) {
+        ahead = (int32_t)(pkt->count_us - now);
+        if (ahead < PKT_FWD_TX_LEAD_US) {
+            return "TOO_LATE";
+        }
+        if (ahead > PKT_FWD_TX_MAX_ADVANCE_US) {
+            return "TOO_EARLY";
+        }
+        /* the radio can only send one packet at a time */
+        for (i = 0; i < jit_nb; i++) {
+            if (jit_queue[i].tx_mode != TIMESTAMPED) {
+                continue;
+            }
+            if (((int32_t)(pkt->count_us - (jit_queue[i].count_us + jit_toa[i])) < PKT_FWD_TX_LEAD_US) &&
+                    ((int32_t)(jit_queue[i].count_us - (pkt->count_us + toa)) < PKT_FWD_TX_LEAD_US)) {
+                return "COLLISION_PACKET";
+            }
+        }
+        for (pos = 0; pos < jit_nb; pos++) {
+            if ((jit_queue[pos].tx_mode == TIMESTAMPED) &&
+                    ((int32_t)(jit_queue[pos].count_us - pkt->count_us) > 0)) {
+                break;
+            }
+        }
+    } else {
+        /* immediate packets go after the other immediate ones */
+        for (pos = 0; (pos < jit_nb) && (jit_queue[pos].tx_mode == IMMEDIATE); pos++);
+    }
+
+    memmove(&jit_queue[pos + 1], &jit_queue[pos], (jit_nb - pos) * sizeof jit_queue[0]);
+    memmove(&jit_toa[pos + 1], &jit_toa[pos], (jit_nb - pos) * sizeof jit_toa[0]);
+    jit_queue[pos] = *pkt;
+    jit_toa[pos] = toa;
+    jit_nb += 1;
+    return NULL;
+}
+
+/* Hand the head of the JIT queue to the concentrator once it is due */
+static void jit_dequeue(void)
+{
+    struct lgw_pkt_tx_s *pkt;
+    int32_t ahead;
+
+    if (jit_nb == 0) {
+        return;
+    }
+    pkt = &jit_queue[0];
+    if (pkt->tx_mode == TIMESTAMPED) {
+        ahead = (int32_t)(pkt->count_us - concentrator_time());
+        if (ahead > PKT_FWD_TX_LEAD_US) {
+            return;
+        }
+        if (ahead < 0) {
+            /* missed, e.g. the loop was blocked for too long */
+            fwd_stats.tx_too_late += 1;
+            goto drop;
+        }
+    }
+    if (fwd_conf.send(pkt) == LGW_HAL_SUCCESS) {
+        fwd_stats.tx_nb += 1;
+    } else {
+        fwd_stats.tx_fail += 1;
+    }
+drop:
+    jit_nb -= 1;
+    memmove(&jit_queue[0], &jit_queue[1], jit_nb * sizeof jit_queue[0]);
+    memmove(&jit_toa[0], &jit_toa[1], jit_nb * sizeof jit_toa[0]);
+}
+
+static void handle_push_ack(uint16_t token)
+{
+    struct push_track_s *track;
+    uint32_t now = micros();
+    uint32_t latency;
+    int i;
+
+    for (i = 0; i < PUSH_TRACK_NB; i++) {
+        track = &push_track[i];
+        if (!track->pending || (track->token != token)) {
+            continue;
+        }
+        track->pending = false;
+        fwd_stats.push_ack += 1;
+        fwd_stats.latency_nb += track->nb_pkt;
+        fwd_stats.latency_sum_us += (uint64_t)now * track->nb_pkt - track->sum_fetch_us;
+        latency = now - track->first_fetch_us;
+        if (latency > fwd_stats.latency_max_us) {
+            fwd_stats.latency_max_us = latency;
+        }
+        return;
+    }
+}
+
+static void handle_pull_resp(uint16_t token, int size)
+{
+    struct lgw_pkt_tx_s pkt;
+    const char *error;
+
+    fwd_stats.dw_nb += 1;
+    pull_buff[size] = '\0';
+    error = parse_txpk((const char *)pull_buff + 4, &pkt);
+    if (error == NULL) {
+        error = jit_enqueue(&pkt);
+        if (error != NULL) {
+            if (strcmp(error, "TOO_LATE") == 0) {
+                fwd_stats.tx_too_late += 1;
+            } else if (strcmp(error, "TOO_EARLY") == 0) {
+                fwd_stats.tx_too_early += 1;
+            } else {
+                fwd_stats.tx_collision += 1;
+            }
+        }
+    }
+    send_tx_ack(token, error);
+}
+
+static void poll_socket(WiFiUDP &sock)
+{
+    int size;
+    uint16_t token;
+
+    while ((size = sock.parsePacket()) > 0) {
+        if (size > PKT_FWD_PULL_BUFF_SIZE) {
+            sock.flush();
+            continue;
+        }
+        size = sock.read(pull_buff, size);
+        if ((size < 4) || (pull_buff[0] != PROTOCOL_VERSION)) {
+            continue;
+        }
+        token = ((uint16_t)pull_buff[1] << 8) | pull_buff[2];
+        switch (pull_buff[3]) {
+        case PKT_PUSH_ACK:
+            handle_push_ack(token);
+            break;
+        case PKT_PULL_ACK:
+            fwd_stats.pull_ack += 1;
+            break;
+        case PKT_PULL_RESP:
+            handle_pull_resp(token, size);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS DEFINITION ------------------------------------------ */
+
+void pkt_fwd_default_conf(struct pkt_fwd_conf_s *conf)
+{
+    *conf = pkt_fwd_conf_s();
+    conf->port_up = PKT_FWD_DEFAULT_PORT;
+    conf->port_down = PKT_FWD_DEFAULT_PORT;
+    conf->push_flush_ms = PKT_FWD_DEFAULT_FLUSH_MS;
+    conf->push_max_pkt = 255;
+    conf->keepalive_ms = PKT_FWD_DEFAULT_KEEPALIVE_MS;
+    conf->stat_interval_ms = PKT_FWD_DEFAULT_STAT_MS;
+    conf->fwd_crc_error = false;
+}
+
+int pkt_fwd_begin(const struct pkt_fwd_conf_s *conf)
+{
+    if ((conf == NULL) || (conf->receive == NULL) || (conf->send == NULL) || (conf->get_instcnt == NULL)) {
+        return PKT_FWD_ERROR;
+    }
+    fwd_conf = *conf;
+    if (fwd_conf.push_max_pkt == 0) {
+        fwd_conf.push_max_pkt = 1;
+    }
+
+    /* separate sockets, the server sends downlinks to the port PULL_DATA came from */
+    if (!sock_up.begin(0) || !sock_down.begin(0)) {
+        sock_up.stop();
+        return PKT_FWD_ERROR;
+    }
+
+    memset(&fwd_stats, 0, sizeof fwd_stats);
+    memset(push_track, 0, sizeof push_track);
+    stat_rx_nb = stat_rx_ok = stat_rx_fw = stat_push_nb = stat_push_ack = stat_dw_nb = stat_tx_nb = 0;
+    push_reset();
+    push_track_next = 0;
+    jit_nb = 0;
+    last_stat_ms = millis();
+    fwd_running = true;
+
+    /* open the downlink route right away */
+    send_pull_data();
+    last_pull_ms = millis();
+    return PKT_FWD_SUCCESS;
+}
+
+void pkt_fwd_end(void)
+{
+    if (!fwd_running) {
+        return;
+    }
+    push_flush();
+    sock_up.stop();
+    sock_down.stop();
+    jit_nb = 0;
+    fwd_running = false;
+}
+
+void pkt_fwd_loop(void)
+{
+    uint32_t now_ms, fetch_us;
+    int nb_pkt, i;
+
+    if (!fwd_running) {
+        return;
+    }
+
+    /* uplinks, keep fetching while the concentrator returns full batches */
+    do {
+        nb_pkt = fwd_conf.receive(PKT_FWD_NB_PKT_MAX, rx_pkt);
+        if (nb_pkt <= 0) {
+            break;
+        }
+        fetch_us = micros();
+        for (i = 0; i < nb_pkt; i++) {
+            fwd_stats.rx_nb += 1;
+            switch (rx_pkt[i].status) {
+            case STAT_CRC_OK:
+                fwd_stats.rx_ok += 1;
+                break;
+            case STAT_CRC_BAD:
+                fwd_stats.rx_bad += 1;
+                if (!fwd_conf.fwd_crc_error) {
+                    continue;
+                }
+                break;
+            case STAT_NO_CRC:
+                fwd_stats.rx_nocrc += 1;
+                break;
+            default:
+                continue;
+            }
+            push_packet(&rx_pkt[i], fetch_us);
+        }
+    } while (nb_pkt == PKT_FWD_NB_PKT_MAX);
+
+    now_ms = millis();
+    if ((push_nb_pkt > 0) && (now_ms - push_start_ms >= fwd_conf.push_flush_ms)) {
+        push_flush();
+    }
+
+    /* downlinks */
+    poll_socket(sock_up);
+    poll_socket(sock_down);
+    jit_dequeue();
+
+    now_ms = millis();
+    if (now_ms - last_pull_ms >= fwd_conf.keepalive_ms) {
+        send_pull_data();
+        last_pull_ms = now_ms;
+    }
+    if ((fwd_conf.stat_interval_ms > 0) && (now_ms - last_stat_ms >= fwd_conf.stat_interval_ms)) {
+        send_stat();
+        last_stat_ms = now_ms;
+    }
+}
+
+void pkt_fwd_get_stats(struct pkt_fwd_stats_s *stats)
+{
+    *stats = fwd_stats;
+}
+
+void pkt_fwd_print_stats(Print &out)
+{
+    out.printf("### [UPSTREAM] ###\n");
+    out.printf("# RF packets received: %u (%u CRC OK, %u CRC bad, %u no CRC)\n",
+               fwd_stats.rx_nb, fwd_stats.rx_ok, fwd_stats.rx_bad, fwd_stats.rx_nocrc);
+    out.printf("# RF packets forwarded: %u in %u datagrams (%u bytes)\n",
+               fwd_stats.rx_fw, fwd_stats.push_nb, fwd_stats.push_bytes);
+    out.printf("# PUSH_DATA acknowledged: %u\n", fwd_stats.push_ack);
+    if (fwd_stats.latency_nb > 0) {
+        out.printf("# Uplink latency: avg %u us, max %u us\n",
+                   (uint32_t)(fwd_stats.latency_sum_us / fwd_stats.latency_nb), fwd_stats.latency_max_us);
+    }
+    out.printf("### [DOWNSTREAM] ###\n");
+    out.printf("# PULL_DATA sent: %u, acknowledged: %u\n", fwd_stats.pull_nb, fwd_stats.pull_ack);
+    out.printf("# PULL_RESP received: %u, sent: %u, failed: %u\n", fwd_stats.dw_nb, fwd_stats.tx_nb, fwd_stats.tx_fail);
+    out.printf("# Rejected: %u too late, %u too early, %u collision\n",
+               fwd_stats.tx_too_late, fwd_stats.tx_too_early, fwd_stats.tx_collision);
+}
+
+uint32_t pkt_fwd_time_on_air(const struct lgw_pkt_tx_s *pkt)
+{
+    double t_sym, t_preamble, payload_symb;
+    uint32_t bw_hz, sf;
+    int de, ih, crc, num, den;
+
+    if (pkt->modulation == MOD_FSK) {
+        /* preamble + sync word (3) + length (1) + payload + CRC (2) */
+        return (uint32_t)((double)(pkt->preamble + 3 + 1 + pkt->size + (pkt->no_crc ? 0 : 2)) * 8e6 / pkt->datarate);
+    }
+    if (pkt->modulation != MOD_LORA) {
+        return 0;
+    }
+
+    switch (pkt->bandwidth) {
+    case BW_125KHZ: bw_hz = 125000; break;
+    case BW_250KHZ: bw_hz = 250000; break;
+    case BW_500KHZ: bw_hz = 500000; break;
+    default:        return 0;
+    }
+    sf = pkt->datarate;
+    t_sym = (double)(1UL << sf) * 1e6 / bw_hz;
+    t_preamble = ((pkt->preamble == 0) ? STD_LORA_PREAMBLE : pkt->preamble) + 4.25;
+
+    /* low datarate optimisation above 16 ms per symbol */
+    de = (t_sym >= 16000.0) ? 1 : 0;
+    ih = pkt->no_header ? 1 : 0;
+    crc = pkt->no_crc ? 0 : 1;
+    num = 8 * pkt->size - 4 * sf + 28 + 16 * crc - 20 * ih;
+    den = 4 * (sf - 2 * de);
+    payload_symb = 8;
+    if (num > 0) {
+        payload_symb += ((num + den - 1) / den) * (pkt->coderate + 4);
+    }
+    return (uint32_t)((t_preamble + payload_symb) * t_sym);
+}
@@ -0,0 +1,127 @@
+/**
+ * @file      pkt_fwd.h
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-06-28
+ * @note      Semtech UDP packet forwarder (GWMP protocol v2) for the SX1302 concentrator.
+ *            Uplinks are fetched from the concentrator, batched into PUSH_DATA datagrams
+ *            and downlinks received in PULL_RESP are scheduled in a just-in-time queue.
+ */
+#pragma once
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include "loragw_hal.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC CONSTANTS ----------------------------------------------------- */
+
+#define PKT_FWD_SUCCESS                 0
+#define PKT_FWD_ERROR                   -1
+
+#define PKT_FWD_DEFAULT_PORT            1700
+#define PKT_FWD_DEFAULT_FLUSH_MS        100     /* max time an uplink waits in the PUSH_DATA batch */
+#define PKT_FWD_DEFAULT_KEEPALIVE_MS    10000   /* PULL_DATA interval, keeps the downlink route open */
+#define PKT_FWD_DEFAULT_STAT_MS         30000   /* interval of the status report */
+
+#define PKT_FWD_NB_PKT_MAX              8       /* max number of packets fetched per poll */
+#define PKT_FWD_PUSH_BUFF_SIZE          2048    /* max size of a PUSH_DATA datagram */
+#define PKT_FWD_PULL_BUFF_SIZE          1024    /* max size of a PULL_RESP datagram */
+#define PKT_FWD_JIT_QUEUE_MAX           16      /* number of downlinks that can be scheduled */
+#define PKT_FWD_TX_LEAD_US              30000   /* hand a downlink to the concentrator this long before it is due */
+#define PKT_FWD_TX_MAX_ADVANCE_US       10000000 /* reject downlinks scheduled further in the future */
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC TYPES --------------------------------------------------------- */
+
+/**
+@struct pkt_fwd_conf_s
+@brief Configuration of the packet forwarder
+*/
+struct pkt_fwd_conf_s {
+    uint64_t    gateway_id;         /*!> gateway EUI reported to the network server */
+    IPAddress   server;             /*!> network server address */
+    uint16_t    port_up;            /*!> server port for PUSH_DATA */
+    uint16_t    port_down;          /*!> server port for PULL_DATA */
+    uint32_t    push_flush_ms;      /*!> flush interval of the uplink batch, 0 to send every poll */
+    uint8_t     push_max_pkt;       /*!> flush the uplink batch once it holds this many packets */
+    uint32_t    keepalive_ms;       /*!> PULL_DATA interval */
+    uint32_t    stat_interval_ms;   /*!> status report interval, 0 to disable */
+    bool        fwd_crc_error;      /*!> also forward packets with a bad CRC */
+
+    /* concentrator access, normally lgw_receive/lgw_send/lgw_get_instcnt of the SX1302 HAL */
+    int (*receive)(uint8_t max_pkt, struct lgw_pkt_rx_s *pkt_data);
+    int (*send)(struct lgw_pkt_tx_s *pkt_data);
+    int (*get_instcnt)(uint32_t *inst_cnt_us);
+};
+
+/**
+@struct pkt_fwd_stats_s
+@brief Counters of the packet forwarder
+*/
+struct pkt_fwd_stats_s {
+    uint32_t    rx_nb;              /*!> packets received by the concentrator */
+    uint32_t    rx_ok;              /*!> packets received with a valid CRC */
+    uint32_t    rx_bad;             /*!> packets received with a bad CRC */
+    uint32_t    rx_nocrc;           /*!> packets received without CRC */
+    uint32_t    rx_fw;              /*!> packets forwarded to the server */
+    uint32_t    push_nb;            /*!> PUSH_DATA datagrams sent */
+    uint32_t    push_ack;           /*!> PUSH_ACK received */
+    uint32_t    push_bytes;         /*!> PUSH_DATA payload bytes sent */
+    uint32_t    pull_nb;            /*!> PULL_DATA datagrams sent */
+    uint32_t    pull_ack;           /*!> PULL_ACK received */
+    uint32_t    dw_nb;              /*!> PULL_RESP received */
+    uint32_t    tx_nb;              /*!> downlinks handed to the concentrator */
+    uint32_t    tx_fail;            /*!> downlinks refused by the concentrator */
+    uint32_t    tx_too_late;        /*!> downlinks rejected, due time already passed */
+    uint32_t    tx_too_early;       /*!> downlinks rejected, due time too far in the future */
+    uint32_t    tx_collision;       /*!> downlinks rejected, overlap with a scheduled one or queue full */
+    uint32_t    latency_nb;         /*!> uplinks with a latency measurement */
+    uint64_t    latency_sum_us;     /*!> sum of fetch -> PUSH_ACK times */
+    uint32_t    latency_max_us;     /*!> largest fetch -> PUSH_ACK time */
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS PROTOTYPES ------------------------------------------ */
+
+/**
+@brief Fill a configuration with the default values
+@param conf configuration to initialize
+*/
+void pkt_fwd_default_conf(struct pkt_fwd_conf_s *conf);
+
+/**
+@brief Open the UDP sockets and start forwarding
+@param conf configuration, copied
+@return PKT_FWD_SUCCESS or PKT_FWD_ERROR
+*/
+int pkt_fwd_begin(const struct pkt_fwd_conf_s *conf);
+
+/**
+@brief Close the UDP sockets, scheduled downlinks are dropped
+*/
+void pkt_fwd_end(void);
+
+/**
+@brief Run the forwarder, must be called as often as possible
+*/
+void pkt_fwd_loop(void);
+
+/**
+@brief Get a copy of the counters
+@param stats pointer to receive the counters
+*/
+void pkt_fwd_get_stats(struct pkt_fwd_stats_s *stats);
+
+/**
+@brief Print the counters in a human readable form
+@param out stream to print to
+*/
+void pkt_fwd_print_stats(Print &out);
+
+/**
+@brief Time on air of a packet
+@param pkt packet to be sent
+@return time on air in microseconds
+*/
+uint32_t pkt_fwd_time_on_air(const struct lgw_pkt_tx_s *pkt);
@@ -132,48 +132,43 @@ int lgw_spi_wb(void *spi_target, uint8_t spi_mux_target, uint16_t address, const
 
     // printf("lgw_spi_wb -> spi_mux_target: %u address: %X data[0]: %X  size: %u\n", spi_mux_target, address, data[0], size);
 
-    int spi_device;
     uint8_t command[3];
     uint8_t command_size;
-    // struct spi_ioc_transfer k[2];
     int size_to_do, chunk_size, offset;
     int byte_transferred = 0;
     int i;
 
-    // /* check input parameters */
+    /* check input parameters */
     CHECK_NULL(data);
     if (size == 0) {
         DEBUG_MSG("ERROR: BURST OF NULL LENGTH\n");
         return LGW_SPI_ERROR;
     }
 
-    // //spi_device = *(int *)spi_target; /* must check that spi_target is not null beforehand */
-
-    // /* prepare command byte */
+    /* prepare command byte */
     command[0] = spi_mux_target;
     command[1] = WRITE_ACCESS | ((address >> 8) & 0x7F);
     command[2] =                ((address >> 0) & 0xFF);
     command_size = 3;
     size_to_do = size;
 
-    // /* I/O transaction */
-    // memset(&k, 0, sizeof(k)); /* clear k */
-    // k[0].tx_buf = (unsigned long) &command[0];
-    // k[0].len = command_size;
-    // k[0].cs_change = 0;
-    // k[1].cs_change = 0;
-
+    /* I/O transaction, one chip select assertion per chunk */
     for (i = 0; size_to_do > 0; ++i) {
         chunk_size = (size_to_do < LGW_BURST_CHUNK) ? size_to_do : LGW_BURST_CHUNK;
         offset = i * LGW_BURST_CHUNK;
-        //     k[1].tx_buf = (unsigned long)(data + offset);
-        //     k[1].len = chunk_size;
-        //     byte_transferred += (ioctl(spi_device, SPI_IOC_MESSAGE(2), &k) - k[0].len );
-        //     DEBUG_PRINTF("BURST WRITE: to trans %d # chunk %d # transferred %d \n", size_to_do, chunk_size, byte_transferred);
+
+        digitalWrite(RADIO_CS_PIN, LOW);
+        SPI.beginTransaction( SPISettings(8E6, MSBFIRST, SPI_MODE0));
+        SPI.writeBytes(command, command_size);
+        SPI.writeBytes(data + offset, chunk_size);
+        SPI.endTransaction();
+        digitalWrite(RADIO_CS_PIN, HIGH);
+
+        byte_transferred += chunk_size;
         size_to_do -= chunk_size; /* subtract the quantity of data already transferred */
     }
 
-    // /* determine return code */
+    /* determine return code */
     if (byte_transferred != size) {
         DEBUG_MSG("ERROR: SPI BURST WRITE FAILURE\n");
         return LGW_SPI_ERROR;
@@ -181,8 +176,6 @@ int lgw_spi_wb(void *spi_target, uint8_t spi_mux_target, uint16_t address, const
         DEBUG_MSG("Note: SPI burst write success\n");
         return LGW_SPI_SUCCESS;
     }
-
-    return LGW_SPI_SUCCESS;
 }
 
 /**
@@ -195,26 +188,22 @@ int lgw_spi_wb(void *spi_target, uint8_t spi_mux_target, uint16_t address, const
 */
 int lgw_spi_rb(void *spi_target, uint8_t spi_mux_target, uint16_t address, uint8_t *data, uint16_t size)
 {
-    int spi_device;
     uint8_t command[4];
     uint8_t command_size;
-    // struct spi_ioc_transfer k[2];
     int size_to_do, chunk_size, offset;
     int byte_transferred = 0;
     int i;
 
     // printf("lgw_spi_rb -> spi_mux_target: %u address: %X data[0]: %X  size: %u\n", spi_mux_target, address, data[0], size);
 
-    // /* check input parameters */
+    /* check input parameters */
     CHECK_NULL(data);
     if (size == 0) {
         DEBUG_MSG("ERROR: BURST OF NULL LENGTH\n");
         return LGW_SPI_ERROR;
     }
 
-    // spi_device = *(int *)spi_target; /* must check that spi_target is not null beforehand */
-
-    // /* prepare command byte */
+    /* prepare command byte */
     command[0] = spi_mux_target;
     command[1] = READ_ACCESS | ((address >> 8) & 0x7F);
     command[2] =               ((address >> 0) & 0xFF);
@@ -222,19 +211,19 @@ int lgw_spi_rb(void *spi_target, uint8_t spi_mux_target, uint16_t address, uint8
     command_size = 4;
     size_to_do = size;
 
-    // /* I/O transaction */
-    // memset(&k, 0, sizeof(k)); /* clear k */
-    // k[0].tx_buf = (unsigned long) &command[0];
-    // k[0].len = command_size;
-    // k[0].cs_change = 0;
-    // k[1].cs_change = 0;
+    /* I/O transaction, one chip select assertion per chunk */
     for (i = 0; size_to_do > 0; ++i) {
         chunk_size = (size_to_do < LGW_BURST_CHUNK) ? size_to_do : LGW_BURST_CHUNK;
         offset = i * LGW_BURST_CHUNK;
-        //     k[1].rx_buf = (unsigned long)(data + offset);
-        //     k[1].len = chunk_size;
-        //     byte_transferred += (ioctl(spi_device, SPI_IOC_MESSAGE(2), &k) - k[0].len );
-        //     DEBUG_PRINTF("BURST READ: to trans %d # chunk %d # transferred %d \n", size_to_do, chunk_size, byte_transferred);
+
+        digitalWrite(RADIO_CS_PIN, LOW);
+        SPI.beginTransaction( SPISettings(8E6, MSBFIRST, SPI_MODE0));
+        SPI.writeBytes(command, command_size);
+        SPI.transferBytes(NULL, data + offset, chunk_size);
+        SPI.endTransaction();
+        digitalWrite(RADIO_CS_PIN, HIGH);
+
+        byte_transferred += chunk_size;
         size_to_do -= chunk_size;  /* subtract the quantity of data already transferred */
     }
 
@@ -246,6 +235,5 @@ int lgw_spi_rb(void *spi_target, uint8_t spi_mux_target, uint16_t address, uint8
         DEBUG_MSG("Note: SPI burst read success\n");
         return LGW_SPI_SUCCESS;
     }
-    return LGW_SPI_SUCCESS;
 }
 
@@ -0,0 +1,176 @@
+/**
+ * @file      UDPBatchIngest.ino
+ * @license   MIT
+ * @copyright Copyright (c) 2024  Shenzhen Xin Yuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      High rate UDP ingest. Datagrams are read whole into a preallocated packet
+ *            pool and processed in batches, each one is acknowledged by sending the
+ *            first 4 bytes back in place, without copying. Rates, drops and pool usage
+ *            are printed every second.
+ *            Load it from a PC with tools/udp_ingest_bench.c:
+ *              cc -O2 -pthread -o udp_ingest_bench tools/udp_ingest_bench.c udp_ingest.c
+ *              ./udp_ingest_bench send <board ip> 3333 5000 64
+ */
+#include <Arduino.h>
+#if ESP_ARDUINO_VERSION < ESP_ARDUINO_VERSION_VAL(3,0,0)
+#include <ETHClass2.h>       //Is to use the modified ETHClass
+#define ETH  ETH2
+#else
+#include <ETH.h>
+#endif
+#include <SPI.h>
+#include "utilities.h"          //Board PinMap
+#include <WiFi.h>
+#include "udp_ingest.h"
+
+// Listen on UDP port
+const uint16_t udpPort = 3333;
+
+// Packets in the pool, each one takes ~1.5KB
+#define INGEST_POOL_SIZE        32
+
+// Acknowledge every datagram to its sender
+#define INGEST_SEND_ACK         1
+
+static struct udp_ingest_s ingest;
+static bool ingest_open = false;
+static uint32_t next_seq = 0;
+static uint32_t lost = 0;
+static uint32_t report_ms = 0;
+
+static bool eth_connected = false;
+
+void WiFiEvent(arduino_event_id_t event)
+{
+    switch (event) {
+    case ARDUINO_EVENT_ETH_START:
+        Serial.println("ETH Started");
+        //set eth hostname here
+        ETH.setHostname("esp32-ethernet");
+        break;
+    case ARDUINO_EVENT_ETH_CONNECTED:
+        Serial.println("ETH Connected");
+        break;
+    case ARDUINO_EVENT_ETH_GOT_IP:
+        Serial.print("ETH MAC: ");
+        Serial.print(ETH.macAddress());
+        Serial.print(", IPv4: ");
+        Serial.print(ETH.localIP());
+        if (ETH.fullDuplex()) {
+            Serial.print(", FULL_DUPLEX");
+        }
+
+        Serial.print(", ");
+        Serial.print(ETH.linkSpeed());
+        Serial.println("Mbps");
+        eth_connected = true;
+        break;
+    case ARDUINO_EVENT_ETH_DISCONNECTED:
+        Serial.println("ETH Disconnected");
+        eth_connected = false;
+        break;
+    case ARDUINO_EVENT_ETH_STOP:
+        Serial.println("ETH Stopped");
+        eth_connected = false;
+        break;
+    default:
+        break;
+    }
+}
+
+// Application work on a batch of datagrams, here: count the gaps in the sequence numbers
+void processBatch(struct udp_pkt_s **pkts, int count)
+{
+    for (int i = 0; i < count; i++) {
+        if (pkts[i]->len < 4) {
+            continue;
+        }
+        uint32_t seq = pkts[i]->data[0] | pkts[i]->data[1] << 8 |
+                       pkts[i]->data[2] << 16 | (uint32_t)pkts[i]->data[3] << 24;
+        if (seq > next_seq) {
+            lost += seq - next_seq;
+        }
+        next_seq = seq + 1;
+    }
+}
+
+void printStats()
+{
+    struct udp_ingest_stats_s stats;
+
+    udp_ingest_get_stats(&ingest, &stats);
+    Serial.printf("RX %u pkt/s, %.1f pkt/batch, total %u, lost %u, dropped %u, too large %u | "
+                  "TX %u pkt/s, failed %u | pool low %u/%u\n",
+                  stats.rx_pps, stats.rx_batches ? (float)stats.rx_pkt / stats.rx_batches : 0.0f,
+                  stats.rx_pkt, lost, stats.rx_drop, stats.rx_trunc,
+                  stats.tx_pps, stats.tx_fail, stats.pool_low, stats.pool_size);
+}
+
+void setup()
+{
+    Serial.begin(115200);
+
+    WiFi.onEvent(WiFiEvent);
+
+#ifdef ETH_POWER_PIN
+    pinMode(ETH_POWER_PIN, OUTPUT);
+    digitalWrite(ETH_POWER_PIN, HIGH);
+#endif
+
+#if CONFIG_IDF_TARGET_ESP32
+    if (!ETH.begin(ETH_TYPE, ETH_ADDR, ETH_MDC_PIN,
+                   ETH_MDIO_PIN, ETH_RESET_PIN, ETH_CLK_MODE)) {
+        Serial.println("ETH start Failed!");
+    }
+#else
+    if (!ETH.begin(ETH_PHY_W5500, 1, ETH_CS_PIN, ETH_INT_PIN, ETH_RST_PIN,
+                   SPI3_HOST,
+                   ETH_SCLK_PIN, ETH_MISO_PIN, ETH_MOSI_PIN)) {
+        Serial.println("ETH start Failed!");
+    }
+#endif
+}
+
+void loop()
+{
+    struct udp_pkt_s *pkts[UDP_INGEST_BATCH_MAX];
+
+    if (!eth_connected) {
+        delay(100);
+        return;
+    }
+
+    if (!ingest_open) {
+        if (udp_ingest_open(&ingest, udpPort, INGEST_POOL_SIZE) != UDP_INGEST_SUCCESS) {
+            Serial.println("UDP ingest open failed!");
+            delay(1000);
+            return;
+        }
+        ingest_open = true;
+        Serial.print("UDP ingest listening on ");
+        Serial.print(ETH.localIP());
+        Serial.print(":");
+        Serial.println(udpPort);
+        report_ms = millis();
+    }
+
+    // Sleep until datagrams arrive, then take everything queued in one batch
+    if (udp_ingest_wait(&ingest, 10) > 0) {
+        int n = udp_ingest_recv(&ingest, pkts, UDP_INGEST_BATCH_MAX);
+        processBatch(pkts, n);
+#if INGEST_SEND_ACK
+        // Reply in place: the packets already hold the sender address
+        for (int i = 0; i < n; i++) {
+            pkts[i]->len = min(pkts[i]->len, (uint16_t)4);
+        }
+        udp_ingest_send(&ingest, pkts, n);
+#else
+        udp_ingest_release(&ingest, pkts, n);
+#endif
+    }
+
+    if (millis() - report_ms >= 1000) {
+        report_ms += 1000;
+        printStats();
+    }
+}
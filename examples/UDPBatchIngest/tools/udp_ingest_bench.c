@@ -0,0 +1,163 @@
+/**
+ * @file      udp_ingest_bench.c
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      Linux load generator and benchmark for udp_ingest. Datagrams carry a
+ *            32 bit sequence number so the receiver can count the lost ones.
+ *
+ * build:  cc -O2 -pthread -o udp_ingest_bench udp_ingest_bench.c ../udp_ingest.c
+ * usage:  udp_ingest_bench send <board ip> [port] [pps, 0 = as fast as possible] [size]
+ *         udp_ingest_bench recv [port]
+ *         udp_ingest_bench loop [seconds] [pps]    sender and receiver over loopback
+ */
+#ifndef ARDUINO     /* PC tool, PlatformIO compiles every file below src_dir */
+
+#include <arpa/inet.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../udp_ingest.h"
+
+#define DEFAULT_PORT    3333
+#define LOOP_PORT       3334
+#define SEND_BATCH      16
+
+static volatile int running = 1;
+
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+struct send_conf_s {
+    uint32_t    addr;
+    uint16_t    port;
+    uint32_t    pps;
+    uint16_t    size;
+};
+
+static void *send_thread(void *arg)
+{
+    struct send_conf_s *conf = arg;
+    struct udp_ingest_s u;
+    struct udp_pkt_s *pkts[SEND_BATCH];
+    struct udp_ingest_stats_s stats;
+    uint64_t start = now_us(), due;
+    uint32_t seq = 0;
+    int i, n;
+
+    if (udp_ingest_open(&u, 0, SEND_BATCH) != UDP_INGEST_SUCCESS) {
+        perror("send socket");
+        return NULL;
+    }
+    while (running) {
+        for (n = 0; n < SEND_BATCH; n++) {
+            pkts[n] = udp_ingest_alloc(&u);
+            pkts[n]->addr = conf->addr;
+            pkts[n]->port = conf->port;
+            pkts[n]->len = conf->size;
+            memset(pkts[n]->data, 0x55, conf->size);
+            for (i = 0; i < 4; i++) {
+                pkts[n]->data[i] = (uint8_t)(seq >> (i * 8));
+            }
+            seq++;
+        }
+        udp_ingest_send(&u, pkts, n);
+        if (conf->pps) {
+            due = start + (uint64_t)seq * 1000000 / conf->pps;
+            while (running && now_us() < due) {
+                struct timespec ts = { 0, 50000 };
+                nanosleep(&ts, NULL);
+            }
+        }
+    }
+    udp_ingest_get_stats(&u, &stats);
+    printf("sent %u datagrams, %u refused\n", stats.tx_pkt, stats.tx_fail);
+    udp_ingest_close(&u);
+    return NULL;
+}
+
+static int run_recv(uint16_t port, int seconds)
+{
+    struct udp_ingest_s u;
+    struct udp_pkt_s *pkts[UDP_INGEST_BATCH_MAX];
+    struct udp_ingest_stats_s stats;
+    uint64_t start = now_us(), report = start + 1000000;
+    uint32_t seq, next_seq = 0, lost = 0;
+    int i, n;
+
+    if (udp_ingest_open(&u, port, 256) != UDP_INGEST_SUCCESS) {
+        perror("recv socket");
+        return 1;
+    }
+    printf("listening on UDP port %u\n", port);
+    while (seconds == 0 || now_us() - start < (uint64_t)seconds * 1000000) {
+        if (udp_ingest_wait(&u, 100) > 0) {
+            n = udp_ingest_recv(&u, pkts, UDP_INGEST_BATCH_MAX);
+            for (i = 0; i < n; i++) {
+                if (pkts[i]->len < 4) {
+                    continue;
+                }
+                seq = pkts[i]->data[0] | pkts[i]->data[1] << 8 | pkts[i]->data[2] << 16 | (uint32_t)pkts[i]->data[3] << 24;
+                if (seq > next_seq) {
+                    lost += seq - next_seq;
+                }
+                next_seq = seq + 1;
+            }
+            udp_ingest_release(&u, pkts, n);
+        }
+        if (now_us() >= report) {
+            report += 1000000;
+            udp_ingest_get_stats(&u, &stats);
+            printf("%u pkt/s, %.1f pkt/batch, total %u, lost %u, dropped %u, pool low %u/%u\n",
+                   stats.rx_pps, stats.rx_batches ? (double)stats.rx_pkt / stats.rx_batches : 0.0,
+                   stats.rx_pkt, lost, stats.rx_drop, stats.pool_low, stats.pool_size);
+        }
+    }
+    udp_ingest_close(&u);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    struct send_conf_s conf;
+    pthread_t thread;
+    struct in_addr ip;
+
+    if (argc >= 3 && strcmp(argv[1], "send") == 0 && inet_pton(AF_INET, argv[2], &ip) == 1) {
+        conf.addr = ip.s_addr;
+        conf.port = argc > 3 ? atoi(argv[3]) : DEFAULT_PORT;
+        conf.pps = argc > 4 ? atoi(argv[4]) : 0;
+        conf.size = argc > 5 ? atoi(argv[5]) : 64;
+        if (conf.size < 4 || conf.size > UDP_INGEST_PKT_SIZE) {
+            fprintf(stderr, "size must be 4..%d\n", UDP_INGEST_PKT_SIZE);
+            return 2;
+        }
+        send_thread(&conf);
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "recv") == 0) {
+        return run_recv(argc > 2 ? atoi(argv[2]) : DEFAULT_PORT, 0);
+    }
+    if (argc >= 2 && strcmp(argv[1], "loop") == 0) {
+        conf.addr = htonl(INADDR_LOOPBACK);
+        conf.port = LOOP_PORT;
+        conf.pps = argc > 3 ? atoi(argv[3]) : 0;
+        conf.size = 64;
+        pthread_create(&thread, NULL, send_thread, &conf);
+        run_recv(LOOP_PORT, argc > 2 ? atoi(argv[2]) : 5);
+        running = 0;
+        pthread_join(thread, NULL);
+        return 0;
+    }
+    fprintf(stderr, "usage: %s send <ip> [port] [pps] [size] | recv [port] | loop [seconds] [pps]\n", argv[0]);
+    return 2;
+}
+
+#endif /* ARDUINO */
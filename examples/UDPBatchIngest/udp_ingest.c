@@ -0,0 +1,317 @@
+/**
+ * @file      udp_ingest.c
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      Batched UDP receive/send on a preallocated packet pool, see udp_ingest.h
+ */
+#if defined(__linux__)
+#define _GNU_SOURCE             /* recvmmsg / sendmmsg */
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <time.h>
+#else
+#include "lwip/sockets.h"
+#include "esp_timer.h"
+#endif
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "udp_ingest.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+/* datagrams that find the pool empty are read into this and dropped */
+static uint8_t drop_buff[UDP_INGEST_PKT_SIZE + 1];
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static uint32_t now_ms(void)
+{
+#if defined(__linux__)
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+#else
+    return (uint32_t)(esp_timer_get_time() / 1000);
+#endif
+}
+
+static struct udp_pkt_s *pool_get(struct udp_ingest_s *u)
+{
+    struct udp_pkt_s *p = u->free_list;
+
+    if (p) {
+        u->free_list = p->next;
+        if (--u->stats.pool_free < u->stats.pool_low) {
+            u->stats.pool_low = u->stats.pool_free;
+        }
+    }
+    return p;
+}
+
+static void pool_put(struct udp_ingest_s *u, struct udp_pkt_s *p)
+{
+    p->next = u->free_list;
+    u->free_list = p;
+    u->stats.pool_free++;
+}
+
+/* Receive into count pooled buffers, without blocking. Lengths above
+ * UDP_INGEST_PKT_SIZE mark oversized datagrams. Return the number of datagrams. */
+static int backend_recv(struct udp_ingest_s *u, struct udp_pkt_s **bufs, int count, int *lens)
+{
+    struct sockaddr_in addr[UDP_INGEST_BATCH_MAX];
+    int i, n;
+#if defined(__linux__)
+    struct mmsghdr msgs[UDP_INGEST_BATCH_MAX];
+    struct iovec iov[UDP_INGEST_BATCH_MAX];
+
+    memset(msgs, 0, count * sizeof(msgs[0]));
+    for (i = 0; i < count; i++) {
+        iov[i].iov_base = bufs[i]->data;
+        iov[i].iov_len = sizeof(bufs[i]->data);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = &addr[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(addr[i]);
+    }
+    n = recvmmsg(u->sock, msgs, count, MSG_DONTWAIT, NULL);
+    if (n < 0) {
+        return 0;
+    }
+    for (i = 0; i < n; i++) {
+        lens[i] = msgs[i].msg_len;
+    }
+#else
+    socklen_t addr_len;
+    int r;
+
+    for (n = 0; n < count; n++) {
+        addr_len = sizeof(addr[n]);
+        r = recvfrom(u->sock, bufs[n]->data, sizeof(bufs[n]->data), MSG_DONTWAIT,
+                     (struct sockaddr *)&addr[n], &addr_len);
+        if (r < 0) {
+            break;
+        }
+        lens[n] = r;
+    }
+#endif
+    for (i = 0; i < n; i++) {
+        bufs[i]->addr = addr[i].sin_addr.s_addr;
+        bufs[i]->port = ntohs(addr[i].sin_port);
+    }
+    return n;
+}
+
+/* Send count packets, return how many the stack accepted */
+static int backend_send(struct udp_ingest_s *u, struct udp_pkt_s **pkts, int count)
+{
+    struct sockaddr_in addr[UDP_INGEST_BATCH_MAX];
+    int i, n;
+
+    memset(addr, 0, count * sizeof(addr[0]));
+    for (i = 0; i < count; i++) {
+        addr[i].sin_family = AF_INET;
+        addr[i].sin_addr.s_addr = pkts[i]->addr;
+        addr[i].sin_port = htons(pkts[i]->port);
+    }
+#if defined(__linux__)
+    struct mmsghdr msgs[UDP_INGEST_BATCH_MAX];
+    struct iovec iov[UDP_INGEST_BATCH_MAX];
+
+    memset(msgs, 0, count * sizeof(msgs[0]));
+    for (i = 0; i < count; i++) {
+        iov[i].iov_base = pkts[i]->data;
+        iov[i].iov_len = pkts[i]->len;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = &addr[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(addr[i]);
+    }
+    n = sendmmsg(u->sock, msgs, count, 0);
+    return n < 0 ? 0 : n;
+#else
+    for (n = 0, i = 0; i < count; i++) {
+        if (sendto(u->sock, pkts[i]->data, pkts[i]->len, 0,
+                   (struct sockaddr *)&addr[i], sizeof(addr[i])) == pkts[i]->len) {
+            n++;
+        }
+    }
+    return n;
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS DEFINITION ------------------------------------------ */
+
+int udp_ingest_open(struct udp_ingest_s *u, uint16_t port, uint16_t pool_size)
+{
+    struct sockaddr_in addr;
+    int i;
+
+    memset(u, 0, sizeof(*u));
+    u->sock = -1;
+    u->pool = calloc(pool_size, sizeof(struct udp_pkt_s));
+    if (u->pool == NULL || pool_size == 0) {
+        udp_ingest_close(u);
+        return UDP_INGEST_ERROR;
+    }
+    for (i = pool_size - 1; i >= 0; i--) {
+        pool_put(u, &u->pool[i]);
+    }
+    u->stats.pool_size = pool_size;
+    u->stats.pool_low = pool_size;
+
+    u->sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (u->sock < 0) {
+        udp_ingest_close(u);
+        return UDP_INGEST_ERROR;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(u->sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        udp_ingest_close(u);
+        return UDP_INGEST_ERROR;
+    }
+    u->rate_ms = now_ms();
+    return UDP_INGEST_SUCCESS;
+}
+
+void udp_ingest_close(struct udp_ingest_s *u)
+{
+    if (u->sock >= 0) {
+        close(u->sock);
+        u->sock = -1;
+    }
+    free(u->pool);
+    u->pool = NULL;
+    u->free_list = NULL;
+}
+
+int udp_ingest_wait(struct udp_ingest_s *u, uint32_t timeout_ms)
+{
+    struct timeval tv;
+    fd_set fds;
+    int r;
+
+    FD_ZERO(&fds);
+    FD_SET(u->sock, &fds);
+    tv.tv_sec = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
+    r = select(u->sock + 1, &fds, NULL, NULL, &tv);
+    if (r < 0) {
+        return errno == EINTR ? 0 : UDP_INGEST_ERROR;
+    }
+    return r > 0 ? 1 : 0;
+}
+
+int udp_ingest_recv(struct udp_ingest_s *u, struct udp_pkt_s **pkts, int max)
+{
+    struct udp_pkt_s *bufs[UDP_INGEST_BATCH_MAX];
+    int lens[UDP_INGEST_BATCH_MAX];
+    int count, i, n, delivered = 0;
+
+    if (max > UDP_INGEST_BATCH_MAX) {
+        max = UDP_INGEST_BATCH_MAX;
+    }
+    for (count = 0; count < max; count++) {
+        bufs[count] = pool_get(u);
+        if (bufs[count] == NULL) {
+            break;
+        }
+    }
+
+    if (count == 0) {
+        /* the application holds the whole pool, make room in the socket queue */
+        for (i = 0; i < max; i++) {
+            if (recv(u->sock, drop_buff, sizeof(drop_buff), MSG_DONTWAIT) < 0) {
+                break;
+            }
+            u->stats.rx_drop++;
+        }
+        return 0;
+    }
+
+    n = backend_recv(u, bufs, count, lens);
+    for (i = 0; i < n; i++) {
+        if (lens[i] > UDP_INGEST_PKT_SIZE) {
+            u->stats.rx_trunc++;
+            pool_put(u, bufs[i]);
+            continue;
+        }
+        bufs[i]->len = (uint16_t)lens[i];
+        u->stats.rx_bytes += lens[i];
+        pkts[delivered++] = bufs[i];
+    }
+    for (i = n; i < count; i++) {
+        pool_put(u, bufs[i]);
+    }
+    if (delivered) {
+        u->stats.rx_pkt += delivered;
+        u->stats.rx_batches++;
+    }
+    return delivered;
+}
+
+void udp_ingest_release(struct udp_ingest_s *u, struct udp_pkt_s **pkts, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        pool_put(u, pkts[i]);
+    }
+}
+
+struct udp_pkt_s *udp_ingest_alloc(struct udp_ingest_s *u)
+{
+    struct udp_pkt_s *p = pool_get(u);
+
+    if (p) {
+        p->len = 0;
+    }
+    return p;
+}
+
+int udp_ingest_send(struct udp_ingest_s *u, struct udp_pkt_s **pkts, int count)
+{
+    int i, sent;
+
+    if (count > UDP_INGEST_BATCH_MAX) {
+        udp_ingest_release(u, pkts + UDP_INGEST_BATCH_MAX, count - UDP_INGEST_BATCH_MAX);
+        u->stats.tx_fail += count - UDP_INGEST_BATCH_MAX;
+        count = UDP_INGEST_BATCH_MAX;
+    }
+    sent = backend_send(u, pkts, count);
+    for (i = 0; i < sent; i++) {
+        u->stats.tx_bytes += pkts[i]->len;
+    }
+    u->stats.tx_pkt += sent;
+    u->stats.tx_fail += count - sent;
+    udp_ingest_release(u, pkts, count);
+    return sent;
+}
+
+void udp_ingest_get_stats(struct udp_ingest_s *u, struct udp_ingest_stats_s *stats)
+{
+    uint32_t now = now_ms();
+    uint32_t dt = now - u->rate_ms;
+
+    if (dt > 0) {
+        u->stats.rx_pps = (uint32_t)((uint64_t)(u->stats.rx_pkt - u->rate_rx) * 1000 / dt);
+        u->stats.tx_pps = (uint32_t)((uint64_t)(u->stats.tx_pkt - u->rate_tx) * 1000 / dt);
+        u->stats.drop_pps = (uint32_t)((uint64_t)(u->stats.rx_drop - u->rate_drop) * 1000 / dt);
+        u->rate_ms = now;
+        u->rate_rx = u->stats.rx_pkt;
+        u->rate_tx = u->stats.tx_pkt;
+        u->rate_drop = u->stats.rx_drop;
+    }
+    *stats = u->stats;
+}
@@ -0,0 +1,147 @@
+/**
+ * @file      udp_ingest.h
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      Batched UDP receive/send on a preallocated packet pool. Whole datagrams
+ *            are read into pooled buffers and handed to the application in batches,
+ *            replies go out through the same pool. Nothing is allocated while the
+ *            traffic runs. Written against BSD sockets: lwIP on the ESP32,
+ *            recvmmsg/sendmmsg on Linux, where tools/udp_ingest_bench.c measures it.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC CONSTANTS ----------------------------------------------------- */
+
+#define UDP_INGEST_SUCCESS          0
+#define UDP_INGEST_ERROR            -1
+
+#define UDP_INGEST_PKT_SIZE         1472    /* largest payload of an unfragmented datagram on Ethernet */
+#define UDP_INGEST_BATCH_MAX        32      /* max packets per udp_ingest_recv / udp_ingest_send */
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC TYPES --------------------------------------------------------- */
+
+/**
+@struct udp_pkt_s
+@brief Pooled datagram, owned by the application between udp_ingest_recv/udp_ingest_alloc
+and udp_ingest_release/udp_ingest_send
+*/
+struct udp_pkt_s {
+    struct udp_pkt_s *next;         /*!> free list link */
+    uint32_t    addr;               /*!> remote IPv4 address, network order */
+    uint16_t    port;               /*!> remote port, host order */
+    uint16_t    len;                /*!> payload length */
+    uint8_t     data[UDP_INGEST_PKT_SIZE + 1];  /*!> one spare byte detects oversized datagrams */
+};
+
+/**
+@struct udp_ingest_stats_s
+@brief Counters, the rates cover the time since the previous udp_ingest_get_stats
+*/
+struct udp_ingest_stats_s {
+    uint32_t    rx_pkt;             /*!> datagrams delivered to the application */
+    uint32_t    rx_bytes;           /*!> payload bytes delivered */
+    uint32_t    rx_batches;         /*!> udp_ingest_recv calls that returned packets */
+    uint32_t    rx_drop;            /*!> datagrams read and discarded because the pool was empty */
+    uint32_t    rx_trunc;           /*!> datagrams discarded because they were larger than UDP_INGEST_PKT_SIZE */
+    uint32_t    tx_pkt;             /*!> datagrams sent */
+    uint32_t    tx_bytes;           /*!> payload bytes sent */
+    uint32_t    tx_fail;            /*!> datagrams the stack refused */
+    uint16_t    pool_size;
+    uint16_t    pool_free;          /*!> packets currently in the pool */
+    uint16_t    pool_low;           /*!> fewest packets seen in the pool */
+    uint32_t    rx_pps;             /*!> received datagrams per second */
+    uint32_t    tx_pps;             /*!> sent datagrams per second */
+    uint32_t    drop_pps;           /*!> dropped datagrams per second */
+};
+
+/**
+@struct udp_ingest_s
+@brief One socket with its packet pool
+*/
+struct udp_ingest_s {
+    int         sock;
+    struct udp_pkt_s *pool;
+    struct udp_pkt_s *free_list;
+    struct udp_ingest_stats_s stats;
+    uint32_t    rate_ms;            /*!> time of the previous rate computation */
+    uint32_t    rate_rx;
+    uint32_t    rate_tx;
+    uint32_t    rate_drop;
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS PROTOTYPES ------------------------------------------ */
+
+/**
+@brief Allocate the packet pool and bind a socket
+@param u instance
+@param port local UDP port, 0 for an ephemeral one (sender only)
+@param pool_size number of packets in the pool
+@return UDP_INGEST_SUCCESS or UDP_INGEST_ERROR
+*/
+int udp_ingest_open(struct udp_ingest_s *u, uint16_t port, uint16_t pool_size);
+
+/**
+@brief Close the socket and free the pool, all packets must have been returned
+*/
+void udp_ingest_close(struct udp_ingest_s *u);
+
+/**
+@brief Wait until datagrams are queued on the socket
+@param timeout_ms max time to wait
+@return 1 if data is ready, 0 on timeout, UDP_INGEST_ERROR on error
+*/
+int udp_ingest_wait(struct udp_ingest_s *u, uint32_t timeout_ms);
+
+/**
+@brief Read the datagrams queued on the socket, does not block
+When the pool is empty the queued datagrams are read and dropped, so the
+application always sees the most recent data.
+@param u instance
+@param pkts array receiving the packets
+@param max size of the array, at most UDP_INGEST_BATCH_MAX
+@return number of packets, they stay with the application until released or sent
+*/
+int udp_ingest_recv(struct udp_ingest_s *u, struct udp_pkt_s **pkts, int max);
+
+/**
+@brief Give packets back to the pool
+*/
+void udp_ingest_release(struct udp_ingest_s *u, struct udp_pkt_s **pkts, int count);
+
+/**
+@brief Take an empty packet from the pool to send
+@return packet or NULL if the pool is empty
+*/
+struct udp_pkt_s *udp_ingest_alloc(struct udp_ingest_s *u);
+
+/**
+@brief Send packets to their addr/port and give them back to the pool
+A received packet can be sent back as it is to reply in place.
+@param u instance
+@param pkts packets to send, released whether they were sent or not
+@param count number of packets, at most UDP_INGEST_BATCH_MAX
+@return number of packets sent
+*/
+int udp_ingest_send(struct udp_ingest_s *u, struct udp_pkt_s **pkts, int count);
+
+/**
+@brief Get a copy of the counters and update the rates
+@param u instance
+@param stats pointer to receive the counters
+*/
+void udp_ingest_get_stats(struct udp_ingest_s *u, struct udp_ingest_stats_s *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -24,6 +24,9 @@ WiFiUDP udp;
 
 const int udpPort = 3333;
 
+//Whole datagrams are read at once
+uint8_t packetBuffer[1472];
+
 
 static bool eth_connected = false;
 
@@ -108,9 +111,11 @@ void setup()
 void loop()
 {
     if (eth_connected) {
-        if (udp.parsePacket() > 0) {
-            while (udp.available()) {
-                Serial.write(udp.read());
+        int len = udp.parsePacket();
+        if (len > 0) {
+            len = udp.read(packetBuffer, sizeof(packetBuffer));
+            if (len > 0) {
+                Serial.write(packetBuffer, len);
             }
         }
     }
@@ -39,16 +39,20 @@
 
 extern void app_httpd_main();
 
-#define BIT0_FRAME_START     (0x01 << 0)
-#define BIT1_NEW_FRAME_START (0x01 << 1)
-#define BIT2_NEW_FRAME_END   (0x01 << 2)
-#define BIT3_SPK_START       (0x01 << 3)
-#define BIT4_SPK_RESET       (0x01 << 4)
 #define BIT5_NET_CONNECT     (0x01 << 5)
 
+// Frames are handed to the web server through a ring, a slow client no longer
+// holds up the USB task. Each slot takes one frame, allocated in PSRAM if present.
+#define FRAME_RING_SLOTS     3
+#define FRAME_SLOT_SIZE      (55 * 1024)
+
 static EventGroupHandle_t s_evt_handle;
 
-static camera_fb_t s_fb = {0};
+static USB_STREAM *usb = NULL;
+
+// One camera_fb_t per ring slot, several requests can hold a frame at the same time
+static camera_fb_t s_fb[FRAME_RING_SLOTS];
+static uvc_ring_frame_t *s_fb_frame[FRAME_RING_SLOTS];
 
 
 void WiFiEvent(WiFiEvent_t event)
@@ -93,44 +97,41 @@ void WiFiEvent(WiFiEvent_t event)
 
 camera_fb_t *esp_camera_fb_get()
 {
-    xEventGroupSetBits(s_evt_handle, BIT0_FRAME_START);
-    xEventGroupWaitBits(s_evt_handle, BIT1_NEW_FRAME_START, true, true, portMAX_DELAY);
-    return &s_fb;
+    uvc_ring_frame_t *frame;
+
+    for (;;) {
+        frame = usb->uvcFrameAcquire(1000);
+        if (frame == NULL) {
+            return NULL;
+        }
+        if (frame->format == UVC_FRAME_FORMAT_MJPEG) {
+            break;
+        }
+        ESP_LOGW(TAG, "Format not supported");
+        usb->uvcFrameRelease(frame);
+    }
+
+    camera_fb_t *fb = &s_fb[frame->index];
+    fb->buf = frame->data;
+    fb->len = frame->data_bytes;
+    fb->width = frame->width;
+    fb->height = frame->height;
+    fb->format = PIXFORMAT_JPEG;
+    fb->timestamp.tv_sec = frame->timestamp_us / 1000000;
+    fb->timestamp.tv_usec = frame->timestamp_us % 1000000;
+    s_fb_frame[frame->index] = frame;
+    return fb;
 }
 
 void esp_camera_fb_return(camera_fb_t *fb)
 {
-    xEventGroupSetBits(s_evt_handle, BIT2_NEW_FRAME_END);
-    return;
-}
+    int index = fb - s_fb;
 
-static void onCameraFrameCallback(uvc_frame_t *frame, void *ptr)
-{
-    // Serial.printf("uvc callback! frame_format = %d, seq = %"PRIu32", width = %"PRIu32", height = %"PRIu32", length = %u, ptr = %d\n",
-    //               frame->frame_format, frame->sequence, frame->width, frame->height, frame->data_bytes, (int) ptr);
-    if (!(xEventGroupGetBits(s_evt_handle) & BIT0_FRAME_START)) {
+    if (index < 0 || index >= FRAME_RING_SLOTS) {
         return;
     }
-
-    switch (frame->frame_format) {
-    case UVC_FRAME_FORMAT_MJPEG:
-        s_fb.buf = (uint8_t *)frame->data;
-        s_fb.len = frame->data_bytes;
-        s_fb.width = frame->width;
-        s_fb.height = frame->height;
-        s_fb.buf = (uint8_t *)frame->data;
-        s_fb.format = PIXFORMAT_JPEG;
-        s_fb.timestamp.tv_sec = frame->sequence;
-        xEventGroupSetBits(s_evt_handle, BIT1_NEW_FRAME_START);
-        // Serial.printf("send frame = %"PRIu32"", frame->sequence);
-        xEventGroupWaitBits(s_evt_handle, BIT2_NEW_FRAME_END, true, true, portMAX_DELAY);
-        // Serial.printf("send frame done = %"PRIu32"", frame->sequence);
-        break;
-    default:
-        ESP_LOGW(TAG, "Format not supported");
-        assert(0);
-        break;
-    }
+    usb->uvcFrameRelease(s_fb_frame[index]);
+    s_fb_frame[index] = NULL;
 }
 
 void setup()
@@ -176,7 +177,7 @@ void setup()
     }
 
     // Instantiate an object
-    USB_STREAM *usb = new USB_STREAM();
+    usb = new USB_STREAM();
 
     // allocate memory
     uint8_t *_xferBufferA = (uint8_t *)malloc(55 * 1024);
@@ -189,8 +190,11 @@ void setup()
     // Config the parameter
     usb->uvcConfiguration(FRAME_RESOLUTION_ANY, FRAME_RESOLUTION_ANY, FRAME_INTERVAL_FPS_15, 55 * 1024, _xferBufferA, _xferBufferB, 55 * 1024, _frameBuffer);
 
-    //Register the camera frame callback function
-    usb->uvcCamRegisterCb(&onCameraFrameCallback, NULL);
+    // Frames are copied out of the frame buffer into the ring, consumers take the newest one
+    if (!usb->uvcFrameRingConfiguration(FRAME_RING_SLOTS, FRAME_SLOT_SIZE, UVC_FRAME_RING_LATEST)) {
+        Serial.println("Frame ring alloc failed");
+        assert(0);
+    }
 
     usb->start();
 
@@ -215,6 +219,11 @@ void setup()
 
 void loop()
 {
-    Serial.println(millis());
+    uvc_frame_ring_stats_t stats;
+
+    usb->uvcFrameRingStats(&stats);
+    Serial.printf("%lu ms frames: captured %u, delivered %u, overwritten %u, dropped %u (busy) %u (too large), held %u (max %u)\n",
+                  millis(), stats.captured, stats.delivered, stats.overwritten,
+                  stats.dropped_busy, stats.dropped_oversize, stats.held, stats.held_max);
     vTaskDelay(10000);
 }
@@ -0,0 +1,130 @@
+/**
+ * @file      bench_modbusmaster.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      ModbusMaster: whole RTU transactions, request framing and CRC out,
+ *            response CRC check and register unpacking in. The canned response is
+ *            fed from the preTransmission hook because the master drains the
+ *            receive side right before it sends.
+ */
+#ifndef ARDUINO     /* PC tool, PlatformIO compiles every file below src_dir */
+
+#include "Arduino.h"
+#include "ModbusMaster.h"
+#include "host_bench.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define SLAVE_ID        1
+#define REGISTERS       32
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE TYPES -------------------------------------------------------- */
+
+struct modbus_ctx_s {
+    HbStream serial;
+    ModbusMaster node;
+    uint8_t read_rsp[3 + 2 * REGISTERS + 2];
+    uint8_t write_rsp[8];
+    const uint8_t *next_rsp;
+    size_t next_len;
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+static struct modbus_ctx_s *hook_ctx;
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static void pre_transmission(void)
+{
+    hook_ctx->serial.feed(hook_ctx->next_rsp, hook_ctx->next_len);
+}
+
+static size_t append_crc(uint8_t *frame, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+
+    for (size_t i = 0; i < len; i++) {
+        crc = crc16_update(crc, frame[i]);
+    }
+    frame[len] = lowByte(crc);
+    frame[len + 1] = highByte(crc);
+    return len + 2;
+}
+
+static uint32_t read_registers(void *arg, uint32_t iterations)
+{
+    struct modbus_ctx_s *c = (struct modbus_ctx_s *)arg;
+    uint32_t sum = 0;
+
+    c->next_rsp = c->read_rsp;
+    c->next_len = sizeof(c->read_rsp);
+    while (iterations--) {
+        if (c->node.readHoldingRegisters(0, REGISTERS) == c->node.ku8MBSuccess) {
+            sum += c->node.getResponseBuffer(REGISTERS - 1);
+        }
+    }
+    return sum;
+}
+
+static uint32_t write_registers(void *arg, uint32_t iterations)
+{
+    struct modbus_ctx_s *c = (struct modbus_ctx_s *)arg;
+    uint32_t ok = 0;
+
+    c->next_rsp = c->write_rsp;
+    c->next_len = sizeof(c->write_rsp);
+    while (iterations--) {
+        for (uint8_t i = 0; i < REGISTERS; i++) {
+            c->node.setTransmitBuffer(i, (uint16_t)(i * 257 + iterations));
+        }
+        ok += c->node.writeMultipleRegisters(0, REGISTERS) == c->node.ku8MBSuccess;
+    }
+    return ok;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS DEFINITION ------------------------------------------ */
+
+void bench_modbusmaster(void)
+{
+    static struct modbus_ctx_s ctx;
+    struct modbus_ctx_s *c = &ctx;
+    size_t n = 0;
+
+    c->read_rsp[n++] = SLAVE_ID;
+    c->read_rsp[n++] = 0x03;
+    c->read_rsp[n++] = 2 * REGISTERS;
+    for (int i = 0; i < REGISTERS; i++) {
+        c->read_rsp[n++] = (uint8_t)(i >> 8);
+        c->read_rsp[n++] = (uint8_t)(i * 3);
+    }
+    append_crc(c->read_rsp, n);
+
+    n = 0;
+    c->write_rsp[n++] = SLAVE_ID;
+    c->write_rsp[n++] = 0x10;
+    c->write_rsp[n++] = 0x00;
+    c->write_rsp[n++] = 0x00;
+    c->write_rsp[n++] = 0x00;
+    c->write_rsp[n++] = REGISTERS;
+    append_crc(c->write_rsp, n);
+
+    hook_ctx = c;
+    c->node.begin(SLAVE_ID, c->serial);
+    c->node.preTransmission(pre_transmission);
+
+    if (hb_check(read_registers(c, 1) == (uint8_t)((REGISTERS - 1) * 3), "modbusmaster.read_holding_32")) {
+        hb_case("modbusmaster.read_holding_32", 2 * REGISTERS, read_registers, c);
+    }
+    if (hb_check(write_registers(c, 1) == 1, "modbusmaster.write_multiple_32")) {
+        hb_case("modbusmaster.write_multiple_32", 2 * REGISTERS, write_registers, c);
+    }
+}
+
+#endif /* ARDUINO */
@@ -0,0 +1,142 @@
+/**
+ * @file      bench_pubsubclient.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      PubSubClient: PUBLISH packets built for a client that swallows them,
+ *            and received ones parsed by loop() up to the callback
+ */
+#ifndef ARDUINO     /* PC tool, PlatformIO compiles every file below src_dir */
+
+#include "Arduino.h"
+#include "PubSubClient.h"
+#include "host_bench.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE TYPES -------------------------------------------------------- */
+
+/* answers CONNECT with an accepted CONNACK and stays connected */
+class BenchClient : public Client {
+public:
+    int connect(IPAddress ip, uint16_t port) override
+    {
+        (void)ip;
+        (void)port;
+        stream.feed(connack, sizeof(connack));
+        is_connected = true;
+        return 1;
+    }
+    int connect(const char *host, uint16_t port) override
+    {
+        (void)host;
+        return connect(IPAddress(), port);
+    }
+    size_t write(uint8_t c) override { return stream.write(c); }
+    size_t write(const uint8_t *buf, size_t size) override { return stream.write(buf, size); }
+    int available() override { return stream.available(); }
+    int read() override { return stream.read(); }
+    int read(uint8_t *buf, size_t size) override { return (int)stream.readBytes(buf, size); }
+    int peek() override { return stream.peek(); }
+    void flush() override {}
+    void stop() override {}
+    uint8_t connected() override { return is_connected; }
+    operator bool() override { return is_connected; }
+
+    HbStream stream;
+    bool is_connected = false;
+
+private:
+    static constexpr uint8_t connack[4] = { 0x20, 0x02, 0x00, 0x00 };
+};
+
+struct mqtt_ctx_s {
+    BenchClient client;
+    PubSubClient mqtt;
+    uint8_t payload[128];
+    uint8_t packet[192];
+    size_t packet_len;
+    uint32_t received;
+
+    mqtt_ctx_s() : mqtt(client) {}
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+static const char topic[] = "t-eth/sensors/bme280/telemetry";
+static struct mqtt_ctx_s *cb_ctx;
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static uint32_t publish(void *arg, uint32_t iterations)
+{
+    struct mqtt_ctx_s *c = (struct mqtt_ctx_s *)arg;
+
+    while (iterations--) {
+        c->mqtt.publish(topic, c->payload, sizeof(c->payload));
+    }
+    return c->client.stream.last;
+}
+
+static uint32_t receive(void *arg, uint32_t iterations)
+{
+    struct mqtt_ctx_s *c = (struct mqtt_ctx_s *)arg;
+
+    while (iterations--) {
+        c->client.stream.feed(c->packet, c->packet_len);
+        c->mqtt.loop();
+    }
+    return c->received;
+}
+
+static void callback(char *topic_name, uint8_t *payload, unsigned int length)
+{
+    cb_ctx->received += length + (uint8_t)topic_name[0] + payload[length - 1];
+}
+
+/* QoS 0 PUBLISH as a broker sends it */
+static size_t build_publish(uint8_t *buf, const uint8_t *payload, size_t len)
+{
+    size_t topic_len = strlen(topic), remaining = 2 + topic_len + len, n = 0;
+
+    buf[n++] = 0x30;
+    buf[n++] = (uint8_t)((remaining & 0x7f) | 0x80);
+    buf[n++] = (uint8_t)(remaining >> 7);
+    buf[n++] = (uint8_t)(topic_len >> 8);
+    buf[n++] = (uint8_t)topic_len;
+    memcpy(&buf[n], topic, topic_len);
+    n += topic_len;
+    memcpy(&buf[n], payload, len);
+    return n + len;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS DEFINITION ------------------------------------------ */
+
+void bench_pubsubclient(void)
+{
+    static struct mqtt_ctx_s ctx;
+    struct mqtt_ctx_s *c = &ctx;
+
+    for (size_t i = 0; i < sizeof(c->payload); i++) {
+        c->payload[i] = (uint8_t)('a' + i % 26);
+    }
+    c->packet_len = build_publish(c->packet, c->payload, sizeof(c->payload));
+    cb_ctx = c;
+    c->mqtt.setServer("broker.local", 1883);
+    c->mqtt.setCallback(callback);
+    if (!hb_check(c->mqtt.connect("host_bench"), "pubsubclient")) {
+        return;
+    }
+
+    if (hb_check(c->mqtt.publish(topic, c->payload, sizeof(c->payload)), "pubsubclient.publish_128B")) {
+        hb_case("pubsubclient.publish_128B", sizeof(c->payload), publish, c);
+    }
+    receive(c, 1);
+    if (hb_check(c->received != 0, "pubsubclient.loop_receive_128B")) {
+        hb_case("pubsubclient.loop_receive_128B", sizeof(c->payload), receive, c);
+    }
+}
+
+#endif /* ARDUINO */
@@ -0,0 +1,129 @@
+/**
+ * @file      bench_radiolib.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      RadioLib: the software CRC and the AES-128 used by LoRaWAN, on frames
+ *            of the sizes a LoRa link carries. Built as RadioLib's generic, non
+ *            Arduino flavour, no radio module is involved.
+ */
+#ifndef ARDUINO     /* PC tool, PlatformIO compiles every file below src_dir */
+
+#include "RadioLib.h"
+#include "host_bench.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define FRAME_LEN       255     /* largest LoRa payload */
+#define LORAWAN_LEN     64      /* a LoRaWAN uplink, whole AES blocks */
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE TYPES -------------------------------------------------------- */
+
+struct radiolib_ctx_s {
+    uint8_t frame[FRAME_LEN];
+    uint8_t plain[LORAWAN_LEN];
+    uint8_t cipher[LORAWAN_LEN];
+    uint8_t mac[16];
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static uint32_t crc16_ccitt(void *arg, uint32_t iterations)
+{
+    struct radiolib_ctx_s *c = (struct radiolib_ctx_s *)arg;
+    uint32_t sum = 0;
+
+    RadioLibCRCInstance.size = 16;
+    RadioLibCRCInstance.poly = RADIOLIB_CRC_CCITT_POLY;
+    RadioLibCRCInstance.init = RADIOLIB_CRC_CCITT_INIT;
+    RadioLibCRCInstance.out = RADIOLIB_CRC_CCITT_OUT;
+    RadioLibCRCInstance.refIn = false;
+    RadioLibCRCInstance.refOut = false;
+    while (iterations--) {
+        sum += RadioLibCRCInstance.checksum(c->frame, sizeof(c->frame));
+    }
+    return sum;
+}
+
+/* reflected in and out, the IEEE 802.3 CRC */
+static uint32_t crc32_reflected(void *arg, uint32_t iterations)
+{
+    struct radiolib_ctx_s *c = (struct radiolib_ctx_s *)arg;
+    uint32_t sum = 0;
+
+    RadioLibCRCInstance.size = 32;
+    RadioLibCRCInstance.poly = 0x04C11DB7;
+    RadioLibCRCInstance.init = 0xFFFFFFFF;
+    RadioLibCRCInstance.out = 0xFFFFFFFF;
+    RadioLibCRCInstance.refIn = true;
+    RadioLibCRCInstance.refOut = true;
+    while (iterations--) {
+        sum += RadioLibCRCInstance.checksum(c->frame, sizeof(c->frame));
+    }
+    return sum;
+}
+
+static uint32_t aes_encrypt(void *arg, uint32_t iterations)
+{
+    struct radiolib_ctx_s *c = (struct radiolib_ctx_s *)arg;
+
+    while (iterations--) {
+        RadioLibAES128Instance.encryptECB(c->plain, sizeof(c->plain), c->cipher);
+    }
+    return c->cipher[0];
+}
+
+static uint32_t aes_decrypt(void *arg, uint32_t iterations)
+{
+    struct radiolib_ctx_s *c = (struct radiolib_ctx_s *)arg;
+
+    while (iterations--) {
+        RadioLibAES128Instance.decryptECB(c->cipher, sizeof(c->cipher), c->plain);
+    }
+    return c->plain[0];
+}
+
+static uint32_t cmac(void *arg, uint32_t iterations)
+{
+    struct radiolib_ctx_s *c = (struct radiolib_ctx_s *)arg;
+
+    while (iterations--) {
+        RadioLibAES128Instance.generateCMAC(c->plain, sizeof(c->plain), c->mac);
+    }
+    return c->mac[0];
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS DEFINITION ------------------------------------------ */
+
+void bench_radiolib(void)
+{
+    /* RFC 4493 example key */
+    static uint8_t key[16] = {
+        0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+    };
+    static struct radiolib_ctx_s ctx;
+    struct radiolib_ctx_s *c = &ctx;
+
+    for (size_t i = 0; i < sizeof(c->frame); i++) {
+        c->frame[i] = (uint8_t)(i * 31 + 7);
+    }
+    memcpy(c->plain, c->frame, sizeof(c->plain));
+    RadioLibAES128Instance.init(key);
+    aes_encrypt(c, 1);
+    aes_decrypt(c, 1);
+    if (!hb_check(memcmp(c->plain, c->frame, sizeof(c->plain)) == 0, "radiolib.aes128")) {
+        return;
+    }
+
+    hb_case("radiolib.crc16_ccitt_255B", FRAME_LEN, crc16_ccitt, c);
+    hb_case("radiolib.crc32_reflected_255B", FRAME_LEN, crc32_reflected, c);
+    hb_case("radiolib.aes128_ecb_encrypt_64B", LORAWAN_LEN, aes_encrypt, c);
+    hb_case("radiolib.aes128_ecb_decrypt_64B", LORAWAN_LEN, aes_decrypt, c);
+    hb_case("radiolib.aes128_cmac_64B", LORAWAN_LEN, cmac, c);
+}
+
+#endif /* ARDUINO */
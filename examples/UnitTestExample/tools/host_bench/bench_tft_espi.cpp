@@ -0,0 +1,146 @@
+/**
+ * @file      bench_tft_espi.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      TFT_eSPI: sprite drawing in RAM, and a sprite pushed to the panel
+ *            through the generic processor code and an SPI stub that drops the bytes.
+ *            The driver and the fonts come from the definitions in CMakeLists.txt.
+ */
+#ifndef ARDUINO     /* PC tool, PlatformIO compiles every file below src_dir */
+
+#include "Arduino.h"
+#include "TFT_eSPI.h"
+#include "host_bench.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define SPRITE_W        160
+#define SPRITE_H        128
+#define ICON_SIZE       32
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE TYPES -------------------------------------------------------- */
+
+struct tft_ctx_s {
+    TFT_eSPI tft;
+    TFT_eSprite sprite;
+    uint16_t icon[ICON_SIZE * ICON_SIZE];
+
+    tft_ctx_s() : sprite(&tft) {}
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static uint32_t pixel_sum(struct tft_ctx_s *c)
+{
+    return c->sprite.readPixel(SPRITE_W / 2, SPRITE_H / 2) + c->sprite.readPixel(3, 5);
+}
+
+static uint32_t fill_rects(void *arg, uint32_t iterations)
+{
+    struct tft_ctx_s *c = (struct tft_ctx_s *)arg;
+
+    while (iterations--) {
+        c->sprite.fillSprite(TFT_BLACK);
+        for (int y = 0; y < SPRITE_H; y += 16) {
+            for (int x = 0; x < SPRITE_W; x += 20) {
+                c->sprite.fillRect(x + 1, y + 1, 18, 14, (uint32_t)(x * 97 + y * 31 + iterations));
+            }
+        }
+    }
+    return pixel_sum(c);
+}
+
+static uint32_t lines(void *arg, uint32_t iterations)
+{
+    struct tft_ctx_s *c = (struct tft_ctx_s *)arg;
+
+    while (iterations--) {
+        for (int x = 0; x < SPRITE_W; x += 4) {
+            c->sprite.drawLine(0, 0, x, SPRITE_H - 1, TFT_GREEN);
+        }
+        for (int y = 0; y < SPRITE_H; y += 4) {
+            c->sprite.drawLine(SPRITE_W - 1, 0, 0, y, TFT_YELLOW);
+        }
+    }
+    return pixel_sum(c);
+}
+
+static uint32_t circles(void *arg, uint32_t iterations)
+{
+    struct tft_ctx_s *c = (struct tft_ctx_s *)arg;
+
+    while (iterations--) {
+        for (int r = 4; r < SPRITE_H / 2; r += 6) {
+            c->sprite.fillCircle(SPRITE_W / 2, SPRITE_H / 2, r, (uint32_t)(r * 1234 + iterations));
+            c->sprite.drawCircle(SPRITE_W / 2, SPRITE_H / 2, r + 2, TFT_WHITE);
+        }
+    }
+    return pixel_sum(c);
+}
+
+static uint32_t text(void *arg, uint32_t iterations)
+{
+    struct tft_ctx_s *c = (struct tft_ctx_s *)arg;
+    uint32_t width = 0;
+
+    c->sprite.setTextColor(TFT_WHITE, TFT_BLACK);
+    while (iterations--) {
+        width += (uint32_t)c->sprite.drawString("ETH 100M FD", 2, 2, 2);
+        width += (uint32_t)c->sprite.drawString("192.168.1.20", 2, 24, 4);
+        width += (uint32_t)c->sprite.drawNumber((long)iterations, 2, 60, 4);
+    }
+    return width + pixel_sum(c);
+}
+
+static uint32_t push_image(void *arg, uint32_t iterations)
+{
+    struct tft_ctx_s *c = (struct tft_ctx_s *)arg;
+
+    while (iterations--) {
+        for (int x = 0; x + ICON_SIZE <= SPRITE_W; x += ICON_SIZE) {
+            c->sprite.pushImage(x, (int32_t)(iterations % (SPRITE_H - ICON_SIZE)), ICON_SIZE, ICON_SIZE, c->icon);
+        }
+    }
+    return pixel_sum(c);
+}
+
+static uint32_t push_sprite(void *arg, uint32_t iterations)
+{
+    struct tft_ctx_s *c = (struct tft_ctx_s *)arg;
+
+    while (iterations--) {
+        c->sprite.pushSprite(40, 56);
+    }
+    return SPI.sink;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS DEFINITION ------------------------------------------ */
+
+void bench_tft_espi(void)
+{
+    static struct tft_ctx_s ctx;
+    struct tft_ctx_s *c = &ctx;
+
+    for (int i = 0; i < ICON_SIZE * ICON_SIZE; i++) {
+        c->icon[i] = (uint16_t)(i * 2654435761u >> 16);
+    }
+    c->tft.init();
+    c->sprite.setColorDepth(16);
+    if (!hb_check(c->sprite.createSprite(SPRITE_W, SPRITE_H) != nullptr, "tft_espi")) {
+        return;
+    }
+
+    hb_case("tft_espi.sprite_fill_rects", 0, fill_rects, c);
+    hb_case("tft_espi.sprite_lines", 0, lines, c);
+    hb_case("tft_espi.sprite_circles", 0, circles, c);
+    hb_case("tft_espi.sprite_text_fonts_2_4", 0, text, c);
+    hb_case("tft_espi.sprite_push_image_32x32", 5 * ICON_SIZE * ICON_SIZE * 2, push_image, c);
+    hb_case("tft_espi.push_sprite_160x128", SPRITE_W * SPRITE_H * 2, push_sprite, c);
+}
+
+#endif /* ARDUINO */
@@ -0,0 +1,134 @@
+/**
+ * @file      bench_tinygpsplus.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      TinyGPS++: one second of NMEA output of a GNSS receiver fed byte by
+ *            byte and as a block, plus the distance helpers
+ */
+#ifndef ARDUINO     /* PC tool, PlatformIO compiles every file below src_dir */
+
+#include <string>
+#include "Arduino.h"
+#include "TinyGPS++.h"
+#include "host_bench.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE TYPES -------------------------------------------------------- */
+
+struct gps_ctx_s {
+    TinyGPSPlus gps;
+    std::string epoch;
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+/* without the leading $ and the checksum, added by add_sentence */
+static const char *const sentences[] = {
+    "GNRMC,101542.00,A,2234.12345,N,11356.65432,E,0.021,,120724,,,A",
+    "GNVTG,,T,,M,0.021,N,0.039,K,A",
+    "GNGGA,101542.00,2234.12345,N,11356.65432,E,1,12,0.62,32.5,M,-2.7,M,,",
+    "GNGSA,A,3,02,05,13,15,18,20,23,24,29,,,,1.10,0.62,0.91",
+    "GPGSV,3,1,11,02,42,310,43,05,19,052,38,13,35,140,41,15,67,021,45",
+    "GPGSV,3,2,11,18,55,232,44,20,12,092,35,23,08,175,30,24,71,318,46",
+    "GPGSV,3,3,11,29,22,274,39,30,05,199,,36,49,145,40",
+    "GNGLL,2234.12345,N,11356.65432,E,101542.00,A,A",
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static void add_sentence(std::string &out, const char *body)
+{
+    uint8_t sum = 0;
+    char tail[8];
+
+    for (const char *p = body; *p; p++) {
+        sum ^= (uint8_t)*p;
+    }
+    snprintf(tail, sizeof(tail), "*%02X\r\n", sum);
+    out += '$';
+    out += body;
+    out += tail;
+}
+
+static uint32_t encode_chars(void *arg, uint32_t iterations)
+{
+    struct gps_ctx_s *c = (struct gps_ctx_s *)arg;
+
+    while (iterations--) {
+        for (char ch : c->epoch) {
+            c->gps.encode(ch);
+        }
+    }
+    return c->gps.passedChecksum();
+}
+
+static uint32_t encode_block(void *arg, uint32_t iterations)
+{
+    struct gps_ctx_s *c = (struct gps_ctx_s *)arg;
+    uint32_t sentences_ok = 0;
+
+    while (iterations--) {
+        sentences_ok += (uint32_t)c->gps.encode(c->epoch.data(), c->epoch.size());
+    }
+    return sentences_ok;
+}
+
+static uint32_t distance_e7(void *arg, uint32_t iterations)
+{
+    int32_t lat = 225687242, lng = 1139442387;
+    uint32_t sum = 0;
+
+    (void)arg;
+    while (iterations--) {
+        sum += TinyGPSPlus::distanceBetweenE7(lat, lng, 312304167, 1214737222);
+        sum += TinyGPSPlus::courseToE7(lat, lng, 312304167, 1214737222);
+        lat += 13;
+    }
+    return sum;
+}
+
+#if !_GPS_FIXED_POINT
+static uint32_t distance_float(void *arg, uint32_t iterations)
+{
+    double lat = 22.5687242, lng = 113.9442387, sum = 0;
+
+    (void)arg;
+    while (iterations--) {
+        sum += TinyGPSPlus::distanceBetween(lat, lng, 31.2304167, 121.4737222);
+        sum += TinyGPSPlus::courseTo(lat, lng, 31.2304167, 121.4737222);
+        lat += 1.3e-6;
+    }
+    return (uint32_t)sum;
+}
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS DEFINITION ------------------------------------------ */
+
+void bench_tinygpsplus(void)
+{
+    static struct gps_ctx_s ctx;
+    struct gps_ctx_s *c = &ctx;
+
+    for (const char *s : sentences) {
+        add_sentence(c->epoch, s);
+    }
+
+    encode_chars(c, 1);
+    if (!hb_check(c->gps.passedChecksum() == sizeof(sentences) / sizeof(sentences[0])
+                  && c->gps.failedChecksum() == 0 && c->gps.location.isValid(), "tinygpsplus")) {
+        return;
+    }
+
+    hb_case("tinygpsplus.encode_epoch_chars", (uint32_t)c->epoch.size(), encode_chars, c);
+    hb_case("tinygpsplus.encode_epoch_block", (uint32_t)c->epoch.size(), encode_block, c);
+    hb_case("tinygpsplus.distance_course_e7", 0, distance_e7, c);
+#if !_GPS_FIXED_POINT
+    hb_case("tinygpsplus.distance_course_float", 0, distance_float, c);
+#endif
+}
+
+#endif /* ARDUINO */
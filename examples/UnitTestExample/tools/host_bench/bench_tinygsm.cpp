@@ -0,0 +1,115 @@
+/**
+ * @file      bench_tinygsm.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      TinyGSM SIM7600: AT command out, canned modem answer parsed back. Every
+ *            answer is complete and ends in OK, so no case waits on a timeout.
+ */
+#ifndef ARDUINO     /* PC tool, PlatformIO compiles every file below src_dir */
+
+#include "Arduino.h"
+#include "TinyGsmClientSIM7600.h"
+#include "host_bench.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE TYPES -------------------------------------------------------- */
+
+struct gsm_ctx_s {
+    HbStream serial;
+    TinyGsmSim7600 modem;
+
+    gsm_ctx_s() : modem(serial) {}
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+static const char csq_rsp[] = "\r\n+CSQ: 23,99\r\n\r\nOK\r\n";
+static const char cgreg_rsp[] = "\r\n+CGREG: 0,1\r\n\r\nOK\r\n";
+static const char cclk_rsp[] = "\r\n+CCLK: \"24/07/12,10:15:42+32\"\r\n\r\nOK\r\n";
+static const char gnss_rsp[] = "\r\n+CGNSSINFO: 2,06,03,00,2234.123456,N,11356.654321,E,120724,101542.0,"
+                               "32.5,0.0,255.0,,1.1,0.8,0.7,\r\n\r\nOK\r\n";
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static uint32_t signal_quality(void *arg, uint32_t iterations)
+{
+    struct gsm_ctx_s *c = (struct gsm_ctx_s *)arg;
+    uint32_t sum = 0;
+
+    while (iterations--) {
+        c->serial.feed(csq_rsp);
+        sum += (uint32_t)c->modem.getSignalQuality();
+    }
+    return sum;
+}
+
+static uint32_t registration(void *arg, uint32_t iterations)
+{
+    struct gsm_ctx_s *c = (struct gsm_ctx_s *)arg;
+    uint32_t sum = 0;
+
+    while (iterations--) {
+        c->serial.feed(cgreg_rsp);
+        sum += (uint32_t)c->modem.getRegistrationStatus();
+    }
+    return sum;
+}
+
+static uint32_t network_time(void *arg, uint32_t iterations)
+{
+    struct gsm_ctx_s *c = (struct gsm_ctx_s *)arg;
+    int year, month, day, hour, minute, second;
+    float tz;
+    uint32_t sum = 0;
+
+    while (iterations--) {
+        c->serial.feed(cclk_rsp);
+        if (c->modem.getNetworkTime(&year, &month, &day, &hour, &minute, &second, &tz)) {
+            sum += (uint32_t)(year + second);
+        }
+    }
+    return sum;
+}
+
+static uint32_t gnss_info(void *arg, uint32_t iterations)
+{
+    struct gsm_ctx_s *c = (struct gsm_ctx_s *)arg;
+    float lat, lon, speed, alt;
+    uint32_t sum = 0;
+
+    while (iterations--) {
+        c->serial.feed(gnss_rsp);
+        if (c->modem.getGPS(&lat, &lon, &speed, &alt)) {
+            sum += (uint32_t)(lat + lon + alt);
+        }
+    }
+    return sum;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS DEFINITION ------------------------------------------ */
+
+void bench_tinygsm(void)
+{
+    static struct gsm_ctx_s ctx;
+    struct gsm_ctx_s *c = &ctx;
+
+    if (hb_check(signal_quality(c, 1) == 23, "tinygsm.sim7600_csq")) {
+        hb_case("tinygsm.sim7600_csq", sizeof(csq_rsp) - 1, signal_quality, c);
+    }
+    if (hb_check(registration(c, 1) == REG_OK_HOME, "tinygsm.sim7600_cgreg")) {
+        hb_case("tinygsm.sim7600_cgreg", sizeof(cgreg_rsp) - 1, registration, c);
+    }
+    if (hb_check(network_time(c, 1) == 2024 + 42, "tinygsm.sim7600_cclk")) {
+        hb_case("tinygsm.sim7600_cclk", sizeof(cclk_rsp) - 1, network_time, c);
+    }
+    /* 22.568 N + 113.944 E + 32.5 m */
+    if (hb_check(gnss_info(c, 1) == 169, "tinygsm.sim7600_cgnssinfo")) {
+        hb_case("tinygsm.sim7600_cgnssinfo", sizeof(gnss_rsp) - 1, gnss_info, c);
+    }
+}
+
+#endif /* ARDUINO */
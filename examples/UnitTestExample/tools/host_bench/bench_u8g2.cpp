@@ -0,0 +1,153 @@
+/**
+ * @file      bench_u8g2.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      U8g2: drawing into the full frame buffer of a 128x64 SSD1306 and sending
+ *            it through the display driver to a byte callback that drops it. The
+ *            vendored clib carries only the u8x8 fonts, text is drawn with those.
+ */
+#ifndef ARDUINO     /* PC tool, PlatformIO compiles every file below src_dir */
+
+#include "u8g2.h"
+#include "host_bench.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define WIDTH           128
+#define HEIGHT          64
+#define ICON_SIZE       16
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE TYPES -------------------------------------------------------- */
+
+struct u8g2_ctx_s {
+    u8g2_t u8g2;
+    uint8_t icon[ICON_SIZE * ICON_SIZE / 8];
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static uint32_t buffer_sum(struct u8g2_ctx_s *c)
+{
+    const uint8_t *buf = u8g2_GetBufferPtr(&c->u8g2);
+
+    return buf[0] + buf[WIDTH * HEIGHT / 8 / 2] + buf[WIDTH * HEIGHT / 8 - 1];
+}
+
+static uint32_t boxes(void *arg, uint32_t iterations)
+{
+    struct u8g2_ctx_s *c = (struct u8g2_ctx_s *)arg;
+
+    while (iterations--) {
+        u8g2_ClearBuffer(&c->u8g2);
+        for (int y = 0; y < HEIGHT; y += 8) {
+            for (int x = 0; x < WIDTH; x += 16) {
+                if ((x + y) & 8) {
+                    u8g2_DrawBox(&c->u8g2, x + 1, y + 1, 14, 6);
+                } else {
+                    u8g2_DrawFrame(&c->u8g2, x + 1, y + 1, 14, 6);
+                }
+            }
+        }
+    }
+    return buffer_sum(c);
+}
+
+static uint32_t lines(void *arg, uint32_t iterations)
+{
+    struct u8g2_ctx_s *c = (struct u8g2_ctx_s *)arg;
+
+    while (iterations--) {
+        u8g2_ClearBuffer(&c->u8g2);
+        for (int x = 0; x < WIDTH; x += 4) {
+            u8g2_DrawLine(&c->u8g2, 0, 0, x, HEIGHT - 1);
+        }
+        for (int y = 0; y < HEIGHT; y += 4) {
+            u8g2_DrawLine(&c->u8g2, WIDTH - 1, 0, 0, y);
+        }
+    }
+    return buffer_sum(c);
+}
+
+static uint32_t circles(void *arg, uint32_t iterations)
+{
+    struct u8g2_ctx_s *c = (struct u8g2_ctx_s *)arg;
+
+    while (iterations--) {
+        u8g2_ClearBuffer(&c->u8g2);
+        u8g2_DrawDisc(&c->u8g2, WIDTH / 4, HEIGHT / 2, 20, U8G2_DRAW_ALL);
+        for (int r = 2; r < HEIGHT / 2; r += 3) {
+            u8g2_DrawCircle(&c->u8g2, 3 * WIDTH / 4, HEIGHT / 2, r, U8G2_DRAW_ALL);
+        }
+    }
+    return buffer_sum(c);
+}
+
+static uint32_t xbm(void *arg, uint32_t iterations)
+{
+    struct u8g2_ctx_s *c = (struct u8g2_ctx_s *)arg;
+
+    while (iterations--) {
+        u8g2_ClearBuffer(&c->u8g2);
+        for (int y = 0; y + ICON_SIZE <= HEIGHT; y += ICON_SIZE) {
+            for (int x = 0; x + ICON_SIZE <= WIDTH; x += ICON_SIZE) {
+                u8g2_DrawXBM(&c->u8g2, x + (int)(iterations & 3), y, ICON_SIZE, ICON_SIZE, c->icon);
+            }
+        }
+    }
+    return buffer_sum(c);
+}
+
+static uint32_t send_buffer(void *arg, uint32_t iterations)
+{
+    struct u8g2_ctx_s *c = (struct u8g2_ctx_s *)arg;
+
+    while (iterations--) {
+        u8g2_SendBuffer(&c->u8g2);
+    }
+    return buffer_sum(c);
+}
+
+/* straight to the display, 8x8 tiles, bypassing the frame buffer */
+static uint32_t u8x8_text(void *arg, uint32_t iterations)
+{
+    struct u8g2_ctx_s *c = (struct u8g2_ctx_s *)arg;
+    u8x8_t *u8x8 = u8g2_GetU8x8(&c->u8g2);
+    uint32_t cols = 0;
+
+    u8x8_SetFont(u8x8, u8x8_font_chroma48medium8_r);
+    while (iterations--) {
+        for (uint8_t row = 0; row < HEIGHT / 8; row++) {
+            cols += u8x8_DrawString(u8x8, 0, row, "T-ETH 10.0.0.20");
+        }
+    }
+    return cols;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS DEFINITION ------------------------------------------ */
+
+void bench_u8g2(void)
+{
+    static struct u8g2_ctx_s ctx;
+    struct u8g2_ctx_s *c = &ctx;
+
+    for (size_t i = 0; i < sizeof(c->icon); i++) {
+        c->icon[i] = (uint8_t)(i * 37 + 11);
+    }
+    u8g2_Setup_ssd1306_128x64_noname_f(&c->u8g2, U8G2_R0, u8x8_byte_empty, u8x8_dummy_cb);
+    u8g2_InitDisplay(&c->u8g2);
+    u8g2_SetPowerSave(&c->u8g2, 0);
+
+    hb_case("u8g2.boxes_frames", 0, boxes, c);
+    hb_case("u8g2.lines", 0, lines, c);
+    hb_case("u8g2.circles_discs", 0, circles, c);
+    hb_case("u8g2.xbm_16x16", 0, xbm, c);
+    hb_case("u8g2.send_buffer_ssd1306", WIDTH * HEIGHT / 8, send_buffer, c);
+    hb_case("u8g2.u8x8_draw_string_8_rows", 0, u8x8_text, c);
+}
+
+#endif /* ARDUINO */
@@ -0,0 +1,316 @@
+/**
+ * @file      host_bench.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      Linux benchmark of the software paths of the vendored libraries, with
+ *            stubbed Arduino types. The cases run in rounds, each round runs every
+ *            case once, so a busy spell of the machine slows one sample of every
+ *            case instead of all samples of a few. The fastest sample is the result,
+ *            the median shows how noisy the machine was. Results go out as JSON and
+ *            can be compared with a stored baseline, a case slower than the
+ *            threshold fails the run.
+ *
+ * build:  cmake -S . -B build && cmake --build build
+ * usage:  host_bench [--filter text] [--rounds n] [--min-ms ms] [--json out.json]
+ *                    [--baseline baseline.json] [--threshold percent]
+ */
+#ifndef ARDUINO     /* PC tool, PlatformIO compiles every file below src_dir */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "host_bench.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define DEFAULT_ROUNDS      15
+#define DEFAULT_MIN_MS      10      /* shortest sample, the clock and the loop overhead vanish */
+#define DEFAULT_THRESHOLD   10.0    /* percent slower than the baseline that fails */
+#define MAX_ITERATIONS      (1u << 30)
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE TYPES -------------------------------------------------------- */
+
+struct case_s {
+    const char  *name;
+    uint32_t    bytes_per_op;
+    hb_fn_t     fn;
+    void        *ctx;
+    uint32_t    iterations;     /*!> per sample */
+    std::vector<double> samples; /*!> ns per op, one per round */
+};
+
+struct result_s {
+    std::string name;
+    double      ns_per_op;      /*!> fastest sample, the least disturbed by the rest of the machine */
+    double      median_ns;
+    double      mb_per_s;       /*!> 0 when the case has no byte count */
+    uint32_t    iterations;     /*!> per sample */
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+static void (*const suites[])(void) = {
+    bench_pubsubclient,
+    bench_modbusmaster,
+    bench_tinygsm,
+    bench_tinygpsplus,
+    bench_radiolib,
+    bench_tft_espi,
+    bench_u8g2,
+};
+
+static std::vector<struct case_s> cases;
+static std::vector<struct result_s> results;
+static const char *filter;
+static int rounds = DEFAULT_ROUNDS;
+static uint32_t min_ns = DEFAULT_MIN_MS * 1000000u;
+static volatile uint32_t sink;
+static int failed_checks;
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t time_run(hb_fn_t fn, void *ctx, uint32_t iterations)
+{
+    uint64_t start = now_ns();
+
+    sink += fn(ctx, iterations);
+    return now_ns() - start;
+}
+
+/* grow the count until a sample is long enough, this also warms up the caches */
+static void calibrate(struct case_s &c)
+{
+    uint64_t elapsed;
+
+    c.iterations = 1;
+    while ((elapsed = time_run(c.fn, c.ctx, c.iterations)) < min_ns && c.iterations < MAX_ITERATIONS) {
+        uint64_t next = elapsed ? (uint64_t)c.iterations * min_ns * 11 / 10 / elapsed : (uint64_t)c.iterations * 16;
+        c.iterations = (uint32_t)std::min<uint64_t>(std::max<uint64_t>(next, (uint64_t)c.iterations * 2),
+                       MAX_ITERATIONS);
+    }
+}
+
+static void report(struct case_s &c)
+{
+    struct result_s r;
+
+    std::sort(c.samples.begin(), c.samples.end());
+    r.name = c.name;
+    r.ns_per_op = c.samples[0];
+    r.median_ns = c.samples[c.samples.size() / 2];
+    r.mb_per_s = c.bytes_per_op ? c.bytes_per_op * 1000.0 / r.ns_per_op : 0;
+    r.iterations = c.iterations;
+    results.push_back(r);
+
+    if (r.mb_per_s > 0) {
+        printf("%-40s %12.1f ns/op %12.1f median %10.1f MB/s\n", c.name, r.ns_per_op, r.median_ns, r.mb_per_s);
+    } else {
+        printf("%-40s %12.1f ns/op %12.1f median\n", c.name, r.ns_per_op, r.median_ns);
+    }
+}
+
+static int write_json(const char *path)
+{
+    FILE *f = strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    fprintf(f, "{\n  \"suite\": \"host_bench\",\n  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const struct result_s &r = results[i];
+        fprintf(f, "    {\"name\": \"%s\", \"ns_per_op\": %.2f, \"median_ns\": %.2f, \"mb_per_s\": %.2f, "
+                "\"iterations\": %u}%s\n", r.name.c_str(), r.ns_per_op, r.median_ns, r.mb_per_s, r.iterations,
+                i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    if (f != stdout) {
+        fclose(f);
+    }
+    return 0;
+}
+
+static char *read_file(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    char *buf;
+    long len;
+
+    if (f == NULL) {
+        perror(path);
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    buf = (char *)malloc((size_t)len + 1);
+    if (buf != NULL) {
+        len = (long)fread(buf, 1, (size_t)len, f);
+        buf[len] = '\0';
+    }
+    fclose(f);
+    return buf;
+}
+
+/* ns_per_op of a case in a file written by write_json, negative when it is missing */
+static double baseline_ns(const char *json, const std::string &name)
+{
+    std::string key = "\"name\": \"" + name + "\"";
+    const char *p = strstr(json, key.c_str());
+    const char *end;
+
+    if (p == NULL) {
+        return -1;
+    }
+    end = strchr(p, '}');
+    p = strstr(p, "\"ns_per_op\":");
+    if (p == NULL || (end != NULL && p > end)) {
+        return -1;
+    }
+    return strtod(p + strlen("\"ns_per_op\":"), NULL);
+}
+
+/* @return number of cases slower than the threshold */
+static int compare(const char *path, double threshold)
+{
+    char *json = read_file(path);
+    int regressions = 0;
+
+    if (json == NULL) {
+        return -1;
+    }
+    printf("\n%-40s %12s %12s %9s\n", "case", "baseline ns", "now ns", "change");
+    for (const struct result_s &r : results) {
+        double base = baseline_ns(json, r.name), change;
+
+        if (base <= 0) {
+            printf("%-40s %12s %12.1f %9s\n", r.name.c_str(), "-", r.ns_per_op, "new");
+            continue;
+        }
+        change = (r.ns_per_op - base) * 100.0 / base;
+        printf("%-40s %12.1f %12.1f %+8.1f%%%s\n", r.name.c_str(), base, r.ns_per_op, change,
+               change > threshold ? "  REGRESSION" : "");
+        if (change > threshold) {
+            regressions++;
+        }
+    }
+    free(json);
+    printf("%d regression(s) above %.1f%%\n", regressions, threshold);
+    return regressions;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [--filter text] [--rounds n] [--min-ms ms] [--json out.json]\n"
+            "          [--baseline baseline.json] [--threshold percent]\n", prog);
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS DEFINITION ------------------------------------------ */
+
+void hb_case(const char *name, uint32_t bytes_per_op, hb_fn_t fn, void *ctx)
+{
+    struct case_s c;
+
+    if (filter != NULL && strstr(name, filter) == NULL) {
+        return;
+    }
+    c.name = name;
+    c.bytes_per_op = bytes_per_op;
+    c.fn = fn;
+    c.ctx = ctx;
+    c.iterations = 1;
+    cases.push_back(c);
+}
+
+bool hb_check(bool ok, const char *what)
+{
+    if (!ok) {
+        fprintf(stderr, "%s: check failed, the case is skipped\n", what);
+        failed_checks++;
+    }
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    const char *json = NULL, *baseline = NULL;
+    double threshold = DEFAULT_THRESHOLD;
+    int regressions = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        if (strcmp(arg, "--filter") == 0) {
+            filter = argv[++i];
+        } else if (strcmp(arg, "--rounds") == 0) {
+            rounds = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(arg, "--min-ms") == 0) {
+            min_ns = (uint32_t)std::max(1, atoi(argv[++i])) * 1000000u;
+        } else if (strcmp(arg, "--json") == 0) {
+            json = argv[++i];
+        } else if (strcmp(arg, "--baseline") == 0) {
+            baseline = argv[++i];
+        } else if (strcmp(arg, "--threshold") == 0) {
+            threshold = atof(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    for (auto suite : suites) {
+        suite();
+    }
+    if (failed_checks) {
+        return 2;
+    }
+    if (cases.empty()) {
+        fprintf(stderr, "no case matches \"%s\"\n", filter ? filter : "");
+        return 2;
+    }
+
+    for (struct case_s &c : cases) {
+        calibrate(c);
+    }
+    for (int round = 0; round < rounds; round++) {
+        for (struct case_s &c : cases) {
+            c.samples.push_back((double)time_run(c.fn, c.ctx, c.iterations) / c.iterations);
+        }
+    }
+    for (struct case_s &c : cases) {
+        report(c);
+    }
+
+    if (json != NULL && write_json(json) != 0) {
+        return 2;
+    }
+    if (baseline != NULL && (regressions = compare(baseline, threshold)) < 0) {
+        return 2;
+    }
+    return regressions ? 1 : 0;
+}
+
+#endif /* ARDUINO */
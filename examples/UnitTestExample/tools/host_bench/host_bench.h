@@ -0,0 +1,95 @@
+/**
+ * @file      host_bench.h
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      Timing harness shared by the bench_*.cpp files. A case is a function
+ *            that runs its operation a given number of times, the harness picks
+ *            the count so a run is long enough and reports ns per op.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "Stream.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC TYPES --------------------------------------------------------- */
+
+/**
+@brief Body of a case
+@param ctx pointer given to hb_case
+@param iterations operations to run
+@return anything derived from the results, summed so the compiler keeps the work
+*/
+typedef uint32_t (*hb_fn_t)(void *ctx, uint32_t iterations);
+
+/**
+@class HbStream
+@brief Stream that replays a canned input and swallows the output
+*/
+class HbStream : public Stream {
+public:
+    /* the data is not copied, it must outlive the reads */
+    void feed(const void *data, size_t len)
+    {
+        rx = (const uint8_t *)data;
+        rx_len = len;
+        rx_pos = 0;
+    }
+    void feed(const char *str) { feed(str, strlen(str)); }
+
+    int available() override { return (int)(rx_len - rx_pos); }
+    int read() override { return rx_pos < rx_len ? rx[rx_pos++] : -1; }
+    int peek() override { return rx_pos < rx_len ? rx[rx_pos] : -1; }
+    size_t write(uint8_t c) override { tx_bytes++; last = c; return 1; }
+    size_t write(const uint8_t *buf, size_t size) override
+    {
+        tx_bytes += size;
+        if (size) {
+            last = buf[size - 1];
+        }
+        return size;
+    }
+    using Print::write;
+
+    size_t tx_bytes = 0;
+    uint8_t last = 0;
+
+private:
+    const uint8_t *rx = nullptr;
+    size_t rx_len = 0;
+    size_t rx_pos = 0;
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS PROTOTYPES ------------------------------------------ */
+
+/**
+@brief Add a case, skipped when it does not match the filter. The cases run
+after every library registered its own, ctx must live until the program ends.
+@param name library.operation, the key in the baseline
+@param bytes_per_op bytes one operation handles, 0 when throughput makes no sense
+@param fn case body
+@param ctx passed to fn
+*/
+void hb_case(const char *name, uint32_t bytes_per_op, hb_fn_t fn, void *ctx);
+
+/**
+@brief Check a canned exchange before it is timed, a stub that answers wrong
+would otherwise show up as a fast case. A failed check fails the run.
+@param ok condition that must hold
+@param what case name for the message
+@return ok
+*/
+bool hb_check(bool ok, const char *what);
+
+/* one per library, each calls hb_case for its cases */
+void bench_pubsubclient(void);
+void bench_modbusmaster(void);
+void bench_tinygsm(void);
+void bench_tinygpsplus(void);
+void bench_radiolib(void);
+void bench_tft_espi(void);
+void bench_u8g2(void);
@@ -0,0 +1,459 @@
+/**
+ * @file      Arduino.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      Bodies of the Arduino stubs, see Arduino.h
+ */
+#ifndef ARDUINO     /* PC tool, PlatformIO compiles every file below src_dir */
+
+#include <stdarg.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+#include "Arduino.h"
+#include "SPI.h"
+#include "Wire.h"
+#include "SD.h"
+
+HardwareSerial Serial;
+SPIClass SPI;
+TwoWire Wire;
+SDFS SD;
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static uint64_t monotonic_us(void)
+{
+    static uint64_t start;
+    struct timespec ts;
+    uint64_t now;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    now = (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+    if (start == 0) {
+        start = now;
+    }
+    return now - start;
+}
+
+static String format_unsigned(unsigned long v, int base)
+{
+    char buf[8 * sizeof(long) + 1];
+    char *p = &buf[sizeof(buf) - 1];
+
+    if (base < 2) {
+        base = 10;
+    }
+    *p = '\0';
+    do {
+        unsigned long d = v % (unsigned long)base;
+        *--p = (char)(d < 10 ? '0' + d : 'A' + d - 10);
+        v /= (unsigned long)base;
+    } while (v);
+    return String(p);
+}
+
+static String format_signed(long v, int base)
+{
+    if (base == 10 && v < 0) {
+        return String("-") + format_unsigned(0UL - (unsigned long)v, 10);
+    }
+    return format_unsigned((unsigned long)v, base);
+}
+
+static String format_double(double v, int digits)
+{
+    char buf[64];
+
+    snprintf(buf, sizeof(buf), "%.*f", digits, v);
+    return String(buf);
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS DEFINITION ------------------------------------------ */
+
+extern "C" uint32_t millis(void)
+{
+    return (uint32_t)(monotonic_us() / 1000u);
+}
+
+extern "C" uint32_t micros(void)
+{
+    return (uint32_t)monotonic_us();
+}
+
+extern "C" void delay(uint32_t ms)
+{
+    if (ms) {
+        usleep(ms * 1000u);
+    }
+}
+
+extern "C" void delayMicroseconds(uint32_t us)
+{
+    if (us) {
+        usleep(us);
+    }
+}
+
+extern "C" void yield(void)
+{
+}
+
+extern "C" void pinMode(uint8_t pin, uint8_t mode)
+{
+    (void)pin;
+    (void)mode;
+}
+
+extern "C" void digitalWrite(uint8_t pin, uint8_t val)
+{
+    (void)pin;
+    (void)val;
+}
+
+extern "C" int digitalRead(uint8_t pin)
+{
+    (void)pin;
+    return LOW;
+}
+
+extern "C" void attachInterrupt(uint8_t pin, void (*isr)(void), int mode)
+{
+    (void)pin;
+    (void)isr;
+    (void)mode;
+}
+
+extern "C" void detachInterrupt(uint8_t pin)
+{
+    (void)pin;
+}
+
+extern "C" char *ultoa(unsigned long value, char *str, int base)
+{
+    String s(value, (unsigned char)base);
+
+    memcpy(str, s.c_str(), s.length() + 1);
+    return str;
+}
+
+extern "C" char *ltoa(long value, char *str, int base)
+{
+    String s(value, (unsigned char)base);
+
+    memcpy(str, s.c_str(), s.length() + 1);
+    return str;
+}
+
+extern "C" char *itoa(int value, char *str, int base)
+{
+    return ltoa(value, str, base);
+}
+
+extern "C" char *dtostrf(double value, signed char width, unsigned char prec, char *str)
+{
+    sprintf(str, "%*.*f", width, prec, value);
+    return str;
+}
+
+/* fixed seed, a run draws the same numbers every time */
+static uint32_t random_state = 1;
+
+long random(long max)
+{
+    random_state = random_state * 1103515245u + 12345u;
+    return max > 0 ? (long)((random_state >> 1) % (unsigned long)max) : 0;
+}
+
+long random(long min, long max)
+{
+    return min < max ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long seed)
+{
+    random_state = seed ? (uint32_t)seed : 1;
+}
+
+/* String */
+
+String::String(int v, unsigned char base) : String(format_signed(v, base)) {}
+String::String(unsigned int v, unsigned char base) : String(format_unsigned(v, base)) {}
+String::String(long v, unsigned char base) : String(format_signed(v, base)) {}
+String::String(unsigned long v, unsigned char base) : String(format_unsigned(v, base)) {}
+String::String(float v, unsigned char decimals) : String(format_double(v, decimals)) {}
+String::String(double v, unsigned char decimals) : String(format_double(v, decimals)) {}
+
+String String::substring(unsigned int from, unsigned int to) const
+{
+    if (from > to) {
+        unsigned int t = from;
+        from = to;
+        to = t;
+    }
+    if (from >= s_.size()) {
+        return String();
+    }
+    return String(s_.substr(from, to - from));
+}
+
+void String::replace(const String &find, const String &replace)
+{
+    size_t pos = 0;
+
+    if (find.s_.empty()) {
+        return;
+    }
+    while ((pos = s_.find(find.s_, pos)) != std::string::npos) {
+        s_.replace(pos, find.s_.size(), replace.s_);
+        pos += replace.s_.size();
+    }
+}
+
+void String::replace(char find, char replace)
+{
+    for (char &c : s_) {
+        if (c == find) {
+            c = replace;
+        }
+    }
+}
+
+void String::trim()
+{
+    size_t begin = 0, end = s_.size();
+
+    while (begin < end && isspace((unsigned char)s_[begin])) {
+        begin++;
+    }
+    while (end > begin && isspace((unsigned char)s_[end - 1])) {
+        end--;
+    }
+    s_ = s_.substr(begin, end - begin);
+}
+
+void String::toUpperCase()
+{
+    for (char &c : s_) {
+        c = (char)toupper((unsigned char)c);
+    }
+}
+
+void String::toLowerCase()
+{
+    for (char &c : s_) {
+        c = (char)tolower((unsigned char)c);
+    }
+}
+
+void String::toCharArray(char *buf, unsigned int size, unsigned int index) const
+{
+    unsigned int n;
+
+    if (size == 0) {
+        return;
+    }
+    n = index < s_.size() ? (unsigned int)s_.size() - index : 0;
+    if (n > size - 1) {
+        n = size - 1;
+    }
+    memcpy(buf, s_.c_str() + (index < s_.size() ? index : 0), n);
+    buf[n] = '\0';
+}
+
+/* Print */
+
+size_t Print::write(const uint8_t *buf, size_t size)
+{
+    size_t n = 0;
+
+    while (size--) {
+        n += write(*buf++);
+    }
+    return n;
+}
+
+size_t Print::print(long v, int base)
+{
+    return print(format_signed(v, base));
+}
+
+size_t Print::print(unsigned long v, int base)
+{
+    return print(format_unsigned(v, base));
+}
+
+size_t Print::print(double v, int digits)
+{
+    return print(format_double(v, digits));
+}
+
+size_t Print::printf(const char *format, ...)
+{
+    char buf[256];
+    va_list args;
+    int len;
+
+    va_start(args, format);
+    len = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (len < 0) {
+        return 0;
+    }
+    return write((const uint8_t *)buf, (size_t)len < sizeof(buf) ? (size_t)len : sizeof(buf) - 1);
+}
+
+/* Stream */
+
+int Stream::timedRead()
+{
+    uint32_t start = millis();
+    int c;
+
+    do {
+        if ((c = read()) >= 0) {
+            return c;
+        }
+    } while (millis() - start < _timeout);
+    return -1;
+}
+
+int Stream::timedPeek()
+{
+    uint32_t start = millis();
+    int c;
+
+    do {
+        if ((c = peek()) >= 0) {
+            return c;
+        }
+    } while (millis() - start < _timeout);
+    return -1;
+}
+
+int Stream::peekNextDigit(bool detectDecimal)
+{
+    int c;
+
+    while ((c = timedPeek()) >= 0) {
+        if (c == '-' || (c >= '0' && c <= '9') || (detectDecimal && c == '.')) {
+            return c;
+        }
+        read();
+    }
+    return -1;
+}
+
+bool Stream::find(const char *target)
+{
+    size_t len = strlen(target), matched = 0;
+    int c;
+
+    if (len == 0) {
+        return true;
+    }
+    while ((c = timedRead()) >= 0) {
+        matched = c == target[matched] ? matched + 1 : (c == target[0] ? 1 : 0);
+        if (matched == len) {
+            return true;
+        }
+    }
+    return false;
+}
+
+long Stream::parseInt()
+{
+    bool negative = false;
+    long value = 0;
+    int c = peekNextDigit(false);
+
+    if (c < 0) {
+        return 0;
+    }
+    do {
+        if (c == '-') {
+            negative = true;
+        } else if (c >= '0' && c <= '9') {
+            value = value * 10 + c - '0';
+        }
+        read();
+        c = timedPeek();
+    } while ((c >= '0' && c <= '9'));
+    return negative ? -value : value;
+}
+
+float Stream::parseFloat()
+{
+    bool negative = false, fraction = false;
+    double value = 0, scale = 1;
+    int c = peekNextDigit(true);
+
+    if (c < 0) {
+        return 0;
+    }
+    do {
+        if (c == '-') {
+            negative = true;
+        } else if (c == '.') {
+            fraction = true;
+        } else {
+            value = value * 10 + c - '0';
+            if (fraction) {
+                scale *= 0.1;
+            }
+        }
+        read();
+        c = timedPeek();
+    } while ((c >= '0' && c <= '9') || (c == '.' && !fraction));
+    value *= scale;
+    return (float)(negative ? -value : value);
+}
+
+size_t Stream::readBytes(char *buffer, size_t length)
+{
+    size_t n = 0;
+    int c;
+
+    while (n < length && (c = timedRead()) >= 0) {
+        buffer[n++] = (char)c;
+    }
+    return n;
+}
+
+size_t Stream::readBytesUntil(char terminator, char *buffer, size_t length)
+{
+    size_t n = 0;
+    int c;
+
+    while (n < length && (c = timedRead()) >= 0 && c != terminator) {
+        buffer[n++] = (char)c;
+    }
+    return n;
+}
+
+String Stream::readString()
+{
+    String ret;
+    int c;
+
+    while ((c = timedRead()) >= 0) {
+        ret += (char)c;
+    }
+    return ret;
+}
+
+String Stream::readStringUntil(char terminator)
+{
+    String ret;
+    int c;
+
+    while ((c = timedRead()) >= 0 && c != terminator) {
+        ret += (char)c;
+    }
+    return ret;
+}
+
+#endif /* ARDUINO */
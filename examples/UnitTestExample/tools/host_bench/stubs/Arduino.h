@@ -0,0 +1,112 @@
+/**
+ * @file      Arduino.h
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      The part of the Arduino core API the benchmarked libraries use, for a
+ *            Linux build. Time comes from the monotonic clock, pins do nothing.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef uint16_t word;
+
+#define HIGH            0x1
+#define LOW             0x0
+#define INPUT           0x01
+#define OUTPUT          0x03
+#define INPUT_PULLUP    0x05
+
+#define CHANGE          0x01
+#define FALLING         0x02
+#define RISING          0x03
+
+/* binary.h, the constants the libraries use */
+#define B111            7
+#define B1000           8
+
+#define DEC             10
+#define HEX             16
+#define OCT             8
+#define BIN             2
+
+#define PI              3.1415926535897932384626433832795
+#define HALF_PI         1.5707963267948966192313216916398
+#define TWO_PI          6.283185307179586476925286766559
+#define DEG_TO_RAD      0.017453292519943295769236907684886
+#define RAD_TO_DEG      57.295779513082320876798154814105
+
+#define radians(deg)    ((deg) * DEG_TO_RAD)
+#define degrees(rad)    ((rad) * RAD_TO_DEG)
+#define sq(x)           ((x) * (x))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define lowByte(w)      ((uint8_t)((w) & 0xff))
+#define highByte(w)     ((uint8_t)((w) >> 8))
+#define bitRead(value, bit)     (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit)      ((value) |= (1UL << (bit)))
+#define bitClear(value, bit)    ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+#define bit(b)          (1UL << (b))
+#define word(...)       makeWord(__VA_ARGS__)
+#define digitalPinToInterrupt(p) (p)
+
+#include "pgmspace.h"
+
+#ifdef __cplusplus
+#include <algorithm>
+using std::min;
+using std::max;
+
+static inline bool isDigit(int c)
+{
+    return c >= '0' && c <= '9';
+}
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+static inline uint16_t makeWord(uint16_t w)
+{
+    return w;
+}
+
+static inline uint16_t makeWord(uint8_t h, uint8_t l)
+{
+    return (uint16_t)((h << 8) | l);
+}
+
+extern "C" {
+#endif
+
+uint32_t millis(void);
+uint32_t micros(void);
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield(void);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode);
+void detachInterrupt(uint8_t pin);
+char *ltoa(long value, char *str, int base);
+char *ultoa(unsigned long value, char *str, int base);
+char *itoa(int value, char *str, int base);
+char *dtostrf(double value, signed char width, unsigned char prec, char *str);
+
+#ifdef __cplusplus
+}
+
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "HardwareSerial.h"
+#endif
@@ -0,0 +1,27 @@
+/**
+ * @file      HardwareSerial.h
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      Serial goes to stdout and never receives anything
+ */
+#pragma once
+
+#include <stdio.h>
+#include "Stream.h"
+
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    operator bool() const { return true; }
+
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+    size_t write(const uint8_t *buf, size_t size) override { return fwrite(buf, 1, size, stdout); }
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,27 @@
+/**
+ * @file      IPAddress.h
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      IPv4 only Arduino IPAddress
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+class IPAddress {
+public:
+    IPAddress() : _addr{0, 0, 0, 0} {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _addr{a, b, c, d} {}
+    IPAddress(uint32_t address) { memcpy(_addr, &address, 4); }
+    IPAddress(const uint8_t *address) { memcpy(_addr, address, 4); }
+
+    operator uint32_t() const { uint32_t v; memcpy(&v, _addr, 4); return v; }
+    bool operator==(const IPAddress &rhs) const { return memcmp(_addr, rhs._addr, 4) == 0; }
+    uint8_t operator[](int index) const { return _addr[index]; }
+    uint8_t &operator[](int index) { return _addr[index]; }
+
+private:
+    uint8_t _addr[4];
+};
@@ -0,0 +1,102 @@
+/**
+ * @file      SD.h
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      SD card backed by a host directory: SD.open("/a/b") opens root + "/a/b".
+ *            Copies of a File share the open file, like the ESP32 FS. The reads
+ *            are counted, so a test sees how much came off the card.
+ */
+#pragma once
+
+#include <stdio.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <memory>
+#include "Arduino.h"
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+struct SDStats {
+    size_t opens;
+    size_t reads;           /*!> read() calls */
+    size_t bytes_read;
+};
+
+class File {
+public:
+    File() {}
+    File(FILE *fp, bool dir, size_t size, time_t mtime, SDStats *stats)
+        : fp_(fp ? std::shared_ptr<FILE>(fp, fclose) : nullptr), dir_(dir), size_(size), mtime_(mtime), stats_(stats) {}
+
+    operator bool() const { return fp_ != nullptr || dir_; }
+    bool isDirectory() const { return dir_; }
+    size_t size() const { return size_; }
+    time_t getLastWrite() const { return mtime_; }
+
+    bool seek(uint32_t pos) { return fp_ && fseek(fp_.get(), pos, SEEK_SET) == 0; }
+    size_t position() const { return fp_ ? (size_t)ftell(fp_.get()) : 0; }
+    size_t read(uint8_t *buf, size_t size)
+    {
+        if (!fp_) {
+            return 0;
+        }
+        size_t n = fread(buf, 1, size, fp_.get());
+        stats_->reads++;
+        stats_->bytes_read += n;
+        return n;
+    }
+    size_t write(const uint8_t *buf, size_t size) { return fp_ ? fwrite(buf, 1, size, fp_.get()) : 0; }
+    void close()
+    {
+        fp_.reset();
+        dir_ = false;
+    }
+
+private:
+    std::shared_ptr<FILE> fp_;
+    bool dir_ = false;
+    size_t size_ = 0;
+    time_t mtime_ = 0;
+    SDStats *stats_ = nullptr;
+};
+
+class SDFS {
+public:
+    bool begin() { return true; }
+
+    File open(const String &path, const char *mode = FILE_READ)
+    {
+        String full = root + path;
+        struct stat st;
+
+        stats.opens++;
+        if (mode[0] == 'r') {
+            if (stat(full.c_str(), &st) != 0) {
+                return File();
+            }
+            if (S_ISDIR(st.st_mode)) {
+                return File(nullptr, true, 0, st.st_mtime, &stats);
+            }
+        }
+        FILE *fp = fopen(full.c_str(), mode[0] == 'r' ? "rb" : mode[0] == 'a' ? "ab" : "wb");
+        if (!fp) {
+            return File();
+        }
+        fstat(fileno(fp), &st);
+        return File(fp, false, (size_t)st.st_size, st.st_mtime, &stats);
+    }
+    bool exists(const String &path)
+    {
+        struct stat st;
+        return stat((root + path).c_str(), &st) == 0;
+    }
+    bool remove(const String &path) { return ::remove((root + path).c_str()) == 0; }
+
+    String root;            /*!> host directory that is the card */
+    SDStats stats = {};
+};
+
+extern SDFS SD;
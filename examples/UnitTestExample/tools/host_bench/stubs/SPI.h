@@ -0,0 +1,115 @@
+/**
+ * @file      SPI.h
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      SPI bus that drops what is written and reads zeros, so only the
+ *            drawing code of a display library is measured. A test can count the
+ *            transactions and transfer calls, and put a device on the bus that
+ *            sees every byte and answers it.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SPI_MODE0   0x00
+#define SPI_MODE1   0x01
+#define SPI_MODE2   0x02
+#define SPI_MODE3   0x03
+
+typedef enum {
+    LSBFIRST = 0,
+    MSBFIRST = 1,
+} BitOrder;
+
+class SPISettings {
+public:
+    SPISettings() {}
+    SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode)
+    {
+        (void)clock;
+        (void)bitOrder;
+        (void)dataMode;
+    }
+};
+
+class SPIClass {
+public:
+    void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1)
+    {
+        (void)sck;
+        (void)miso;
+        (void)mosi;
+        (void)ss;
+    }
+    void end() {}
+    void pins(int8_t sck, int8_t miso, int8_t mosi, int8_t ss) { begin(sck, miso, mosi, ss); }
+    void setHwCs(bool use) { (void)use; }
+    void setFrequency(uint32_t freq) { (void)freq; }
+    void setBitOrder(uint8_t order) { (void)order; }
+    void setDataMode(uint8_t mode) { (void)mode; }
+    void usingInterrupt(int interrupt) { (void)interrupt; }
+    void notUsingInterrupt(int interrupt) { (void)interrupt; }
+    void beginTransaction(SPISettings settings)
+    {
+        (void)settings;
+        transactions++;
+        if (select) {
+            select();
+        }
+    }
+    void endTransaction() {}
+
+    /* the last byte goes to a volatile so the compiler keeps the caller loops */
+    uint8_t transfer(uint8_t data) { transfers++; return exchange(data); }
+    uint16_t transfer16(uint16_t data) { transfers++; sink = (uint8_t)data; return 0; }
+    uint32_t transfer32(uint32_t data) { transfers++; sink = (uint8_t)data; return 0; }
+    void transfer(void *buf, size_t count)
+    {
+        transfers++;
+        for (size_t i = 0; i < count; i++) {
+            ((uint8_t *)buf)[i] = exchange(((uint8_t *)buf)[i]);
+        }
+    }
+    void write(uint8_t data) { transfers++; exchange(data); }
+    void write16(uint16_t data) { transfers++; sink = (uint8_t)data; }
+    void write32(uint32_t data) { transfers++; sink = (uint8_t)data; }
+    void writeBytes(const uint8_t *data, uint32_t size)
+    {
+        transfers++;
+        for (uint32_t i = 0; i < size; i++) {
+            exchange(data[i]);
+        }
+    }
+    /* ESP32 core, NULL out sends 0xFF, NULL in drops what comes back */
+    void transferBytes(const uint8_t *out, uint8_t *in, uint32_t size)
+    {
+        transfers++;
+        for (uint32_t i = 0; i < size; i++) {
+            uint8_t b = exchange(out ? out[i] : 0xFF);
+            if (in) {
+                in[i] = b;
+            }
+        }
+    }
+
+    /* the device, the start of every transaction and then every byte */
+    void (*select)(void) = nullptr;
+    uint8_t (*device)(uint8_t data) = nullptr;
+
+    /* beginTransaction() calls, and calls moving data, a burst counts once */
+    uint32_t transactions = 0;
+    uint32_t transfers = 0;
+
+    volatile uint8_t sink = 0;
+
+private:
+    uint8_t exchange(uint8_t data)
+    {
+        sink = data;
+        return device ? device(data) : 0;
+    }
+};
+
+extern SPIClass SPI;
@@ -0,0 +1,10 @@
+/**
+ * @file      WProgram.h
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      Pre 1.0 name of Arduino.h, taken by the libraries when ARDUINO is not defined
+ */
+#pragma once
+
+#include "Arduino.h"
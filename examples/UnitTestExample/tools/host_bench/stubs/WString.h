@@ -0,0 +1,84 @@
+/**
+ * @file      WString.h
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      Arduino String on top of std::string, with the Arduino semantics the
+ *            libraries rely on: indexes are unsigned, -1 means not found
+ */
+#pragma once
+
+#include <string>
+#include <stdint.h>
+
+class __FlashStringHelper;
+#define F(s)    (s)
+
+class String {
+public:
+    String(const char *s = "") : s_(s ? s : "") {}
+    String(const std::string &s) : s_(s) {}
+    String(char c) : s_(1, c) {}
+    String(int v, unsigned char base = 10);
+    String(unsigned int v, unsigned char base = 10);
+    String(long v, unsigned char base = 10);
+    String(unsigned long v, unsigned char base = 10);
+    String(float v, unsigned char decimals = 2);
+    String(double v, unsigned char decimals = 2);
+
+    unsigned int length() const { return (unsigned int)s_.size(); }
+    const char *c_str() const { return s_.c_str(); }
+    bool reserve(unsigned int size) { s_.reserve(size); return true; }
+
+    String &operator+=(const String &rhs) { s_ += rhs.s_; return *this; }
+    String &operator+=(const char *rhs) { s_ += rhs; return *this; }
+    String &operator+=(char c) { s_ += c; return *this; }
+    String &operator+=(int v) { return *this += String(v); }
+    String &operator+=(unsigned int v) { return *this += String(v); }
+    String &operator+=(long v) { return *this += String(v); }
+    String &operator+=(unsigned long v) { return *this += String(v); }
+    bool concat(const String &rhs) { s_ += rhs.s_; return true; }
+    bool concat(char c) { s_ += c; return true; }
+
+    friend String operator+(const String &a, const String &b) { return String(a.s_ + b.s_); }
+    friend String operator+(const String &a, const char *b) { return String(a.s_ + b); }
+    friend String operator+(const char *a, const String &b) { return String(a + b.s_); }
+
+    bool operator==(const String &rhs) const { return s_ == rhs.s_; }
+    bool operator==(const char *rhs) const { return s_ == rhs; }
+    bool operator!=(const String &rhs) const { return s_ != rhs.s_; }
+    bool operator!=(const char *rhs) const { return s_ != rhs; }
+    bool equals(const String &rhs) const { return s_ == rhs.s_; }
+    char operator[](unsigned int i) const { return i < s_.size() ? s_[i] : 0; }
+    char &operator[](unsigned int i) { return s_[i]; }
+    char charAt(unsigned int i) const { return (*this)[i]; }
+
+    bool startsWith(const String &prefix) const { return s_.compare(0, prefix.s_.size(), prefix.s_) == 0; }
+    bool endsWith(const String &suffix) const
+    {
+        return s_.size() >= suffix.s_.size() && s_.compare(s_.size() - suffix.s_.size(), suffix.s_.size(), suffix.s_) == 0;
+    }
+    int indexOf(char c, unsigned int from = 0) const { return pos(s_.find(c, from)); }
+    int indexOf(const String &str, unsigned int from = 0) const { return pos(s_.find(str.s_, from)); }
+    int lastIndexOf(char c) const { return pos(s_.rfind(c)); }
+    int lastIndexOf(const String &str) const { return pos(s_.rfind(str.s_)); }
+    String substring(unsigned int from) const { return from < s_.size() ? String(s_.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const;
+
+    void replace(const String &find, const String &replace);
+    void replace(char find, char replace);
+    void remove(unsigned int index) { if (index < s_.size()) s_.erase(index); }
+    void remove(unsigned int index, unsigned int count) { if (index < s_.size()) s_.erase(index, count); }
+    void trim();
+    void toUpperCase();
+    void toLowerCase();
+
+    long toInt() const { return atol(s_.c_str()); }
+    float toFloat() const { return (float)atof(s_.c_str()); }
+    double toDouble() const { return atof(s_.c_str()); }
+    void toCharArray(char *buf, unsigned int size, unsigned int index = 0) const;
+
+private:
+    static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+    std::string s_;
+};
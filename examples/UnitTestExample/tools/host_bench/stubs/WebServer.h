@@ -0,0 +1,135 @@
+/**
+ * @file      WebServer.h
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      ESP32 WebServer that records the answer instead of sending it. A test
+ *            sets up a request with request(), addHeader() and addArg(), calls the
+ *            handler, then reads the status, the headers and what went to the client.
+ *            The header bytes are counted as the real server would send them.
+ */
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "Arduino.h"
+
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS };
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+class WiFiClient {
+public:
+    size_t write(const uint8_t *buf, size_t size)
+    {
+        data.append((const char *)buf, size);
+        return size;
+    }
+    bool connected() { return true; }
+
+    std::string data;       /*!> body bytes written by the handler */
+};
+
+class WebServer {
+public:
+    typedef std::vector<std::pair<String, String>> Fields;
+
+    WebServer(int port = 80) { (void)port; }
+
+    /* request side, set by the test */
+    void request(HTTPMethod method, const String &uri)
+    {
+        method_ = method;
+        uri_ = uri;
+        reqHeaders.clear();
+        args.clear();
+        respHeaders.clear();
+        pending.clear();
+        code = 0;
+        contentType = String();
+        contentLength = CONTENT_LENGTH_NOT_SET;
+        headerBytes = 0;
+        client_.data.clear();
+    }
+    void addHeader(const String &name, const String &value) { reqHeaders.push_back({ name, value }); }
+    void addArg(const String &name, const String &value) { args.push_back({ name, value }); }
+
+    HTTPMethod method() { return method_; }
+    String uri() { return uri_; }
+    bool hasHeader(const String &name) { return find(reqHeaders, name) != nullptr; }
+    String header(const String &name)
+    {
+        const String *v = find(reqHeaders, name);
+        return v ? *v : String();
+    }
+    bool hasArg(const String &name) { return find(args, name) != nullptr; }
+    String arg(const String &name)
+    {
+        const String *v = find(args, name);
+        return v ? *v : String();
+    }
+
+    /* response side */
+    void sendHeader(const String &name, const String &value, bool first = false)
+    {
+        (void)first;
+        pending.push_back({ name, value });
+    }
+    void setContentLength(size_t length) { contentLength = length; }
+    void send(int status, const char *type = nullptr, const String &content = String())
+    {
+        code = status;
+        contentType = type ? type : "";
+        respHeaders = pending;
+        pending.clear();
+        if (contentLength == CONTENT_LENGTH_NOT_SET) {
+            contentLength = content.length();
+        }
+        headerBytes = snprintf(nullptr, 0, "HTTP/1.1 %d X\r\n", status);
+        if (contentType.length()) {
+            headerBytes += strlen("Content-Type: \r\n") + contentType.length();
+        }
+        headerBytes += snprintf(nullptr, 0, "Content-Length: %zu\r\n", contentLength);
+        for (const auto &h : respHeaders) {
+            headerBytes += h.first.length() + h.second.length() + 4;
+        }
+        headerBytes += 2;
+        client_.data.append(content.c_str(), content.length());
+    }
+    void send(int status, const String &type, const String &content) { send(status, type.c_str(), content); }
+    WiFiClient &client() { return client_; }
+
+    String responseHeader(const String &name)
+    {
+        const String *v = find(respHeaders, name);
+        return v ? *v : String();
+    }
+    bool hasResponseHeader(const String &name) { return find(respHeaders, name) != nullptr; }
+    size_t bodyBytes() const { return client_.data.size(); }
+
+    int code = 0;
+    String contentType;
+    size_t contentLength = CONTENT_LENGTH_NOT_SET;
+    size_t headerBytes = 0;
+    Fields respHeaders;
+
+private:
+    static const String *find(const Fields &fields, const String &name)
+    {
+        for (const auto &f : fields) {
+            if (f.first == name) {
+                return &f.second;
+            }
+        }
+        return nullptr;
+    }
+
+    HTTPMethod method_ = HTTP_GET;
+    String uri_;
+    Fields reqHeaders;
+    Fields args;
+    Fields pending;
+    WiFiClient client_;
+};
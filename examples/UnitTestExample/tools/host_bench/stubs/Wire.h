@@ -0,0 +1,128 @@
+/**
+ * @file      Wire.h
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      I2C bus with one device behind it, modelled as 256 registers with an
+ *            auto-incrementing address: the first byte written sets the address,
+ *            the following bytes and all reads move through the registers. Every
+ *            transaction is logged, so a test can check how many the library
+ *            needed and what they looked like.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define WIRE_BUFFER_SIZE    128
+#define WIRE_LOG_SIZE       64
+
+struct WireTransaction {
+    uint8_t addr;
+    bool    read;       /*!> requestFrom, otherwise a transmission */
+    bool    stop;
+    uint8_t len;        /*!> bytes moved, the register address included on writes */
+    uint8_t data[WIRE_BUFFER_SIZE];
+};
+
+class TwoWire {
+public:
+    bool begin() { return true; }
+    void end() {}
+    void setClock(uint32_t freq) { (void)freq; }
+
+    void beginTransmission(uint8_t addr)
+    {
+        tx_addr = addr;
+        tx_len = 0;
+    }
+    size_t write(uint8_t data)
+    {
+        if (tx_len == WIRE_BUFFER_SIZE) {
+            return 0;
+        }
+        tx[tx_len++] = data;
+        return 1;
+    }
+    size_t write(const uint8_t *data, size_t len)
+    {
+        size_t n = 0;
+        while (n < len && write(data[n])) {
+            n++;
+        }
+        return n;
+    }
+    /* 2 (address NACK) when the device does not answer to addr */
+    uint8_t endTransmission(bool stop = true)
+    {
+        if (tx_addr != address) {
+            return 2;
+        }
+        log(tx_addr, false, stop, tx, tx_len);
+        if (tx_len > 0) {
+            pointer = tx[0];
+            for (uint8_t i = 1; i < tx_len; i++) {
+                regs[pointer++] = tx[i];
+            }
+        }
+        return 0;
+    }
+    uint8_t endTransmission(uint8_t stop) { return endTransmission((bool)stop); }
+
+    size_t requestFrom(uint8_t addr, size_t len, bool stop = true)
+    {
+        if (addr != address || len > WIRE_BUFFER_SIZE) {
+            return 0;
+        }
+        for (size_t i = 0; i < len; i++) {
+            rx[i] = regs[pointer++];
+        }
+        rx_len = (uint8_t)len;
+        rx_pos = 0;
+        log(addr, true, stop, rx, rx_len);
+        return len;
+    }
+    uint8_t requestFrom(uint8_t addr, uint8_t len, uint8_t stop)
+    {
+        return (uint8_t)requestFrom(addr, (size_t)len, (bool)stop);
+    }
+
+    int available() { return rx_len - rx_pos; }
+    int read() { return rx_pos < rx_len ? rx[rx_pos++] : -1; }
+    int peek() { return rx_pos < rx_len ? rx[rx_pos] : -1; }
+
+    void clearLog() { transactions = 0; }
+
+    /* the device */
+    uint8_t address = 0x77;
+    uint8_t regs[256] = {};
+    uint8_t pointer = 0;
+
+    /* transactions since clearLog(), the first WIRE_LOG_SIZE are kept */
+    WireTransaction trace[WIRE_LOG_SIZE];
+    size_t transactions = 0;
+
+private:
+    void log(uint8_t addr, bool read, bool stop, const uint8_t *data, uint8_t len)
+    {
+        if (transactions < WIRE_LOG_SIZE) {
+            WireTransaction *t = &trace[transactions];
+            t->addr = addr;
+            t->read = read;
+            t->stop = stop;
+            t->len = len;
+            memcpy(t->data, data, len);
+        }
+        transactions++;
+    }
+
+    uint8_t tx_addr = 0;
+    uint8_t tx[WIRE_BUFFER_SIZE];
+    uint8_t tx_len = 0;
+    uint8_t rx[WIRE_BUFFER_SIZE];
+    uint8_t rx_len = 0;
+    uint8_t rx_pos = 0;
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,25 @@
+/**
+ * @file      pgmspace.h
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      Program memory is plain memory on Linux
+ */
+#pragma once
+
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P               const char *
+#define PSTR(s)             (s)
+#define pgm_read_byte(addr)         (*(const uint8_t *)(addr))
+#define pgm_read_byte_near(addr)    pgm_read_byte(addr)
+#define pgm_read_word(addr)         (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr)        (*(const uint32_t *)(addr))
+#define pgm_read_float(addr)        (*(const float *)(addr))
+#define pgm_read_ptr(addr)          (*(void *const *)(addr))
+#define memcpy_P            memcpy
+#define strlen_P            strlen
+#define strcpy_P            strcpy
+#define strncpy_P           strncpy
+#define strcmp_P            strcmp
@@ -0,0 +1,40 @@
+/**
+ * @file      host_test.h
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      Checks shared by the tests/test_*.cpp programs. Every test is its own
+ *            executable run by ctest, a failed check prints where it failed and
+ *            the program exits with 1 once all its checks ran.
+ */
+#pragma once
+
+#include <stdio.h>
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC MACROS -------------------------------------------------------- */
+
+static int ht_failed;
+
+/* the check goes on after a failure, so one run shows every broken case */
+#define HT_CHECK(cond)                                                          \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ht_failed++;                                                        \
+        }                                                                       \
+    } while (0)
+
+#define HT_CHECK_EQ(a, b)                                                       \
+    do {                                                                        \
+        long long ht_a = (long long)(a), ht_b = (long long)(b);                 \
+        if (ht_a != ht_b) {                                                     \
+            fprintf(stderr, "%s:%d: check failed: %s == %s (%lld != %lld)\n",   \
+                    __FILE__, __LINE__, #a, #b, ht_a, ht_b);                    \
+            ht_failed++;                                                        \
+        }                                                                       \
+    } while (0)
+
+/* end of main */
+#define HT_RESULT()                                                             \
+    (ht_failed ? (fprintf(stderr, "%d check(s) failed\n", ht_failed), 1) : 0)
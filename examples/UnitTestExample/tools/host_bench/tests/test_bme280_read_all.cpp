@@ -0,0 +1,152 @@
+/**
+ * @file      test_bme280_read_all.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      Adafruit BME280 readAll(): one burst read of the data registers on the
+ *            I2C bus, and the same compensated values as the float functions. The
+ *            sensor is the register file of the Wire stub, loaded with the
+ *            calibration and raw values of the Bosch datasheet example.
+ */
+#ifndef ARDUINO     /* PC tool, PlatformIO compiles every file below src_dir */
+
+#include "Adafruit_BME280.h"
+#include "host_test.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define ADC_T   519888      /* 25.08 C with the datasheet calibration */
+#define ADC_P   415148      /* 100653 Pa */
+#define ADC_H   30000
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+static Adafruit_BME280 bme;
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static void put16_le(uint8_t reg, int32_t v)
+{
+    Wire.regs[reg] = (uint8_t)v;
+    Wire.regs[reg + 1] = (uint8_t)(v >> 8);
+}
+
+static void put20(uint8_t reg, int32_t adc)
+{
+    Wire.regs[reg] = (uint8_t)(adc >> 12);
+    Wire.regs[reg + 1] = (uint8_t)(adc >> 4);
+    Wire.regs[reg + 2] = (uint8_t)(adc << 4);
+}
+
+static void load_sensor(void)
+{
+    Wire.address = BME280_ADDRESS;
+    Wire.regs[BME280_REGISTER_CHIPID] = 0x60;
+    Wire.regs[BME280_REGISTER_STATUS] = 0x00;   /* calibration loaded, not measuring */
+
+    put16_le(BME280_REGISTER_DIG_T1, 27504);
+    put16_le(BME280_REGISTER_DIG_T2, 26435);
+    put16_le(BME280_REGISTER_DIG_T3, -1000);
+    put16_le(BME280_REGISTER_DIG_P1, 36477);
+    put16_le(BME280_REGISTER_DIG_P2, -10685);
+    put16_le(BME280_REGISTER_DIG_P3, 3024);
+    put16_le(BME280_REGISTER_DIG_P4, 2855);
+    put16_le(BME280_REGISTER_DIG_P5, 140);
+    put16_le(BME280_REGISTER_DIG_P6, -7);
+    put16_le(BME280_REGISTER_DIG_P7, 15500);
+    put16_le(BME280_REGISTER_DIG_P8, -14600);
+    put16_le(BME280_REGISTER_DIG_P9, 6000);
+
+    /* H4 and H5 are 12 bits sharing the nibbles of 0xE5 */
+    Wire.regs[BME280_REGISTER_DIG_H1] = 75;
+    put16_le(BME280_REGISTER_DIG_H2, 362);
+    Wire.regs[BME280_REGISTER_DIG_H3] = 0;
+    Wire.regs[BME280_REGISTER_DIG_H4] = 313 >> 4;
+    Wire.regs[BME280_REGISTER_DIG_H4 + 1] = (313 & 0x0F) | ((50 & 0x0F) << 4);
+    Wire.regs[BME280_REGISTER_DIG_H5 + 1] = 50 >> 4;
+    Wire.regs[BME280_REGISTER_DIG_H6] = 30;
+
+    put20(BME280_REGISTER_PRESSUREDATA, ADC_P);
+    put20(BME280_REGISTER_TEMPDATA, ADC_T);
+    Wire.regs[BME280_REGISTER_HUMIDDATA] = (uint8_t)(ADC_H >> 8);
+    Wire.regs[BME280_REGISTER_HUMIDDATA + 1] = (uint8_t)ADC_H;
+}
+
+static void test_one_burst(void)
+{
+    bme280_sample s;
+
+    Wire.clearLog();
+    HT_CHECK(bme.readAll(&s));
+
+    /* register address without a stop, then the 8 data bytes from 0xF7 to 0xFE */
+    HT_CHECK_EQ(Wire.transactions, 2);
+    const WireTransaction *w = &Wire.trace[0], *r = &Wire.trace[1];
+    HT_CHECK(!w->read && !w->stop && w->len == 1 && w->data[0] == BME280_REGISTER_PRESSUREDATA);
+    HT_CHECK(r->read && r->stop && r->len == 8);
+    HT_CHECK(memcmp(r->data, &Wire.regs[BME280_REGISTER_PRESSUREDATA], 8) == 0);
+}
+
+static void test_values(void)
+{
+    bme280_sample s;
+
+    HT_CHECK(bme.readAll(&s));
+    HT_CHECK_EQ(s.temperature, 2508);
+    HT_CHECK_EQ(s.pressure / 256, 100653);
+
+    /* the float functions round the same integers */
+    HT_CHECK(bme.readTemperature() == (float)s.temperature / 100);
+    HT_CHECK(bme.readPressure() == (float)(s.pressure / 256.0));
+    HT_CHECK(bme.readHumidity() == (float)(s.humidity / 1024.0));
+    HT_CHECK(s.humidity > 0 && s.humidity < 100 * 1024);
+}
+
+static void test_skipped(void)
+{
+    bme280_sample s;
+
+    /* a disabled measurement reads 0x80000 / 0x8000 */
+    put20(BME280_REGISTER_PRESSUREDATA, 0x80000);
+    Wire.regs[BME280_REGISTER_HUMIDDATA] = 0x80;
+    Wire.regs[BME280_REGISTER_HUMIDDATA + 1] = 0x00;
+    HT_CHECK(bme.readAll(&s));
+    HT_CHECK_EQ(s.temperature, 2508);
+    HT_CHECK(s.pressure == BME280_VALUE_SKIPPED);
+    HT_CHECK(s.humidity == BME280_VALUE_SKIPPED);
+
+    put20(BME280_REGISTER_TEMPDATA, 0x80000);
+    HT_CHECK(bme.readAll(&s));
+    HT_CHECK(s.temperature == BME280_TEMPERATURE_SKIPPED);
+}
+
+static void test_no_device(void)
+{
+    bme280_sample s;
+
+    Wire.address = 0;
+    HT_CHECK(!bme.readAll(&s));
+    Wire.address = BME280_ADDRESS;
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- MAIN FUNCTION -------------------------------------------------------- */
+
+int main(void)
+{
+    load_sensor();
+    HT_CHECK(bme.begin(BME280_ADDRESS, &Wire));
+    HT_CHECK_EQ(Wire.regs[BME280_REGISTER_SOFTRESET], 0xB6);
+
+    test_one_burst();
+    test_values();
+    test_skipped();
+    test_no_device();
+
+    return HT_RESULT();
+}
+
+#endif /* ARDUINO */
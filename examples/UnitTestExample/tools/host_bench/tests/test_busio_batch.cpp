@@ -0,0 +1,135 @@
+/**
+ * @file      test_busio_batch.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      Adafruit BusIO Adafruit_BusIO_RegisterBatch: the I2C transactions a
+ *            flush sends, against the register file of the Wire stub.
+ */
+#ifndef ARDUINO     /* PC tool, PlatformIO compiles every file below src_dir */
+
+#include "Adafruit_BusIO_Register.h"
+#include "host_test.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define DEV_ADDR    0x77
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+static Adafruit_I2CDevice dev(DEV_ADDR, &Wire);
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+/* transaction n of the log is a write of exactly the given bytes */
+static bool wrote(size_t n, const uint8_t *bytes, uint8_t len)
+{
+    const WireTransaction *t = &Wire.trace[n];
+    return (n < Wire.transactions) && !t->read && (t->addr == DEV_ADDR) &&
+           (t->len == len) && (memcmp(t->data, bytes, len) == 0);
+}
+
+static void test_order_kept(void)
+{
+    Adafruit_BusIO_Register a(&dev, 0x10);
+    Adafruit_BusIO_Register b(&dev, 0x20);
+    Adafruit_BusIO_RegisterBatch batch;
+
+    // A is queued again after B, both A writes must reach the device around B
+    Wire.clearLog();
+    HT_CHECK(batch.write(&a, 1));
+    HT_CHECK(batch.write(&b, 2));
+    HT_CHECK(batch.write(&a, 3));
+    HT_CHECK_EQ(batch.pending(), 3);
+    HT_CHECK(batch.flush());
+    HT_CHECK_EQ(batch.pending(), 0);
+
+    static const uint8_t w0[] = { 0x10, 1 }, w1[] = { 0x20, 2 }, w2[] = { 0x10, 3 };
+    HT_CHECK_EQ(Wire.transactions, 3);
+    HT_CHECK(wrote(0, w0, sizeof(w0)));
+    HT_CHECK(wrote(1, w1, sizeof(w1)));
+    HT_CHECK(wrote(2, w2, sizeof(w2)));
+    HT_CHECK_EQ(Wire.regs[0x10], 3);
+}
+
+static void test_repeat_merged(void)
+{
+    Adafruit_BusIO_Register a(&dev, 0x10);
+    Adafruit_BusIO_RegisterBatch batch;
+
+    // nothing in between, only the last value goes out
+    Wire.clearLog();
+    HT_CHECK(batch.write(&a, 4));
+    HT_CHECK(batch.write(&a, 5));
+    HT_CHECK(batch.write(&a, 6));
+    HT_CHECK_EQ(batch.pending(), 1);
+    HT_CHECK(batch.flush());
+
+    static const uint8_t w0[] = { 0x10, 6 };
+    HT_CHECK_EQ(Wire.transactions, 1);
+    HT_CHECK(wrote(0, w0, sizeof(w0)));
+}
+
+static void test_unlock_configure_lock(void)
+{
+    Adafruit_BusIO_Register lock(&dev, 0x40);
+    Adafruit_BusIO_Register cfg(&dev, 0x41);
+    Adafruit_BusIO_Register cfg2(&dev, 0x42, 2);
+    Adafruit_BusIO_RegisterBatch batch;
+
+    // unlock and the contiguous configuration share a burst, the re-lock comes last
+    Wire.clearLog();
+    HT_CHECK(batch.write(&lock, 0x55));
+    HT_CHECK(batch.write(&cfg, 0xA5));
+    HT_CHECK(batch.write(&cfg2, 0x1234));
+    HT_CHECK(batch.write(&lock, 0x00));
+    HT_CHECK(batch.flush());
+
+    static const uint8_t w0[] = { 0x40, 0x55, 0xA5, 0x34, 0x12 }, w1[] = { 0x40, 0x00 };
+    HT_CHECK_EQ(Wire.transactions, 2);
+    HT_CHECK(wrote(0, w0, sizeof(w0)));
+    HT_CHECK(wrote(1, w1, sizeof(w1)));
+    HT_CHECK_EQ(Wire.regs[0x40], 0x00);
+}
+
+static void test_full_queue(void)
+{
+    Adafruit_BusIO_Register a(&dev, 0x10);
+    Adafruit_BusIO_Register b(&dev, 0x20);
+    Adafruit_BusIO_RegisterBatch batch;
+
+    // alternating writes never merge, the queue fills and is flushed in order
+    Wire.clearLog();
+    for (uint8_t i = 0; i <= BUSIO_BATCH_MAX_WRITES; i++) {
+        HT_CHECK(batch.write((i & 1) ? &b : &a, i));
+    }
+    HT_CHECK_EQ(Wire.transactions, BUSIO_BATCH_MAX_WRITES);
+    HT_CHECK_EQ(batch.pending(), 1);
+    for (uint8_t i = 0; i < BUSIO_BATCH_MAX_WRITES; i++) {
+        const uint8_t w[] = { (uint8_t)((i & 1) ? 0x20 : 0x10), i };
+        HT_CHECK(wrote(i, w, sizeof(w)));
+    }
+    HT_CHECK(batch.flush());
+    HT_CHECK_EQ(Wire.regs[0x10], BUSIO_BATCH_MAX_WRITES);
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- MAIN FUNCTION -------------------------------------------------------- */
+
+int main(void)
+{
+    Wire.address = DEV_ADDR;
+    HT_CHECK(dev.begin());
+
+    test_order_kept();
+    test_repeat_merged();
+    test_unlock_configure_lock();
+    test_full_queue();
+
+    return HT_RESULT();
+}
+
+#endif /* ARDUINO */
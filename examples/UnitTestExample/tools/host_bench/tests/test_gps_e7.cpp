@@ -0,0 +1,163 @@
+/**
+ * @file      test_gps_e7.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      TinyGPS++ distanceBetweenE7() and courseToE7() against the double
+ *            distanceBetween() and courseTo(), on random, near coincident and
+ *            antipodal pairs, with the bounds given in TinyGPS++.h.
+ */
+#ifndef ARDUINO     /* PC tool, PlatformIO compiles every file below src_dir */
+
+#include <math.h>
+#include "TinyGPS++.h"
+#include "host_test.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define PAIRS               300000
+#define MAX_DISTANCE_ERR    1.0     /* meters */
+#define MAX_COURSE_ERR      0.02    /* degrees */
+#define MIN_COURSE_LEG      5.0     /* meters, shorter legs are below the E7 resolution */
+#define MIN_ANTIPODE_GAP    500.0   /* meters, the course turns ill defined next to the antipode */
+#define HALF_CIRCUMFERENCE  20020726.0
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE TYPES -------------------------------------------------------- */
+
+typedef struct {
+    double distance;                /* worst distance error, meters */
+    double course;                  /* worst course error, degrees */
+} worst_t;
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+static uint64_t seed = 88172645463325252ull;
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static uint32_t next_random(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return (uint32_t)seed;
+}
+
+static int32_t random_in(int32_t lo, int32_t hi)
+{
+    return lo + (int32_t)(next_random() % (uint32_t)(hi - lo + 1));
+}
+
+static int32_t wrap_lng(int64_t lng)
+{
+    if (lng >= 1800000000) {
+        lng -= 3600000000LL;
+    } else if (lng < -1800000000) {
+        lng += 3600000000LL;
+    }
+    return (int32_t)lng;
+}
+
+static int32_t clamp_lat(int64_t lat)
+{
+    return (int32_t)(lat > 900000000 ? 900000000 : lat < -900000000 ? -900000000 : lat);
+}
+
+static void compare(worst_t *w, int32_t lat1, int32_t lng1, int32_t lat2, int32_t lng2)
+{
+    double ref = TinyGPSPlus::distanceBetween(lat1 / 1e7, lng1 / 1e7, lat2 / 1e7, lng2 / 1e7);
+    double err = fabs(TinyGPSPlus::distanceBetweenE7(lat1, lng1, lat2, lng2) - ref);
+
+    if (err > w->distance) {
+        w->distance = err;
+    }
+    if (ref >= MIN_COURSE_LEG && HALF_CIRCUMFERENCE - ref >= MIN_ANTIPODE_GAP) {
+        double course = TinyGPSPlus::courseTo(lat1 / 1e7, lng1 / 1e7, lat2 / 1e7, lng2 / 1e7);
+        err = fabs(TinyGPSPlus::courseToE7(lat1, lng1, lat2, lng2) / 100.0 - course);
+        err = err > 180 ? 360 - err : err;
+        if (err > w->course) {
+            w->course = err;
+        }
+    }
+}
+
+static void check(const char *name, const worst_t *w)
+{
+    printf("%-15s distance %.3f m, course %.4f deg\n", name, w->distance, w->course);
+    HT_CHECK(w->distance <= MAX_DISTANCE_ERR);
+    HT_CHECK(w->course <= MAX_COURSE_ERR);
+}
+
+static void test_random(void)
+{
+    worst_t w = {};
+
+    for (int i = 0; i < PAIRS; i++) {
+        compare(&w, random_in(-900000000, 900000000), random_in(-1800000000, 1799999999),
+                random_in(-900000000, 900000000), random_in(-1800000000, 1799999999));
+    }
+    check("random", &w);
+}
+
+static void test_near(void)
+{
+    static const int32_t spreads[] = { 2, 50, 1000, 30000, 99999, 100001, 3000000 };
+    worst_t w = {};
+
+    /* from a few millimeters to a few hundred kilometers, across the date line and up to the poles */
+    for (int32_t spread : spreads) {
+        for (int i = 0; i < PAIRS / 7; i++) {
+            int32_t lat = random_in(-900000000, 900000000);
+            int32_t lng = random_in(-1800000000, 1799999999);
+            compare(&w, lat, lng, clamp_lat((int64_t)lat + random_in(-spread, spread)),
+                    wrap_lng((int64_t)lng + random_in(-spread, spread)));
+        }
+    }
+    check("near", &w);
+
+    /* right on the axes of the CORDIC, the angle used to wrap below 0 */
+    HT_CHECK(TinyGPSPlus::distanceBetweenE7(-898524272, -1485774311, -898524273, -1485769982) <= 1);
+    HT_CHECK_EQ(TinyGPSPlus::distanceBetweenE7(312304167, 1214737222, 312304167, 1214737222), 0);
+    HT_CHECK_EQ(TinyGPSPlus::courseToE7(312304167, 1214737222, 312304167, 1214737222), 0);
+    HT_CHECK_EQ(TinyGPSPlus::courseToE7(312304167, 1214737222, 312304168, 1214737222), 0);
+    HT_CHECK_EQ(TinyGPSPlus::courseToE7(312304167, 1214737222, 312304166, 1214737222), 18000);
+    HT_CHECK_EQ(TinyGPSPlus::courseToE7(0, 1214737222, 0, 1214737223), 9000);
+    HT_CHECK_EQ(TinyGPSPlus::courseToE7(0, 1214737222, 0, 1214737221), 27000);
+    HT_CHECK_EQ(TinyGPSPlus::courseToE7(0, 1799999999, 0, -1800000000), 9000);
+}
+
+static void test_antipodal(void)
+{
+    worst_t w = {};
+
+    for (int i = 0; i < PAIRS; i++) {
+        int32_t lat = random_in(-900000000, 900000000);
+        int32_t lng = random_in(-1800000000, 1799999999);
+        int32_t spread = random_in(0, 3) == 0 ? 200 : 100000;
+        compare(&w, lat, lng, clamp_lat(-(int64_t)lat + random_in(-spread, spread)),
+                wrap_lng((int64_t)lng + 1800000000 + random_in(-spread, spread)));
+    }
+    check("antipodal", &w);
+
+    /* half the circumference, 2 * pi * 6372795 / 2 */
+    HT_CHECK_EQ(TinyGPSPlus::distanceBetweenE7(0, 0, 0, -1800000000), 20020726);
+    HT_CHECK_EQ(TinyGPSPlus::distanceBetweenE7(900000000, 0, -900000000, 0), 20020726);
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- MAIN FUNCTION -------------------------------------------------------- */
+
+int main(void)
+{
+    test_random();
+    test_near();
+    test_antipodal();
+
+    return HT_RESULT();
+}
+
+#endif /* ARDUINO */
@@ -0,0 +1,258 @@
+/**
+ * @file      test_lora_fifo_burst.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      LoRa library burst FIFO access, against a mock SX1276 on the SPI stub:
+ *            the packet sent and the payload read back, and the SPI transactions
+ *            and transfer calls of write() and readBytes() next to the register
+ *            at a time access they replace. Built with ESP32 defined, as on the
+ *            boards, so the bursts go through writeBytes() and transferBytes().
+ */
+#ifndef ARDUINO     /* PC tool, PlatformIO compiles every file below src_dir */
+
+#include "LoRa.h"
+#include "host_test.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+/* the registers of LoRa.cpp the mock models */
+#define REG_FIFO                0x00
+#define REG_OP_MODE             0x01
+#define REG_FIFO_ADDR_PTR       0x0d
+#define REG_FIFO_TX_BASE_ADDR   0x0e
+#define REG_FIFO_RX_CURRENT_ADDR 0x10
+#define REG_IRQ_FLAGS           0x12
+#define REG_RX_NB_BYTES         0x13
+#define REG_PAYLOAD_LENGTH      0x22
+#define REG_VERSION             0x42
+
+#define MODE_MASK               0x07
+#define MODE_STDBY              0x01
+#define MODE_TX                 0x03
+#define IRQ_TX_DONE_MASK        0x08
+#define IRQ_RX_DONE_MASK        0x40
+
+#define PAYLOAD                 64
+#define RX_ADDR                 0x80
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE TYPES -------------------------------------------------------- */
+
+typedef struct {
+    uint32_t transactions;
+    uint32_t transfers;
+} bus_count_t;
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+/* the radio */
+static uint8_t regs[128];
+static uint8_t fifo[256];
+static int access_addr = -1;    /* register of the transaction, -1 before the address byte */
+static bool access_write;
+static uint8_t sent[256];
+static uint8_t sent_len;
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static void radio_write(uint8_t addr, uint8_t data)
+{
+    if (addr == REG_IRQ_FLAGS) {
+        regs[addr] &= ~data;
+    } else if (addr == REG_OP_MODE && (data & MODE_MASK) == MODE_TX) {
+        /* the packet leaves at once, the radio drops back to standby */
+        sent_len = regs[REG_PAYLOAD_LENGTH];
+        for (int i = 0; i < sent_len; i++) {
+            sent[i] = fifo[(uint8_t)(regs[REG_FIFO_TX_BASE_ADDR] + i)];
+        }
+        regs[REG_IRQ_FLAGS] |= IRQ_TX_DONE_MASK;
+        regs[addr] = (data & ~MODE_MASK) | MODE_STDBY;
+    } else {
+        regs[addr] = data;
+    }
+}
+
+static void radio_select(void)
+{
+    access_addr = -1;
+}
+
+/* the first byte is the address, bit 7 set for a write; the FIFO moves its own pointer */
+static uint8_t radio_byte(uint8_t data)
+{
+    if (access_addr < 0) {
+        access_addr = data & 0x7f;
+        access_write = data & 0x80;
+        return 0;
+    }
+    if (access_addr == REG_FIFO) {
+        uint8_t *ptr = &regs[REG_FIFO_ADDR_PTR];
+        uint8_t out = fifo[*ptr];
+        if (access_write) {
+            fifo[*ptr] = data;
+        }
+        (*ptr)++;
+        return out;
+    }
+    uint8_t out = regs[access_addr];
+    if (access_write) {
+        radio_write((uint8_t)access_addr, data);
+    }
+    access_addr = (access_addr + 1) & 0x7f;
+    return out;
+}
+
+static bus_count_t bus_count(void)
+{
+    return { SPI.transactions, SPI.transfers };
+}
+
+static bus_count_t bus_since(bus_count_t start)
+{
+    return { SPI.transactions - start.transactions, SPI.transfers - start.transfers };
+}
+
+static void radio_reset(void)
+{
+    memset(regs, 0, sizeof(regs));
+    memset(fifo, 0, sizeof(fifo));
+    regs[REG_VERSION] = 0x12;
+    SPI.select = radio_select;
+    SPI.device = radio_byte;
+    HT_CHECK_EQ(LoRa.begin(868E6), 1);
+}
+
+/* one register as LoRaClass::singleTransfer() moves it */
+static uint8_t single_transfer(uint8_t address, uint8_t value)
+{
+    SPI.beginTransaction(SPISettings(8000000, MSBFIRST, SPI_MODE0));
+    SPI.transfer(address);
+    uint8_t response = SPI.transfer(value);
+    SPI.endTransaction();
+    return response;
+}
+
+/* what write(buffer, size) did before the burst, a FIFO write per byte */
+static void write_per_byte(const uint8_t *buffer, size_t size)
+{
+    uint8_t length = single_transfer(REG_PAYLOAD_LENGTH, 0x00);
+    for (size_t i = 0; i < size; i++) {
+        single_transfer(REG_FIFO | 0x80, buffer[i]);
+    }
+    single_transfer(REG_PAYLOAD_LENGTH | 0x80, length + size);
+}
+
+static void test_send(void)
+{
+    uint8_t payload[PAYLOAD];
+    for (int i = 0; i < PAYLOAD; i++) {
+        payload[i] = (uint8_t)(i * 7 + 3);
+    }
+
+    radio_reset();
+    HT_CHECK_EQ(LoRa.beginPacket(), 1);
+    bus_count_t start = bus_count();
+    write_per_byte(payload, PAYLOAD);
+    bus_count_t before = bus_since(start);
+    HT_CHECK_EQ(LoRa.endPacket(), 1);
+    HT_CHECK_EQ(sent_len, PAYLOAD);
+    HT_CHECK(memcmp(sent, payload, PAYLOAD) == 0);
+
+    memset(sent, 0, sizeof(sent));
+    HT_CHECK_EQ(LoRa.beginPacket(), 1);
+    start = bus_count();
+    HT_CHECK_EQ(LoRa.write(payload, PAYLOAD), PAYLOAD);
+    bus_count_t after = bus_since(start);
+    HT_CHECK_EQ(LoRa.endPacket(), 1);
+    HT_CHECK_EQ(sent_len, PAYLOAD);
+    HT_CHECK(memcmp(sent, payload, PAYLOAD) == 0);
+
+    printf("send %d bytes:    per byte %u transactions %u transfers, burst %u transactions %u transfers\n",
+           PAYLOAD, (unsigned)before.transactions, (unsigned)before.transfers, (unsigned)after.transactions,
+           (unsigned)after.transfers);
+    /* payload length read, the FIFO, payload length written */
+    HT_CHECK_EQ(before.transactions, PAYLOAD + 2);
+    HT_CHECK_EQ(before.transfers, 2 * PAYLOAD + 4);
+    HT_CHECK_EQ(after.transactions, 3);
+    HT_CHECK_EQ(after.transfers, 6);
+
+    /* a packet in two writes keeps both parts in order */
+    memset(sent, 0, sizeof(sent));
+    HT_CHECK_EQ(LoRa.beginPacket(), 1);
+    HT_CHECK_EQ(LoRa.write(payload, 10), 10);
+    HT_CHECK_EQ(LoRa.write(payload + 10, PAYLOAD - 10), PAYLOAD - 10);
+    HT_CHECK_EQ(LoRa.endPacket(), 1);
+    HT_CHECK_EQ(sent_len, PAYLOAD);
+    HT_CHECK(memcmp(sent, payload, PAYLOAD) == 0);
+}
+
+/* a packet of PAYLOAD bytes at RX_ADDR, as the radio leaves it after RX_DONE */
+static void receive(const uint8_t *payload)
+{
+    memcpy(&fifo[RX_ADDR], payload, PAYLOAD);
+    regs[REG_FIFO_RX_CURRENT_ADDR] = RX_ADDR;
+    regs[REG_RX_NB_BYTES] = PAYLOAD;
+    regs[REG_IRQ_FLAGS] = IRQ_RX_DONE_MASK;
+    HT_CHECK_EQ(LoRa.parsePacket(), PAYLOAD);
+}
+
+static void test_receive(void)
+{
+    uint8_t payload[PAYLOAD], got[PAYLOAD];
+    for (int i = 0; i < PAYLOAD; i++) {
+        payload[i] = (uint8_t)(i * 13 + 1);
+    }
+
+    radio_reset();
+
+    /* read() is the register at a time path Stream::readBytes() took */
+    receive(payload);
+    bus_count_t start = bus_count();
+    for (int i = 0; i < PAYLOAD; i++) {
+        got[i] = (uint8_t)LoRa.read();
+    }
+    bus_count_t before = bus_since(start);
+    HT_CHECK(memcmp(got, payload, PAYLOAD) == 0);
+    HT_CHECK_EQ(LoRa.read(), -1);
+
+    memset(got, 0, sizeof(got));
+    receive(payload);
+    start = bus_count();
+    HT_CHECK_EQ(LoRa.readBytes(got, sizeof(got)), PAYLOAD);
+    bus_count_t after = bus_since(start);
+    HT_CHECK(memcmp(got, payload, PAYLOAD) == 0);
+    HT_CHECK_EQ(LoRa.readBytes(got, sizeof(got)), 0);
+
+    printf("receive %d bytes: per byte %u transactions %u transfers, burst %u transactions %u transfers\n",
+           PAYLOAD, (unsigned)before.transactions, (unsigned)before.transfers, (unsigned)after.transactions,
+           (unsigned)after.transfers);
+    /* available() and the FIFO, per byte or once */
+    HT_CHECK_EQ(before.transactions, 2 * PAYLOAD);
+    HT_CHECK_EQ(before.transfers, 4 * PAYLOAD);
+    HT_CHECK_EQ(after.transactions, 2);
+    HT_CHECK_EQ(after.transfers, 4);
+
+    /* a short read leaves the rest for the next one */
+    receive(payload);
+    HT_CHECK_EQ(LoRa.readBytes(got, 20), 20);
+    HT_CHECK_EQ(LoRa.available(), PAYLOAD - 20);
+    HT_CHECK_EQ(LoRa.readBytes(got + 20, sizeof(got)), PAYLOAD - 20);
+    HT_CHECK(memcmp(got, payload, PAYLOAD) == 0);
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- MAIN FUNCTION -------------------------------------------------------- */
+
+int main(void)
+{
+    test_send();
+    test_receive();
+
+    return HT_RESULT();
+}
+
+#endif /* ARDUINO */
@@ -0,0 +1,236 @@
+/**
+ * @file      test_loragw_reg_cache.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      T-ETH-Elite-Gateway-Shield loragw_reg register shadow cache, against a
+ *            mock SX1302 behind lgw_spi_*: registers the MCUs change behind the
+ *            host and self clearing triggers always reach the chip, and the SPI
+ *            transactions of writing and reading the whole register file without
+ *            cache, write-through and batched, with the same chip content.
+ */
+#ifndef ARDUINO     /* PC tool, PlatformIO compiles every file below src_dir */
+
+#include <string.h>
+#include "loragw_spi.h"
+#include "loragw_reg.h"
+#include "host_test.h"
+
+extern "C" const struct lgw_reg_s loregs[];
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define CHIP_SIZE           0x8000
+#define REG_FILE_START      0x5200      /* TX_TOP_A, the first register block */
+#define REG_FILE_END        0x6200      /* end of the OTP block */
+#define TX_TRIG_BITS        0x07        /* GPS, DELAYED and IMMEDIATE */
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+static uint8_t chip[CHIP_SIZE];
+static uint32_t spi_transactions;
+static uint32_t tx_triggers;
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static uint16_t reg_addr(uint16_t id)
+{
+    return loregs[id].addr;
+}
+
+/* the TX state machine starts and clears its trigger bits */
+static void chip_write(uint16_t addr, uint8_t data)
+{
+    chip[addr] = data;
+    if ((addr == reg_addr(SX1302_REG_TX_TOP_A_TX_TRIG_TX_TRIG_IMMEDIATE) ||
+         addr == reg_addr(SX1302_REG_TX_TOP_B_TX_TRIG_TX_TRIG_IMMEDIATE)) && (data & TX_TRIG_BITS)) {
+        tx_triggers++;
+        chip[addr] &= ~TX_TRIG_BITS;
+    }
+}
+
+extern "C" int lgw_spi_open(const char *spidev_path, void **spi_target_ptr)
+{
+    (void)spidev_path;
+    *spi_target_ptr = chip;
+    return LGW_SPI_SUCCESS;
+}
+
+extern "C" int lgw_spi_close(void *spi_target)
+{
+    (void)spi_target;
+    return LGW_SPI_SUCCESS;
+}
+
+extern "C" int lgw_spi_w(void *spi_target, uint8_t spi_mux_target, uint16_t address, uint8_t data)
+{
+    (void)spi_target;
+    (void)spi_mux_target;
+    spi_transactions++;
+    chip_write(address, data);
+    return LGW_SPI_SUCCESS;
+}
+
+extern "C" int lgw_spi_r(void *spi_target, uint8_t spi_mux_target, uint16_t address, uint8_t *data)
+{
+    (void)spi_target;
+    (void)spi_mux_target;
+    spi_transactions++;
+    *data = chip[address];
+    return LGW_SPI_SUCCESS;
+}
+
+extern "C" int lgw_spi_wb(void *spi_target, uint8_t spi_mux_target, uint16_t address, const uint8_t *data, uint16_t size)
+{
+    (void)spi_target;
+    (void)spi_mux_target;
+    spi_transactions++;
+    for (uint16_t i = 0; i < size; i++) {
+        chip_write(address + i, data[i]);
+    }
+    return LGW_SPI_SUCCESS;
+}
+
+extern "C" int lgw_spi_rb(void *spi_target, uint8_t spi_mux_target, uint16_t address, uint8_t *data, uint16_t size)
+{
+    (void)spi_target;
+    (void)spi_mux_target;
+    spi_transactions++;
+    memcpy(data, &chip[address], size);
+    return LGW_SPI_SUCCESS;
+}
+
+/* power on: registers cleared, the version register answers */
+static void chip_reset(bool cache)
+{
+    lgw_disconnect();
+    memset(chip, 0, sizeof(chip));
+    chip[reg_addr(SX1302_REG_COMMON_VERSION_VERSION)] = (uint8_t)loregs[SX1302_REG_COMMON_VERSION_VERSION].dflt;
+    HT_CHECK_EQ(lgw_connect("mock"), LGW_REG_SUCCESS);
+    HT_CHECK_EQ(lgw_reg_cache_enable(cache), LGW_REG_SUCCESS);
+    spi_transactions = 0;
+    tx_triggers = 0;
+}
+
+static int32_t reg_read(uint16_t id)
+{
+    int32_t v = -1;
+    HT_CHECK_EQ(lgw_reg_r(id, &v), LGW_REG_SUCCESS);
+    return v;
+}
+
+static void test_mcu_owned(void)
+{
+    chip_reset(true);
+
+    /* the AGC firmware switches the PA on, the host must see it */
+    HT_CHECK_EQ(reg_read(SX1302_REG_AGC_MCU_RF_EN_A_PA_EN), 0);
+    chip[reg_addr(SX1302_REG_AGC_MCU_RF_EN_A_PA_EN)] |= 1 << loregs[SX1302_REG_AGC_MCU_RF_EN_A_PA_EN].offs;
+    HT_CHECK_EQ(reg_read(SX1302_REG_AGC_MCU_RF_EN_A_PA_EN), 1);
+
+    /* the firmware changed the gain since the host last wrote it, writing it again must go out */
+    HT_CHECK_EQ(lgw_reg_w(SX1302_REG_AGC_MCU_PA_GAIN_PA_A_GAIN, 1), LGW_REG_SUCCESS);
+    chip[reg_addr(SX1302_REG_AGC_MCU_PA_GAIN_PA_A_GAIN)] |= 3 << loregs[SX1302_REG_AGC_MCU_PA_GAIN_PA_A_GAIN].offs;
+    HT_CHECK_EQ(lgw_reg_w(SX1302_REG_AGC_MCU_PA_GAIN_PA_A_GAIN, 1), LGW_REG_SUCCESS);
+    HT_CHECK_EQ((chip[reg_addr(SX1302_REG_AGC_MCU_PA_GAIN_PA_A_GAIN)] >> loregs[SX1302_REG_AGC_MCU_PA_GAIN_PA_A_GAIN].offs) & 3, 1);
+
+    /* the same mailbox command twice is two commands */
+    uint16_t mailbox = SX1302_REG_AGC_MCU_MCU_MAIL_BOX_WR_DATA_BYTE0_MCU_MAIL_BOX_WR_DATA;
+    HT_CHECK_EQ(lgw_reg_w(mailbox, 0x42), LGW_REG_SUCCESS);
+    chip[reg_addr(mailbox)] = 0;
+    spi_transactions = 0;
+    HT_CHECK_EQ(lgw_reg_w(mailbox, 0x42), LGW_REG_SUCCESS);
+    HT_CHECK_EQ(spi_transactions, 1);
+    HT_CHECK_EQ(chip[reg_addr(mailbox)], 0x42);
+}
+
+static void test_self_clearing(void)
+{
+    chip_reset(true);
+
+    /* two transmissions in a row, the TX state machine cleared the trigger in between */
+    HT_CHECK_EQ(lgw_reg_w(SX1302_REG_TX_TOP_A_TX_TRIG_TX_TRIG_IMMEDIATE, 1), LGW_REG_SUCCESS);
+    HT_CHECK_EQ(lgw_reg_w(SX1302_REG_TX_TOP_A_TX_TRIG_TX_TRIG_IMMEDIATE, 1), LGW_REG_SUCCESS);
+    HT_CHECK_EQ(tx_triggers, 2);
+
+    /* also in a batch */
+    HT_CHECK_EQ(lgw_reg_batch_begin(), LGW_REG_SUCCESS);
+    HT_CHECK_EQ(lgw_reg_w(SX1302_REG_TX_TOP_B_TX_TRIG_TX_TRIG_DELAYED, 1), LGW_REG_SUCCESS);
+    HT_CHECK_EQ(lgw_reg_w(SX1302_REG_TX_TOP_B_TX_TRIG_TX_TRIG_DELAYED, 1), LGW_REG_SUCCESS);
+    HT_CHECK_EQ(lgw_reg_batch_end(), LGW_REG_SUCCESS);
+    HT_CHECK_EQ(tx_triggers, 4);
+}
+
+/* every writable register once, as a boot configuration would */
+static uint32_t write_all(void)
+{
+    spi_transactions = 0;
+    for (uint16_t i = 0; i < LGW_TOTALREGS; i++) {
+        const struct lgw_reg_s *r = &loregs[i];
+        if (r->rdon || !r->chck) {
+            continue;
+        }
+        int32_t v = (int32_t)((i * 37u + 5u) & (r->leng < 32 ? (1u << r->leng) - 1 : 0xFFFFFFFFu));
+        lgw_reg_w(i, v);
+    }
+    return spi_transactions;
+}
+
+static uint32_t read_all(int32_t *values)
+{
+    spi_transactions = 0;
+    for (uint16_t i = 0; i < LGW_TOTALREGS; i++) {
+        values[i] = 0;
+        lgw_reg_r(i, &values[i]);
+    }
+    return spi_transactions;
+}
+
+static void test_transactions(void)
+{
+    static uint8_t image[REG_FILE_END - REG_FILE_START];
+    static int32_t values[LGW_TOTALREGS], cached_values[LGW_TOTALREGS];
+
+    chip_reset(false);
+    uint32_t plain = write_all();
+    memcpy(image, &chip[REG_FILE_START], sizeof(image));
+    uint32_t plain_read = read_all(values);
+
+    chip_reset(true);
+    uint32_t through = write_all();
+    HT_CHECK(memcmp(image, &chip[REG_FILE_START], sizeof(image)) == 0);
+    uint32_t cached_read = read_all(cached_values);
+    HT_CHECK(memcmp(values, cached_values, sizeof(values)) == 0);
+
+    chip_reset(true);
+    HT_CHECK_EQ(lgw_reg_batch_begin(), LGW_REG_SUCCESS);
+    write_all();
+    HT_CHECK_EQ(lgw_reg_batch_end(), LGW_REG_SUCCESS);
+    uint32_t batched = spi_transactions;
+    HT_CHECK(memcmp(image, &chip[REG_FILE_START], sizeof(image)) == 0);
+
+    printf("write all: no cache %u, write-through %u, batched %u transactions\n",
+           (unsigned)plain, (unsigned)through, (unsigned)batched);
+    printf("read all:  no cache %u, cached %u transactions\n", (unsigned)plain_read, (unsigned)cached_read);
+    HT_CHECK(through < plain);
+    HT_CHECK(batched < through / 2);
+    HT_CHECK(cached_read < plain_read / 2);
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- MAIN FUNCTION -------------------------------------------------------- */
+
+int main(void)
+{
+    test_mcu_owned();
+    test_self_clearing();
+    test_transactions();
+
+    lgw_disconnect();
+    return HT_RESULT();
+}
+
+#endif /* ARDUINO */
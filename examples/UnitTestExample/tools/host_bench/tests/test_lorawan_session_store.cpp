@@ -0,0 +1,123 @@
+/**
+ * @file      test_lorawan_session_store.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      RadioLib LoRaWANSessionStore: registering devices while the cold
+ *            storage fails. The node is never activated, the sessions are given
+ *            to add() as buffers.
+ */
+#ifndef ARDUINO     /* PC tool, PlatformIO compiles every file below src_dir */
+
+#include <string.h>
+#include "RadioLib.h"
+#include "host_test.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define HOT         RADIOLIB_LORAWAN_SESSION_STORE_HOT_SLOTS
+#define ADDR_BASE   0x26011000u
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE TYPES -------------------------------------------------------- */
+
+class MemStorage : public LoRaWANSessionStorage {
+public:
+    int16_t load(uint16_t index, uint8_t *nonces, uint8_t *session) override
+    {
+        if (!valid[index]) {
+            return RADIOLIB_LORAWAN_SESSION_NOT_FOUND;
+        }
+        memcpy(nonces, this->nonces[index], RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
+        memcpy(session, this->session[index], RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+        return RADIOLIB_ERR_NONE;
+    }
+
+    int16_t save(uint16_t index, const uint8_t *nonces, const uint8_t *session) override
+    {
+        if (fail) {
+            failed_saves++;
+            return RADIOLIB_ERR_UNKNOWN;
+        }
+        memcpy(this->nonces[index], nonces, RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
+        memcpy(this->session[index], session, RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+        valid[index] = true;
+        return RADIOLIB_ERR_NONE;
+    }
+
+    bool fail = false;
+    int failed_saves = 0;
+    bool valid[RADIOLIB_LORAWAN_SESSION_STORE_MAX_DEVICES] = {};
+    uint8_t nonces[RADIOLIB_LORAWAN_SESSION_STORE_MAX_DEVICES][RADIOLIB_LORAWAN_NONCES_BUF_SIZE];
+    uint8_t session[RADIOLIB_LORAWAN_SESSION_STORE_MAX_DEVICES][RADIOLIB_LORAWAN_SESSION_BUF_SIZE];
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+static LoRaWANNode node(nullptr, &EU868);
+static MemStorage storage;
+static LoRaWANSessionStore store(&node, &storage);
+static uint8_t nonces[RADIOLIB_LORAWAN_NONCES_BUF_SIZE];
+static uint8_t session[RADIOLIB_LORAWAN_SESSION_BUF_SIZE];
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static int16_t add_device(uint32_t addr)
+{
+    memset(nonces, (uint8_t)addr, sizeof(nonces));
+    memset(session, (uint8_t)addr, sizeof(session));
+    session[RADIOLIB_LORAWAN_SESSION_DEV_ADDR + 0] = (uint8_t)addr;
+    session[RADIOLIB_LORAWAN_SESSION_DEV_ADDR + 1] = (uint8_t)(addr >> 8);
+    session[RADIOLIB_LORAWAN_SESSION_DEV_ADDR + 2] = (uint8_t)(addr >> 16);
+    session[RADIOLIB_LORAWAN_SESSION_DEV_ADDR + 3] = (uint8_t)(addr >> 24);
+    return store.add(nonces, session);
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- MAIN FUNCTION -------------------------------------------------------- */
+
+int main(void)
+{
+    // the working set fills without touching the storage
+    for (uint32_t i = 0; i < HOT; i++) {
+        HT_CHECK_EQ(add_device(ADDR_BASE + i), RADIOLIB_ERR_NONE);
+    }
+    HT_CHECK_EQ(store.getNumDevices(), HOT);
+
+    // the next device needs an eviction, whose write-back fails
+    storage.fail = true;
+    const uint32_t extra = ADDR_BASE + HOT;
+    for (int i = 0; i < RADIOLIB_LORAWAN_SESSION_STORE_MAX_DEVICES + 1; i++) {
+        HT_CHECK(add_device(extra) != RADIOLIB_ERR_NONE);
+    }
+    HT_CHECK_EQ(storage.failed_saves, RADIOLIB_LORAWAN_SESSION_STORE_MAX_DEVICES + 1);
+    HT_CHECK(!store.contains(extra));
+    HT_CHECK_EQ(store.getNumDevices(), HOT);
+    HT_CHECK_EQ(store.getStats().evictions, 0);
+    for (uint32_t i = 0; i < HOT; i++) {
+        HT_CHECK(store.contains(ADDR_BASE + i));
+    }
+
+    // once the storage works again the device gets a slot and the oldest one is written back
+    storage.fail = false;
+    HT_CHECK_EQ(add_device(extra), RADIOLIB_ERR_NONE);
+    HT_CHECK(store.contains(extra));
+    HT_CHECK_EQ(store.getNumDevices(), HOT + 1);
+    HT_CHECK_EQ(store.getStats().evictions, 1);
+    HT_CHECK(storage.valid[0]);
+    HT_CHECK_EQ(storage.session[0][RADIOLIB_LORAWAN_SESSION_DEV_ADDR], (uint8_t)ADDR_BASE);
+
+    // a removed device frees its entry for the next one
+    HT_CHECK_EQ(store.remove(extra), RADIOLIB_ERR_NONE);
+    HT_CHECK_EQ(store.getNumDevices(), HOT);
+    HT_CHECK_EQ(add_device(extra + 1), RADIOLIB_ERR_NONE);
+    HT_CHECK_EQ(store.getNumDevices(), HOT + 1);
+    HT_CHECK(store.contains(ADDR_BASE));
+
+    return HT_RESULT();
+}
+
+#endif /* ARDUINO */
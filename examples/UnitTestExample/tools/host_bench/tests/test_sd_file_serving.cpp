@@ -0,0 +1,294 @@
+/**
+ * @file      test_sd_file_serving.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      SDWebServer handleFileRead() and parseRange(), from the sketch's
+ *            file_serving.cpp, with a temporary directory as the SD card and the
+ *            recording WebServer stub. Checks the answers to full, ranged,
+ *            conditional and gzip requests and prints the bytes each one moved.
+ */
+#ifndef ARDUINO     /* PC tool, PlatformIO compiles every file below src_dir */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <utime.h>
+#include <string>
+#include "file_serving.h"
+#include "host_test.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define PAGE_SIZE   10000               /* not a multiple of the sector size */
+#define JS_SIZE     3000
+#define GZ_SIZE     700
+#define MTIME       1700000000          /* Tue, 14 Nov 2023 22:13:20 GMT */
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+WebServer server(80);
+
+static std::string page;
+static char root[] = "/tmp/sd_file_serving_XXXXXX";
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static std::string make_file(const char *name, size_t size, uint32_t seed)
+{
+    std::string data(size, '\0');
+    for (size_t i = 0; i < size; i++) {
+        seed = seed * 1103515245u + 12345u;
+        data[i] = (char)(seed >> 16);
+    }
+
+    std::string path = std::string(root) + name;
+    FILE *fp = fopen(path.c_str(), "wb");
+    fwrite(data.data(), 1, size, fp);
+    fclose(fp);
+    struct utimbuf t = { MTIME, MTIME };
+    utime(path.c_str(), &t);
+    return data;
+}
+
+/* runs the handler for one request, headers are name, value pairs ending with NULL */
+static bool get(HTTPMethod method, const char *uri, const char *const *headers)
+{
+    server.request(method, uri);
+    for (; headers && headers[0]; headers += 2) {
+        server.addHeader(headers[0], headers[1]);
+    }
+    SD.stats = {};
+    return handleFileRead(uri);
+}
+
+static void report(const char *what)
+{
+    printf("%-28s %3d  header %4zu  body %6zu  card %6zu bytes\n", what, server.code,
+           server.headerBytes, server.bodyBytes(), SD.stats.bytes_read);
+}
+
+static bool body_is(size_t start, size_t len)
+{
+    return server.bodyBytes() == len && server.client().data == page.substr(start, len);
+}
+
+static void test_parse_range(void)
+{
+    size_t start = 0, end = 0;
+
+    HT_CHECK_EQ(parseRange("bytes=0-99", 1000, &start, &end), 1);
+    HT_CHECK(start == 0 && end == 99);
+    HT_CHECK_EQ(parseRange("bytes=900-", 1000, &start, &end), 1);
+    HT_CHECK(start == 900 && end == 999);
+    HT_CHECK_EQ(parseRange("bytes=-100", 1000, &start, &end), 1);
+    HT_CHECK(start == 900 && end == 999);
+    HT_CHECK_EQ(parseRange("bytes=-5000", 1000, &start, &end), 1);     /* suffix longer than the file */
+    HT_CHECK(start == 0 && end == 999);
+    HT_CHECK_EQ(parseRange("bytes=500-5000", 1000, &start, &end), 1);  /* last clamped */
+    HT_CHECK(start == 500 && end == 999);
+    HT_CHECK_EQ(parseRange("bytes=999-999", 1000, &start, &end), 1);
+    HT_CHECK(start == 999 && end == 999);
+
+    /* not satisfiable */
+    HT_CHECK_EQ(parseRange("bytes=1000-", 1000, &start, &end), -1);
+    HT_CHECK_EQ(parseRange("bytes=1000-1200", 1000, &start, &end), -1);
+    HT_CHECK_EQ(parseRange("bytes=-0", 1000, &start, &end), -1);
+    HT_CHECK_EQ(parseRange("bytes=-10", 0, &start, &end), -1);
+    HT_CHECK_EQ(parseRange("bytes=0-", 0, &start, &end), -1);
+
+    /* ignored, the whole file is sent */
+    HT_CHECK_EQ(parseRange("bytes=0-1,5-6", 1000, &start, &end), 0);
+    HT_CHECK_EQ(parseRange("bytes=20-10", 1000, &start, &end), 0);
+    HT_CHECK_EQ(parseRange("bytes=abc", 1000, &start, &end), 0);
+    HT_CHECK_EQ(parseRange("bytes=-", 1000, &start, &end), 0);
+    HT_CHECK_EQ(parseRange("bytes=-10x", 1000, &start, &end), 0);
+    HT_CHECK_EQ(parseRange("bytes=10-20x", 1000, &start, &end), 0);
+    HT_CHECK_EQ(parseRange("items=0-10", 1000, &start, &end), 0);
+    HT_CHECK_EQ(parseRange("", 1000, &start, &end), 0);
+}
+
+static void test_full(String *etag, String *last_modified)
+{
+    HT_CHECK(get(HTTP_GET, "/index.htm", nullptr));
+    report("full");
+    HT_CHECK_EQ(server.code, 200);
+    HT_CHECK(server.contentType == "text/html");
+    HT_CHECK_EQ(server.contentLength, PAGE_SIZE);
+    HT_CHECK(body_is(0, PAGE_SIZE));
+    HT_CHECK_EQ(SD.stats.bytes_read, PAGE_SIZE);
+    HT_CHECK(server.responseHeader("Accept-Ranges") == "bytes");
+    HT_CHECK(server.responseHeader("Last-Modified") == "Tue, 14 Nov 2023 22:13:20 GMT");
+    HT_CHECK(!server.hasResponseHeader("Content-Encoding"));
+    *etag = server.responseHeader("ETag");
+    *last_modified = server.responseHeader("Last-Modified");
+    HT_CHECK(etag->length() > 2);
+
+    /* a directory gets its index */
+    HT_CHECK(get(HTTP_GET, "/", nullptr));
+    HT_CHECK_EQ(server.code, 200);
+    HT_CHECK(body_is(0, PAGE_SIZE));
+
+    /* HEAD has the headers of the GET and no body */
+    HT_CHECK(get(HTTP_HEAD, "/index.htm", nullptr));
+    report("head");
+    HT_CHECK_EQ(server.code, 200);
+    HT_CHECK_EQ(server.contentLength, PAGE_SIZE);
+    HT_CHECK_EQ(server.bodyBytes(), 0);
+    HT_CHECK_EQ(SD.stats.bytes_read, 0);
+
+    HT_CHECK(!get(HTTP_GET, "/missing.htm", nullptr));
+}
+
+static void test_ranges(const String &etag)
+{
+    static const char *const first[] = { "Range", "bytes=0-99", nullptr };
+    HT_CHECK(get(HTTP_GET, "/index.htm", first));
+    report("range 0-99");
+    HT_CHECK_EQ(server.code, 206);
+    HT_CHECK(server.responseHeader("Content-Range") == "bytes 0-99/10000");
+    HT_CHECK_EQ(server.contentLength, 100);
+    HT_CHECK(body_is(0, 100));
+    HT_CHECK_EQ(SD.stats.bytes_read, 100);
+
+    /* crosses sector boundaries from an unaligned start */
+    static const char *const middle[] = { "Range", "bytes=1000-5999", nullptr };
+    HT_CHECK(get(HTTP_GET, "/index.htm", middle));
+    report("range 1000-5999");
+    HT_CHECK_EQ(server.code, 206);
+    HT_CHECK(server.responseHeader("Content-Range") == "bytes 1000-5999/10000");
+    HT_CHECK(body_is(1000, 5000));
+    HT_CHECK_EQ(SD.stats.bytes_read, 5000);
+
+    static const char *const suffix[] = { "Range", "bytes=-500", nullptr };
+    HT_CHECK(get(HTTP_GET, "/index.htm", suffix));
+    report("range -500");
+    HT_CHECK_EQ(server.code, 206);
+    HT_CHECK(server.responseHeader("Content-Range") == "bytes 9500-9999/10000");
+    HT_CHECK(body_is(9500, 500));
+
+    static const char *const open_end[] = { "Range", "bytes=9000-", nullptr };
+    HT_CHECK(get(HTTP_GET, "/index.htm", open_end));
+    report("range 9000-");
+    HT_CHECK_EQ(server.code, 206);
+    HT_CHECK(body_is(9000, 1000));
+
+    static const char *const outside[] = { "Range", "bytes=20000-", nullptr };
+    HT_CHECK(get(HTTP_GET, "/index.htm", outside));
+    report("range 20000-");
+    HT_CHECK_EQ(server.code, 416);
+    HT_CHECK(server.responseHeader("Content-Range") == "bytes */10000");
+    HT_CHECK_EQ(server.bodyBytes(), 0);
+    HT_CHECK_EQ(SD.stats.bytes_read, 0);
+
+    /* several ranges are not supported, the whole file is the valid answer */
+    static const char *const multi[] = { "Range", "bytes=0-1,5-6", nullptr };
+    HT_CHECK(get(HTTP_GET, "/index.htm", multi));
+    report("range 0-1,5-6");
+    HT_CHECK_EQ(server.code, 200);
+    HT_CHECK(!server.hasResponseHeader("Content-Range"));
+    HT_CHECK(body_is(0, PAGE_SIZE));
+
+    /* If-Range: the range only applies while the file is unchanged */
+    static const char *const if_range[] = { "Range", "bytes=0-99", "If-Range", etag.c_str(), nullptr };
+    HT_CHECK(get(HTTP_GET, "/index.htm", if_range));
+    HT_CHECK_EQ(server.code, 206);
+    HT_CHECK(body_is(0, 100));
+
+    static const char *const stale[] = { "Range", "bytes=0-99", "If-Range", "\"0-0\"", nullptr };
+    HT_CHECK(get(HTTP_GET, "/index.htm", stale));
+    report("range, stale If-Range");
+    HT_CHECK_EQ(server.code, 200);
+    HT_CHECK(body_is(0, PAGE_SIZE));
+}
+
+static void test_not_modified(const String &etag, const String &last_modified)
+{
+    const char *const match[] = { "If-None-Match", etag.c_str(), nullptr };
+    HT_CHECK(get(HTTP_GET, "/index.htm", match));
+    report("If-None-Match");
+    HT_CHECK_EQ(server.code, 304);
+    HT_CHECK_EQ(server.bodyBytes(), 0);
+    HT_CHECK_EQ(SD.stats.bytes_read, 0);
+    HT_CHECK(server.responseHeader("ETag") == etag);
+
+    const char *const since[] = { "If-Modified-Since", last_modified.c_str(), nullptr };
+    HT_CHECK(get(HTTP_GET, "/index.htm", since));
+    report("If-Modified-Since");
+    HT_CHECK_EQ(server.code, 304);
+    HT_CHECK_EQ(server.bodyBytes(), 0);
+
+    /* If-None-Match wins over a matching date */
+    const char *const changed[] = { "If-None-Match", "\"0-0\"", "If-Modified-Since", last_modified.c_str(), nullptr };
+    HT_CHECK(get(HTTP_GET, "/index.htm", changed));
+    HT_CHECK_EQ(server.code, 200);
+    HT_CHECK(body_is(0, PAGE_SIZE));
+
+    /* the file was rewritten, its validators changed */
+    struct utimbuf t = { MTIME + 60, MTIME + 60 };
+    utime((std::string(root) + "/index.htm").c_str(), &t);
+    HT_CHECK(get(HTTP_GET, "/index.htm", match));
+    HT_CHECK_EQ(server.code, 200);
+    HT_CHECK(server.responseHeader("ETag") != etag);
+    t = { MTIME, MTIME };
+    utime((std::string(root) + "/index.htm").c_str(), &t);
+}
+
+static void test_gzip(void)
+{
+    static const char *const gzip[] = { "Accept-Encoding", "gzip, deflate", nullptr };
+    HT_CHECK(get(HTTP_GET, "/app.js", gzip));
+    report("gzip accepted");
+    HT_CHECK_EQ(server.code, 200);
+    HT_CHECK(server.contentType == "application/javascript");
+    HT_CHECK(server.responseHeader("Content-Encoding") == "gzip");
+    HT_CHECK(server.responseHeader("Vary") == "Accept-Encoding");
+    HT_CHECK_EQ(server.bodyBytes(), GZ_SIZE);
+    HT_CHECK(server.responseHeader("ETag").endsWith("-gz\""));
+
+    HT_CHECK(get(HTTP_GET, "/app.js", nullptr));
+    report("gzip not accepted");
+    HT_CHECK_EQ(server.code, 200);
+    HT_CHECK(!server.hasResponseHeader("Content-Encoding"));
+    HT_CHECK_EQ(server.bodyBytes(), JS_SIZE);
+
+    /* only the .gz exists, it is sent either way */
+    HT_CHECK(get(HTTP_GET, "/only.css", nullptr));
+    HT_CHECK_EQ(server.code, 200);
+    HT_CHECK(server.responseHeader("Content-Encoding") == "gzip");
+    HT_CHECK_EQ(server.bodyBytes(), GZ_SIZE);
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- MAIN FUNCTION -------------------------------------------------------- */
+
+int main(void)
+{
+    String etag, last_modified;
+
+    if (!mkdtemp(root)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    SD.root = root;
+    page = make_file("/index.htm", PAGE_SIZE, 1);
+    make_file("/app.js", JS_SIZE, 2);
+    make_file("/app.js.gz", GZ_SIZE, 3);
+    make_file("/only.css.gz", GZ_SIZE, 4);
+
+    test_parse_range();
+    test_full(&etag, &last_modified);
+    test_ranges(etag);
+    test_not_modified(etag, last_modified);
+    test_gzip();
+
+    for (const char *name : { "/index.htm", "/app.js", "/app.js.gz", "/only.css.gz" }) {
+        unlink((std::string(root) + name).c_str());
+    }
+    rmdir(root);
+    return HT_RESULT();
+}
+
+#endif /* ARDUINO */
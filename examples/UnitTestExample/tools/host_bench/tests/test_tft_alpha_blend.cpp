@@ -0,0 +1,128 @@
+/**
+ * @file      test_tft_alpha_blend.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      TFT_eSPI alphaBlendSpan() and alphaBlendBuffer() give bit for bit the
+ *            colours of the per pixel alphaBlend(), for every alpha value, short
+ *            and odd widths and both alignments of the output.
+ */
+#ifndef ARDUINO     /* PC tool, PlatformIO compiles every file below src_dir */
+
+#include "Arduino.h"
+#include "TFT_eSPI.h"
+#include "host_test.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define RANDOM_PAIRS    2000
+#define MAX_EDGE_WIDTH  9
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+static TFT_eSPI tft;
+
+/* every alpha value, then the same in reverse so each one lands in both lanes of a word */
+static uint8_t alphas[512];
+
+/* channel extremes, where an overflow from one lane into the next would show */
+static const uint16_t edge_colours[] = {
+    0x0000, 0xFFFF, 0xF800, 0x07E0, 0x001F, 0xF81F, 0x07FF, 0xFFE0, 0x0821, 0xF7DE,
+};
+
+static uint32_t seed = 12345;
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static uint16_t next_colour(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return (uint16_t)(seed >> 16);
+}
+
+static uint16_t swap16(uint16_t c)
+{
+    return (uint16_t)((c >> 8) | (c << 8));
+}
+
+/* the 4 byte aligned buffer plus offset 1 gives the start that needs the lead pixel */
+static int check_span(uint16_t fg, uint16_t bg, const uint8_t *alpha, uint32_t len, int offset)
+{
+    alignas(4) uint16_t out[sizeof(alphas) + 2];
+    int bad = 0;
+
+    out[offset + len] = 0xA5A5;
+    tft.alphaBlendSpan(out + offset, alpha, len, fg, bg);
+    for (uint32_t i = 0; i < len; i++) {
+        bad += out[offset + i] != tft.alphaBlend(alpha[i], fg, bg, 0);
+    }
+    bad += out[offset + len] != 0xA5A5;
+    return bad;
+}
+
+static int check_buffer(uint16_t fg, const uint16_t *bg, const uint8_t *alpha, uint32_t len, bool swapped)
+{
+    uint16_t buf[sizeof(alphas) + 1];
+    int bad = 0;
+
+    for (uint32_t i = 0; i < len; i++) {
+        buf[i] = swapped ? swap16(bg[i]) : bg[i];
+    }
+    buf[len] = 0xA5A5;
+    tft.alphaBlendBuffer(buf, alpha, len, fg, swapped);
+    for (uint32_t i = 0; i < len; i++) {
+        uint16_t px = swapped ? swap16(buf[i]) : buf[i];
+        bad += px != tft.alphaBlend(alpha[i], fg, bg[i], 0);
+    }
+    bad += buf[len] != 0xA5A5;
+    return bad;
+}
+
+static void test_pair(uint16_t fg, uint16_t bg)
+{
+    uint16_t bgs[sizeof(alphas)];
+
+    for (size_t i = 0; i < sizeof(alphas); i++) {
+        bgs[i] = (uint16_t)(bg + i * 0x0841);
+    }
+    for (int offset = 0; offset < 2; offset++) {
+        HT_CHECK_EQ(check_span(fg, bg, alphas, sizeof(alphas), offset), 0);
+        for (uint32_t len = 0; len <= MAX_EDGE_WIDTH; len++) {
+            HT_CHECK_EQ(check_span(fg, bg, alphas + 250, len, offset), 0);
+        }
+    }
+    for (int swapped = 0; swapped < 2; swapped++) {
+        HT_CHECK_EQ(check_buffer(fg, bgs, alphas, sizeof(alphas), swapped), 0);
+        for (uint32_t len = 0; len <= MAX_EDGE_WIDTH; len++) {
+            HT_CHECK_EQ(check_buffer(fg, bgs, alphas + 250, len, swapped), 0);
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- MAIN FUNCTION -------------------------------------------------------- */
+
+int main(void)
+{
+    for (int i = 0; i < 256; i++) {
+        alphas[i] = (uint8_t)i;
+        alphas[511 - i] = (uint8_t)i;
+    }
+
+    for (uint16_t fg : edge_colours) {
+        for (uint16_t bg : edge_colours) {
+            test_pair(fg, bg);
+        }
+    }
+    for (int i = 0; i < RANDOM_PAIRS; i++) {
+        uint16_t fg = next_colour();
+        test_pair(fg, next_colour());
+    }
+
+    return HT_RESULT();
+}
+
+#endif /* ARDUINO */
@@ -0,0 +1,219 @@
+/**
+ * @file      test_u8g2_dirty_buffer.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      U8g2 u8g2_SendDirtyBuffer(): after random draws the display, captured
+ *            from the DRAW_TILE messages, is the same as one fed by u8g2_SendBuffer(),
+ *            and only the tiles marked dirty are sent. On a SSD1306 (vertical tiles)
+ *            and a ST7920 (horizontal buffer, whole tile rows).
+ */
+#ifndef ARDUINO     /* PC tool, PlatformIO compiles every file below src_dir */
+
+#include <string.h>
+#include "u8g2.h"
+#include "host_test.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define WIDTH           128
+#define HEIGHT          64
+#define TILE_COLS       (WIDTH / 8)
+#define TILE_ROWS       (HEIGHT / 8)
+#define FRAMES          3000
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE TYPES -------------------------------------------------------- */
+
+typedef void (*setup_fn)(u8g2_t *u8g2, const u8g2_cb_t *rotation, u8x8_msg_cb byte_cb, u8x8_msg_cb gpio_and_delay_cb);
+
+/* u8g2 first, the capture callback gets the u8x8_t at its start */
+struct display_s {
+    u8g2_t u8g2;
+    u8x8_msg_cb driver_cb;
+    uint8_t buf[WIDTH * HEIGHT / 8];
+    uint8_t screen[TILE_ROWS][TILE_COLS * 8];     /* what the display holds, as the tiles were sent */
+    uint16_t sent[TILE_ROWS];                     /* tiles sent since the last look, one bit per column */
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+static uint64_t seed = 88172645463325252ull;
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static uint32_t next_random(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return (uint32_t)seed;
+}
+
+static int random_in(int lo, int hi)
+{
+    return lo + (int)(next_random() % (uint32_t)(hi - lo + 1));
+}
+
+/* records the tiles, then lets the driver send them to the empty byte callback */
+static uint8_t capture_cb(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr)
+{
+    struct display_s *d = (struct display_s *)u8x8;
+
+    if (msg == U8X8_MSG_DISPLAY_DRAW_TILE) {
+        const u8x8_tile_t *tile = (const u8x8_tile_t *)arg_ptr;
+        /* arg_int repeats the cnt tiles at the following columns */
+        for (uint8_t r = 0; r < arg_int; r++) {
+            for (uint8_t i = 0; i < tile->cnt; i++) {
+                uint8_t col = tile->x_pos + r * tile->cnt + i;
+                memcpy(&d->screen[tile->y_pos][col * 8], tile->tile_ptr + i * 8, 8);
+                d->sent[tile->y_pos] |= 1u << col;
+            }
+        }
+    }
+    return d->driver_cb(u8x8, msg, arg_int, arg_ptr);
+}
+
+static void display_init(struct display_s *d, setup_fn setup, bool dirty)
+{
+    memset(d, 0, sizeof(*d));
+    setup(&d->u8g2, U8G2_R0, u8x8_byte_empty, u8x8_dummy_cb);
+    /* the setup functions of one size share a static buffer */
+    d->u8g2.tile_buf_ptr = d->buf;
+    d->driver_cb = d->u8g2.u8x8.display_cb;
+    d->u8g2.u8x8.display_cb = capture_cb;
+    u8g2_InitDisplay(&d->u8g2);
+    u8g2_SetPowerSave(&d->u8g2, 0);
+    /* the display powers up with noise, a tile that is never sent would show */
+    memset(d->screen, 0xA5, sizeof(d->screen));
+    if (dirty) {
+        u8g2_SetDirtyTracking(&d->u8g2, 1);
+    }
+}
+
+static void draw_random(u8g2_t *u8g2)
+{
+    /* reaching past the edges exercises the clipping */
+    int x = random_in(-20, WIDTH + 20);
+    int y = random_in(-20, HEIGHT + 20);
+    int w = random_in(0, 40);
+    int h = random_in(0, 40);
+
+    u8g2_SetDrawColor(u8g2, (uint8_t)random_in(0, 2));
+    switch (random_in(0, 8)) {
+    case 0:
+        u8g2_DrawPixel(u8g2, (u8g2_uint_t)x, (u8g2_uint_t)y);
+        break;
+    case 1:
+        u8g2_DrawHLine(u8g2, (u8g2_uint_t)x, (u8g2_uint_t)y, (u8g2_uint_t)w);
+        break;
+    case 2:
+        u8g2_DrawVLine(u8g2, (u8g2_uint_t)x, (u8g2_uint_t)y, (u8g2_uint_t)h);
+        break;
+    case 3:
+        u8g2_DrawBox(u8g2, (u8g2_uint_t)x, (u8g2_uint_t)y, (u8g2_uint_t)w, (u8g2_uint_t)h);
+        break;
+    case 4:
+        u8g2_DrawFrame(u8g2, (u8g2_uint_t)x, (u8g2_uint_t)y, (u8g2_uint_t)w, (u8g2_uint_t)h);
+        break;
+    case 5:
+        u8g2_DrawLine(u8g2, (u8g2_uint_t)random_in(0, WIDTH - 1), (u8g2_uint_t)random_in(0, HEIGHT - 1),
+                      (u8g2_uint_t)random_in(0, WIDTH - 1), (u8g2_uint_t)random_in(0, HEIGHT - 1));
+        break;
+    case 6:
+        u8g2_DrawCircle(u8g2, (u8g2_uint_t)x, (u8g2_uint_t)y, (u8g2_uint_t)(w / 2), U8G2_DRAW_ALL);
+        break;
+    case 7:
+        u8g2_DrawDisc(u8g2, (u8g2_uint_t)x, (u8g2_uint_t)y, (u8g2_uint_t)(h / 2), U8G2_DRAW_ALL);
+        break;
+    default:
+        u8g2_DrawTriangle(u8g2, x, y, x + w, y + random_in(-h, h), x + random_in(-w, w), y + h);
+        break;
+    }
+}
+
+static int tiles(const uint16_t *rows)
+{
+    int n = 0;
+    for (int ty = 0; ty < TILE_ROWS; ty++) {
+        n += __builtin_popcount(rows[ty]);
+    }
+    return n;
+}
+
+static void test_display(const char *name, setup_fn setup, bool whole_rows)
+{
+    static struct display_s full, dirty;
+    long full_tiles = 0, dirty_tiles = 0;
+    int mismatch = 0, not_marked = 0, first_tiles = 0;
+
+    display_init(&full, setup, false);
+    display_init(&dirty, setup, true);
+
+    for (int frame = 0; frame < FRAMES; frame++) {
+        /* the same draws on both, mostly a few small changes, sometimes a new screen */
+        int clear = frame > 0 && random_in(0, 15) == 0;
+        int draws = random_in(0, 4);
+        uint64_t frame_seed = seed;
+        struct display_s *both[] = { &full, &dirty };
+        for (struct display_s *d : both) {
+            seed = frame_seed;
+            if (clear) {
+                u8g2_ClearBuffer(&d->u8g2);
+            }
+            for (int i = 0; i < draws; i++) {
+                draw_random(&d->u8g2);
+            }
+        }
+
+        /* what u8g2_SendDirtyBuffer() has to send, the ST7920 takes whole tile rows */
+        uint16_t marked[TILE_ROWS];
+        for (int ty = 0; ty < TILE_ROWS; ty++) {
+            marked[ty] = dirty.u8g2.dirty_tiles[ty >> dirty.u8g2.dirty_row_shift];
+            if (whole_rows && marked[ty] != 0) {
+                marked[ty] = 0xffff;
+            }
+        }
+        memset(full.sent, 0, sizeof(full.sent));
+        memset(dirty.sent, 0, sizeof(dirty.sent));
+        u8g2_SendBuffer(&full.u8g2);
+        u8g2_SendDirtyBuffer(&dirty.u8g2);
+
+        mismatch += memcmp(full.screen, dirty.screen, sizeof(full.screen)) != 0;
+        not_marked += memcmp(marked, dirty.sent, sizeof(marked)) != 0;
+        full_tiles += tiles(full.sent);
+        dirty_tiles += tiles(dirty.sent);
+        if (frame == 0) {
+            first_tiles = tiles(dirty.sent);
+        }
+    }
+
+    printf("%-8s %d frames, SendBuffer %ld tiles, SendDirtyBuffer %ld tiles\n", name, FRAMES, full_tiles,
+           dirty_tiles);
+    HT_CHECK_EQ(mismatch, 0);
+    HT_CHECK_EQ(not_marked, 0);
+    /* tracking starts with everything dirty, then far less goes out */
+    HT_CHECK_EQ(first_tiles, TILE_COLS * TILE_ROWS);
+    HT_CHECK(dirty_tiles * 2 < full_tiles);
+
+    /* nothing drawn, nothing sent */
+    memset(dirty.sent, 0, sizeof(dirty.sent));
+    u8g2_SendDirtyBuffer(&dirty.u8g2);
+    HT_CHECK_EQ(tiles(dirty.sent), 0);
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- MAIN FUNCTION -------------------------------------------------------- */
+
+int main(void)
+{
+    test_display("ssd1306", u8g2_Setup_ssd1306_128x64_noname_f, false);
+    test_display("st7920", u8g2_Setup_st7920_s_128x64_f, true);
+
+    return HT_RESULT();
+}
+
+#endif /* ARDUINO */
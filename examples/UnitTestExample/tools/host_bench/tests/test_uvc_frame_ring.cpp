@@ -0,0 +1,246 @@
+/**
+ * @file      test_uvc_frame_ring.cpp
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-12
+ * @note      ESP32_USB_STREAM uvc_frame_ring, built with its pthread lock: order
+ *            across wraparound, dropping the oldest ready frame when full, a
+ *            consumer holding a frame while the producer laps the ring, and a
+ *            producer and a consumer thread checking no frame is torn.
+ */
+#ifndef ARDUINO     /* PC tool, PlatformIO compiles every file below src_dir */
+
+#include <string.h>
+#include <pthread.h>
+#include "uvc_frame_ring.h"
+#include "host_test.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE CONSTANTS ---------------------------------------------------- */
+
+#define SLOTS           3
+#define SLOT_SIZE       256
+#define THREAD_FRAMES   200000
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE VARIABLES ---------------------------------------------------- */
+
+static uint8_t slot_mem[SLOTS][SLOT_SIZE];
+static uint8_t *const buffers[SLOTS] = { slot_mem[0], slot_mem[1], slot_mem[2] };
+static uvc_frame_ring_t ring;
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+/* frame n is n + 1 bytes of n, so the length and every byte tell which frame it is */
+static int push(uint32_t n)
+{
+    uint8_t data[SLOT_SIZE];
+    size_t len = (n % (SLOT_SIZE - 1)) + 1;
+
+    memset(data, (uint8_t)n, len);
+    return uvc_frame_ring_push(&ring, data, len, 640, 480, 0, n, (int64_t)n * 33333);
+}
+
+static bool frame_is(const uvc_ring_frame_t *f, uint32_t n)
+{
+    size_t len = (n % (SLOT_SIZE - 1)) + 1;
+
+    if (f == NULL || f->sequence != n || f->data_bytes != len) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (f->data[i] != (uint8_t)n) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uvc_frame_ring_stats_t stats(void)
+{
+    uvc_frame_ring_stats_t s;
+    uvc_frame_ring_get_stats(&ring, &s);
+    return s;
+}
+
+static void test_init(void)
+{
+    uint8_t *const too_few[1] = { slot_mem[0] };
+    uint8_t *const with_null[2] = { slot_mem[0], NULL };
+
+    HT_CHECK_EQ(uvc_frame_ring_init(&ring, too_few, 1, SLOT_SIZE, UVC_FRAME_RING_FIFO), UVC_FRAME_RING_ERR_ARG);
+    HT_CHECK_EQ(uvc_frame_ring_init(&ring, with_null, 2, SLOT_SIZE, UVC_FRAME_RING_FIFO), UVC_FRAME_RING_ERR_ARG);
+    HT_CHECK_EQ(uvc_frame_ring_init(&ring, buffers, SLOTS, 0, UVC_FRAME_RING_FIFO), UVC_FRAME_RING_ERR_ARG);
+    HT_CHECK_EQ(uvc_frame_ring_init(&ring, buffers, UVC_FRAME_RING_MAX_SLOTS + 1, SLOT_SIZE, UVC_FRAME_RING_FIFO),
+                UVC_FRAME_RING_ERR_ARG);
+}
+
+static void test_wraparound(void)
+{
+    HT_CHECK_EQ(uvc_frame_ring_init(&ring, buffers, SLOTS, SLOT_SIZE, UVC_FRAME_RING_FIFO), UVC_FRAME_RING_OK);
+    HT_CHECK(uvc_frame_ring_acquire(&ring) == NULL);
+
+    /* the push order counter runs over 2^32 between the two frames of a round */
+    ring.order = 0xFFFFFFF1u;
+    uint32_t n = 0;
+    for (int round = 0; round < 40; round++) {
+        HT_CHECK_EQ(push(n), UVC_FRAME_RING_OK);
+        HT_CHECK_EQ(push(n + 1), UVC_FRAME_RING_OK);
+        uvc_ring_frame_t *a = uvc_frame_ring_acquire(&ring);
+        HT_CHECK(frame_is(a, n));
+        uvc_frame_ring_release(&ring, a);
+        uvc_ring_frame_t *b = uvc_frame_ring_acquire(&ring);
+        HT_CHECK(frame_is(b, n + 1));
+        uvc_frame_ring_release(&ring, b);
+        n += 2;
+    }
+    HT_CHECK(uvc_frame_ring_acquire(&ring) == NULL);
+
+    uvc_frame_ring_stats_t s = stats();
+    HT_CHECK_EQ(s.captured, n);
+    HT_CHECK_EQ(s.delivered, n);
+    HT_CHECK_EQ(s.overwritten, 0);
+    HT_CHECK_EQ(s.held, 0);
+    uvc_frame_ring_deinit(&ring);
+}
+
+static void test_drop_oldest(void)
+{
+    HT_CHECK_EQ(uvc_frame_ring_init(&ring, buffers, SLOTS, SLOT_SIZE, UVC_FRAME_RING_FIFO), UVC_FRAME_RING_OK);
+
+    /* nobody reads, the two oldest frames make room */
+    for (uint32_t n = 0; n < SLOTS + 2; n++) {
+        HT_CHECK_EQ(push(n), UVC_FRAME_RING_OK);
+    }
+    for (uint32_t n = 2; n < SLOTS + 2; n++) {
+        uvc_ring_frame_t *f = uvc_frame_ring_acquire(&ring);
+        HT_CHECK(frame_is(f, n));
+        uvc_frame_ring_release(&ring, f);
+    }
+    HT_CHECK(uvc_frame_ring_acquire(&ring) == NULL);
+
+    uvc_frame_ring_stats_t s = stats();
+    HT_CHECK_EQ(s.captured, SLOTS + 2);
+    HT_CHECK_EQ(s.overwritten, 2);
+    HT_CHECK_EQ(s.dropped_busy, 0);
+
+    /* a frame larger than a slot is refused, the ring is untouched */
+    uint8_t big[SLOT_SIZE + 1] = {};
+    HT_CHECK_EQ(uvc_frame_ring_push(&ring, big, sizeof(big), 0, 0, 0, 99, 0), UVC_FRAME_RING_ERR_SIZE);
+    HT_CHECK_EQ(stats().dropped_oversize, 1);
+    HT_CHECK(uvc_frame_ring_acquire(&ring) == NULL);
+    uvc_frame_ring_deinit(&ring);
+}
+
+static void test_held_while_lapped(void)
+{
+    HT_CHECK_EQ(uvc_frame_ring_init(&ring, buffers, SLOTS, SLOT_SIZE, UVC_FRAME_RING_LATEST), UVC_FRAME_RING_OK);
+
+    HT_CHECK_EQ(push(0), UVC_FRAME_RING_OK);
+    uvc_ring_frame_t *held = uvc_frame_ring_acquire(&ring);
+    HT_CHECK(frame_is(held, 0));
+
+    /* the producer laps the ring many times around the held slot */
+    for (uint32_t n = 1; n <= 50; n++) {
+        HT_CHECK_EQ(push(n), UVC_FRAME_RING_OK);
+    }
+    HT_CHECK(frame_is(held, 0));
+
+    /* latest mode hands out the newest and recycles the one still waiting */
+    uvc_ring_frame_t *latest = uvc_frame_ring_acquire(&ring);
+    HT_CHECK(frame_is(latest, 50));
+    HT_CHECK(uvc_frame_ring_acquire(&ring) == NULL);
+
+    uvc_frame_ring_stats_t s = stats();
+    HT_CHECK_EQ(s.captured, 51);
+    HT_CHECK_EQ(s.overwritten, 49);
+    HT_CHECK_EQ(s.held, 2);
+
+    /* every slot held: the new frame is dropped, the held ones stay as they are */
+    HT_CHECK_EQ(push(51), UVC_FRAME_RING_OK);
+    uvc_ring_frame_t *third = uvc_frame_ring_acquire(&ring);
+    HT_CHECK(frame_is(third, 51));
+    HT_CHECK_EQ(push(52), UVC_FRAME_RING_ERR_BUSY);
+    HT_CHECK_EQ(stats().dropped_busy, 1);
+    HT_CHECK_EQ(stats().held_max, SLOTS);
+    HT_CHECK(frame_is(held, 0));
+    HT_CHECK(frame_is(latest, 50));
+
+    /* a released slot takes frames again, releasing twice changes nothing */
+    uvc_frame_ring_release(&ring, held);
+    uvc_frame_ring_release(&ring, held);
+    HT_CHECK_EQ(stats().held, 2);
+    HT_CHECK_EQ(push(53), UVC_FRAME_RING_OK);
+    uvc_ring_frame_t *next = uvc_frame_ring_acquire(&ring);
+    HT_CHECK(frame_is(next, 53));
+    uvc_frame_ring_release(&ring, next);
+    uvc_frame_ring_release(&ring, latest);
+    uvc_frame_ring_release(&ring, third);
+    HT_CHECK_EQ(stats().held, 0);
+    uvc_frame_ring_deinit(&ring);
+}
+
+static void *producer(void *arg)
+{
+    (void)arg;
+    for (uint32_t n = 0; n < THREAD_FRAMES; n++) {
+        push(n);
+    }
+    return NULL;
+}
+
+static void test_threads(uvc_frame_ring_mode_t mode)
+{
+    pthread_t thread;
+    uint32_t got = 0, torn = 0, backwards = 0, last = 0;
+    bool first = true;
+
+    HT_CHECK_EQ(uvc_frame_ring_init(&ring, buffers, SLOTS, SLOT_SIZE, mode), UVC_FRAME_RING_OK);
+    pthread_create(&thread, NULL, producer, NULL);
+    while (true) {
+        /* looked at before acquiring, so the last frame is never left behind */
+        uvc_frame_ring_stats_t s = stats();
+        bool done = s.captured + s.dropped_busy == THREAD_FRAMES;
+        uvc_ring_frame_t *f = uvc_frame_ring_acquire(&ring);
+        if (f == NULL) {
+            if (done) {
+                break;
+            }
+            continue;
+        }
+        torn += !frame_is(f, f->sequence);
+        backwards += !first && f->sequence <= last;
+        last = f->sequence;
+        first = false;
+        got++;
+        uvc_frame_ring_release(&ring, f);
+    }
+    pthread_join(thread, NULL);
+
+    uvc_frame_ring_stats_t s = stats();
+    HT_CHECK(got > 0);
+    HT_CHECK_EQ(torn, 0);
+    HT_CHECK_EQ(backwards, 0);
+    HT_CHECK_EQ(s.delivered, got);
+    HT_CHECK_EQ(s.captured, s.delivered + s.overwritten);
+    HT_CHECK_EQ(s.held, 0);
+    uvc_frame_ring_deinit(&ring);
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- MAIN FUNCTION -------------------------------------------------------- */
+
+int main(void)
+{
+    test_init();
+    test_wraparound();
+    test_drop_oldest();
+    test_held_while_lapped();
+    test_threads(UVC_FRAME_RING_FIFO);
+    test_threads(UVC_FRAME_RING_LATEST);
+
+    return HT_RESULT();
+}
+
+#endif /* ARDUINO */
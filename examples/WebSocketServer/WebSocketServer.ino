@@ -5,6 +5,9 @@
  * @copyright Copyright (c) 2023  Shenzhen Xin Yuan Electronic Technology Co., Ltd
  * @date      2023-12-25
  * @note      HTTP Server API docs: https://docs.espressif.com/projects/esp-idf/en/latest/esp32s3/api-reference/protocols/esp_http_server.html
+ * @note      Every client connected to /ws also receives live telemetry through ws_hub:
+ *            records are coalesced into one frame per TELEMETRY_COALESCE_MS, the frame is
+ *            built once and shared by all clients, a client that can not keep up is closed.
  */
 #include <Arduino.h>
 #if ESP_ARDUINO_VERSION < ESP_ARDUINO_VERSION_VAL(3,0,0)
@@ -18,10 +21,53 @@
 #include "utilities.h"          //Board PinMap
 #include <esp_http_server.h>
 #include <WiFi.h>
+#include "ws_hub.h"
+
+// One telemetry record every TELEMETRY_INTERVAL_MS, sent in frames of TELEMETRY_COALESCE_MS
+#define TELEMETRY_INTERVAL_MS   10
+#define TELEMETRY_COALESCE_MS   50
 
 #if ESP_ARDUINO_VERSION < ESP_ARDUINO_VERSION_VAL(3,0,0)
 static httpd_handle_t server = NULL;
 
+/*
+ * The hub is used from the loop task (publish) and the httpd task (clients,
+ * sending), the mutex serializes both. Sockets are only written in the httpd
+ * task, through ws_hub_poll queued with httpd_queue_work.
+ */
+static struct ws_hub_s hub;
+static SemaphoreHandle_t hub_lock = NULL;
+static volatile bool hub_poll_queued = false;
+
+static int hub_send(void *arg, int fd, const uint8_t *buf, size_t len)
+{
+    int n = httpd_socket_send((httpd_handle_t)arg, fd, (const char *)buf, len, MSG_DONTWAIT);
+    // EAGAIN is reported as a timeout, the rest of the frame goes out on the next poll
+    return n == HTTPD_SOCK_ERR_TIMEOUT ? 0 : n;
+}
+
+static void hub_evict(void *arg, int fd)
+{
+    Serial.printf("Closing slow websocket client %d\n", fd);
+    httpd_sess_trigger_close((httpd_handle_t)arg, fd);
+}
+
+static void hub_poll_work(void *arg)
+{
+    xSemaphoreTake(hub_lock, portMAX_DELAY);
+    hub_poll_queued = false;
+    ws_hub_poll(&hub, millis());
+    xSemaphoreGive(hub_lock);
+}
+
+static void ws_close_fn(httpd_handle_t hd, int sockfd)
+{
+    xSemaphoreTake(hub_lock, portMAX_DELAY);
+    ws_hub_remove(&hub, sockfd);
+    xSemaphoreGive(hub_lock);
+    close(sockfd);
+}
+
 /*
  * Structure holding server handle
  * and internal socket fd in order
@@ -37,17 +83,14 @@ struct async_resp_arg {
  */
 void ws_async_send(void *arg)
 {
-    static const char *data = "Async data";
+    static const char data[] = "Async data";
     struct async_resp_arg *resp_arg = (struct async_resp_arg *)arg;
-    httpd_handle_t hd = resp_arg->hd;
-    int fd = resp_arg->fd;
-    httpd_ws_frame_t ws_pkt;
-    memset(&ws_pkt, 0, sizeof(httpd_ws_frame_t));
-    ws_pkt.payload = (uint8_t *)data;
-    ws_pkt.len = strlen(data);
-    ws_pkt.type = HTTPD_WS_TYPE_TEXT;
 
-    httpd_ws_send_frame_async(hd, fd, &ws_pkt);
+    // Through the hub, which owns the writes to the client sockets
+    xSemaphoreTake(hub_lock, portMAX_DELAY);
+    ws_hub_unicast(&hub, resp_arg->fd, WS_HUB_OPCODE_TEXT, data, sizeof(data) - 1);
+    ws_hub_poll(&hub, millis());
+    xSemaphoreGive(hub_lock);
     free(resp_arg);
 }
 
@@ -59,6 +102,24 @@ esp_err_t trigger_async_send(httpd_handle_t handle, httpd_req_t *req)
     return httpd_queue_work(handle, ws_async_send, resp_arg);
 }
 
+/*
+ * The client closes: answer with its status code through the hub, behind the
+ * frame it may be in the middle of, stop broadcasting to it and end the session.
+ * A reply the socket does not take at once is dropped with the connection.
+ */
+static esp_err_t ws_close_handshake(httpd_req_t *req, httpd_ws_frame_t *ws_pkt)
+{
+    int fd = httpd_req_to_sockfd(req);
+
+    xSemaphoreTake(hub_lock, portMAX_DELAY);
+    ws_hub_unicast(&hub, fd, WS_HUB_OPCODE_CLOSE, ws_pkt->payload, ws_pkt->len >= 2 ? 2 : 0);
+    ws_hub_poll(&hub, millis());
+    ws_hub_remove(&hub, fd);
+    xSemaphoreGive(hub_lock);
+    free(ws_pkt->payload);
+    return httpd_sess_trigger_close(req->handle, fd);
+}
+
 /*
  * This handler echos back the received ws data
  * and triggers an async send if certain message received
@@ -67,6 +128,11 @@ esp_err_t echo_handler(httpd_req_t *req)
 {
     if (req->method == HTTP_GET) {
         Serial.println( "Handshake done, the new connection was opened");
+        xSemaphoreTake(hub_lock, portMAX_DELAY);
+        if (ws_hub_add(&hub, httpd_req_to_sockfd(req)) != WS_HUB_SUCCESS) {
+            Serial.println("Too many telemetry clients");
+        }
+        xSemaphoreGive(hub_lock);
         return ESP_OK;
     }
     httpd_ws_frame_t ws_pkt;
@@ -98,16 +164,28 @@ esp_err_t echo_handler(httpd_req_t *req)
         Serial.printf( "Got packet with message: %s\n", ws_pkt.payload);
     }
     Serial.printf( "Packet type: %d\n", ws_pkt.type);
+    if (ws_pkt.type == HTTPD_WS_TYPE_PONG) {
+        free(buf);
+        return ESP_OK;
+    }
+    if (ws_pkt.type == HTTPD_WS_TYPE_CLOSE) {
+        return ws_close_handshake(req, &ws_pkt);
+    }
     if (ws_pkt.type == HTTPD_WS_TYPE_TEXT &&
             strcmp((char *)ws_pkt.payload, "Trigger async") == 0) {
         free(buf);
         return trigger_async_send(req->handle, req);
     }
 
-    ret = httpd_ws_send_frame(req, &ws_pkt);
-    if (ret != ESP_OK) {
-        Serial.printf( "httpd_ws_send_frame failed with %d\n", ret);
+    // A PING is answered with a PONG carrying its payload, anything else is echoed
+    uint8_t type = ws_pkt.type == HTTPD_WS_TYPE_PING ? WS_HUB_OPCODE_PONG : ws_pkt.type;
+    xSemaphoreTake(hub_lock, portMAX_DELAY);
+    if (ws_hub_unicast(&hub, httpd_req_to_sockfd(req), type, ws_pkt.payload, ws_pkt.len) != WS_HUB_SUCCESS) {
+        Serial.println("Echo failed");
+        ret = ESP_FAIL;
     }
+    ws_hub_poll(&hub, millis());
+    xSemaphoreGive(hub_lock);
     free(buf);
     return ret;
 }
@@ -117,13 +195,22 @@ static const httpd_uri_t ws = {
     .method     = HTTP_GET,
     .handler    = echo_handler,
     .user_ctx   = NULL,
-    .is_websocket = true
+    .is_websocket = true,
+    // PING and CLOSE come to echo_handler, the replies go through the hub
+    .handle_ws_control_frames = true
 };
 
 static httpd_handle_t start_webserver(void)
 {
     httpd_handle_t server = NULL;
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    struct ws_hub_conf_s hub_conf;
+
+    config.close_fn = ws_close_fn;
+
+    if (hub_lock == NULL) {
+        hub_lock = xSemaphoreCreateMutex();
+    }
 
     // Start the httpd server
     Serial.printf( "Starting server on port: '%d'\n", config.server_port);
@@ -131,6 +218,15 @@ static httpd_handle_t start_webserver(void)
         // Registering the ws handler
         Serial.println( "Registering URI handlers");
         httpd_register_uri_handler(server, &ws);
+
+        ws_hub_default_conf(&hub_conf);
+        hub_conf.coalesce_ms = TELEMETRY_COALESCE_MS;
+        hub_conf.send = hub_send;
+        hub_conf.evict = hub_evict;
+        hub_conf.arg = server;
+        xSemaphoreTake(hub_lock, portMAX_DELAY);
+        ws_hub_init(&hub, &hub_conf);
+        xSemaphoreGive(hub_lock);
         return server;
     }
     Serial.println( "Error starting server!");
@@ -139,8 +235,55 @@ static httpd_handle_t start_webserver(void)
 
 void stop_webserver(httpd_handle_t server)
 {
-    // Stop the httpd server
+    if (server == NULL) {
+        return;
+    }
+    // Stop the httpd server, the hub drops the frames still queued
     httpd_stop(server);
+    xSemaphoreTake(hub_lock, portMAX_DELAY);
+    ws_hub_deinit(&hub);
+    xSemaphoreGive(hub_lock);
+}
+
+void publish_telemetry()
+{
+    static uint32_t last_ms = 0;
+    static uint32_t seq = 0;
+    static uint32_t stats_ms = 0;
+    char record[96];
+
+    if (server == NULL) {
+        return;
+    }
+    uint32_t now = millis();
+    if (now - last_ms >= TELEMETRY_INTERVAL_MS) {
+        last_ms = now;
+        int len = snprintf(record, sizeof(record), "{\"seq\":%u,\"ms\":%u,\"heap\":%u}",
+                           (unsigned)seq++, (unsigned)now, (unsigned)ESP.getFreeHeap());
+        xSemaphoreTake(hub_lock, portMAX_DELAY);
+        ws_hub_publish(&hub, record, len, now);
+        xSemaphoreGive(hub_lock);
+    }
+
+    // Let the httpd task seal expired frames and write the client queues
+    if (!hub_poll_queued) {
+        hub_poll_queued = true;
+        if (httpd_queue_work(server, hub_poll_work, NULL) != ESP_OK) {
+            hub_poll_queued = false;
+        }
+    }
+
+    if (now - stats_ms >= 10000) {
+        struct ws_hub_stats_s stats;
+        stats_ms = now;
+        xSemaphoreTake(hub_lock, portMAX_DELAY);
+        ws_hub_get_stats(&hub, &stats);
+        xSemaphoreGive(hub_lock);
+        if (stats.clients) {
+            Serial.printf("Telemetry: %u clients, %u records in %u frames, %u bytes sent, %u evicted\n",
+                          stats.clients, stats.published, stats.frames, stats.bytes_sent, stats.evicted);
+        }
+    }
 }
 #endif
 
@@ -179,6 +322,7 @@ void WiFiEvent(arduino_event_id_t event)
         // Disconnect and end the echo service
 #if ESP_ARDUINO_VERSION < ESP_ARDUINO_VERSION_VAL(3,0,0)
         stop_webserver(server);
+        server = NULL;
 #endif
         break;
     case ARDUINO_EVENT_ETH_STOP:
@@ -223,5 +367,8 @@ void loop()
 #if !(ESP_ARDUINO_VERSION < ESP_ARDUINO_VERSION_VAL(3,0,0))
     Serial.println("The current version is not supported for the time being, please use versions below 3.0.");
     delay(1000);
+#else
+    publish_telemetry();
+    delay(1);
 #endif
 }
@@ -8,7 +8,11 @@ while True:
     ws = create_connection(url)
     data = input("Please enter message:")
     ws.send(data)
-    print("Message received:", ws.recv())
+    # skip the telemetry frames broadcast by the board, records start with {"seq"
+    reply = ws.recv()
+    while reply.startswith('{"seq"'):
+        reply = ws.recv()
+    print("Message received:", reply)
     if data == "q":
         ws.close()
         break
@@ -0,0 +1,179 @@
+/**
+ * @file      ws_hub_host.c
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-16
+ * @note      Runs ws_hub on a PC over non-blocking socket pairs: a number of clients
+ *            that read everything, and one that never reads and has to be evicted.
+ *            The frames received by every client are parsed and the records checked
+ *            against the published ones.
+ *
+ * build:  cc -O2 -o ws_hub_host ws_hub_host.c ../ws_hub.c
+ * usage:  ws_hub_host [clients] [records] [coalesce_ms]
+ */
+#ifndef ARDUINO     /* PC tool, PlatformIO compiles every file below src_dir */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "../ws_hub.h"
+
+#define MAX_CLIENTS     (WS_HUB_MAX_CLIENTS - 1)
+
+struct reader_s {
+    int         fd;
+    uint8_t     buf[8192];
+    size_t      len;
+    uint32_t    frames;
+    uint32_t    records;            /* next record number expected */
+    int         error;
+};
+
+static int host_send(void *arg, int fd, const uint8_t *buf, size_t len)
+{
+    ssize_t n = send(fd, buf, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+
+    (void)arg;
+    if (n < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+    }
+    return (int)n;
+}
+
+static void host_evict(void *arg, int fd)
+{
+    (void)arg;
+    printf("evicted fd %d\n", fd);
+    shutdown(fd, SHUT_RDWR);
+}
+
+/* read what is available and check every complete frame */
+static void reader_poll(struct reader_s *r)
+{
+    ssize_t n;
+    size_t hdr, len, pos;
+    uint8_t *payload;
+    char expect[32];
+    int i;
+
+    while ((n = recv(r->fd, r->buf + r->len, sizeof(r->buf) - r->len, MSG_DONTWAIT)) > 0) {
+        r->len += n;
+        for (;;) {
+            if (r->len < 2) {
+                break;
+            }
+            hdr = 2;
+            len = r->buf[1] & 0x7F;
+            if (len == 126) {
+                hdr = 4;
+                len = r->len >= 4 ? (size_t)r->buf[2] << 8 | r->buf[3] : 0;
+            } else if (len == 127) {
+                hdr = 10;
+                for (len = 0, i = 2; i < 10 && r->len >= 10; i++) {
+                    len = len << 8 | r->buf[i];
+                }
+            }
+            if (r->len < hdr || r->len < hdr + len) {
+                break;
+            }
+            if (r->buf[0] != (0x80 | WS_HUB_OPCODE_TEXT)) {
+                r->error = 1;
+            }
+            /* records are "rec <n> ..." separated by '\n' */
+            payload = r->buf + hdr;
+            for (pos = 0; pos < len;) {
+                snprintf(expect, sizeof(expect), "rec %u ", r->records);
+                if (strncmp((char *)payload + pos, expect, strlen(expect)) != 0) {
+                    r->error = 1;
+                }
+                r->records++;
+                while (pos < len && payload[pos] != '\n') {
+                    pos++;
+                }
+                pos++;
+            }
+            r->frames++;
+            memmove(r->buf, r->buf + hdr + len, r->len - hdr - len);
+            r->len -= hdr + len;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int clients = argc > 1 ? atoi(argv[1]) : 4;
+    uint32_t records = argc > 2 ? atoi(argv[2]) : 20000;
+    uint32_t coalesce_ms = argc > 3 ? atoi(argv[3]) : 20;
+    static struct reader_s readers[MAX_CLIENTS];
+    struct ws_hub_conf_s conf;
+    struct ws_hub_stats_s stats;
+    struct ws_hub_s hub;
+    int sv[2], slow[2], i, failed = 0, sndbuf = 4096;
+    uint32_t now = 0, rec;
+    char line[96];
+
+    if (clients < 1 || clients > MAX_CLIENTS) {
+        fprintf(stderr, "1..%d clients\n", MAX_CLIENTS);
+        return 2;
+    }
+
+    ws_hub_default_conf(&conf);
+    conf.coalesce_ms = coalesce_ms;
+    conf.send = host_send;
+    conf.evict = host_evict;
+    ws_hub_init(&hub, &conf);
+
+    for (i = 0; i < clients; i++) {
+        socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+        readers[i].fd = sv[1];
+        ws_hub_add(&hub, sv[0]);
+    }
+    socketpair(AF_UNIX, SOCK_STREAM, 0, slow);
+    setsockopt(slow[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+    ws_hub_add(&hub, slow[0]);
+
+    /* telemetry at one record per 2 ms of simulated time */
+    for (rec = 0; rec < records; rec++) {
+        snprintf(line, sizeof(line), "rec %u {\"t\":%u,\"temp\":%u.%02u,\"rssi\":-%u}",
+                 rec, now, 20 + rec % 10, rec % 100, 40 + rec % 50);
+        ws_hub_publish(&hub, line, strlen(line), now);
+        now += 2;
+        ws_hub_poll(&hub, now);
+        for (i = 0; i < clients; i++) {
+            reader_poll(&readers[i]);
+        }
+    }
+    ws_hub_flush(&hub);
+    for (int round = 0; round < 100; round++) {
+        ws_hub_poll(&hub, now);
+        for (i = 0; i < clients; i++) {
+            reader_poll(&readers[i]);
+        }
+    }
+
+    ws_hub_get_stats(&hub, &stats);
+    printf("published %u records in %u frames (%.1f records/frame, %u bytes)\n",
+           stats.published, stats.frames, (double)stats.published / stats.frames, stats.frame_bytes);
+    printf("queued %u, %u sends, %u bytes sent, %u would block, %u evicted, %u clients left\n",
+           stats.queued, stats.sends, stats.bytes_sent, stats.would_block, stats.evicted, stats.clients);
+    for (i = 0; i < clients; i++) {
+        if (readers[i].error || readers[i].records != records) {
+            printf("client %d: %u records, %u frames, %s\n", i, readers[i].records, readers[i].frames,
+                   readers[i].error ? "corrupt" : "incomplete");
+            failed = 1;
+        }
+    }
+    if (stats.evicted != 1) {
+        printf("the slow client was not evicted\n");
+        failed = 1;
+    }
+    printf("%s\n", failed ? "FAILED" : "all clients received every record");
+    ws_hub_deinit(&hub);
+    return failed;
+}
+
+#endif /* ARDUINO */
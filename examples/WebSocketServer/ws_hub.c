@@ -0,0 +1,339 @@
+/**
+ * @file      ws_hub.c
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-16
+ * @note      WebSocket broadcast hub, see ws_hub.h
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "ws_hub.h"
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE TYPES -------------------------------------------------------- */
+
+/* One frame shared by all the clients it is queued to. The header is written
+ * right in front of the payload so that header and payload go out in one send. */
+struct ws_msg_s {
+    uint16_t    refs;
+    uint8_t     hdr_len;
+    uint32_t    len;                /* payload length */
+    uint32_t    cap;                /* payload capacity */
+    uint8_t     buf[];              /* WS_HUB_MAX_HEADER bytes for the header, then the payload */
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PRIVATE FUNCTIONS DEFINITION ----------------------------------------- */
+
+static struct ws_msg_s *msg_new(uint32_t cap)
+{
+    struct ws_msg_s *m = malloc(sizeof(struct ws_msg_s) + WS_HUB_MAX_HEADER + cap);
+
+    if (m) {
+        m->refs = 1;
+        m->hdr_len = 0;
+        m->len = 0;
+        m->cap = cap;
+    }
+    return m;
+}
+
+static void msg_release(struct ws_msg_s *m)
+{
+    if (--m->refs == 0) {
+        free(m);
+    }
+}
+
+static uint8_t *msg_payload(struct ws_msg_s *m)
+{
+    return m->buf + WS_HUB_MAX_HEADER;
+}
+
+static const uint8_t *msg_frame(const struct ws_msg_s *m)
+{
+    return m->buf + WS_HUB_MAX_HEADER - m->hdr_len;
+}
+
+static uint32_t msg_frame_len(const struct ws_msg_s *m)
+{
+    return m->hdr_len + m->len;
+}
+
+/* RFC 6455 5.2, FIN set, no mask */
+static void msg_write_header(struct ws_msg_s *m, uint8_t opcode)
+{
+    uint8_t hdr[WS_HUB_MAX_HEADER];
+    uint8_t n = 2;
+    int i;
+
+    hdr[0] = 0x80 | opcode;
+    if (m->len < 126) {
+        hdr[1] = (uint8_t)m->len;
+    } else if (m->len <= 0xFFFF) {
+        hdr[1] = 126;
+        hdr[2] = (uint8_t)(m->len >> 8);
+        hdr[3] = (uint8_t)m->len;
+        n = 4;
+    } else {
+        hdr[1] = 127;
+        for (i = 0; i < 8; i++) {
+            hdr[2 + i] = i < 4 ? 0 : (uint8_t)(m->len >> ((7 - i) * 8));
+        }
+        n = 10;
+    }
+    m->hdr_len = n;
+    memcpy(m->buf + WS_HUB_MAX_HEADER - n, hdr, n);
+}
+
+static void client_clear(struct ws_client_s *c)
+{
+    while (c->count) {
+        msg_release(c->queue[c->head]);
+        c->head = (c->head + 1) % WS_HUB_QUEUE_LEN;
+        c->count--;
+    }
+    c->fd = -1;
+    c->head = 0;
+    c->offset = 0;
+    c->queued_bytes = 0;
+}
+
+static void client_evict(struct ws_hub_s *hub, struct ws_client_s *c)
+{
+    int fd = c->fd;
+
+    client_clear(c);
+    hub->stats.clients--;
+    hub->stats.evicted++;
+    if (hub->conf.evict) {
+        hub->conf.evict(hub->conf.arg, fd);
+    }
+}
+
+static void client_enqueue(struct ws_hub_s *hub, struct ws_client_s *c, struct ws_msg_s *m)
+{
+    uint32_t len = msg_frame_len(m);
+
+    if (c->count == WS_HUB_QUEUE_LEN || c->queued_bytes + len > hub->conf.max_queued_bytes) {
+        /* slow consumer, it would hold every frame published from now on */
+        client_evict(hub, c);
+        return;
+    }
+    m->refs++;
+    c->queue[(c->head + c->count) % WS_HUB_QUEUE_LEN] = m;
+    c->count++;
+    c->queued_bytes += len;
+    hub->stats.queued++;
+}
+
+/* write as much of the queue as the socket takes */
+static void client_service(struct ws_hub_s *hub, struct ws_client_s *c)
+{
+    struct ws_msg_s *m;
+    uint32_t len;
+    int n;
+
+    while (c->count) {
+        m = c->queue[c->head];
+        len = msg_frame_len(m);
+        n = hub->conf.send(hub->conf.arg, c->fd, msg_frame(m) + c->offset, len - c->offset);
+        hub->stats.sends++;
+        if (n < 0) {
+            client_evict(hub, c);
+            return;
+        }
+        hub->stats.bytes_sent += n;
+        c->offset += n;
+        if (c->offset < len) {
+            hub->stats.would_block++;
+            return;
+        }
+        c->offset = 0;
+        c->queued_bytes -= len;
+        c->head = (c->head + 1) % WS_HUB_QUEUE_LEN;
+        c->count--;
+        msg_release(m);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS DEFINITION ------------------------------------------ */
+
+void ws_hub_default_conf(struct ws_hub_conf_s *conf)
+{
+    memset(conf, 0, sizeof(*conf));
+    conf->opcode = WS_HUB_OPCODE_TEXT;
+    conf->separator = '\n';
+    conf->coalesce_ms = 20;
+    conf->max_frame = 1400;
+    conf->max_queued_bytes = 16 * 1024;
+}
+
+void ws_hub_init(struct ws_hub_s *hub, const struct ws_hub_conf_s *conf)
+{
+    int i;
+
+    memset(hub, 0, sizeof(*hub));
+    hub->conf = *conf;
+    for (i = 0; i < WS_HUB_MAX_CLIENTS; i++) {
+        hub->clients[i].fd = -1;
+    }
+}
+
+void ws_hub_deinit(struct ws_hub_s *hub)
+{
+    int i;
+
+    for (i = 0; i < WS_HUB_MAX_CLIENTS; i++) {
+        client_clear(&hub->clients[i]);
+    }
+    hub->stats.clients = 0;
+    if (hub->pending) {
+        msg_release(hub->pending);
+        hub->pending = NULL;
+    }
+}
+
+int ws_hub_add(struct ws_hub_s *hub, int fd)
+{
+    struct ws_client_s *free_slot = NULL;
+    int i;
+
+    for (i = 0; i < WS_HUB_MAX_CLIENTS; i++) {
+        if (hub->clients[i].fd == fd) {
+            return WS_HUB_SUCCESS;
+        }
+        if (hub->clients[i].fd < 0 && free_slot == NULL) {
+            free_slot = &hub->clients[i];
+        }
+    }
+    if (free_slot == NULL) {
+        return WS_HUB_ERROR;
+    }
+    client_clear(free_slot);
+    free_slot->fd = fd;
+    hub->stats.clients++;
+    return WS_HUB_SUCCESS;
+}
+
+void ws_hub_remove(struct ws_hub_s *hub, int fd)
+{
+    int i;
+
+    for (i = 0; i < WS_HUB_MAX_CLIENTS; i++) {
+        if (hub->clients[i].fd == fd && fd >= 0) {
+            client_clear(&hub->clients[i]);
+            hub->stats.clients--;
+            return;
+        }
+    }
+}
+
+int ws_hub_publish(struct ws_hub_s *hub, const void *data, size_t len, uint32_t now_ms)
+{
+    struct ws_msg_s *m = hub->pending;
+    uint32_t sep = 0;
+
+    hub->stats.published++;
+    if (hub->stats.clients == 0 || len > hub->conf.max_frame) {
+        hub->stats.dropped++;
+        return WS_HUB_ERROR;
+    }
+
+    if (m && hub->conf.separator != WS_HUB_NO_SEPARATOR) {
+        sep = 1;
+    }
+    if (m && m->len + sep + len > m->cap) {
+        ws_hub_flush(hub);
+        m = NULL;
+        sep = 0;
+    }
+    if (m == NULL) {
+        m = msg_new(hub->conf.coalesce_ms ? hub->conf.max_frame : (uint32_t)len);
+        if (m == NULL) {
+            hub->stats.dropped++;
+            return WS_HUB_ERROR;
+        }
+        hub->pending = m;
+        hub->pending_ms = now_ms;
+    }
+
+    if (sep) {
+        msg_payload(m)[m->len++] = (uint8_t)hub->conf.separator;
+    }
+    memcpy(msg_payload(m) + m->len, data, len);
+    m->len += len;
+
+    if (hub->conf.coalesce_ms == 0) {
+        ws_hub_flush(hub);
+    }
+    return WS_HUB_SUCCESS;
+}
+
+int ws_hub_unicast(struct ws_hub_s *hub, int fd, uint8_t opcode, const void *data, size_t len)
+{
+    struct ws_msg_s *m;
+    int i;
+
+    for (i = 0; i < WS_HUB_MAX_CLIENTS; i++) {
+        if (hub->clients[i].fd == fd && fd >= 0) {
+            break;
+        }
+    }
+    if (i == WS_HUB_MAX_CLIENTS || ((opcode & 0x8) && len > WS_HUB_MAX_CONTROL)) {
+        return WS_HUB_ERROR;
+    }
+    if ((m = msg_new((uint32_t)len)) == NULL) {
+        return WS_HUB_ERROR;
+    }
+    if (len) {
+        memcpy(msg_payload(m), data, len);
+    }
+    m->len = (uint32_t)len;
+    msg_write_header(m, opcode);
+    hub->stats.frames++;
+    hub->stats.frame_bytes += msg_frame_len(m);
+    client_enqueue(hub, &hub->clients[i], m);
+    msg_release(m);
+    return WS_HUB_SUCCESS;
+}
+
+void ws_hub_flush(struct ws_hub_s *hub)
+{
+    struct ws_msg_s *m = hub->pending;
+    int i;
+
+    if (m == NULL) {
+        return;
+    }
+    hub->pending = NULL;
+    msg_write_header(m, hub->conf.opcode);
+    hub->stats.frames++;
+    hub->stats.frame_bytes += msg_frame_len(m);
+    for (i = 0; i < WS_HUB_MAX_CLIENTS; i++) {
+        if (hub->clients[i].fd >= 0) {
+            client_enqueue(hub, &hub->clients[i], m);
+        }
+    }
+    msg_release(m);
+}
+
+void ws_hub_poll(struct ws_hub_s *hub, uint32_t now_ms)
+{
+    int i;
+
+    if (hub->pending && now_ms - hub->pending_ms >= hub->conf.coalesce_ms) {
+        ws_hub_flush(hub);
+    }
+    for (i = 0; i < WS_HUB_MAX_CLIENTS; i++) {
+        if (hub->clients[i].fd >= 0) {
+            client_service(hub, &hub->clients[i]);
+        }
+    }
+}
+
+void ws_hub_get_stats(const struct ws_hub_s *hub, struct ws_hub_stats_s *stats)
+{
+    *stats = hub->stats;
+}
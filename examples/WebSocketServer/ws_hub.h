@@ -0,0 +1,186 @@
+/**
+ * @file      ws_hub.h
+ * @license   MIT
+ * @copyright Copyright (c) 2024  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2024-07-16
+ * @note      WebSocket broadcast hub. Records published within the coalescing window
+ *            are packed into one frame, its header is serialized once and the same
+ *            reference counted buffer is queued to every client; nothing is copied
+ *            per client. Each client has its own send queue, sockets are written
+ *            without blocking and a client that falls too far behind is evicted.
+ *            The hub knows nothing about the HTTP server, sockets are written and
+ *            closed through callbacks, so it also runs on a PC (tools/ws_hub_host.c).
+ *            Not thread safe, the caller serializes the calls.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC CONSTANTS ----------------------------------------------------- */
+
+#define WS_HUB_SUCCESS          0
+#define WS_HUB_ERROR            -1
+
+#define WS_HUB_OPCODE_TEXT      0x1
+#define WS_HUB_OPCODE_BINARY    0x2
+#define WS_HUB_OPCODE_CLOSE     0x8
+#define WS_HUB_OPCODE_PING      0x9
+#define WS_HUB_OPCODE_PONG      0xA
+#define WS_HUB_MAX_CONTROL      125     /* payload limit of a control frame */
+
+#define WS_HUB_MAX_CLIENTS      8       /* esp_http_server opens 7 sockets by default */
+#define WS_HUB_QUEUE_LEN        16      /* frames waiting per client */
+#define WS_HUB_MAX_HEADER       10      /* unmasked server frame header */
+#define WS_HUB_NO_SEPARATOR     -1
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC TYPES --------------------------------------------------------- */
+
+/**
+@struct ws_hub_conf_s
+@brief Configuration of the hub
+*/
+struct ws_hub_conf_s {
+    uint8_t     opcode;             /*!> WS_HUB_OPCODE_TEXT or WS_HUB_OPCODE_BINARY */
+    int         separator;          /*!> byte between coalesced records, WS_HUB_NO_SEPARATOR for none */
+    uint32_t    coalesce_ms;        /*!> records published within this time share a frame, 0 to send each one */
+    uint32_t    max_frame;          /*!> max payload of a coalesced frame */
+    uint32_t    max_queued_bytes;   /*!> a client with more than this waiting is evicted */
+
+    /* write to a socket without blocking, return the bytes written, 0 if it would block, <0 on error */
+    int (*send)(void *arg, int fd, const uint8_t *buf, size_t len);
+    /* close a client, it has already been removed from the hub */
+    void (*evict)(void *arg, int fd);
+    void        *arg;
+};
+
+/**
+@struct ws_hub_stats_s
+@brief Counters of the hub
+*/
+struct ws_hub_stats_s {
+    uint32_t    published;          /*!> records published */
+    uint32_t    dropped;            /*!> records published without clients or larger than max_frame */
+    uint32_t    frames;             /*!> frames built */
+    uint32_t    frame_bytes;        /*!> header and payload bytes of the frames built */
+    uint32_t    queued;             /*!> frames queued to clients */
+    uint32_t    sends;              /*!> send callbacks */
+    uint32_t    bytes_sent;         /*!> bytes written to the sockets */
+    uint32_t    would_block;        /*!> sends that stopped on a full socket */
+    uint32_t    evicted;            /*!> clients closed for falling behind or a socket error */
+    uint8_t     clients;            /*!> clients connected */
+};
+
+struct ws_msg_s;
+
+/**
+@struct ws_client_s
+@brief Send queue of one client
+*/
+struct ws_client_s {
+    int         fd;                 /*!> -1 when the slot is free */
+    uint8_t     head;
+    uint8_t     count;
+    uint32_t    offset;             /*!> bytes of the head frame already written */
+    uint32_t    queued_bytes;
+    struct ws_msg_s *queue[WS_HUB_QUEUE_LEN];
+};
+
+/**
+@struct ws_hub_s
+@brief Hub state
+*/
+struct ws_hub_s {
+    struct ws_hub_conf_s conf;
+    struct ws_hub_stats_s stats;
+    struct ws_client_s clients[WS_HUB_MAX_CLIENTS];
+    struct ws_msg_s *pending;       /*!> frame being filled */
+    uint32_t    pending_ms;         /*!> time of the first record in the pending frame */
+};
+
+/* -------------------------------------------------------------------------- */
+/* --- PUBLIC FUNCTIONS PROTOTYPES ------------------------------------------ */
+
+/**
+@brief Fill a configuration with the default values, callbacks are left NULL
+*/
+void ws_hub_default_conf(struct ws_hub_conf_s *conf);
+
+/**
+@brief Prepare a hub
+@param hub hub state
+@param conf configuration, copied
+*/
+void ws_hub_init(struct ws_hub_s *hub, const struct ws_hub_conf_s *conf);
+
+/**
+@brief Drop all clients and frames
+*/
+void ws_hub_deinit(struct ws_hub_s *hub);
+
+/**
+@brief Start broadcasting to a socket, after the WebSocket handshake
+@return WS_HUB_SUCCESS or WS_HUB_ERROR if all the client slots are taken
+*/
+int ws_hub_add(struct ws_hub_s *hub, int fd);
+
+/**
+@brief Forget a socket, frames queued to it are released
+*/
+void ws_hub_remove(struct ws_hub_s *hub, int fd);
+
+/**
+@brief Publish a record to all clients
+The record is copied into the pending frame, which is queued once the coalescing
+window has expired (see ws_hub_poll), it is full, or coalesce_ms is 0.
+@param hub hub state
+@param data record
+@param len record length
+@param now_ms current time in milliseconds
+@return WS_HUB_SUCCESS or WS_HUB_ERROR if the record was dropped
+*/
+int ws_hub_publish(struct ws_hub_s *hub, const void *data, size_t len, uint32_t now_ms);
+
+/**
+@brief Send a frame to one client only
+Replies to a client have to go through the hub as well, a frame written directly
+to the socket could land in the middle of a partially sent broadcast frame. That
+includes the PONG and CLOSE answers to a client's PING and CLOSE, which
+esp_http_server writes itself unless the URI sets handle_ws_control_frames.
+@param hub hub state
+@param fd client socket
+@param opcode WS_HUB_OPCODE_TEXT, WS_HUB_OPCODE_BINARY or a control frame opcode
+@param data payload
+@param len payload length, at most WS_HUB_MAX_CONTROL for a control frame
+@return WS_HUB_SUCCESS or WS_HUB_ERROR if fd is not a client, the control payload
+is too long or out of memory
+*/
+int ws_hub_unicast(struct ws_hub_s *hub, int fd, uint8_t opcode, const void *data, size_t len);
+
+/**
+@brief Queue the pending frame now
+*/
+void ws_hub_flush(struct ws_hub_s *hub);
+
+/**
+@brief Queue the pending frame once its window has expired and write the queues to the sockets
+Call it regularly and after publishing.
+@param hub hub state
+@param now_ms current time in milliseconds
+*/
+void ws_hub_poll(struct ws_hub_s *hub, uint32_t now_ms);
+
+/**
+@brief Get a copy of the counters
+*/
+void ws_hub_get_stats(const struct ws_hub_s *hub, struct ws_hub_stats_s *stats);
+
+#ifdef __cplusplus
+}
+#endif
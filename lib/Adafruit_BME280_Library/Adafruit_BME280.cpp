@@ -266,6 +266,25 @@ uint32_t Adafruit_BME280::read24(byte reg) {
          uint32_t(buffer[2]);
 }
 
+/*!
+ *   @brief  Reads consecutive registers in a single transfer over I2C or SPI
+ *   @param reg the first register address to read from
+ *   @param buffer the buffer to read into
+ *   @param len the number of bytes to read
+ *   @returns true on success, false otherwise
+ */
+bool Adafruit_BME280::readBuffer(byte reg, uint8_t *buffer, uint8_t len) {
+  uint8_t cmd;
+
+  if (i2c_dev) {
+    cmd = uint8_t(reg);
+    return i2c_dev->write_then_read(&cmd, 1, buffer, len);
+  } else {
+    cmd = uint8_t(reg | 0x80);
+    return spi_dev->write_then_read(&cmd, 1, buffer, len);
+  }
+}
+
 /*!
  *  @brief  Take a new measurement (only possible in forced mode)
     @returns true in case of success else false
@@ -335,17 +354,13 @@ bool Adafruit_BME280::isReadingCalibration(void) {
 }
 
 /*!
- *   @brief  Returns the temperature from the sensor
- *   @returns the temperature read from the device
+ *   @brief  Compensates a raw temperature reading and updates t_fine
+ *   @param adc_T the 20 bit raw temperature value
+ *   @returns the temperature in degrees Celsius * 100
  */
-float Adafruit_BME280::readTemperature(void) {
+int32_t Adafruit_BME280::compensateTemperature(int32_t adc_T) {
   int32_t var1, var2;
 
-  int32_t adc_T = read24(BME280_REGISTER_TEMPDATA);
-  if (adc_T == 0x800000) // value in case temp measurement was disabled
-    return NAN;
-  adc_T >>= 4;
-
   var1 = (int32_t)((adc_T / 8) - ((int32_t)_bme280_calib.dig_T1 * 2));
   var1 = (var1 * ((int32_t)_bme280_calib.dig_T2)) / 2048;
   var2 = (int32_t)((adc_T / 16) - ((int32_t)_bme280_calib.dig_T1));
@@ -353,25 +368,17 @@ float Adafruit_BME280::readTemperature(void) {
 
   t_fine = var1 + var2 + t_fine_adjust;
 
-  int32_t T = (t_fine * 5 + 128) / 256;
-
-  return (float)T / 100;
+  return (t_fine * 5 + 128) / 256;
 }
 
 /*!
- *   @brief  Returns the pressure from the sensor
- *   @returns the pressure value (in Pascal) read from the device
+ *   @brief  Compensates a raw pressure reading, t_fine must be up to date
+ *   @param adc_P the 20 bit raw pressure value
+ *   @returns the pressure in Pascal * 256 (Q24.8)
  */
-float Adafruit_BME280::readPressure(void) {
+uint32_t Adafruit_BME280::compensatePressure(int32_t adc_P) {
   int64_t var1, var2, var3, var4;
 
-  readTemperature(); // must be done first to get t_fine
-
-  int32_t adc_P = read24(BME280_REGISTER_PRESSUREDATA);
-  if (adc_P == 0x800000) // value in case pressure measurement was disabled
-    return NAN;
-  adc_P >>= 4;
-
   var1 = ((int64_t)t_fine) - 128000;
   var2 = var1 * var1 * (int64_t)_bme280_calib.dig_P6;
   var2 = var2 + ((var1 * (int64_t)_bme280_calib.dig_P5) * 131072);
@@ -392,24 +399,17 @@ float Adafruit_BME280::readPressure(void) {
   var2 = (((int64_t)_bme280_calib.dig_P8) * var4) / 524288;
   var4 = ((var4 + var1 + var2) / 256) + (((int64_t)_bme280_calib.dig_P7) * 16);
 
-  float P = var4 / 256.0;
-
-  return P;
+  return (uint32_t)var4;
 }
 
 /*!
- *  @brief  Returns the humidity from the sensor
- *  @returns the humidity value read from the device
+ *   @brief  Compensates a raw humidity reading, t_fine must be up to date
+ *   @param adc_H the 16 bit raw humidity value
+ *   @returns the relative humidity in % * 1024 (Q22.10)
  */
-float Adafruit_BME280::readHumidity(void) {
+uint32_t Adafruit_BME280::compensateHumidity(int32_t adc_H) {
   int32_t var1, var2, var3, var4, var5;
 
-  readTemperature(); // must be done first to get t_fine
-
-  int32_t adc_H = read16(BME280_REGISTER_HUMIDDATA);
-  if (adc_H == 0x8000) // value in case humidity measurement was disabled
-    return NAN;
-
   var1 = t_fine - ((int32_t)76800);
   var2 = (int32_t)(adc_H * 16384);
   var3 = (int32_t)(((int32_t)_bme280_calib.dig_H4) * 1048576);
@@ -424,11 +424,209 @@ float Adafruit_BME280::readHumidity(void) {
   var5 = var3 - ((var4 * ((int32_t)_bme280_calib.dig_H1)) / 16);
   var5 = (var5 < 0 ? 0 : var5);
   var5 = (var5 > 419430400 ? 419430400 : var5);
-  uint32_t H = (uint32_t)(var5 / 4096);
 
-  return (float)H / 1024.0;
+  return (uint32_t)(var5 / 4096);
+}
+
+/*!
+ *   @brief  Returns the temperature from the sensor
+ *   @returns the temperature read from the device
+ */
+float Adafruit_BME280::readTemperature(void) {
+  int32_t adc_T = read24(BME280_REGISTER_TEMPDATA);
+  if (adc_T == 0x800000) // value in case temp measurement was disabled
+    return NAN;
+  adc_T >>= 4;
+
+  return (float)compensateTemperature(adc_T) / 100;
+}
+
+/*!
+ *   @brief  Returns the pressure from the sensor
+ *   @returns the pressure value (in Pascal) read from the device
+ */
+float Adafruit_BME280::readPressure(void) {
+  uint8_t buffer[6];
+
+  // pressure and temperature (for t_fine) are adjacent, read both at once
+  readBuffer(BME280_REGISTER_PRESSUREDATA, buffer, 6);
+
+  int32_t adc_T = uint32_t(buffer[3]) << 16 | uint32_t(buffer[4]) << 8 |
+                  uint32_t(buffer[5]);
+  if (adc_T != 0x800000) // must be done first to get t_fine
+    compensateTemperature(adc_T >> 4);
+
+  int32_t adc_P = uint32_t(buffer[0]) << 16 | uint32_t(buffer[1]) << 8 |
+                  uint32_t(buffer[2]);
+  if (adc_P == 0x800000) // value in case pressure measurement was disabled
+    return NAN;
+  adc_P >>= 4;
+
+  return compensatePressure(adc_P) / 256.0;
 }
 
+/*!
+ *  @brief  Returns the humidity from the sensor
+ *  @returns the humidity value read from the device
+ */
+float Adafruit_BME280::readHumidity(void) {
+  uint8_t buffer[5];
+
+  // temperature (for t_fine) and humidity are adjacent, read both at once
+  readBuffer(BME280_REGISTER_TEMPDATA, buffer, 5);
+
+  int32_t adc_T = uint32_t(buffer[0]) << 16 | uint32_t(buffer[1]) << 8 |
+                  uint32_t(buffer[2]);
+  if (adc_T != 0x800000) // must be done first to get t_fine
+    compensateTemperature(adc_T >> 4);
+
+  int32_t adc_H = uint16_t(buffer[3]) << 8 | uint16_t(buffer[4]);
+  if (adc_H == 0x8000) // value in case humidity measurement was disabled
+    return NAN;
+
+  return (float)compensateHumidity(adc_H) / 1024.0;
+}
+
+/*!
+ *   @brief  Reads temperature, pressure and humidity in a single burst
+ *           transfer and compensates them in integer math. All three
+ *           values come from the same measurement, since the sensor keeps
+ *           the data registers locked while a burst read is going on.
+ *   @param sample the sample to fill in, see bme280_sample for the units.
+ *           Disabled measurements are set to BME280_TEMPERATURE_SKIPPED or
+ *           BME280_VALUE_SKIPPED.
+ *   @returns true on success, false if the bus transfer failed
+ */
+bool Adafruit_BME280::readAll(bme280_sample *sample) {
+  uint8_t buffer[8];
+
+  if (!readBuffer(BME280_REGISTER_PRESSUREDATA, buffer, 8))
+    return false;
+
+  int32_t adc_P = uint32_t(buffer[0]) << 16 | uint32_t(buffer[1]) << 8 |
+                  uint32_t(buffer[2]);
+  int32_t adc_T = uint32_t(buffer[3]) << 16 | uint32_t(buffer[4]) << 8 |
+                  uint32_t(buffer[5]);
+  int32_t adc_H = uint16_t(buffer[6]) << 8 | uint16_t(buffer[7]);
+
+  sample->timestamp = millis();
+  sample->temperature = (adc_T == 0x800000)
+                            ? BME280_TEMPERATURE_SKIPPED
+                            : compensateTemperature(adc_T >> 4);
+  sample->pressure = (adc_P == 0x800000) ? BME280_VALUE_SKIPPED
+                                         : compensatePressure(adc_P >> 4);
+  sample->humidity =
+      (adc_H == 0x8000) ? BME280_VALUE_SKIPPED : compensateHumidity(adc_H);
+  return true;
+}
+
+/*!
+ *   @brief  Returns the time between two measurements in normal mode
+ *   @returns the maximum measurement time plus the standby time, in
+ *            microseconds (see DS 9.1 and 9.2)
+ */
+uint32_t Adafruit_BME280::getSamplePeriod(void) {
+  static const uint16_t oversampling[8] = {0, 1, 2, 4, 8, 16, 16, 16};
+  static const uint32_t standby[8] = {500,    62500, 125000, 250000,
+                                      500000, 1000000, 10000, 20000};
+
+  uint32_t period = 1250 + 2300 * oversampling[_measReg.osrs_t];
+  if (_measReg.osrs_p)
+    period += 2300 * oversampling[_measReg.osrs_p] + 575;
+  if (_humReg.osrs_h)
+    period += 2300 * oversampling[_humReg.osrs_h] + 575;
+
+  return period + standby[_configReg.t_sb];
+}
+
+/*!
+ *   @brief  Starts collecting samples into a ring buffer. The sensor has to
+ *           be in normal mode, updateSampler() then reads a new sample
+ *           with readAll() once per getSamplePeriod(). When the buffer is
+ *           full the oldest sample is overwritten.
+ *   @param buffer storage for the samples, must stay valid until
+ *           stopSampler() is called
+ *   @param length number of samples the buffer can hold
+ *   @returns true on success, false if not in normal mode or no buffer
+ */
+bool Adafruit_BME280::startSampler(bme280_sample *buffer, uint16_t length) {
+  if (!buffer || !length || (_measReg.mode != MODE_NORMAL))
+    return false;
+
+  _samples = buffer;
+  _samplesLength = length;
+  _samplesHead = 0;
+  _samplesCount = 0;
+  _samplesDropped = 0;
+  _samplePeriod = getSamplePeriod();
+  _sampleLast = micros() - _samplePeriod; // first sample right away
+  return true;
+}
+
+/*!
+ *   @brief  Stops collecting samples, the buffer is no longer used
+ */
+void Adafruit_BME280::stopSampler(void) {
+  _samples = NULL;
+  _samplesCount = 0;
+}
+
+/*!
+ *   @brief  Reads a new sample into the ring buffer if the sample period
+ *           has passed. Call this from loop() at least once per period.
+ *   @returns true if a sample was stored, false otherwise
+ */
+bool Adafruit_BME280::updateSampler(void) {
+  if (!_samples || (micros() - _sampleLast) < _samplePeriod)
+    return false;
+
+  bme280_sample sample;
+  if (!readAll(&sample))
+    return false;
+
+  // keep to the schedule, but don't try to catch up after a long stall
+  _sampleLast += _samplePeriod;
+  if ((micros() - _sampleLast) >= _samplePeriod)
+    _sampleLast = micros();
+
+  if (_samplesCount == _samplesLength) {
+    _samplesCount--; // overwrite the oldest sample
+    _samplesDropped++;
+  }
+  _samples[_samplesHead] = sample;
+  _samplesHead = (_samplesHead + 1) % _samplesLength;
+  _samplesCount++;
+  return true;
+}
+
+/*!
+ *   @brief  Returns the number of samples waiting in the ring buffer
+ *   @returns the number of samples readSample() can return
+ */
+uint16_t Adafruit_BME280::samplesAvailable(void) { return _samplesCount; }
+
+/*!
+ *   @brief  Takes the oldest sample from the ring buffer
+ *   @param sample the sample to fill in
+ *   @returns true on success, false if the buffer is empty
+ */
+bool Adafruit_BME280::readSample(bme280_sample *sample) {
+  if (!_samplesCount)
+    return false;
+
+  uint16_t tail =
+      (_samplesHead + _samplesLength - _samplesCount) % _samplesLength;
+  *sample = _samples[tail];
+  _samplesCount--;
+  return true;
+}
+
+/*!
+ *   @brief  Returns the number of samples overwritten before being read
+ *   @returns the number of dropped samples since startSampler()
+ */
+uint32_t Adafruit_BME280::samplesDropped(void) { return _samplesDropped; }
+
 /*!
  *   Calculates the altitude (in meters) from the specified atmospheric
  *   pressure (in hPa), and sea-level pressure (in hPa).
@@ -103,6 +103,29 @@ typedef struct {
   int16_t dig_H5; ///< humidity compensation value
   int8_t dig_H6;  ///< humidity compensation value
 } bme280_calib_data;
+
+/*!
+ *  @brief  value of a sample field whose measurement is disabled
+ *          (SAMPLING_NONE)
+ */
+#define BME280_TEMPERATURE_SKIPPED INT32_MIN
+/*!
+ *  @brief  value of a sample field whose measurement is disabled
+ *          (SAMPLING_NONE)
+ */
+#define BME280_VALUE_SKIPPED UINT32_MAX
+
+/**************************************************************************/
+/*!
+    @brief  compensated sample in fixed point, as filled in by readAll()
+*/
+/**************************************************************************/
+typedef struct {
+  uint32_t timestamp;  ///< millis() when the sample was read
+  int32_t temperature; ///< degrees Celsius * 100, 5123 = 51.23 C
+  uint32_t pressure;   ///< Pascal * 256 (Q24.8), 24674867 = 96386.2 Pa
+  uint32_t humidity;   ///< %RH * 1024 (Q22.10), 47445 = 46.333 %RH
+} bme280_sample;
 /*=========================================================================*/
 
 class Adafruit_BME280;
@@ -229,6 +252,15 @@ public:
   float readTemperature(void);
   float readPressure(void);
   float readHumidity(void);
+  bool readAll(bme280_sample *sample);
+
+  bool startSampler(bme280_sample *buffer, uint16_t length);
+  void stopSampler(void);
+  bool updateSampler(void);
+  uint16_t samplesAvailable(void);
+  bool readSample(bme280_sample *sample);
+  uint32_t samplesDropped(void);
+  uint32_t getSamplePeriod(void);
 
   float readAltitude(float seaLevel);
   float seaLevelForAltitude(float altitude, float pressure);
@@ -264,6 +296,11 @@ protected:
   int16_t readS16(byte reg);
   uint16_t read16_LE(byte reg); // little endian
   int16_t readS16_LE(byte reg); // little endian
+  bool readBuffer(byte reg, uint8_t *buffer, uint8_t len);
+
+  int32_t compensateTemperature(int32_t adc_T);
+  uint32_t compensatePressure(int32_t adc_P);
+  uint32_t compensateHumidity(int32_t adc_H);
 
   uint8_t _i2caddr;  //!< I2C addr for the TwoWire interface
   int32_t _sensorID; //!< ID of the BME Sensor
@@ -276,6 +313,14 @@ protected:
 
   bme280_calib_data _bme280_calib; //!< here calibration data is stored
 
+  bme280_sample *_samples = NULL; //!< sampler ring buffer, NULL if stopped
+  uint16_t _samplesLength = 0;    //!< number of entries in _samples
+  uint16_t _samplesHead = 0;      //!< next entry to be written
+  uint16_t _samplesCount = 0;     //!< entries not read yet
+  uint32_t _samplesDropped = 0;   //!< samples overwritten before being read
+  uint32_t _samplePeriod = 0;     //!< sampler period in microseconds
+  uint32_t _sampleLast = 0;       //!< micros() of the last scheduled sample
+
   /**************************************************************************/
   /*!
       @brief  config register
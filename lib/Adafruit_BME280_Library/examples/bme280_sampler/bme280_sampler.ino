@@ -0,0 +1,91 @@
+/***************************************************************************
+  This is a library for the BME280 humidity, temperature & pressure sensor
+
+  This example runs the sensor in normal mode and collects samples into a
+  ring buffer with updateSampler(). Each sample is a single burst read of
+  all data registers, compensated in integer math by readAll(). Once a
+  second the buffered samples are printed, together with the time taken by
+  readAll() and by the three separate read functions.
+
+  Written for Adafruit Industries.
+  BSD license, all text above must be included in any redistribution
+  See the LICENSE file for details.
+ ***************************************************************************/
+
+#include <Wire.h>
+#include <SPI.h>
+#include <Adafruit_Sensor.h>
+#include <Adafruit_BME280.h>
+
+#define SAMPLE_BUFFER_LENGTH 32
+
+Adafruit_BME280 bme; // I2C
+
+bme280_sample samples[SAMPLE_BUFFER_LENGTH];
+unsigned long lastReport = 0;
+
+void setup() {
+  Serial.begin(9600);
+  Serial.println(F("BME280 sampler test"));
+
+  if (!bme.begin()) {
+    Serial.println("Could not find a valid BME280 sensor, check wiring!");
+    while (1);
+  }
+
+  // normal mode, 1x oversampling, 62.5 ms standby -> about 14 samples/s
+  bme.setSampling(Adafruit_BME280::MODE_NORMAL,
+                  Adafruit_BME280::SAMPLING_X1, // temperature
+                  Adafruit_BME280::SAMPLING_X1, // pressure
+                  Adafruit_BME280::SAMPLING_X1, // humidity
+                  Adafruit_BME280::FILTER_OFF,
+                  Adafruit_BME280::STANDBY_MS_62_5);
+
+  Serial.print("Sample period: ");
+  Serial.print(bme.getSamplePeriod());
+  Serial.println(" us");
+
+  bme.startSampler(samples, SAMPLE_BUFFER_LENGTH);
+}
+
+void loop() {
+  bme.updateSampler();
+
+  if (millis() - lastReport < 1000)
+    return;
+  lastReport = millis();
+
+  bme280_sample sample;
+  uint16_t count = bme.samplesAvailable();
+  while (bme.readSample(&sample)) {
+    Serial.print(sample.timestamp);
+    Serial.print(" ms: ");
+    Serial.print(sample.temperature / 100.0);
+    Serial.print(" *C, ");
+    Serial.print(sample.pressure / 25600.0);
+    Serial.print(" hPa, ");
+    Serial.print(sample.humidity / 1024.0);
+    Serial.println(" %");
+  }
+  Serial.print(count);
+  Serial.print(" samples, ");
+  Serial.print(bme.samplesDropped());
+  Serial.println(" dropped");
+
+  unsigned long start = micros();
+  bme.readAll(&sample);
+  unsigned long burst = micros() - start;
+
+  start = micros();
+  bme.readTemperature();
+  bme.readPressure();
+  bme.readHumidity();
+  unsigned long separate = micros() - start;
+
+  Serial.print("readAll(): ");
+  Serial.print(burst);
+  Serial.print(" us, readTemperature/Pressure/Humidity(): ");
+  Serial.print(separate);
+  Serial.println(" us");
+  Serial.println();
+}
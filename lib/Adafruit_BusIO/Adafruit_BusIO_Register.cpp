@@ -147,26 +147,59 @@ bool Adafruit_BusIO_Register::write(uint32_t value, uint8_t numbytes) {
     return false;
   }
 
+  if (_cachemode != BUSIO_CACHE_NONE) {
+    if (numbytes != _width) {
+      // partial write, the copy no longer matches the register
+      if (!flush()) {
+        return false;
+      }
+      _cachevalid = false;
+    } else {
+      _cachevalid = true;
+      if (_cachemode == BUSIO_CACHE_WRITE_BACK) {
+        _cached = value;
+        _dirty = true;
+        return true;
+      }
+    }
+  }
+
   // store a copy
   _cached = value;
 
+  encode(value, numbytes, _buffer);
+  return write(_buffer, numbytes);
+}
+
+/*!
+ *    @brief  Convert a value to register bytes in the register byte order
+ *    @param  value Data to convert
+ *    @param  numbytes How many bytes from 'value' to convert
+ *    @param  buffer Pointer to at least 'numbytes' bytes to fill in
+ */
+void Adafruit_BusIO_Register::encode(uint32_t value, uint8_t numbytes,
+                                     uint8_t *buffer) {
   for (int i = 0; i < numbytes; i++) {
     if (_byteorder == LSBFIRST) {
-      _buffer[i] = value & 0xFF;
+      buffer[i] = value & 0xFF;
     } else {
-      _buffer[numbytes - i - 1] = value & 0xFF;
+      buffer[numbytes - i - 1] = value & 0xFF;
     }
     value >>= 8;
   }
-  return write(_buffer, numbytes);
 }
 
 /*!
  *    @brief  Read data from the register location. This does not do any error
- * checking!
+ * checking! With a cache mode set, the device is only read if there is no
+ * valid shadow copy yet.
  *    @return Returns 0xFFFFFFFF on failure, value otherwise
  */
 uint32_t Adafruit_BusIO_Register::read(void) {
+  if (_cachemode != BUSIO_CACHE_NONE && _cachevalid) {
+    return _cached;
+  }
+
   if (!read(_buffer, _width)) {
     return -1;
   }
@@ -182,6 +215,10 @@ uint32_t Adafruit_BusIO_Register::read(void) {
     }
   }
 
+  if (_cachemode != BUSIO_CACHE_NONE) {
+    _cached = value;
+    _cachevalid = true;
+  }
   return value;
 }
 
@@ -192,7 +229,8 @@ uint32_t Adafruit_BusIO_Register::read(void) {
 uint32_t Adafruit_BusIO_Register::readCached(void) { return _cached; }
 
 /*!
- *    @brief  Read a buffer of data from the register location
+ *    @brief  Read a buffer of data from the register location. This always
+ * goes to the device and bypasses the register cache
  *    @param  buffer Pointer to data to read into
  *    @param  len Number of bytes to read
  *    @return True on successful write (only really useful for I2C as SPI is
@@ -362,4 +400,132 @@ void Adafruit_BusIO_Register::setAddressWidth(uint16_t address_width) {
   _addrwidth = address_width;
 }
 
+/*!
+ *    @brief  Select how read() and write() use the shadow copy of the
+ * register. Leaving BUSIO_CACHE_WRITE_BACK writes a dirty value first
+ *    @param mode One of BUSIO_CACHE_NONE, BUSIO_CACHE_WRITE_THROUGH or
+ * BUSIO_CACHE_WRITE_BACK
+ */
+void Adafruit_BusIO_Register::setCacheMode(Adafruit_BusIO_CacheMode mode) {
+  if (mode != BUSIO_CACHE_WRITE_BACK) {
+    flush();
+  }
+  if (mode == BUSIO_CACHE_NONE) {
+    _cachevalid = false;
+  }
+  _cachemode = mode;
+}
+
+/*!
+ *    @brief  Write a value held back by BUSIO_CACHE_WRITE_BACK to the device
+ *    @return True if there was nothing to write or the write succeeded
+ */
+bool Adafruit_BusIO_Register::flush(void) {
+  if (!_dirty) {
+    return true;
+  }
+  encode(_cached, _width, _buffer);
+  if (!write(_buffer, _width)) {
+    return false;
+  }
+  _dirty = false;
+  return true;
+}
+
+/*!
+ *    @brief  Drop the shadow copy so the next read() goes to the device, e.g.
+ * after a device reset. A dirty value is written first
+ */
+void Adafruit_BusIO_Register::invalidate(void) {
+  flush();
+  _cachevalid = false;
+}
+
+/*!
+ *    @brief  Queue a register write. The register cache is updated right
+ * away, the device on flush(). Writes go out in the order they were queued,
+ * only a register queued again right after itself is merged into one write.
+ * A full queue is flushed first
+ *    @param  reg The register to write, its width is used
+ *    @param  value Data to write
+ *    @return False if the register is wider than 4 bytes or flushing a full
+ * queue failed, true otherwise
+ */
+bool Adafruit_BusIO_RegisterBatch::write(Adafruit_BusIO_Register *reg,
+                                         uint32_t value) {
+  if (reg->_width > 4) {
+    return false;
+  }
+
+  if ((_count > 0) && (_regs[_count - 1] == reg)) {
+    // nothing was queued in between, the earlier value can be dropped
+    _values[_count - 1] = value;
+  } else {
+    if ((_count == BUSIO_BATCH_MAX_WRITES) && !flush()) {
+      return false;
+    }
+    _regs[_count] = reg;
+    _values[_count] = value;
+    _count++;
+  }
+
+  reg->_cached = value;
+  if (reg->_cachemode != BUSIO_CACHE_NONE) {
+    reg->_cachevalid = true;
+    reg->_dirty = false; // the batch writes it
+  }
+  return true;
+}
+
+/*!
+ *    @brief  Check if register b directly follows register a on the same
+ * device, so both can be written in one burst
+ *    @param  a The register queued first
+ *    @param  b The register queued next
+ *    @return True if the writes can be merged
+ */
+bool Adafruit_BusIO_RegisterBatch::contiguous(Adafruit_BusIO_Register *a,
+                                              Adafruit_BusIO_Register *b) {
+  return (a->_i2cdevice == b->_i2cdevice) &&
+         (a->_spidevice == b->_spidevice) &&
+         (!a->_spidevice || (a->_spiregtype == b->_spiregtype)) &&
+         (a->_addrwidth == b->_addrwidth) &&
+         (b->_address == a->_address + a->_width);
+}
+
+/*!
+ *    @brief  Write all queued registers. Runs of contiguous registers are
+ * sent as one burst of up to BUSIO_BATCH_MAX_BURST bytes
+ *    @return True if all writes succeeded. The queue is emptied either way
+ */
+bool Adafruit_BusIO_RegisterBatch::flush(void) {
+  uint8_t buffer[BUSIO_BATCH_MAX_BURST];
+  bool ok = true;
+  uint8_t i = 0;
+
+  while (i < _count) {
+    Adafruit_BusIO_Register *first = _regs[i];
+    size_t maxlen = BUSIO_BATCH_MAX_BURST;
+    if (first->_i2cdevice &&
+        first->_i2cdevice->maxBufferSize() - first->_addrwidth < maxlen) {
+      maxlen = first->_i2cdevice->maxBufferSize() - first->_addrwidth;
+    }
+
+    uint8_t len = 0;
+    do {
+      Adafruit_BusIO_Register *reg = _regs[i];
+      reg->encode(_values[i], reg->_width, buffer + len);
+      len += reg->_width;
+      i++;
+    } while ((i < _count) && contiguous(_regs[i - 1], _regs[i]) &&
+             (len + _regs[i]->_width <= maxlen));
+
+    if (!first->write(buffer, len)) {
+      ok = false;
+    }
+  }
+  _count = 0;
+  return ok;
+}
+
 #endif // SPI exists
@@ -36,6 +36,42 @@ typedef enum _Adafruit_BusIO_SPIRegType {
 
 } Adafruit_BusIO_SPIRegType;
 
+typedef enum _Adafruit_BusIO_CacheMode {
+  BUSIO_CACHE_NONE = 0,
+  /*!<
+   * BUSIO_CACHE_NONE
+   * Every read() and write() goes to the device. This is the default and the
+   * only safe choice for registers the device changes by itself (status,
+   * data, interrupt flags...)
+   */
+  BUSIO_CACHE_WRITE_THROUGH = 1,
+
+  /*!<
+   * BUSIO_CACHE_WRITE_THROUGH
+   * read() returns the shadow copy once the register has been read or
+   * written, write() updates the copy and the device. A read-modify-write
+   * through Adafruit_BusIO_RegisterBits then costs one transaction, not two
+   */
+  BUSIO_CACHE_WRITE_BACK = 2,
+
+  /*!<
+   * BUSIO_CACHE_WRITE_BACK
+   * Like BUSIO_CACHE_WRITE_THROUGH, but write() only updates the copy and
+   * marks it dirty. The device is written on flush(), so several bit field
+   * changes end up in a single write
+   */
+} Adafruit_BusIO_CacheMode;
+
+/*!
+ * @brief Max number of registers queued in an Adafruit_BusIO_RegisterBatch
+ */
+#define BUSIO_BATCH_MAX_WRITES 8
+/*!
+ * @brief Max number of data bytes in one burst written by
+ * Adafruit_BusIO_RegisterBatch
+ */
+#define BUSIO_BATCH_MAX_BURST 32
+
 /*!
  * @brief The class which defines a device register (a location to read/write
  * data from)
@@ -71,10 +107,21 @@ public:
   void setAddress(uint16_t address);
   void setAddressWidth(uint16_t address_width);
 
+  void setCacheMode(Adafruit_BusIO_CacheMode mode);
+  bool flush(void);
+  void invalidate(void);
+  /*!   @brief  Check for a write-back value not written to the device yet
+   *    @return True if flush() has something to write */
+  bool isDirty(void) { return _dirty; }
+
   void print(Stream *s = &Serial);
   void println(Stream *s = &Serial);
 
 private:
+  friend class Adafruit_BusIO_RegisterBatch;
+
+  void encode(uint32_t value, uint8_t numbytes, uint8_t *buffer);
+
   Adafruit_I2CDevice *_i2cdevice;
   Adafruit_SPIDevice *_spidevice;
   Adafruit_BusIO_SPIRegType _spiregtype;
@@ -83,6 +130,9 @@ private:
   uint8_t _buffer[4]; // we won't support anything larger than uint32 for
                       // non-buffered read
   uint32_t _cached = 0;
+  Adafruit_BusIO_CacheMode _cachemode = BUSIO_CACHE_NONE;
+  bool _cachevalid = false; // _cached holds the whole register
+  bool _dirty = false;      // _cached not written to the device yet
 };
 
 /*!
@@ -101,5 +151,27 @@ private:
   uint8_t _bits, _shift;
 };
 
+/*!
+ * @brief Queues register writes and sends them with as few transactions as
+ * possible. Registers queued one after the other whose addresses follow each
+ * other on the same device are written in one burst, so the device has to
+ * auto-increment the register address on writes.
+ */
+class Adafruit_BusIO_RegisterBatch {
+public:
+  bool write(Adafruit_BusIO_Register *reg, uint32_t value);
+  bool flush(void);
+  /*!   @brief  Number of registers waiting to be written
+   *    @return The number of queued writes */
+  uint8_t pending(void) { return _count; }
+
+private:
+  bool contiguous(Adafruit_BusIO_Register *a, Adafruit_BusIO_Register *b);
+
+  Adafruit_BusIO_Register *_regs[BUSIO_BATCH_MAX_WRITES];
+  uint32_t _values[BUSIO_BATCH_MAX_WRITES];
+  uint8_t _count = 0;
+};
+
 #endif // SPI exists
 #endif // BusIO_Register_h
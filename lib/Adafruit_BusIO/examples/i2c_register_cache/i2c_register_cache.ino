@@ -0,0 +1,64 @@
+#include <Adafruit_I2CDevice.h>
+#include <Adafruit_BusIO_Register.h>
+
+#define I2C_ADDRESS 0x60
+Adafruit_I2CDevice i2c_dev = Adafruit_I2CDevice(I2C_ADDRESS);
+
+// Two configuration registers next to each other, with some bit fields
+Adafruit_BusIO_Register config_reg = Adafruit_BusIO_Register(&i2c_dev, 0x01, 2, LSBFIRST);
+Adafruit_BusIO_Register config2_reg = Adafruit_BusIO_Register(&i2c_dev, 0x03, 2, LSBFIRST);
+Adafruit_BusIO_RegisterBits mode_bits = Adafruit_BusIO_RegisterBits(&config_reg, 2, 0);
+Adafruit_BusIO_RegisterBits rate_bits = Adafruit_BusIO_RegisterBits(&config_reg, 3, 4);
+Adafruit_BusIO_RegisterBits gain_bits = Adafruit_BusIO_RegisterBits(&config_reg, 2, 8);
+
+void setBits(void) {
+  mode_bits.write(2);
+  rate_bits.write(5);
+  gain_bits.write(1);
+}
+
+void setup() {
+  while (!Serial) { delay(10); }
+  Serial.begin(115200);
+  Serial.println("I2C register cache test");
+
+  if (!i2c_dev.begin()) {
+    Serial.print("Did not find device at 0x");
+    Serial.println(i2c_dev.address(), HEX);
+    while (1);
+  }
+
+  // No cache: every bit field write is a read and a write, 6 transactions
+  uint32_t t = micros();
+  setBits();
+  Serial.print("No cache:      "); Serial.print(micros() - t); Serial.println(" us");
+
+  // Write-through: one read to fill the cache, then 3 writes
+  config_reg.setCacheMode(BUSIO_CACHE_WRITE_THROUGH);
+  t = micros();
+  setBits();
+  Serial.print("Write-through: "); Serial.print(micros() - t); Serial.println(" us");
+
+  // Write-back: no bus access until flush(), then a single write
+  config_reg.setCacheMode(BUSIO_CACHE_WRITE_BACK);
+  t = micros();
+  setBits();
+  config_reg.flush();
+  Serial.print("Write-back:    "); Serial.print(micros() - t); Serial.println(" us");
+
+  // Batch: both registers go out in one burst (the device has to
+  // auto-increment the register address)
+  Adafruit_BusIO_RegisterBatch batch;
+  t = micros();
+  batch.write(&config_reg, 0x0152);
+  batch.write(&config2_reg, 0x1234);
+  batch.flush();
+  Serial.print("Batch of 2:    "); Serial.print(micros() - t); Serial.println(" us");
+
+  config_reg.setCacheMode(BUSIO_CACHE_NONE);
+  Serial.print("Config register = 0x"); Serial.println(config_reg.read(), HEX);
+}
+
+void loop() {
+  
+}
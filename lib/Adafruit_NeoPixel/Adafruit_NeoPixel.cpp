@@ -117,6 +117,12 @@ Adafruit_NeoPixel::Adafruit_NeoPixel()
   @brief   Deallocate Adafruit_NeoPixel object, set data pin back to INPUT.
 */
 Adafruit_NeoPixel::~Adafruit_NeoPixel() {
+#if defined(ESP32)
+  if (pin >= 0)
+    espShowRelease(pin); // show() keeps an RMT channel too, waits for showAsync()
+  if (txPixels)
+    free(txPixels);
+#endif
   free(pixels);
   if (pin >= 0)
     pinMode(pin, INPUT);
@@ -144,6 +150,14 @@ void Adafruit_NeoPixel::begin(void) {
            type).
 */
 void Adafruit_NeoPixel::updateLength(uint16_t n) {
+#if defined(ESP32)
+  if (txPixels) { // Second buffer is re-allocated on the next showAsync()
+    while (isShowing())
+      ;
+    free(txPixels);
+    txPixels = NULL;
+  }
+#endif
   free(pixels); // Free existing data (if any)
 
   // Allocate new data -- note: ALL PIXELS ARE CLEARED
@@ -234,6 +248,10 @@ extern "C" IRAM_ATTR void espShow(uint16_t pin, uint8_t *pixels,
 #elif defined(ESP32)
 extern "C" void espShow(uint16_t pin, uint8_t *pixels, uint32_t numBytes,
                         uint8_t type);
+extern "C" bool espShowAsync(uint16_t pin, uint8_t *pixels,
+                             uint32_t numBytes, uint8_t type);
+extern "C" bool espShowBusy(uint16_t pin);
+extern "C" void espShowRelease(uint16_t pin);
 #endif // ESP8266
 
 #if defined(K210)
@@ -3039,12 +3057,66 @@ if(is800KHz) {
   endTime = micros(); // Save EOD time for latch on next call
 }
 
+/*!
+  @brief   Transmit pixel data in RAM to NeoPixels without waiting for the
+           transfer to complete. The pixel buffer is copied to a second
+           buffer which the RMT peripheral encodes from on the fly, so the
+           next frame can be drawn with setPixelColor(), fill() etc. while
+           this one is still being sent.
+  @note    Only ESP32 sends in the background, on other architectures this
+           is the same as show(). The second buffer (numPixels() * 3 or 4
+           bytes) is allocated on first use, and the strip keeps its RMT
+           channel until the pin is changed or the object is deleted. If
+           the buffer can't be allocated, the data is sent with show().
+           canShow() returns false until the transfer and the latch time
+           are over, isShowing() only covers the transfer.
+*/
+void Adafruit_NeoPixel::showAsync(void) {
+#if defined(ESP32)
+  if (!pixels)
+    return;
+
+  while (!canShow())
+    ;
+
+  if (!txPixels && !(txPixels = (uint8_t *)malloc(numBytes))) {
+    show();
+    return;
+  }
+  memcpy(txPixels, pixels, numBytes);
+
+  // canShow() notes the end time once it sees the transfer finished
+  txRunning = espShowAsync(pin, txPixels, numBytes, is800KHz);
+  endTime = micros();
+#else
+  show();
+#endif
+}
+
+/*!
+  @brief   Check whether a showAsync() transfer is still in progress.
+  @return  true while pixel data is being sent in the background, false
+           otherwise (and always false on architectures without
+           background transfers).
+*/
+bool Adafruit_NeoPixel::isShowing(void) {
+#if defined(ESP32)
+  return txPixels && espShowBusy(pin);
+#else
+  return false;
+#endif
+}
+
 /*!
   @brief   Set/change the NeoPixel output pin number. Previous pin,
            if any, is set to INPUT and the new pin is set to OUTPUT.
   @param   p  Arduino pin number (-1 = no pin).
 */
 void Adafruit_NeoPixel::setPin(int16_t p) {
+#if defined(ESP32)
+  if (pin >= 0)
+    espShowRelease(pin); // Give back the RMT channel kept by show()
+#endif
   if (begun && (pin >= 0))
     pinMode(pin, INPUT); // Disable existing out pin
   pin = p;
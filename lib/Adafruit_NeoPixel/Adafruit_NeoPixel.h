@@ -223,6 +223,8 @@ public:
 
   void begin(void);
   void show(void);
+  void showAsync(void);
+  bool isShowing(void);
   void setPin(int16_t p);
   void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b);
   void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w);
@@ -261,6 +263,18 @@ public:
     // stall for 30+ minutes, or having to document and frequently remind
     // and/or provide tech support explaining an unintuitive need for
     // show() calls at least once an hour.
+#if defined(ESP32)
+    // A showAsync() transfer may still be running in the background. Its
+    // end is only known once it is seen finished, the latch time starts
+    // counting from there.
+    if (txRunning) {
+      if (isShowing())
+        return false;
+      txRunning = false;
+      endTime = micros();
+      return false;
+    }
+#endif
     uint32_t now = micros();
     if (endTime > now) {
       endTime = now;
@@ -394,6 +408,10 @@ protected:
   uint8_t bOffset;    ///< Index of blue byte
   uint8_t wOffset;    ///< Index of white (==rOffset if no white)
   uint32_t endTime;   ///< Latch timing reference
+#if defined(ESP32)
+  uint8_t *txPixels = NULL; ///< Copy of pixels being sent by showAsync()
+  bool txRunning = false;   ///< showAsync() transfer not yet seen finished
+#endif
 #ifdef __AVR__
   volatile uint8_t *port; ///< Output PORT register
   uint8_t pinMask;        ///< Output PORT bitmask
@@ -34,34 +34,159 @@
 
 #ifdef HAS_ESP_IDF_5
 
-void espShow(uint8_t pin, uint8_t *pixels, uint32_t numBytes, boolean is800KHz) {
-  rmt_data_t led_data[numBytes * 8];
+#include "soc/soc_caps.h"
+#include "driver/rmt_tx.h"
+#include "driver/rmt_encoder.h"
+
+// Pixel bytes are turned into RMT symbols on the fly by the bytes encoder,
+// which refills the channel memory half by half from the RMT interrupt, so
+// no symbol buffer (32 bytes per pixel byte) is needed. The channel stays
+// installed for the pin, which lets espShowAsync() return while the data is
+// still going out.
+
+// Limit the number of RMT channels available for the Neopixels. Redefining
+// this value leaves the other TX channels free for other uses.
+#define ADAFRUIT_RMT_CHANNEL_MAX SOC_RMT_TX_CANDIDATES_PER_GROUP
+
+#define ADAFRUIT_RMT_RESOLUTION_HZ 10000000 // 100 ns per tick
+
+typedef struct {
+  rmt_channel_handle_t channel; // NULL if the slot is free
+  rmt_encoder_handle_t encoder;
+  uint16_t pin;
+  bool is800KHz;
+  volatile bool busy;           // Cleared from the RMT interrupt
+} rmt_strip_t;
+
+static rmt_strip_t rmt_strips[ADAFRUIT_RMT_CHANNEL_MAX];
+
+static bool IRAM_ATTR rmt_strip_done(rmt_channel_handle_t channel,
+                                     const rmt_tx_done_event_data_t *edata,
+                                     void *user_ctx) {
+  ((rmt_strip_t *)user_ctx)->busy = false;
+  return false;
+}
 
-  if (!rmtInit(pin, RMT_TX_MODE, RMT_MEM_NUM_BLOCKS_1, 10000000)) {
-    log_e("Failed to init RMT TX mode on pin %d", pin);
-    return;
+static rmt_strip_t *rmt_find_strip(uint16_t pin) {
+  for (size_t i = 0; i < ADAFRUIT_RMT_CHANNEL_MAX; i++) {
+    if (rmt_strips[i].channel && rmt_strips[i].pin == pin) {
+      return &rmt_strips[i];
+    }
+  }
+  return NULL;
+}
+
+static void rmt_release_strip(rmt_strip_t *strip) {
+  rmt_tx_wait_all_done(strip->channel, -1);
+  rmt_disable(strip->channel);
+  rmt_del_channel(strip->channel);
+  rmt_del_encoder(strip->encoder);
+  memset(strip, 0, sizeof(rmt_strip_t));
+}
+
+static rmt_strip_t *rmt_get_strip(uint16_t pin, bool is800KHz) {
+  rmt_strip_t *strip = rmt_find_strip(pin);
+  if (strip) {
+    if (strip->is800KHz == is800KHz) {
+      return strip;
+    }
+    rmt_release_strip(strip); // Speed changed, encoder has to be rebuilt
+  }
+
+  for (size_t i = 0; i < ADAFRUIT_RMT_CHANNEL_MAX; i++) {
+    if (!rmt_strips[i].channel) {
+      strip = &rmt_strips[i];
+      break;
+    }
+  }
+  if (!strip) {
+    log_e("No free RMT channel for pin %d", pin);
+    return NULL;
   }
 
-  int i=0;
-  for (int b=0; b < numBytes; b++) {
-    for (int bit=0; bit<8; bit++){
-      if ( pixels[b] & (1<<(7-bit)) ) {
-        led_data[i].level0 = 1;
-        led_data[i].duration0 = 8;
-        led_data[i].level1 = 0;
-        led_data[i].duration1 = 4;
-      } else {
-        led_data[i].level0 = 1;
-        led_data[i].duration0 = 4;
-        led_data[i].level1 = 0;
-        led_data[i].duration1 = 8;
-      }
-      i++;
+  rmt_tx_channel_config_t tx_config = {
+    .gpio_num = pin,
+    .clk_src = RMT_CLK_SRC_DEFAULT,
+    .resolution_hz = ADAFRUIT_RMT_RESOLUTION_HZ,
+    .mem_block_symbols = SOC_RMT_MEM_WORDS_PER_CHANNEL,
+    .trans_queue_depth = 1,
+  };
+  // 800 KHz: 0 = 400 ns high + 800 ns low, 1 = 800 ns high + 400 ns low
+  // 400 KHz: 0 = 500 ns high + 2000 ns low, 1 = 1200 ns high + 1300 ns low
+  rmt_bytes_encoder_config_t encoder_config = {
+    .bit0 = {
+      .duration0 = is800KHz ? 4 : 5, .level0 = 1,
+      .duration1 = is800KHz ? 8 : 20, .level1 = 0,
+    },
+    .bit1 = {
+      .duration0 = is800KHz ? 8 : 12, .level0 = 1,
+      .duration1 = is800KHz ? 4 : 13, .level1 = 0,
+    },
+    .flags.msb_first = 1,
+  };
+  rmt_tx_event_callbacks_t callbacks = {
+    .on_trans_done = rmt_strip_done,
+  };
+
+  if (rmt_new_tx_channel(&tx_config, &strip->channel) != ESP_OK) {
+    log_e("Failed to init RMT TX mode on pin %d", pin);
+    strip->channel = NULL;
+    return NULL;
+  }
+  if (rmt_new_bytes_encoder(&encoder_config, &strip->encoder) != ESP_OK ||
+      rmt_tx_register_event_callbacks(strip->channel, &callbacks, strip) != ESP_OK ||
+      rmt_enable(strip->channel) != ESP_OK) {
+    log_e("Failed to init RMT TX mode on pin %d", pin);
+    if (strip->encoder) {
+      rmt_del_encoder(strip->encoder);
     }
+    rmt_del_channel(strip->channel);
+    memset(strip, 0, sizeof(rmt_strip_t));
+    return NULL;
+  }
+  strip->pin = pin;
+  strip->is800KHz = is800KHz;
+  return strip;
+}
+
+static rmt_strip_t *rmt_start(uint16_t pin, uint8_t *pixels, uint32_t numBytes, bool is800KHz) {
+  rmt_strip_t *strip = rmt_get_strip(pin, is800KHz);
+  if (!strip) {
+    return NULL;
+  }
+  rmt_transmit_config_t tx_config = {
+    .loop_count = 0,
+  };
+  rmt_tx_wait_all_done(strip->channel, -1); // Previous frame on this pin
+  strip->busy = true;
+  if (rmt_transmit(strip->channel, strip->encoder, pixels, numBytes, &tx_config) != ESP_OK) {
+    strip->busy = false;
+    return NULL;
   }
+  return strip;
+}
+
+void espShow(uint16_t pin, uint8_t *pixels, uint32_t numBytes, uint8_t is800KHz) {
+  rmt_strip_t *strip = rmt_start(pin, pixels, numBytes, is800KHz);
+  if (strip) {
+    rmt_tx_wait_all_done(strip->channel, -1);
+  }
+}
+
+bool espShowAsync(uint16_t pin, uint8_t *pixels, uint32_t numBytes, uint8_t is800KHz) {
+  return rmt_start(pin, pixels, numBytes, is800KHz) != NULL;
+}
 
-  //pinMode(pin, OUTPUT);  // don't do this, will cause the rmt to disable!
-  rmtWrite(pin, led_data, numBytes * 8, RMT_WAIT_FOR_EVER);
+bool espShowBusy(uint16_t pin) {
+  rmt_strip_t *strip = rmt_find_strip(pin);
+  return strip && strip->busy;
+}
+
+void espShowRelease(uint16_t pin) {
+  rmt_strip_t *strip = rmt_find_strip(pin);
+  if (strip) {
+    rmt_release_strip(strip);
+  }
 }
 
 
@@ -84,10 +209,9 @@ void espShow(uint8_t pin, uint8_t *pixels, uint32_t numBytes, boolean is800KHz)
 #define WS2811_T1H_NS (1200)
 #define WS2811_T1L_NS (1300)
 
-static uint32_t t0h_ticks = 0;
-static uint32_t t1h_ticks = 0;
-static uint32_t t0l_ticks = 0;
-static uint32_t t1l_ticks = 0;
+// Logical 0 and 1 in ticks, [0] for 400 KHz and [1] for 800 KHz. All channels
+// use the same clock divider, so strips of both speeds can be sent at once.
+static rmt_item32_t rmt_bits[2][2];
 
 // Limit the number of RMT channels available for the Neopixels. Defaults to all
 // channels (8 on ESP32, 4 on ESP32-S2 and S3). Redefining this value will free
@@ -99,16 +223,27 @@ static uint32_t t1l_ticks = 0;
 
 bool rmt_reserved_channels[ADAFRUIT_RMT_CHANNEL_MAX];
 
-static void IRAM_ATTR ws2812_rmt_adapter(const void *src, rmt_item32_t *dest, size_t src_size,
-        size_t wanted_num, size_t *translated_size, size_t *item_num)
+// Channels kept installed by espShowAsync(), so the transfer can run in the
+// background and the next one skips the driver setup.
+typedef struct {
+    bool used;
+    bool is800KHz;
+    uint16_t pin;
+    rmt_channel_t channel;
+} rmt_strip_t;
+
+static rmt_strip_t rmt_strips[ADAFRUIT_RMT_CHANNEL_MAX];
+
+static inline void IRAM_ATTR rmt_translate(const rmt_item32_t *bits, const void *src, rmt_item32_t *dest,
+        size_t src_size, size_t wanted_num, size_t *translated_size, size_t *item_num)
 {
     if (src == NULL || dest == NULL) {
         *translated_size = 0;
         *item_num = 0;
         return;
     }
-    const rmt_item32_t bit0 = {{{ t0h_ticks, 1, t0l_ticks, 0 }}}; //Logical 0
-    const rmt_item32_t bit1 = {{{ t1h_ticks, 1, t1l_ticks, 0 }}}; //Logical 1
+    const rmt_item32_t bit0 = bits[0]; //Logical 0
+    const rmt_item32_t bit1 = bits[1]; //Logical 1
     size_t size = 0;
     size_t num = 0;
     uint8_t *psrc = (uint8_t *)src;
@@ -131,7 +266,19 @@ static void IRAM_ATTR ws2812_rmt_adapter(const void *src, rmt_item32_t *dest, si
     *item_num = num;
 }
 
-void espShow(uint8_t pin, uint8_t *pixels, uint32_t numBytes, boolean is800KHz) {
+static void IRAM_ATTR ws2812_rmt_adapter(const void *src, rmt_item32_t *dest, size_t src_size,
+        size_t wanted_num, size_t *translated_size, size_t *item_num)
+{
+    rmt_translate(rmt_bits[1], src, dest, src_size, wanted_num, translated_size, item_num);
+}
+
+static void IRAM_ATTR ws2811_rmt_adapter(const void *src, rmt_item32_t *dest, size_t src_size,
+        size_t wanted_num, size_t *translated_size, size_t *item_num)
+{
+    rmt_translate(rmt_bits[0], src, dest, src_size, wanted_num, translated_size, item_num);
+}
+
+static rmt_channel_t rmt_install(uint16_t pin, bool is800KHz) {
     // Reserve channel
     rmt_channel_t channel = ADAFRUIT_RMT_CHANNEL_MAX;
     for (size_t i = 0; i < ADAFRUIT_RMT_CHANNEL_MAX; i++) {
@@ -143,7 +290,7 @@ void espShow(uint8_t pin, uint8_t *pixels, uint32_t numBytes, boolean is800KHz)
     }
     if (channel == ADAFRUIT_RMT_CHANNEL_MAX) {
         // Ran out of channels!
-        return;
+        return channel;
     }
 
 #if defined(HAS_ESP_IDF_4)
@@ -192,32 +339,118 @@ void espShow(uint8_t pin, uint8_t *pixels, uint32_t numBytes, boolean is800KHz)
     // NS to tick converter
     float ratio = (float)counter_clk_hz / 1e9;
 
+    rmt_item32_t *bits = rmt_bits[is800KHz ? 1 : 0];
     if (is800KHz) {
-        t0h_ticks = (uint32_t)(ratio * WS2812_T0H_NS);
-        t0l_ticks = (uint32_t)(ratio * WS2812_T0L_NS);
-        t1h_ticks = (uint32_t)(ratio * WS2812_T1H_NS);
-        t1l_ticks = (uint32_t)(ratio * WS2812_T1L_NS);
+        bits[0].duration0 = (uint32_t)(ratio * WS2812_T0H_NS);
+        bits[0].duration1 = (uint32_t)(ratio * WS2812_T0L_NS);
+        bits[1].duration0 = (uint32_t)(ratio * WS2812_T1H_NS);
+        bits[1].duration1 = (uint32_t)(ratio * WS2812_T1L_NS);
     } else {
-        t0h_ticks = (uint32_t)(ratio * WS2811_T0H_NS);
-        t0l_ticks = (uint32_t)(ratio * WS2811_T0L_NS);
-        t1h_ticks = (uint32_t)(ratio * WS2811_T1H_NS);
-        t1l_ticks = (uint32_t)(ratio * WS2811_T1L_NS);
+        bits[0].duration0 = (uint32_t)(ratio * WS2811_T0H_NS);
+        bits[0].duration1 = (uint32_t)(ratio * WS2811_T0L_NS);
+        bits[1].duration0 = (uint32_t)(ratio * WS2811_T1H_NS);
+        bits[1].duration1 = (uint32_t)(ratio * WS2811_T1L_NS);
     }
+    bits[0].level0 = bits[1].level0 = 1;
+    bits[0].level1 = bits[1].level1 = 0;
 
     // Initialize automatic timing translator
-    rmt_translator_init(config.channel, ws2812_rmt_adapter);
+    rmt_translator_init(config.channel, is800KHz ? ws2812_rmt_adapter : ws2811_rmt_adapter);
 
-    // Write and wait to finish
-    rmt_write_sample(config.channel, pixels, (size_t)numBytes, true);
-    rmt_wait_tx_done(config.channel, pdMS_TO_TICKS(100));
+    return channel;
+}
 
+static void rmt_uninstall(rmt_channel_t channel, uint16_t pin) {
     // Free channel again
-    rmt_driver_uninstall(config.channel);
+    rmt_driver_uninstall(channel);
     rmt_reserved_channels[channel] = false;
 
     gpio_set_direction(pin, GPIO_MODE_OUTPUT);
 }
 
+static rmt_strip_t *rmt_find_strip(uint16_t pin) {
+    for (size_t i = 0; i < ADAFRUIT_RMT_CHANNEL_MAX; i++) {
+        if (rmt_strips[i].used && rmt_strips[i].pin == pin) {
+            return &rmt_strips[i];
+        }
+    }
+    return NULL;
+}
+
+static void rmt_release_strip(rmt_strip_t *strip) {
+    rmt_wait_tx_done(strip->channel, portMAX_DELAY);
+    rmt_uninstall(strip->channel, strip->pin);
+    strip->used = false;
+}
+
+static rmt_strip_t *rmt_get_strip(uint16_t pin, bool is800KHz) {
+    rmt_strip_t *strip = rmt_find_strip(pin);
+    if (strip) {
+        if (strip->is800KHz == is800KHz) {
+            return strip;
+        }
+        rmt_release_strip(strip); // Speed changed, translator has to be set again
+    }
+
+    rmt_channel_t channel = rmt_install(pin, is800KHz);
+    if (channel == ADAFRUIT_RMT_CHANNEL_MAX) {
+        return NULL;
+    }
+    // There is one strip slot per channel, so this can't come up empty
+    strip = &rmt_strips[channel];
+    strip->used = true;
+    strip->is800KHz = is800KHz;
+    strip->pin = pin;
+    strip->channel = channel;
+    return strip;
+}
+
+void espShow(uint16_t pin, uint8_t *pixels, uint32_t numBytes, uint8_t is800KHz) {
+    if (rmt_find_strip(pin)) {
+        // Pin already owns a channel from espShowAsync(), reuse it
+        rmt_strip_t *strip = rmt_get_strip(pin, is800KHz);
+        if (strip) {
+            rmt_write_sample(strip->channel, pixels, (size_t)numBytes, true);
+            rmt_wait_tx_done(strip->channel, pdMS_TO_TICKS(100));
+        }
+        return;
+    }
+
+    rmt_channel_t channel = rmt_install(pin, is800KHz);
+    if (channel == ADAFRUIT_RMT_CHANNEL_MAX) {
+        return;
+    }
+
+    // Write and wait to finish
+    rmt_write_sample(channel, pixels, (size_t)numBytes, true);
+    rmt_wait_tx_done(channel, pdMS_TO_TICKS(100));
+
+    rmt_uninstall(channel, pin);
+}
+
+bool espShowAsync(uint16_t pin, uint8_t *pixels, uint32_t numBytes, uint8_t is800KHz) {
+    rmt_strip_t *strip = rmt_get_strip(pin, is800KHz);
+    if (!strip) {
+        return false;
+    }
+    // Waits for a previous frame on this channel, then returns once the first
+    // block of the channel memory is filled. The translator is called from the
+    // RMT interrupt for the rest, so pixels must stay untouched until done.
+    return rmt_write_sample(strip->channel, pixels, (size_t)numBytes, false) == ESP_OK;
+}
+
+bool espShowBusy(uint16_t pin) {
+    rmt_strip_t *strip = rmt_find_strip(pin);
+    return strip && (rmt_wait_tx_done(strip->channel, 0) == ESP_ERR_TIMEOUT);
+}
+
+void espShowRelease(uint16_t pin) {
+    rmt_strip_t *strip = rmt_find_strip(pin);
+    if (strip) {
+        rmt_release_strip(strip);
+    }
+}
+
 #endif // ifndef IDF5
  
 
@@ -0,0 +1,61 @@
+// Compares show() and showAsync() on ESP32. With showAsync() the rainbow is
+// drawn while the previous frame is still being sent by the RMT peripheral,
+// and the time the sketch is blocked in each call is printed once a second
+// along with the heap and stack use.
+
+#include <Adafruit_NeoPixel.h>
+
+#define LED_PIN    16
+#define LED_COUNT 300
+
+Adafruit_NeoPixel strip(LED_COUNT, LED_PIN, NEO_GRB + NEO_KHZ800);
+
+uint16_t firstHue = 0;
+
+void drawFrame() {
+  strip.rainbow(firstHue);
+  firstHue += 256;
+}
+
+// Runs the animation for one second and prints the average time per frame
+// spent drawing and blocked in the show function.
+void runOneSecond(bool async) {
+  uint32_t frames = 0, drawMicros = 0, showMicros = 0;
+  uint32_t begin = millis();
+  while (millis() - begin < 1000) {
+    uint32_t start = micros();
+    drawFrame();
+    drawMicros += micros() - start;
+    start = micros();
+    if (async) {
+      strip.showAsync();
+    } else {
+      strip.show();
+    }
+    showMicros += micros() - start;
+    frames++;
+  }
+  Serial.printf("%-12s %4lu fps, draw %5lu us, blocked %5lu us per frame\n",
+                async ? "showAsync():" : "show():", frames,
+                drawMicros / frames, showMicros / frames);
+}
+
+void setup() {
+  Serial.begin(115200);
+  strip.begin();
+  strip.setBrightness(50);
+
+  uint32_t heap = ESP.getFreeHeap();
+  UBaseType_t stack = uxTaskGetStackHighWaterMark(NULL);
+  strip.show();
+  Serial.printf("show():      stack high water mark %u -> %u bytes free\n",
+                stack, uxTaskGetStackHighWaterMark(NULL));
+  strip.showAsync();
+  Serial.printf("showAsync(): heap %u -> %u bytes free (pixel data %u bytes)\n",
+                heap, ESP.getFreeHeap(), strip.numPixels() * 3);
+}
+
+void loop() {
+  runOneSecond(false);
+  runOneSecond(true);
+}
@@ -0,0 +1,156 @@
+#include <Arduino.h>
+#include "USB_STREAM.h"
+#include "esp_timer.h"
+
+/*
+ * Microphone to speaker loopback through the PCM rings, at 16 kHz mono in between as a
+ * VoIP codec or speech recognizer would use it. The mic ring wakes the loop task once
+ * 20 ms of audio are buffered, the loop moves it to the speaker ring.
+ * Before starting, the converter and the ring are benchmarked on the chip.
+ */
+
+// Format of the USB device, the converters need to know the channel numbers
+#define MIC_CH_NUM          1
+#define SPK_CH_NUM          2
+#define DEVICE_FREQUENCY    48000
+
+// Format in the application
+#define APP_FREQUENCY       16000
+#define APP_MS_BYTES        (APP_FREQUENCY / 1000 * 2)                      // mono 16 bit
+#define APP_BLOCK_BYTES     (APP_MS_BYTES * 20)
+#define SPK_MS_BYTES        (DEVICE_FREQUENCY / 1000 * SPK_CH_NUM * 2)      // the spk ring holds the converted audio
+
+static USB_STREAM *usb = NULL;
+static TaskHandle_t s_app_task = NULL;
+
+/* Runs in the USB task once the mic ring holds a block, must not block */
+static void onMicRingCallback(uac_pcm_ring_event_t event, size_t used, void *arg)
+{
+    if (event == UAC_PCM_RING_HIGH) {
+        xTaskNotifyGive(s_app_task);
+    }
+}
+
+/* Convert 10 s of audio in 10 ms blocks and report the time taken per block */
+static void benchmarkConverter(uint32_t inRate, uint8_t inCh, uint32_t outRate, uint8_t outCh)
+{
+    const int blocks = 1000;
+    const size_t inBytes = inRate / 100 * inCh * 2;
+    uac_pcm_conv_config_t config = {
+        .in_rate = inRate,
+        .in_channels = inCh,
+        .in_bits = 16,
+        .out_rate = outRate,
+        .out_channels = outCh,
+    };
+    uac_pcm_conv_t conv;
+    uac_pcm_conv_init(&conv, &config);
+    size_t outMax = uac_pcm_conv_out_max(&conv, inBytes);
+
+    int16_t *in = (int16_t *)malloc(inBytes);
+    int16_t *out = (int16_t *)malloc(outMax);
+    assert(in != NULL && out != NULL);
+    for (size_t i = 0; i < inBytes / 2; i++) {
+        in[i] = (int16_t)(i * 997);
+    }
+
+    size_t used;
+    int64_t worst = 0;
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < blocks; i++) {
+        int64_t t = esp_timer_get_time();
+        uac_pcm_conv_process(&conv, in, inBytes, &used, out, outMax);
+        t = esp_timer_get_time() - t;
+        if (t > worst) {
+            worst = t;
+        }
+    }
+    int64_t total = esp_timer_get_time() - start;
+
+    Serial.printf("%" PRIu32 " Hz %uch -> %" PRIu32 " Hz %uch: %.1f us per 10 ms block (worst %lld us), %.0fx realtime, %.2f Msamples/s, delay %" PRIu32 " us\n",
+                  inRate, inCh, outRate, outCh, (float)total / blocks, worst, blocks * 10000.0f / total,
+                  (float)blocks * inRate / 100 / total, uac_pcm_conv_delay_us(&conv));
+    free(in);
+    free(out);
+}
+
+/* Write and read a ring in 20 ms blocks, in place on the read side */
+static void benchmarkRing()
+{
+    const int blocks = 5000;
+    uint8_t *buf = (uint8_t *)malloc(4096);
+    uint8_t *block = (uint8_t *)malloc(APP_BLOCK_BYTES);
+    assert(buf != NULL && block != NULL);
+    memset(block, 0x55, APP_BLOCK_BYTES);
+    uac_pcm_ring_t ring;
+    uac_pcm_ring_init(&ring, buf, 4096);
+
+    uint32_t sum = 0;
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < blocks; i++) {
+        uac_pcm_ring_write(&ring, block, APP_BLOCK_BYTES);
+        const uint8_t *ptr;
+        size_t n;
+        while ((n = uac_pcm_ring_read_span(&ring, &ptr)) > 0) {
+            sum += ptr[0];
+            uac_pcm_ring_read_commit(&ring, n);
+        }
+    }
+    int64_t total = esp_timer_get_time() - start;
+
+    Serial.printf("ring: %.2f us per %u byte block, %.1f MB/s (%" PRIu32 ")\n",
+                  (float)total / blocks, APP_BLOCK_BYTES, (float)blocks * APP_BLOCK_BYTES / total, sum);
+    free(buf);
+    free(block);
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    s_app_task = xTaskGetCurrentTaskHandle();
+
+    benchmarkConverter(48000, 2, 16000, 1);
+    benchmarkConverter(44100, 2, 16000, 1);
+    benchmarkConverter(16000, 1, 48000, 2);
+    benchmarkRing();
+
+    // Instantiate a Ustream object
+    usb = new USB_STREAM();
+
+    // Mic frames only go to the ring, no internal mic buffer
+    usb->uacConfiguration(MIC_CH_NUM, 16, DEVICE_FREQUENCY, 0, SPK_CH_NUM, 16, DEVICE_FREQUENCY, 6400);
+
+    // 16 kHz mono in both rings, the rate and channel conversion happen on the way in
+    usb->uacMicRingConfiguration(8192, APP_FREQUENCY, 1);
+    uac_pcm_ring_set_watermarks(usb->uacMicRing(), 0, APP_BLOCK_BYTES, onMicRingCallback, NULL);
+    usb->uacSpkRingConfiguration(8192, APP_FREQUENCY, 1);
+
+    usb->start();
+
+    usb->connectWait(1000);
+}
+
+void loop()
+{
+    static uint8_t block[APP_BLOCK_BYTES];
+    static uint32_t report_ms = 0;
+
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+
+    while (uac_pcm_ring_used(usb->uacMicRing()) >= APP_BLOCK_BYTES) {
+        usb->uacMicRingRead(block, APP_BLOCK_BYTES);
+        // Process the block here, then play it back
+        usb->uacSpkRingWrite(block, APP_BLOCK_BYTES);
+    }
+
+    if (millis() - report_ms >= 5000) {
+        report_ms = millis();
+        uac_pcm_ring_stats_t mic, spk;
+        uac_pcm_ring_get_stats(usb->uacMicRing(), &mic);
+        uac_pcm_ring_get_stats(usb->uacSpkRing(), &spk);
+        // Latency added by the rings is what they hold
+        Serial.printf("mic ring: %u ms buffered (max %" PRIu32 "), overrun %" PRIu32 " bytes | spk ring: %u ms buffered (max %" PRIu32 "), overrun %" PRIu32 " bytes\n",
+                      uac_pcm_ring_used(usb->uacMicRing()) / APP_MS_BYTES, mic.used_max / APP_MS_BYTES, mic.overrun,
+                      uac_pcm_ring_used(usb->uacSpkRing()) / SPK_MS_BYTES, spk.used_max / SPK_MS_BYTES, spk.overrun);
+    }
+}
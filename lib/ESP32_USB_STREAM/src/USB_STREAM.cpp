@@ -4,10 +4,15 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
 #include "USB_STREAM.h"
 #include "original/include/usb_stream.h"
 #include "freertos/event_groups.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
 
 // Define the static variable TAG with a string "driver"
 static const char *TAG = "arduino-usb";
@@ -31,11 +36,42 @@ USB_STREAM::USB_STREAM()
     _mic_bit_resolution = UAC_BITS_ANY;
     _mic_samples_frequency = UAC_FREQUENCY_ANY;
     _mic_buf_size = 6400;
-}
-
-// A destructor with default values
+    _frame_ring = NULL;
+    _frame_ready = NULL;
+    memset(_frame_ring_buf, 0, sizeof(_frame_ring_buf));
+    _mic_ring = NULL;
+    _mic_conv = NULL;
+    _mic_out_frequency = 0;
+    _mic_out_ch_num = 0;
+    _mic_conv_bits = 0;
+    _mic_conv_frequency = 0;
+    _mic_conv_valid = false;
+    _spk_ring = NULL;
+    _spk_conv = NULL;
+    _spk_pump_task = NULL;
+}
+
+// A destructor releasing the frame ring
 USB_STREAM::~USB_STREAM()
-{}
+{
+    if (_frame_ring) {
+        uvc_frame_ring_deinit(_frame_ring);
+        free(_frame_ring);
+    }
+    for (int i = 0; i < UVC_FRAME_RING_MAX_SLOTS; i++) {
+        free(_frame_ring_buf[i]);
+    }
+    if (_frame_ready) {
+        vSemaphoreDelete(_frame_ready);
+    }
+    if (_spk_pump_task) {
+        vTaskDelete(_spk_pump_task);
+    }
+    free(_spk_ring);
+    free(_spk_conv);
+    free(_mic_ring);
+    free(_mic_conv);
+}
 
 // Method to register a user-defined callback function
 void USB_STREAM::uvcCamRegisterCb(uvc_frame_callback_t *newFunction, void *cb_arg)
@@ -53,6 +89,7 @@ void USB_STREAM::uvcCamRegisterCb(uvc_frame_callback_t *newFunction, void *cb_ar
 static void _camera_frame_cb(uvc_frame_t *frame, void *ptr)
 {
     USB_STREAM *my_instance = (USB_STREAM *)ptr;
+    my_instance->uvcFrameRingPush(frame);
     if (my_instance->_user_frame_cb != NULL) {
         my_instance->_user_frame_cb(frame, my_instance->_user_frame_cb_arg);
     }
@@ -74,6 +111,7 @@ void USB_STREAM::uacMicRegisterCb(mic_callback_t *newFunction, void *cb_arg)
 static void _mic_frame_cb(mic_frame_t *frame, void *ptr)
 {
     USB_STREAM *my_instance = (USB_STREAM *)ptr;
+    my_instance->uacMicRingPush(frame);
     if (my_instance->_user_mic_frame_cb != NULL) {
         my_instance->_user_mic_frame_cb(frame, my_instance->_user_frame_cb_arg);
     }
@@ -107,6 +145,323 @@ void USB_STREAM::uvcConfiguration(uint16_t width, uint16_t height, uint32_t fram
     CHECK_ESP_ERROR(uvc_streaming_config(&uvc_config), "UVC streaming config fail");
 }
 
+// Method to configure the uvc frame ring
+bool USB_STREAM::uvcFrameRingConfiguration(uint8_t slots, uint32_t slotSize, uvc_frame_ring_mode_t mode)
+{
+    if (_frame_ring != NULL) {
+        ESP_LOGE(TAG, "frame ring already configured");
+        return false;
+    }
+    if (slots < 2 || slots > UVC_FRAME_RING_MAX_SLOTS || slotSize == 0) {
+        ESP_LOGE(TAG, "frame ring takes 2 to %d slots", UVC_FRAME_RING_MAX_SLOTS);
+        return false;
+    }
+
+    for (int i = 0; i < slots; i++) {
+        _frame_ring_buf[i] = (uint8_t *)heap_caps_malloc(slotSize, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (_frame_ring_buf[i] == NULL) {
+            _frame_ring_buf[i] = (uint8_t *)malloc(slotSize);
+        }
+        if (_frame_ring_buf[i] == NULL) {
+            ESP_LOGE(TAG, "frame ring slot %d alloc fail", i);
+            goto fail;
+        }
+    }
+    _frame_ready = xSemaphoreCreateBinary();
+    _frame_ring = (uvc_frame_ring_t *)calloc(1, sizeof(uvc_frame_ring_t));
+    if (_frame_ready == NULL || _frame_ring == NULL) {
+        ESP_LOGE(TAG, "frame ring alloc fail");
+        goto fail;
+    }
+    uvc_frame_ring_init(_frame_ring, _frame_ring_buf, slots, slotSize, mode);
+    return true;
+
+fail:
+    free(_frame_ring);
+    _frame_ring = NULL;
+    if (_frame_ready) {
+        vSemaphoreDelete(_frame_ready);
+        _frame_ready = NULL;
+    }
+    for (int i = 0; i < UVC_FRAME_RING_MAX_SLOTS; i++) {
+        free(_frame_ring_buf[i]);
+        _frame_ring_buf[i] = NULL;
+    }
+    return false;
+}
+
+// Method to store a camera frame into the ring, runs in the usb task
+void USB_STREAM::uvcFrameRingPush(uvc_frame_t *frame)
+{
+    if (_frame_ring == NULL) {
+        return;
+    }
+    if (uvc_frame_ring_push(_frame_ring, frame->data, frame->data_bytes, frame->width, frame->height,
+                            frame->frame_format, frame->sequence, esp_timer_get_time()) == UVC_FRAME_RING_OK) {
+        xSemaphoreGive(_frame_ready);
+    }
+}
+
+// Method to take a frame from the ring
+uvc_ring_frame_t *USB_STREAM::uvcFrameAcquire(uint32_t timeoutMs)
+{
+    if (_frame_ring == NULL) {
+        ESP_LOGE(TAG, "frame ring not configured");
+        return NULL;
+    }
+
+    TickType_t start = xTaskGetTickCount();
+    TickType_t timeout = pdMS_TO_TICKS(timeoutMs);
+    uvc_ring_frame_t *frame;
+    while ((frame = uvc_frame_ring_acquire(_frame_ring)) == NULL) {
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= timeout || xSemaphoreTake(_frame_ready, timeout - elapsed) != pdTRUE) {
+            return uvc_frame_ring_acquire(_frame_ring);
+        }
+    }
+    return frame;
+}
+
+// Method to give a frame back to the ring
+void USB_STREAM::uvcFrameRelease(uvc_ring_frame_t *frame)
+{
+    if (_frame_ring == NULL || frame == nullptr) {
+        return;
+    }
+    uvc_frame_ring_release(_frame_ring, frame);
+}
+
+// Method to get the frame ring counters
+void USB_STREAM::uvcFrameRingStats(uvc_frame_ring_stats_t *stats)
+{
+    if (stats == nullptr) {
+        ESP_LOGE(TAG, "arguments cannot be null");
+        return;
+    }
+    if (_frame_ring == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    uvc_frame_ring_get_stats(_frame_ring, stats);
+}
+
+// Allocate a pcm ring and its buffer in one block, the buffer rounded up to a power of two
+static uac_pcm_ring_t *_pcm_ring_create(uint32_t ringSize)
+{
+    size_t size = uac_pcm_ring_size_for(ringSize);
+    uac_pcm_ring_t *ring = (uac_pcm_ring_t *)malloc(sizeof(uac_pcm_ring_t) + size);
+    if (ring == NULL || uac_pcm_ring_init(ring, (uint8_t *)(ring + 1), size) != 0) {
+        free(ring);
+        return NULL;
+    }
+    return ring;
+}
+
+// Convert straight into the ring free space, returns the input bytes consumed
+static size_t _pcm_ring_write_conv(uac_pcm_ring_t *ring, uac_pcm_conv_t *conv, const uint8_t *data, size_t data_bytes)
+{
+    size_t done = 0;
+    for (;;) {
+        uint8_t *ptr;
+        size_t used = 0;
+        size_t span = uac_pcm_ring_write_span(ring, &ptr);
+        size_t written = uac_pcm_conv_process(conv, data + done, data_bytes - done, &used, ptr, span);
+        done += used;
+        if (written) {
+            uac_pcm_ring_write_commit(ring, written);
+        }
+        if (written == 0 && used == 0) {
+            return done;
+        }
+    }
+}
+
+// Method to configure the uac mic ring
+bool USB_STREAM::uacMicRingConfiguration(uint32_t ringSize, uint32_t outSamplesFrequency, uint8_t outChNum)
+{
+    if (_mic_ring != NULL) {
+        ESP_LOGE(TAG, "mic ring already configured");
+        return false;
+    }
+    if (outChNum > UAC_PCM_CONV_MAX_CHANNELS) {
+        ESP_LOGE(TAG, "mic ring takes 1 or 2 channels");
+        return false;
+    }
+    if (outSamplesFrequency || outChNum) {
+        // the input format is only known from the first mic frame
+        _mic_conv = (uac_pcm_conv_t *)calloc(1, sizeof(uac_pcm_conv_t));
+        if (_mic_conv == NULL) {
+            ESP_LOGE(TAG, "mic converter alloc fail");
+            return false;
+        }
+        _mic_out_frequency = outSamplesFrequency;
+        _mic_out_ch_num = outChNum;
+    }
+    _mic_ring = _pcm_ring_create(ringSize);
+    if (_mic_ring == NULL) {
+        ESP_LOGE(TAG, "mic ring alloc fail");
+        free(_mic_conv);
+        _mic_conv = NULL;
+        return false;
+    }
+    return true;
+}
+
+// Method to get the uac mic ring
+uac_pcm_ring_t *USB_STREAM::uacMicRing()
+{
+    return _mic_ring;
+}
+
+// Method to read the uac mic ring
+size_t USB_STREAM::uacMicRingRead(void *buffer, size_t buf_size)
+{
+    if (_mic_ring == NULL || buffer == nullptr) {
+        ESP_LOGE(TAG, "Invalid parameters for uacMicRingRead");
+        return 0;
+    }
+    size_t used = uac_pcm_ring_used(_mic_ring);
+    return uac_pcm_ring_read(_mic_ring, buffer, buf_size < used ? buf_size : used);
+}
+
+// Method to store a mic frame into the ring, runs in the usb task
+void USB_STREAM::uacMicRingPush(mic_frame_t *frame)
+{
+    if (_mic_ring == NULL) {
+        return;
+    }
+    if (_mic_conv == NULL) {
+        // a USB frame holds whole sample frames, a part of it would shift every later sample
+        if (uac_pcm_ring_free(_mic_ring) < frame->data_bytes) {
+            uac_pcm_ring_drop(_mic_ring, frame->data_bytes);
+        } else {
+            uac_pcm_ring_write(_mic_ring, frame->data, frame->data_bytes);
+        }
+        return;
+    }
+    if (frame->bit_resolution != _mic_conv_bits || frame->samples_frequence != _mic_conv_frequency) {
+        uint8_t ch_num = _mic_ch_num == UAC_CH_ANY ? 1 : _mic_ch_num;
+        uac_pcm_conv_config_t config = {
+            .in_rate = frame->samples_frequence,
+            .in_channels = ch_num,
+            .in_bits = (uint8_t)frame->bit_resolution,
+            .out_rate = _mic_out_frequency ? _mic_out_frequency : frame->samples_frequence,
+            .out_channels = _mic_out_ch_num ? _mic_out_ch_num : ch_num,
+        };
+        _mic_conv_bits = frame->bit_resolution;
+        _mic_conv_frequency = frame->samples_frequence;
+        _mic_conv_valid = uac_pcm_conv_init(_mic_conv, &config) == 0;
+        if (!_mic_conv_valid) {
+            ESP_LOGE(TAG, "mic format %" PRIu32 " Hz %u bits not supported by the converter", frame->samples_frequence, frame->bit_resolution);
+        }
+    }
+    if (!_mic_conv_valid) {
+        return;
+    }
+    size_t used = _pcm_ring_write_conv(_mic_ring, _mic_conv, (const uint8_t *)frame->data, frame->data_bytes);
+    if (used < frame->data_bytes) {
+        uac_pcm_ring_drop(_mic_ring, uac_pcm_conv_out_max(_mic_conv, frame->data_bytes - used));
+    }
+}
+
+// A static function that runs the speaker ring task
+static void _spk_ring_task(void *arg)
+{
+    ((USB_STREAM *)arg)->uacSpkRingPump();
+}
+
+// Method to configure the uac spk ring
+bool USB_STREAM::uacSpkRingConfiguration(uint32_t ringSize, uint32_t inSamplesFrequency, uint8_t inChNum)
+{
+    if (_spk_ring != NULL) {
+        ESP_LOGE(TAG, "spk ring already configured");
+        return false;
+    }
+    if (inChNum > UAC_PCM_CONV_MAX_CHANNELS) {
+        ESP_LOGE(TAG, "spk ring takes 1 or 2 channels");
+        return false;
+    }
+    if (inSamplesFrequency || inChNum) {
+        if (_spk_ch_num == UAC_CH_ANY || _spk_bit_resolution != 16 || _spk_samples_frequency == UAC_FREQUENCY_ANY) {
+            ESP_LOGE(TAG, "set the spk channel number, 16 bits and frequency in uacConfiguration to convert");
+            return false;
+        }
+        uac_pcm_conv_config_t config = {
+            .in_rate = inSamplesFrequency ? inSamplesFrequency : _spk_samples_frequency,
+            .in_channels = inChNum ? inChNum : _spk_ch_num,
+            .in_bits = 16,
+            .out_rate = _spk_samples_frequency,
+            .out_channels = _spk_ch_num,
+        };
+        _spk_conv = (uac_pcm_conv_t *)calloc(1, sizeof(uac_pcm_conv_t));
+        if (_spk_conv == NULL || uac_pcm_conv_init(_spk_conv, &config) != 0) {
+            ESP_LOGE(TAG, "spk converter init fail");
+            goto fail;
+        }
+    }
+    _spk_ring = _pcm_ring_create(ringSize);
+    if (_spk_ring == NULL) {
+        ESP_LOGE(TAG, "spk ring alloc fail");
+        goto fail;
+    }
+    if (xTaskCreate(_spk_ring_task, "usb_spk_ring", 3 * 1024, this, 5, &_spk_pump_task) != pdPASS) {
+        ESP_LOGE(TAG, "spk ring task create fail");
+        goto fail;
+    }
+    return true;
+
+fail:
+    free(_spk_ring);
+    _spk_ring = NULL;
+    free(_spk_conv);
+    _spk_conv = NULL;
+    return false;
+}
+
+// Method to get the uac spk ring
+uac_pcm_ring_t *USB_STREAM::uacSpkRing()
+{
+    return _spk_ring;
+}
+
+// Method to write the uac spk ring
+size_t USB_STREAM::uacSpkRingWrite(const void *buffer, size_t data_bytes)
+{
+    if (_spk_ring == NULL || buffer == nullptr) {
+        ESP_LOGE(TAG, "Invalid parameters for uacSpkRingWrite");
+        return 0;
+    }
+    size_t taken;
+    if (_spk_conv) {
+        taken = _pcm_ring_write_conv(_spk_ring, _spk_conv, (const uint8_t *)buffer, data_bytes);
+    } else {
+        size_t free_bytes = uac_pcm_ring_free(_spk_ring);
+        taken = uac_pcm_ring_write(_spk_ring, buffer, data_bytes < free_bytes ? data_bytes : free_bytes);
+    }
+    xTaskNotifyGive(_spk_pump_task);
+    return taken;
+}
+
+// Method to move the uac spk ring to the speaker stream, runs in its own task
+void USB_STREAM::uacSpkRingPump()
+{
+    const uint8_t *ptr;
+    for (;;) {
+        size_t bytes = uac_pcm_ring_read_span(_spk_ring, &ptr);
+        if (bytes == 0) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(20));
+            continue;
+        }
+        if (bytes > 1024) {
+            bytes = 1024;
+        }
+        // the driver copies into its speaker buffer, waiting while the buffer is full
+        if (uac_spk_streaming_write((void *)ptr, bytes, 100) == ESP_OK) {
+            uac_pcm_ring_read_commit(_spk_ring, bytes);
+        }
+    }
+}
+
 // Method to configure the uac mic stream
 void USB_STREAM::uacConfiguration(uint8_t mic_ch_num, uint16_t mic_bit_resolution, uint32_t mic_samples_frequency, uint32_t mic_buf_size, uint8_t spk_ch_num, uint16_t spk_bit_resolution, uint32_t spk_samples_frequency, uint32_t spk_buf_size)
 {
@@ -11,9 +11,13 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/event_groups.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_err.h"
 #include "esp_log.h"
 #include "original/include/usb_stream.h"
+#include "uvc_frame_ring.h"
+#include "uac_pcm_ring.h"
+#include "uac_pcm_conv.h"
 
 class USB_STREAM {
 
@@ -83,6 +87,49 @@ public:
      */
     void uvcConfiguration(uint16_t width, uint16_t height, uint32_t frameInterval, uint32_t transferBufferSize, uint8_t *transferBufferA, uint8_t *transferBufferB, uint32_t frameBufferSize, uint8_t *frameBuffer);
 
+    /**
+     * @brief Hand the camera frames over through a ring of preallocated slots instead of
+     * the frame buffer alone. Each frame is copied into a free slot in the USB task, which
+     * then goes on without waiting for the consumers; frames are taken with uvcFrameAcquire()
+     * and kept until uvcFrameRelease(). Call it before start(). A callback registered with
+     * uvcCamRegisterCb() still runs after each frame, it must not block.
+     *
+     * @param slots number of slots, 2 to UVC_FRAME_RING_MAX_SLOTS
+     * @param slotSize size of each slot, must be larger than one frame, allocated in PSRAM when available
+     * @param mode UVC_FRAME_RING_LATEST to always get the newest frame, UVC_FRAME_RING_FIFO to get them in order
+     * @return true on success
+     */
+    bool uvcFrameRingConfiguration(uint8_t slots, uint32_t slotSize, uvc_frame_ring_mode_t mode = UVC_FRAME_RING_LATEST);
+
+    /**
+     * @brief Take a frame from the ring, the caller owns it until uvcFrameRelease()
+     *
+     * @param timeoutMs time to wait for a frame, 0 to return at once
+     * @return the frame, or NULL on timeout or if no ring is configured
+     */
+    uvc_ring_frame_t *uvcFrameAcquire(uint32_t timeoutMs);
+
+    /**
+     * @brief Give a frame back to the ring
+     *
+     * @param frame frame returned by uvcFrameAcquire()
+     */
+    void uvcFrameRelease(uvc_ring_frame_t *frame);
+
+    /**
+     * @brief Get the frame ring counters: frames captured, delivered, overwritten and dropped
+     *
+     * @param stats the counters
+     */
+    void uvcFrameRingStats(uvc_frame_ring_stats_t *stats);
+
+    /**
+     * @brief Called from the USB task for each frame, pushes it into the ring when configured
+     *
+     * @param frame the frame from the driver
+     */
+    void uvcFrameRingPush(uvc_frame_t *frame);
+
     /**
      * @brief Suspends USB Camera streaming
      *
@@ -268,6 +315,78 @@ public:
      */
     void uacSpkFrameReset(uint8_t ch_num, uint16_t bit_resolution, uint32_t samples_frequency);
 
+    /**
+     * @brief Feed the microphone frames into a lock free PCM ring, optionally converted to another
+     * sample rate and channel number (16 bit). The ring is written from the USB task and read by
+     * one consumer task without locks or timeouts; use uac_pcm_ring_set_watermarks() on uacMicRing()
+     * to be called when enough audio is buffered. Call it before start(). When converting, set the
+     * mic channel number in uacConfiguration(), it is not part of the mic frames.
+     *
+     * @param ringSize ring size in bytes, rounded up to a power of two
+     * @param outSamplesFrequency sample rate in the ring, 0 to keep the mic frames as they are
+     * @param outChNum channel number in the ring, 1 or 2, 0 to keep the mic channel number
+     * @return true on success
+     */
+    bool uacMicRingConfiguration(uint32_t ringSize, uint32_t outSamplesFrequency = 0, uint8_t outChNum = 0);
+
+    /**
+     * @brief Get the microphone PCM ring, for in place reads with uac_pcm_ring_read_span()
+     *
+     * @return the ring, NULL if not configured
+     */
+    uac_pcm_ring_t *uacMicRing();
+
+    /**
+     * @brief Copy what the microphone ring holds, up to buf_size bytes, without waiting
+     *
+     * @param buffer pointer to the buffer to store the data
+     * @param buf_size The size of the data buffer.
+     * @return bytes read
+     */
+    size_t uacMicRingRead(void *buffer, size_t buf_size);
+
+    /**
+     * @brief Called from the USB task for each mic frame, writes it into the ring when configured
+     *
+     * @param frame the mic frame from the driver
+     */
+    void uacMicRingPush(mic_frame_t *frame);
+
+    /**
+     * @brief Send the speaker audio through a lock free PCM ring, optionally converted from another
+     * sample rate and channel number (16 bit). A task moves the ring to the speaker stream, it calls
+     * the UAC_PCM_RING_LOW watermark callback set on uacSpkRing() when the ring needs more audio.
+     * Call it before start(). When converting, the speaker channel number, bit resolution (16) and
+     * sample frequency have to be set in uacConfiguration().
+     *
+     * @param ringSize ring size in bytes, rounded up to a power of two
+     * @param inSamplesFrequency sample rate written by the application, 0 for the speaker one
+     * @param inChNum channel number written by the application, 1 or 2, 0 for the speaker one
+     * @return true on success
+     */
+    bool uacSpkRingConfiguration(uint32_t ringSize, uint32_t inSamplesFrequency = 0, uint8_t inChNum = 0);
+
+    /**
+     * @brief Get the speaker PCM ring
+     *
+     * @return the ring, NULL if not configured
+     */
+    uac_pcm_ring_t *uacSpkRing();
+
+    /**
+     * @brief Write speaker audio into the ring, converting it when configured, without waiting
+     *
+     * @param buffer The data to be written, whole frames.
+     * @param data_bytes The size of the data to be written.
+     * @return bytes taken from buffer, less than data_bytes when the ring is full
+     */
+    size_t uacSpkRingWrite(const void *buffer, size_t data_bytes);
+
+    /**
+     * @brief Speaker ring task body, moves the ring to the speaker stream
+     */
+    void uacSpkRingPump();
+
 private:
     uint16_t _frame_width;
     uint16_t _frame_height;
@@ -280,4 +399,17 @@ private:
     uint16_t _mic_bit_resolution;
     uint32_t _mic_samples_frequency;
     uint32_t _mic_buf_size;
+    uvc_frame_ring_t *_frame_ring;
+    uint8_t *_frame_ring_buf[UVC_FRAME_RING_MAX_SLOTS];
+    SemaphoreHandle_t _frame_ready;
+    uac_pcm_ring_t *_mic_ring;
+    uac_pcm_conv_t *_mic_conv;
+    uint32_t _mic_out_frequency;
+    uint8_t _mic_out_ch_num;
+    uint16_t _mic_conv_bits;
+    uint32_t _mic_conv_frequency;
+    bool _mic_conv_valid;
+    uac_pcm_ring_t *_spk_ring;
+    uac_pcm_conv_t *_spk_conv;
+    TaskHandle_t _spk_pump_task;
 };
@@ -0,0 +1,138 @@
+/*
+ * SPDX-FileCopyrightText: 2024 ShenZhen XinYuan Electronic Technology Co., Ltd
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "uac_pcm_conv.h"
+
+#define Q16_ONE     0x10000u
+
+/* the top 16 bits of a little endian sample */
+static inline int16_t read_sample(const uint8_t *p, uint8_t bytes)
+{
+    return (int16_t)(p[bytes - 2] | p[bytes - 1] << 8);
+}
+
+int uac_pcm_conv_init(uac_pcm_conv_t *conv, const uac_pcm_conv_config_t *config)
+{
+    uint32_t taps = 1;
+
+    if (conv == NULL || config == NULL || config->in_rate == 0 || config->out_rate == 0
+            || config->in_channels < 1 || config->in_channels > UAC_PCM_CONV_MAX_CHANNELS
+            || config->out_channels < 1 || config->out_channels > UAC_PCM_CONV_MAX_CHANNELS
+            || (config->in_bits != 16 && config->in_bits != 24 && config->in_bits != 32)) {
+        return -1;
+    }
+    uint64_t step = ((uint64_t)config->in_rate << 16) / config->out_rate;
+    if (step == 0 || step > 0xFFFFFFFFull - Q16_ONE) {
+        return -1;
+    }
+    if (config->out_rate < config->in_rate) {
+        taps = config->in_rate / config->out_rate;
+        if (taps > UAC_PCM_CONV_MAX_TAPS) {
+            taps = UAC_PCM_CONV_MAX_TAPS;
+        }
+    }
+
+    memset(conv, 0, sizeof(*conv));
+    conv->cfg = *config;
+    conv->in_frame_bytes = config->in_channels * config->in_bits / 8;
+    conv->out_frame_bytes = config->out_channels * 2;
+    conv->channels = config->in_channels < config->out_channels ? config->in_channels : config->out_channels;
+    conv->taps = (uint8_t)taps;
+    conv->step = (uint32_t)step;
+    return 0;
+}
+
+void uac_pcm_conv_reset(uac_pcm_conv_t *conv)
+{
+    conv->tap_pos = 0;
+    conv->pending = 0;
+    conv->frac = 0;
+    memset(conv->sum, 0, sizeof(conv->sum));
+    memset(conv->hist, 0, sizeof(conv->hist));
+    memset(conv->prev, 0, sizeof(conv->prev));
+    memset(conv->cur, 0, sizeof(conv->cur));
+}
+
+size_t uac_pcm_conv_out_max(const uac_pcm_conv_t *conv, size_t in_bytes)
+{
+    uint64_t frames = in_bytes / conv->in_frame_bytes + 1;     /* +1 for a pending frame */
+
+    return (size_t)(((frames << 16) / conv->step + 1) * conv->out_frame_bytes);
+}
+
+size_t uac_pcm_conv_process(uac_pcm_conv_t *conv, const void *in, size_t in_bytes, size_t *in_used, void *out, size_t out_bytes)
+{
+    const uint8_t *src = (const uint8_t *)in;
+    int16_t *dst = (int16_t *)out;
+    const uint8_t sample_bytes = conv->cfg.in_bits / 8;
+    const uint8_t channels = conv->channels;
+    const int mix = conv->cfg.in_channels > conv->cfg.out_channels;
+    const int dup = conv->cfg.out_channels > conv->cfg.in_channels;
+    size_t used = 0, done = 0;
+    int32_t s, v;
+    int ch;
+
+    for (;;) {
+        if (!conv->pending) {
+            if (in_bytes - used < conv->in_frame_bytes) {
+                break;
+            }
+            for (ch = 0; ch < channels; ch++) {
+                s = read_sample(src + used + ch * sample_bytes, sample_bytes);
+                if (mix) {
+                    s = (s + read_sample(src + used + sample_bytes, sample_bytes)) >> 1;
+                }
+                if (conv->taps > 1) {
+                    conv->sum[ch] += s - conv->hist[ch][conv->tap_pos];
+                    conv->hist[ch][conv->tap_pos] = (int16_t)s;
+                    s = conv->sum[ch] / conv->taps;
+                }
+                conv->cur[ch] = (int16_t)s;
+            }
+            if (++conv->tap_pos == conv->taps) {
+                conv->tap_pos = 0;
+            }
+            used += conv->in_frame_bytes;
+            conv->pending = 1;
+        }
+
+        /* every output that falls between prev and cur */
+        while (conv->frac < Q16_ONE) {
+            if (out_bytes - done < conv->out_frame_bytes) {
+                goto out_full;
+            }
+            for (ch = 0; ch < channels; ch++) {
+                if (conv->step == Q16_ONE) {
+                    v = conv->cur[ch];
+                } else {
+                    v = conv->prev[ch] + (((conv->cur[ch] - conv->prev[ch]) * (int32_t)(conv->frac >> 1)) >> 15);
+                }
+                *dst++ = (int16_t)v;
+                if (dup) {
+                    *dst++ = (int16_t)v;
+                }
+            }
+            done += conv->out_frame_bytes;
+            conv->frac += conv->step;
+        }
+        conv->frac -= Q16_ONE;
+        memcpy(conv->prev, conv->cur, sizeof(conv->prev));
+        conv->pending = 0;
+    }
+
+out_full:
+    if (in_used) {
+        *in_used = used;
+    }
+    return done;
+}
+
+uint32_t uac_pcm_conv_delay_us(const uac_pcm_conv_t *conv)
+{
+    /* half the moving average plus the interpolation, one input sample */
+    return (uint32_t)((conv->taps + 1) * 500000ull / conv->cfg.in_rate);
+}
@@ -0,0 +1,108 @@
+/*
+ * SPDX-FileCopyrightText: 2024 ShenZhen XinYuan Electronic Technology Co., Ltd
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Fixed point PCM format and sample rate converter, e.g. 48 kHz stereo 16 bit from a
+ * USB microphone to the 16 kHz mono 16 bit a VoIP codec or a speech recognizer expects.
+ *
+ * Input is 16, 24 (packed) or 32 bit little endian, 1 or 2 channels, output is always
+ * 16 bit. Stereo to mono averages both channels, mono to stereo duplicates.
+ * The rate is changed by linear interpolation with a Q16 step; when the rate goes down,
+ * a moving average over in_rate / out_rate samples runs first so that most of what
+ * would alias is removed (first null at the output rate). No floating point, no heap.
+ *
+ * The converter is streaming: input is consumed in whole frames, and output that did
+ * not fit is kept and comes out first on the next call.
+ */
+
+#define UAC_PCM_CONV_MAX_CHANNELS   2
+#define UAC_PCM_CONV_MAX_TAPS       16  /*!< longest moving average, enough for 96 kHz to 6 kHz */
+
+/**
+ * @brief Input and output formats
+ */
+typedef struct {
+    uint32_t in_rate;               /*!< input sample rate, Hz */
+    uint8_t in_channels;            /*!< 1 or 2 */
+    uint8_t in_bits;                /*!< 16, 24 or 32 */
+    uint32_t out_rate;              /*!< output sample rate, Hz */
+    uint8_t out_channels;           /*!< 1 or 2, 16 bit */
+} uac_pcm_conv_config_t;
+
+/**
+ * @brief Converter state, treat as opaque
+ */
+typedef struct {
+    uac_pcm_conv_config_t cfg;
+    uint8_t in_frame_bytes;
+    uint8_t out_frame_bytes;
+    uint8_t channels;               /*!< channels after mixing, the ones being resampled */
+    uint8_t taps;                   /*!< moving average length, 1 when the rate goes up */
+    uint8_t tap_pos;
+    uint8_t pending;                /*!< cur holds an input frame whose outputs did not all fit */
+    uint32_t step;                  /*!< input samples per output sample, Q16 */
+    uint32_t frac;                  /*!< position of the next output after prev, Q16 */
+    int32_t sum[UAC_PCM_CONV_MAX_CHANNELS];
+    int16_t hist[UAC_PCM_CONV_MAX_CHANNELS][UAC_PCM_CONV_MAX_TAPS];
+    int16_t prev[UAC_PCM_CONV_MAX_CHANNELS];
+    int16_t cur[UAC_PCM_CONV_MAX_CHANNELS];
+} uac_pcm_conv_t;
+
+/**
+ * @brief Prepare a converter
+ *
+ * @param conv converter state
+ * @param config formats, copied
+ * @return 0 on success, -1 on an unsupported format
+ */
+int uac_pcm_conv_init(uac_pcm_conv_t *conv, const uac_pcm_conv_config_t *config);
+
+/**
+ * @brief Forget the history, e.g. after the stream was suspended
+ */
+void uac_pcm_conv_reset(uac_pcm_conv_t *conv);
+
+/**
+ * @brief Largest output for an input, to size the output buffer
+ *
+ * @param conv converter state
+ * @param in_bytes input bytes
+ * @return output bytes
+ */
+size_t uac_pcm_conv_out_max(const uac_pcm_conv_t *conv, size_t in_bytes);
+
+/**
+ * @brief Convert
+ *
+ * @param conv converter state
+ * @param in input, whole frames
+ * @param in_bytes input bytes
+ * @param in_used input bytes consumed, stops early when the output is full
+ * @param out output, interleaved 16 bit
+ * @param out_bytes output space, whole output frames are written
+ * @return output bytes written
+ */
+size_t uac_pcm_conv_process(uac_pcm_conv_t *conv, const void *in, size_t in_bytes, size_t *in_used, void *out, size_t out_bytes);
+
+/**
+ * @brief Delay added by the converter
+ *
+ * @return delay in microseconds
+ */
+uint32_t uac_pcm_conv_delay_us(const uac_pcm_conv_t *conv);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,148 @@
+/*
+ * SPDX-FileCopyrightText: 2024 ShenZhen XinYuan Electronic Technology Co., Ltd
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "uac_pcm_ring.h"
+
+/* the data has to be visible before the index that publishes it, and the index
+ * read before the data it covers; the indexes run free and wrap at 2^32 */
+#define LOAD_ACQUIRE(p)         __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(p, v)     __atomic_store_n(p, v, __ATOMIC_RELEASE)
+
+int uac_pcm_ring_init(uac_pcm_ring_t *ring, uint8_t *buf, size_t size)
+{
+    if (ring == NULL || buf == NULL || size < 4 || size > 0x80000000u || (size & (size - 1)) != 0) {
+        return -1;
+    }
+    memset(ring, 0, sizeof(*ring));
+    ring->buf = buf;
+    ring->size = (uint32_t)size;
+    ring->mask = (uint32_t)size - 1;
+    return 0;
+}
+
+size_t uac_pcm_ring_size_for(size_t bytes)
+{
+    size_t size = 4;
+
+    while (size < bytes && size < 0x80000000u) {
+        size <<= 1;
+    }
+    return size;
+}
+
+void uac_pcm_ring_set_watermarks(uac_pcm_ring_t *ring, size_t low, size_t high, uac_pcm_ring_cb_t *cb, void *arg)
+{
+    ring->low = low < ring->size ? (uint32_t)low : ring->size;
+    ring->high = high < ring->size ? (uint32_t)high : ring->size;
+    ring->cb = cb;
+    ring->cb_arg = arg;
+}
+
+size_t uac_pcm_ring_used(const uac_pcm_ring_t *ring)
+{
+    return LOAD_ACQUIRE(&ring->head) - LOAD_ACQUIRE(&ring->tail);
+}
+
+size_t uac_pcm_ring_free(const uac_pcm_ring_t *ring)
+{
+    return ring->size - uac_pcm_ring_used(ring);
+}
+
+size_t uac_pcm_ring_write_span(uac_pcm_ring_t *ring, uint8_t **ptr)
+{
+    uint32_t head = ring->head;
+    uint32_t free_bytes = ring->size - (head - LOAD_ACQUIRE(&ring->tail));
+    uint32_t to_end = ring->size - (head & ring->mask);
+
+    *ptr = ring->buf + (head & ring->mask);
+    return free_bytes < to_end ? free_bytes : to_end;
+}
+
+void uac_pcm_ring_write_commit(uac_pcm_ring_t *ring, size_t bytes)
+{
+    uint32_t head = ring->head + (uint32_t)bytes;
+    uint32_t used = head - LOAD_ACQUIRE(&ring->tail);
+
+    STORE_RELEASE(&ring->head, head);
+    ring->stats.written += bytes;
+    if (used > ring->stats.used_max) {
+        ring->stats.used_max = used;
+    }
+    /* fire once, on the write that crossed the mark */
+    if (ring->cb && ring->high && used >= ring->high && used - bytes < ring->high) {
+        ring->cb(UAC_PCM_RING_HIGH, used, ring->cb_arg);
+    }
+}
+
+size_t uac_pcm_ring_write(uac_pcm_ring_t *ring, const void *data, size_t bytes)
+{
+    const uint8_t *src = (const uint8_t *)data;
+    size_t done = 0, n;
+    uint8_t *ptr;
+
+    /* at most two spans, up to the end of the buffer then from its start */
+    while (done < bytes && (n = uac_pcm_ring_write_span(ring, &ptr)) > 0) {
+        if (n > bytes - done) {
+            n = bytes - done;
+        }
+        memcpy(ptr, src + done, n);
+        uac_pcm_ring_write_commit(ring, n);
+        done += n;
+    }
+    uac_pcm_ring_drop(ring, bytes - done);
+    return done;
+}
+
+void uac_pcm_ring_drop(uac_pcm_ring_t *ring, size_t bytes)
+{
+    ring->stats.overrun += bytes;
+}
+
+size_t uac_pcm_ring_read_span(uac_pcm_ring_t *ring, const uint8_t **ptr)
+{
+    uint32_t tail = ring->tail;
+    uint32_t used = LOAD_ACQUIRE(&ring->head) - tail;
+    uint32_t to_end = ring->size - (tail & ring->mask);
+
+    *ptr = ring->buf + (tail & ring->mask);
+    return used < to_end ? used : to_end;
+}
+
+void uac_pcm_ring_read_commit(uac_pcm_ring_t *ring, size_t bytes)
+{
+    uint32_t tail = ring->tail + (uint32_t)bytes;
+    uint32_t used = LOAD_ACQUIRE(&ring->head) - tail;
+
+    STORE_RELEASE(&ring->tail, tail);
+    ring->stats.read += bytes;
+    if (ring->cb && ring->low && used <= ring->low && used + bytes > ring->low) {
+        ring->cb(UAC_PCM_RING_LOW, used, ring->cb_arg);
+    }
+}
+
+size_t uac_pcm_ring_read(uac_pcm_ring_t *ring, void *data, size_t bytes)
+{
+    uint8_t *dst = (uint8_t *)data;
+    size_t done = 0, n;
+    const uint8_t *ptr;
+
+    while (done < bytes && (n = uac_pcm_ring_read_span(ring, &ptr)) > 0) {
+        if (n > bytes - done) {
+            n = bytes - done;
+        }
+        memcpy(dst + done, ptr, n);
+        uac_pcm_ring_read_commit(ring, n);
+        done += n;
+    }
+    ring->stats.underrun += bytes - done;
+    return done;
+}
+
+void uac_pcm_ring_get_stats(const uac_pcm_ring_t *ring, uac_pcm_ring_stats_t *stats)
+{
+    *stats = ring->stats;
+}
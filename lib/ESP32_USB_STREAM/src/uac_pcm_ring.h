@@ -0,0 +1,161 @@
+/*
+ * SPDX-FileCopyrightText: 2024 ShenZhen XinYuan Electronic Technology Co., Ltd
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Single producer, single consumer PCM byte ring.
+ *
+ * The producer and the consumer each own one index and only read the other one,
+ * so neither side takes a lock or waits: the USB task can feed the ring while an
+ * application task drains it. Both sides can work in place through
+ * uac_pcm_ring_write_span()/uac_pcm_ring_read_span() to avoid a copy.
+ *
+ * The watermark callback runs in the context of the side that crossed the mark:
+ * UAC_PCM_RING_HIGH from the producer once the fill level reaches the high mark,
+ * UAC_PCM_RING_LOW from the consumer once it drops to the low mark. It must not block.
+ */
+
+/**
+ * @brief Watermark events
+ */
+typedef enum {
+    UAC_PCM_RING_HIGH = 0,          /*!< fill level reached the high watermark, time to read */
+    UAC_PCM_RING_LOW,               /*!< fill level dropped to the low watermark, time to write */
+} uac_pcm_ring_event_t;
+
+typedef void (uac_pcm_ring_cb_t)(uac_pcm_ring_event_t event, size_t used, void *arg);
+
+/**
+ * @brief Ring counters, in bytes
+ */
+typedef struct {
+    uint32_t written;               /*!< bytes written */
+    uint32_t read;                  /*!< bytes read */
+    uint32_t overrun;               /*!< bytes the producer could not write, the ring was full */
+    uint32_t underrun;              /*!< bytes the consumer asked for but were not there */
+    uint32_t used_max;              /*!< highest fill level */
+} uac_pcm_ring_stats_t;
+
+/**
+ * @brief Ring state, treat as opaque
+ */
+typedef struct {
+    uint8_t *buf;
+    uint32_t size;                  /*!< power of two */
+    uint32_t mask;
+    volatile uint32_t head;         /*!< bytes written since init, written by the producer only */
+    volatile uint32_t tail;         /*!< bytes read since init, written by the consumer only */
+    uint32_t low;
+    uint32_t high;
+    uac_pcm_ring_cb_t *cb;
+    void *cb_arg;
+    uac_pcm_ring_stats_t stats;
+} uac_pcm_ring_t;
+
+/**
+ * @brief Prepare a ring over a caller provided buffer
+ *
+ * @param ring ring state
+ * @param buf buffer
+ * @param size buffer size, a power of two from 4 bytes to 2 GB, see uac_pcm_ring_size_for()
+ * @return 0 on success, -1 if size is not a power of two in that range
+ */
+int uac_pcm_ring_init(uac_pcm_ring_t *ring, uint8_t *buf, size_t size);
+
+/**
+ * @brief Ring buffer size to allocate for at least the given number of bytes
+ *
+ * @param bytes bytes the ring has to hold
+ * @return smallest power of two that is at least bytes, 4 at least
+ */
+size_t uac_pcm_ring_size_for(size_t bytes);
+
+/**
+ * @brief Set the watermarks and their callback, before the ring is in use
+ *
+ * @param ring ring state
+ * @param low UAC_PCM_RING_LOW fires when the fill level drops to this, 0 to disable
+ * @param high UAC_PCM_RING_HIGH fires when the fill level reaches this, 0 to disable
+ * @param cb callback
+ * @param arg callback argument
+ */
+void uac_pcm_ring_set_watermarks(uac_pcm_ring_t *ring, size_t low, size_t high, uac_pcm_ring_cb_t *cb, void *arg);
+
+/**
+ * @brief Bytes ready to be read
+ */
+size_t uac_pcm_ring_used(const uac_pcm_ring_t *ring);
+
+/**
+ * @brief Bytes that can be written
+ */
+size_t uac_pcm_ring_free(const uac_pcm_ring_t *ring);
+
+/**
+ * @brief Producer: copy into the ring, what does not fit is dropped and counted as overrun
+ *
+ * The copy can end inside a sample frame, check uac_pcm_ring_free() first to keep frames whole.
+ *
+ * @return bytes written
+ */
+size_t uac_pcm_ring_write(uac_pcm_ring_t *ring, const void *data, size_t bytes);
+
+/**
+ * @brief Producer: get the contiguous free space, fill it and call uac_pcm_ring_write_commit()
+ *
+ * @param ring ring state
+ * @param ptr start of the free space
+ * @return bytes available at ptr, the rest of the free space follows at the start of the buffer
+ */
+size_t uac_pcm_ring_write_span(uac_pcm_ring_t *ring, uint8_t **ptr);
+
+/**
+ * @brief Producer: publish bytes filled in through uac_pcm_ring_write_span()
+ */
+void uac_pcm_ring_write_commit(uac_pcm_ring_t *ring, size_t bytes);
+
+/**
+ * @brief Producer: count bytes that were not written for lack of space as overrun
+ */
+void uac_pcm_ring_drop(uac_pcm_ring_t *ring, size_t bytes);
+
+/**
+ * @brief Consumer: copy out of the ring, a short read is counted as underrun
+ *
+ * @return bytes read
+ */
+size_t uac_pcm_ring_read(uac_pcm_ring_t *ring, void *data, size_t bytes);
+
+/**
+ * @brief Consumer: get the contiguous ready data, use it and call uac_pcm_ring_read_commit()
+ *
+ * @param ring ring state
+ * @param ptr start of the ready data
+ * @return bytes available at ptr, the rest of the data follows at the start of the buffer
+ */
+size_t uac_pcm_ring_read_span(uac_pcm_ring_t *ring, const uint8_t **ptr);
+
+/**
+ * @brief Consumer: release bytes used through uac_pcm_ring_read_span()
+ */
+void uac_pcm_ring_read_commit(uac_pcm_ring_t *ring, size_t bytes);
+
+/**
+ * @brief Get a copy of the counters
+ */
+void uac_pcm_ring_get_stats(const uac_pcm_ring_t *ring, uac_pcm_ring_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,171 @@
+/*
+ * SPDX-FileCopyrightText: 2024 ShenZhen XinYuan Electronic Technology Co., Ltd
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "uvc_frame_ring.h"
+
+enum {
+    SLOT_FREE = 0,
+    SLOT_FILLING,                   /* being written by the producer */
+    SLOT_READY,                     /* complete, waiting for a consumer */
+    SLOT_HELD,                      /* owned by a consumer */
+};
+
+#ifdef ESP_PLATFORM
+#define RING_LOCK(r)        portENTER_CRITICAL(&(r)->lock)
+#define RING_UNLOCK(r)      portEXIT_CRITICAL(&(r)->lock)
+#else
+#define RING_LOCK(r)        pthread_mutex_lock(&(r)->lock)
+#define RING_UNLOCK(r)      pthread_mutex_unlock(&(r)->lock)
+#endif
+
+/* ready slot pushed first (oldest) or last (newest), called with the lock held */
+static uvc_ring_frame_t *ring_find_ready(uvc_frame_ring_t *ring, int newest)
+{
+    uvc_ring_frame_t *found = NULL;
+
+    for (int i = 0; i < ring->slot_num; i++) {
+        uvc_ring_frame_t *s = &ring->slots[i];
+        if (s->state != SLOT_READY) {
+            continue;
+        }
+        /* orders wrap, compare the distance */
+        if (found == NULL || (newest ? (int32_t)(s->order - found->order) > 0
+                              : (int32_t)(s->order - found->order) < 0)) {
+            found = s;
+        }
+    }
+    return found;
+}
+
+int uvc_frame_ring_init(uvc_frame_ring_t *ring, uint8_t *const *buffers, uint8_t slot_num, size_t slot_size, uvc_frame_ring_mode_t mode)
+{
+    if (ring == NULL || buffers == NULL || slot_num < 2 || slot_num > UVC_FRAME_RING_MAX_SLOTS || slot_size == 0) {
+        return UVC_FRAME_RING_ERR_ARG;
+    }
+    for (int i = 0; i < slot_num; i++) {
+        if (buffers[i] == NULL) {
+            return UVC_FRAME_RING_ERR_ARG;
+        }
+    }
+
+    memset(ring, 0, sizeof(*ring));
+    for (int i = 0; i < slot_num; i++) {
+        ring->slots[i].data = buffers[i];
+        ring->slots[i].capacity = slot_size;
+        ring->slots[i].index = (uint8_t)i;
+        ring->slots[i].state = SLOT_FREE;
+    }
+    ring->slot_num = slot_num;
+    ring->mode = mode;
+#ifdef ESP_PLATFORM
+    portMUX_INITIALIZE(&ring->lock);
+#else
+    pthread_mutex_init(&ring->lock, NULL);
+#endif
+    return UVC_FRAME_RING_OK;
+}
+
+void uvc_frame_ring_deinit(uvc_frame_ring_t *ring)
+{
+#ifndef ESP_PLATFORM
+    pthread_mutex_destroy(&ring->lock);
+#endif
+    ring->slot_num = 0;
+}
+
+int uvc_frame_ring_push(uvc_frame_ring_t *ring, const void *data, size_t data_bytes, uint32_t width, uint32_t height,
+                        uint32_t format, uint32_t sequence, int64_t timestamp_us)
+{
+    uvc_ring_frame_t *slot = NULL;
+
+    RING_LOCK(ring);
+    if (ring->slot_num && data_bytes > ring->slots[0].capacity) {
+        ring->stats.dropped_oversize++;
+        RING_UNLOCK(ring);
+        return UVC_FRAME_RING_ERR_SIZE;
+    }
+    for (int i = 0; i < ring->slot_num; i++) {
+        if (ring->slots[i].state == SLOT_FREE) {
+            slot = &ring->slots[i];
+            break;
+        }
+    }
+    if (slot == NULL) {
+        /* nobody took the oldest frame yet, a fresher one is worth more */
+        slot = ring_find_ready(ring, 0);
+        if (slot) {
+            ring->stats.overwritten++;
+        }
+    }
+    if (slot == NULL) {
+        ring->stats.dropped_busy++;
+        RING_UNLOCK(ring);
+        return UVC_FRAME_RING_ERR_BUSY;
+    }
+    slot->state = SLOT_FILLING;
+    RING_UNLOCK(ring);
+
+    /* the slot is out of reach of the consumers while it is filled */
+    memcpy(slot->data, data, data_bytes);
+    slot->data_bytes = data_bytes;
+    slot->width = width;
+    slot->height = height;
+    slot->format = format;
+    slot->sequence = sequence;
+    slot->timestamp_us = timestamp_us;
+
+    RING_LOCK(ring);
+    slot->order = ring->order++;
+    slot->state = SLOT_READY;
+    ring->stats.captured++;
+    RING_UNLOCK(ring);
+    return UVC_FRAME_RING_OK;
+}
+
+uvc_ring_frame_t *uvc_frame_ring_acquire(uvc_frame_ring_t *ring)
+{
+    uvc_ring_frame_t *frame, *older;
+
+    RING_LOCK(ring);
+    frame = ring_find_ready(ring, ring->mode == UVC_FRAME_RING_LATEST);
+    if (frame) {
+        frame->state = SLOT_HELD;
+        ring->stats.delivered++;
+        if (++ring->stats.held > ring->stats.held_max) {
+            ring->stats.held_max = ring->stats.held;
+        }
+        if (ring->mode == UVC_FRAME_RING_LATEST) {
+            /* frames older than the one handed out would only be shown late */
+            while ((older = ring_find_ready(ring, 0)) != NULL && (int32_t)(older->order - frame->order) < 0) {
+                older->state = SLOT_FREE;
+                ring->stats.overwritten++;
+            }
+        }
+    }
+    RING_UNLOCK(ring);
+    return frame;
+}
+
+void uvc_frame_ring_release(uvc_frame_ring_t *ring, uvc_ring_frame_t *frame)
+{
+    if (frame == NULL) {
+        return;
+    }
+    RING_LOCK(ring);
+    if (frame->state == SLOT_HELD) {
+        frame->state = SLOT_FREE;
+        ring->stats.held--;
+    }
+    RING_UNLOCK(ring);
+}
+
+void uvc_frame_ring_get_stats(uvc_frame_ring_t *ring, uvc_frame_ring_stats_t *stats)
+{
+    RING_LOCK(ring);
+    *stats = ring->stats;
+    RING_UNLOCK(ring);
+}
@@ -0,0 +1,160 @@
+/*
+ * SPDX-FileCopyrightText: 2024 ShenZhen XinYuan Electronic Technology Co., Ltd
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#else
+#include <pthread.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * N slot frame ring between the UVC frame callback and the frame consumers.
+ *
+ * The producer (the USB task) copies each complete frame into a free slot and never
+ * waits: when no slot is free the oldest frame nobody has taken yet is overwritten,
+ * and when every slot is held by a consumer the new frame is dropped. A consumer
+ * owns the frame it acquired until it releases it, so it can take as long as it
+ * wants without stalling the USB intake or seeing the frame change under it.
+ *
+ * The ring does not block, waiting for a frame is left to the caller. It only
+ * depends on FreeRTOS for its spinlock and builds on a PC with a pthread mutex
+ * instead, so the ring logic can be exercised on the host.
+ */
+
+#define UVC_FRAME_RING_MAX_SLOTS    8
+
+#define UVC_FRAME_RING_OK           0
+#define UVC_FRAME_RING_ERR_ARG      -1  /*!< invalid argument */
+#define UVC_FRAME_RING_ERR_SIZE     -2  /*!< frame larger than a slot, dropped */
+#define UVC_FRAME_RING_ERR_BUSY     -3  /*!< every slot held by a consumer, dropped */
+
+/**
+ * @brief Which ready frame a consumer gets
+ */
+typedef enum {
+    UVC_FRAME_RING_LATEST = 0,      /*!< the newest one, older ready frames are recycled (live view) */
+    UVC_FRAME_RING_FIFO,            /*!< the oldest one, frames are only lost when the ring is full (recording) */
+} uvc_frame_ring_mode_t;
+
+/**
+ * @brief A frame in the ring, read only for the consumer holding it
+ */
+typedef struct {
+    uint8_t *data;                  /*!< frame data */
+    size_t data_bytes;              /*!< frame length */
+    size_t capacity;                /*!< slot size */
+    uint32_t width;                 /*!< frame width */
+    uint32_t height;                /*!< frame height */
+    uint32_t format;                /*!< enum uvc_frame_format */
+    uint32_t sequence;              /*!< frame number from the driver */
+    int64_t timestamp_us;           /*!< time the frame was completed */
+    uint8_t index;                  /*!< slot number, 0 .. slot_num - 1 */
+    uint8_t state;                  /*!< private */
+    uint32_t order;                 /*!< private, push order */
+} uvc_ring_frame_t;
+
+/**
+ * @brief Ring counters
+ */
+typedef struct {
+    uint32_t captured;              /*!< frames stored into the ring */
+    uint32_t delivered;             /*!< frames handed to consumers */
+    uint32_t overwritten;           /*!< ready frames recycled before a consumer took them */
+    uint32_t dropped_busy;          /*!< incoming frames dropped, every slot was held */
+    uint32_t dropped_oversize;      /*!< incoming frames dropped, larger than a slot */
+    uint8_t held;                   /*!< slots held by consumers now */
+    uint8_t held_max;               /*!< highest number of slots held at once */
+} uvc_frame_ring_stats_t;
+
+/**
+ * @brief Ring state, treat as opaque
+ */
+typedef struct {
+    uvc_ring_frame_t slots[UVC_FRAME_RING_MAX_SLOTS];
+    uint8_t slot_num;
+    uvc_frame_ring_mode_t mode;
+    uint32_t order;
+    uvc_frame_ring_stats_t stats;
+#ifdef ESP_PLATFORM
+    portMUX_TYPE lock;
+#else
+    pthread_mutex_t lock;
+#endif
+} uvc_frame_ring_t;
+
+/**
+ * @brief Prepare a ring over caller provided buffers
+ *
+ * @param ring ring state
+ * @param buffers slot_num buffers of slot_size bytes each
+ * @param slot_num number of slots, 2 .. UVC_FRAME_RING_MAX_SLOTS
+ * @param slot_size size of each buffer, must be larger than one frame
+ * @param mode which ready frame uvc_frame_ring_acquire() returns
+ * @return UVC_FRAME_RING_OK or UVC_FRAME_RING_ERR_ARG
+ */
+int uvc_frame_ring_init(uvc_frame_ring_t *ring, uint8_t *const *buffers, uint8_t slot_num, size_t slot_size, uvc_frame_ring_mode_t mode);
+
+/**
+ * @brief Release the lock of the ring, the buffers belong to the caller
+ *
+ * @param ring ring state
+ */
+void uvc_frame_ring_deinit(uvc_frame_ring_t *ring);
+
+/**
+ * @brief Copy a complete frame into the ring, never blocks
+ *
+ * Only one producer at a time. The copy runs outside of the lock.
+ *
+ * @param ring ring state
+ * @param data frame data
+ * @param data_bytes frame length
+ * @param width frame width
+ * @param height frame height
+ * @param format frame format
+ * @param sequence frame number
+ * @param timestamp_us time the frame was completed
+ * @return UVC_FRAME_RING_OK, UVC_FRAME_RING_ERR_SIZE or UVC_FRAME_RING_ERR_BUSY
+ */
+int uvc_frame_ring_push(uvc_frame_ring_t *ring, const void *data, size_t data_bytes, uint32_t width, uint32_t height,
+                        uint32_t format, uint32_t sequence, int64_t timestamp_us);
+
+/**
+ * @brief Take ownership of a ready frame, never blocks
+ *
+ * @param ring ring state
+ * @return the frame, to be given back with uvc_frame_ring_release(), or NULL if none is ready
+ */
+uvc_ring_frame_t *uvc_frame_ring_acquire(uvc_frame_ring_t *ring);
+
+/**
+ * @brief Give a frame back to the ring
+ *
+ * @param ring ring state
+ * @param frame frame returned by uvc_frame_ring_acquire()
+ */
+void uvc_frame_ring_release(uvc_frame_ring_t *ring, uvc_ring_frame_t *frame);
+
+/**
+ * @brief Get a copy of the counters
+ *
+ * @param ring ring state
+ * @param stats counters
+ */
+void uvc_frame_ring_get_stats(uvc_frame_ring_t *ring, uvc_frame_ring_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
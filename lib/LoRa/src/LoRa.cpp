@@ -297,10 +297,8 @@ size_t LoRaClass::write(const uint8_t *buffer, size_t size)
     size = MAX_PKT_LENGTH - currentLength;
   }
 
-  // write data
-  for (size_t i = 0; i < size; i++) {
-    writeRegister(REG_FIFO, buffer[i]);
-  }
+  // write data in a single burst
+  writeRegisterBurst(REG_FIFO, buffer, size);
 
   // update length
   writeRegister(REG_PAYLOAD_LENGTH, currentLength + size);
@@ -342,6 +340,31 @@ int LoRaClass::peek()
   return b;
 }
 
+size_t LoRaClass::readBytes(char *buffer, size_t length)
+{
+  return readBytes((uint8_t *)buffer, length);
+}
+
+size_t LoRaClass::readBytes(uint8_t *buffer, size_t length)
+{
+  int remaining = available();
+
+  if (remaining <= 0) {
+    return 0;
+  }
+
+  if (length > (size_t)remaining) {
+    length = remaining;
+  }
+
+  // read the payload in a single burst
+  readRegisterBurst(REG_FIFO, buffer, length);
+
+  _packetIndex += length;
+
+  return length;
+}
+
 void LoRaClass::flush()
 {
 }
@@ -665,6 +688,50 @@ void LoRaClass::writeRegister(uint8_t address, uint8_t value)
   singleTransfer(address | 0x80, value);
 }
 
+void LoRaClass::readRegisterBurst(uint8_t address, uint8_t* buffer, size_t size)
+{
+  if (size == 0) {
+    return;
+  }
+
+  digitalWrite(_ss, LOW);
+
+  _spi->beginTransaction(_spiSettings);
+  _spi->transfer(address & 0x7f);
+#if defined(ESP32)
+  _spi->transferBytes(NULL, buffer, size);
+#else
+  for (size_t i = 0; i < size; i++) {
+    buffer[i] = _spi->transfer(0x00);
+  }
+#endif
+  _spi->endTransaction();
+
+  digitalWrite(_ss, HIGH);
+}
+
+void LoRaClass::writeRegisterBurst(uint8_t address, const uint8_t* buffer, size_t size)
+{
+  if (size == 0) {
+    return;
+  }
+
+  digitalWrite(_ss, LOW);
+
+  _spi->beginTransaction(_spiSettings);
+  _spi->transfer(address | 0x80);
+#if defined(ESP32)
+  _spi->writeBytes(buffer, size);
+#else
+  for (size_t i = 0; i < size; i++) {
+    _spi->transfer(buffer[i]);
+  }
+#endif
+  _spi->endTransaction();
+
+  digitalWrite(_ss, HIGH);
+}
+
 uint8_t LoRaClass::singleTransfer(uint8_t address, uint8_t value)
 {
   uint8_t response;
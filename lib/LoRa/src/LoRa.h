@@ -54,6 +54,8 @@ public:
   virtual int read();
   virtual int peek();
   virtual void flush();
+  virtual size_t readBytes(char *buffer, size_t length);
+  size_t readBytes(uint8_t *buffer, size_t length);
 
 #ifndef ARDUINO_SAMD_MKRWAN1300
   void onReceive(void(*callback)(int));
@@ -103,6 +105,8 @@ private:
 
   uint8_t readRegister(uint8_t address);
   void writeRegister(uint8_t address, uint8_t value);
+  void readRegisterBurst(uint8_t address, uint8_t* buffer, size_t size);
+  void writeRegisterBurst(uint8_t address, const uint8_t* buffer, size_t size);
   uint8_t singleTransfer(uint8_t address, uint8_t value);
 
   static void onDio0Rise();
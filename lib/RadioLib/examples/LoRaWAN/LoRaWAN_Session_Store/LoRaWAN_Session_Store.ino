@@ -0,0 +1,170 @@
+/*
+  RadioLib LoRaWAN Session Store Example
+
+  This example uses a single radio to emulate a fleet of
+  ABP devices, e.g. to load-test a network server.
+  All sessions are registered in a LoRaWANSessionStore.
+  The most recently used ones are kept in RAM, the others
+  are stored in flash (LittleFS) in fixed-size records.
+  Switching the active device only restores the stored
+  session buffers, it does not depend on the fleet size.
+
+  The devices must be registered at the network server
+  with DevAddr = firstDevAddr + n and the session keys below,
+  and "Resets frame counters" should be enabled.
+
+  This example requires an ESP32 (LittleFS).
+
+  For default module settings, see the wiki page
+  https://github.com/jgromes/RadioLib/wiki/Default-configuration
+
+  For full API reference, see the GitHub Pages
+  https://jgromes.github.io/RadioLib/
+
+  For LoRaWAN details, see the wiki page
+  https://github.com/jgromes/RadioLib/wiki/LoRaWAN
+
+*/
+
+#include <RadioLib.h>
+#include <LittleFS.h>
+
+// first you have to set your radio model and pin configuration
+// this is provided just as a default example
+SX1276 radio = new Module(10, 2, 9, 3);
+
+// regional choices: EU868, US915, AU915, AS923, AS923_2, AS923_3, AS923_4, IN865, KR920, CN500
+const LoRaWANBand_t Region = EU868;
+const uint8_t subBand = 0;  // For US915, change this to 2, otherwise leave on 0
+
+// number of virtual devices and the address of the first one
+const uint16_t numDevices = 100;
+const uint32_t firstDevAddr = 0x26000000;
+
+// session keys shared by all virtual devices (LoRaWAN 1.0)
+uint8_t nwkSKey[] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+uint8_t appSKey[] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+// how often to send an uplink (from any of the devices)
+const uint32_t uplinkIntervalMillis = 10UL * 1000UL;
+
+// cold storage: one file with a fixed-size record per device
+class LittleFSSessionStorage : public LoRaWANSessionStorage {
+  public:
+    int16_t load(uint16_t index, uint8_t* nonces, uint8_t* session) override {
+      File file = LittleFS.open(path, "r");
+      if(!file) {
+        return(RADIOLIB_ERR_UNKNOWN);
+      }
+      bool ok = file.seek((size_t)index * recordSize) &&
+                (file.read(nonces, RADIOLIB_LORAWAN_NONCES_BUF_SIZE) == RADIOLIB_LORAWAN_NONCES_BUF_SIZE) &&
+                (file.read(session, RADIOLIB_LORAWAN_SESSION_BUF_SIZE) == RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+      file.close();
+      return(ok ? RADIOLIB_ERR_NONE : RADIOLIB_ERR_UNKNOWN);
+    }
+
+    int16_t save(uint16_t index, const uint8_t* nonces, const uint8_t* session) override {
+      File file = LittleFS.open(path, LittleFS.exists(path) ? "r+" : "w+");
+      if(!file) {
+        return(RADIOLIB_ERR_UNKNOWN);
+      }
+      bool ok = file.seek((size_t)index * recordSize) &&
+                (file.write(nonces, RADIOLIB_LORAWAN_NONCES_BUF_SIZE) == RADIOLIB_LORAWAN_NONCES_BUF_SIZE) &&
+                (file.write(session, RADIOLIB_LORAWAN_SESSION_BUF_SIZE) == RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+      file.close();
+      return(ok ? RADIOLIB_ERR_NONE : RADIOLIB_ERR_UNKNOWN);
+    }
+
+  private:
+    const char* path = "/lorawan_sessions.bin";
+    const size_t recordSize = RADIOLIB_LORAWAN_NONCES_BUF_SIZE + RADIOLIB_LORAWAN_SESSION_BUF_SIZE;
+};
+
+LoRaWANNode node(&radio, &Region, subBand);
+LittleFSSessionStorage storage;
+LoRaWANSessionStore store(&node, &storage);
+
+uint16_t current = 0;
+
+void setup() {
+  Serial.begin(115200);
+  while(!Serial);
+  delay(5000);  // Give time to switch to the serial monitor
+  Serial.println(F("\nSetup ... "));
+
+  if(!LittleFS.begin(true)) {
+    Serial.println(F("Mounting LittleFS failed!"));
+    while(true) { delay(1); }
+  }
+
+  Serial.println(F("Initialise the radio"));
+  int16_t state = radio.begin();
+  if(state != RADIOLIB_ERR_NONE) {
+    Serial.print(F("Initialise radio failed, code "));
+    Serial.println(state);
+    while(true) { delay(1); }
+  }
+
+  // activate every virtual device once and register its session
+  Serial.print(F("Registering "));
+  Serial.print(numDevices);
+  Serial.println(F(" devices"));
+  for(uint16_t i = 0; i < numDevices; i++) {
+    node.clearSession();
+    node.beginABP(firstDevAddr + i, NULL, NULL, nwkSKey, appSKey);
+    node.activateABP();
+    state = store.add();
+    if(state != RADIOLIB_ERR_NONE) {
+      Serial.print(F("Registering device failed, code "));
+      Serial.println(state);
+      while(true) { delay(1); }
+    }
+  }
+  store.flush();
+
+  Serial.println(F("Ready!\n"));
+}
+
+void loop() {
+  uint32_t devAddr = firstDevAddr + current;
+  current = (current + 1) % numDevices;
+
+  // switch the node over to the next device
+  uint32_t start = micros();
+  int16_t state = store.activate(devAddr);
+  uint32_t switchTime = micros() - start;
+  if(state != RADIOLIB_ERR_NONE) {
+    Serial.print(F("Switching session failed, code "));
+    Serial.println(state);
+    delay(uplinkIntervalMillis);
+    return;
+  }
+
+  Serial.print(F("[0x"));
+  Serial.print(devAddr, HEX);
+  Serial.print(F("] switched in "));
+  Serial.print(switchTime);
+  Serial.print(F(" us, sending uplink ... "));
+
+  uint8_t uplinkPayload[2] = { highByte(current), lowByte(current) };
+  state = node.sendReceive(uplinkPayload, sizeof(uplinkPayload));
+  if((state == RADIOLIB_ERR_NONE) || (state == RADIOLIB_LORAWAN_NO_DOWNLINK)) {
+    Serial.println(F("done"));
+  } else {
+    Serial.print(F("failed, code "));
+    Serial.println(state);
+  }
+
+  // keep the frame counters of the active device in the store
+  store.sync();
+
+  LoRaWANSessionStoreStats_t stats = store.getStats();
+  Serial.print(F("Working set hits: "));
+  Serial.print(stats.hits);
+  Serial.print(F(", misses: "));
+  Serial.print(stats.misses);
+  Serial.print(F(", write-backs: "));
+  Serial.println(stats.writeBacks);
+
+  delay(uplinkIntervalMillis);
+}
@@ -109,6 +109,7 @@
 #include "protocols/Print/Print.h"
 #include "protocols/BellModem/BellModem.h"
 #include "protocols/LoRaWAN/LoRaWAN.h"
+#include "protocols/LoRaWAN/LoRaWANSessionStore.h"
 
 // utilities
 #include "utils/CRC.h"
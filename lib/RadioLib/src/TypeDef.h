@@ -588,6 +588,16 @@
 */
 #define RADIOLIB_LORAWAN_INVALID_MODE                            (-1121)
 
+/*!
+  \brief The session store has no space left for another device.
+*/
+#define RADIOLIB_LORAWAN_SESSION_STORE_FULL                      (-1122)
+
+/*!
+  \brief The requested device address is not registered in the session store.
+*/
+#define RADIOLIB_LORAWAN_SESSION_NOT_FOUND                       (-1123)
+
 // LR11x0-specific status codes
 
 /*!
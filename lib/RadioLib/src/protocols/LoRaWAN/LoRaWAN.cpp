@@ -283,6 +283,27 @@ int16_t LoRaWANNode::setBufferSession(uint8_t* persistentBuffer) {
   return(state);
 }
 
+int16_t LoRaWANNode::switchSession(uint8_t* nonces, uint8_t* session) {
+  int16_t state = LoRaWANNode::checkBufferCommon(nonces, RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
+  RADIOLIB_ASSERT(state);
+
+  // drop the current session and take over the activation parameters of the stored one,
+  // the configuration check in setBufferNonces will then only compare the frequency plan
+  this->clearSession();
+  this->lwMode = LoRaWANNode::ntoh<uint16_t>(&nonces[RADIOLIB_LORAWAN_NONCES_MODE]);
+  this->lwClass = LoRaWANNode::ntoh<uint8_t>(&nonces[RADIOLIB_LORAWAN_NONCES_CLASS]);
+  this->keyCheckSum = LoRaWANNode::ntoh<uint16_t>(&nonces[RADIOLIB_LORAWAN_NONCES_CHECKSUM]);
+
+  state = this->setBufferNonces(nonces);
+  RADIOLIB_ASSERT(state);
+
+  state = this->setBufferSession(session);
+  RADIOLIB_ASSERT(state);
+
+  this->isActive = true;
+  return(state);
+}
+
 int16_t LoRaWANNode::checkBufferCommon(uint8_t *buffer, uint16_t size) {
   // check if there are actually values in the buffer
   size_t i = 0;
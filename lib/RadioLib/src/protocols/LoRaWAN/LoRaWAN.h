@@ -563,6 +563,15 @@ class LoRaWANNode {
     */
     int16_t setBufferSession(uint8_t* persistentBuffer);
 
+    /*!
+      \brief Replace the current session by a previously saved one, without going through activation again.
+      This allows a single node to service multiple devices, see LoRaWANSessionStore.
+      \param nonces Nonces buffer of the session (previously extracted using getBufferNonces)
+      \param session Session buffer of the session (previously extracted using getBufferSession)
+      \returns \ref status_codes
+    */
+    int16_t switchSession(uint8_t* nonces, uint8_t* session);
+
     /*!
       \brief Set the device credentials and activation configuration
       \param joinEUI 8-byte application identifier.
@@ -0,0 +1,341 @@
+#include "LoRaWANSessionStore.h"
+#include <string.h>
+
+#if !RADIOLIB_EXCLUDE_LORAWAN
+
+LoRaWANSessionStore::LoRaWANSessionStore(LoRaWANNode* node, LoRaWANSessionStorage* storage) {
+  this->node = node;
+  this->storage = storage;
+  memset(this->index, 0, sizeof(this->index));
+  for(size_t i = 0; i < RADIOLIB_LORAWAN_SESSION_STORE_MAX_DEVICES; i++) {
+    this->entries[i].devAddr = 0;
+    this->entries[i].slot = RADIOLIB_LORAWAN_SESSION_SLOT_NONE;
+    this->entries[i].used = false;
+  }
+  for(size_t i = 0; i < RADIOLIB_LORAWAN_SESSION_STORE_HOT_SLOTS; i++) {
+    this->slots[i].entry = RADIOLIB_LORAWAN_SESSION_ENTRY_NONE;
+    this->slots[i].prev = RADIOLIB_LORAWAN_SESSION_SLOT_NONE;
+    this->slots[i].next = RADIOLIB_LORAWAN_SESSION_SLOT_NONE;
+    this->slots[i].dirty = false;
+  }
+}
+
+int16_t LoRaWANSessionStore::add() {
+  if(!this->node->isActivated()) {
+    return(RADIOLIB_ERR_NETWORK_NOT_JOINED);
+  }
+
+  int16_t state = this->add(this->node->getBufferNonces(), this->node->getBufferSession());
+  RADIOLIB_ASSERT(state);
+
+  // the session that was just added is the one running on the node
+  this->active = this->entries[this->findEntry((uint32_t)this->node->getDevAddr())].slot;
+  return(state);
+}
+
+int16_t LoRaWANSessionStore::add(uint8_t* nonces, uint8_t* session) {
+  // DevAddr is stored little-endian, same as all other multi-byte fields of the session buffer
+  uint8_t* addrPtr = &session[RADIOLIB_LORAWAN_SESSION_DEV_ADDR];
+  uint32_t devAddr = (uint32_t)addrPtr[0] | ((uint32_t)addrPtr[1] << 8) | ((uint32_t)addrPtr[2] << 16) | ((uint32_t)addrPtr[3] << 24);
+
+  uint16_t entry = this->findEntry(devAddr);
+  uint8_t slot = RADIOLIB_LORAWAN_SESSION_SLOT_NONE;
+  if(entry == RADIOLIB_LORAWAN_SESSION_ENTRY_NONE) {
+    // without cold storage, all sessions must fit in RAM
+    uint16_t maxDevices = this->storage ? RADIOLIB_LORAWAN_SESSION_STORE_MAX_DEVICES : RADIOLIB_LORAWAN_SESSION_STORE_HOT_SLOTS;
+    if(this->numDevices >= maxDevices) {
+      return(RADIOLIB_LORAWAN_SESSION_STORE_FULL);
+    }
+
+    // find a free entry
+    for(entry = 0; entry < RADIOLIB_LORAWAN_SESSION_STORE_MAX_DEVICES; entry++) {
+      if(!this->entries[entry].used) {
+        break;
+      }
+    }
+
+    // the device is only registered once it has a slot, so a failed eviction leaves the store as it was
+    int16_t state = this->acquireSlot(entry, &slot);
+    RADIOLIB_ASSERT(state);
+
+    this->entries[entry].devAddr = devAddr;
+    this->entries[entry].used = true;
+    this->insertIndex(devAddr, entry);
+    this->numDevices++;
+  } else {
+    slot = this->entries[entry].slot;
+    if(slot == RADIOLIB_LORAWAN_SESSION_SLOT_NONE) {
+      int16_t state = this->acquireSlot(entry, &slot);
+      RADIOLIB_ASSERT(state);
+    } else {
+      this->unlink(slot);
+      this->pushFront(slot);
+    }
+  }
+
+  memcpy(this->slots[slot].nonces, nonces, RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
+  memcpy(this->slots[slot].session, session, RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+  this->slots[slot].dirty = true;
+
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANSessionStore::remove(uint32_t devAddr) {
+  uint16_t entry = this->findEntry(devAddr);
+  if(entry == RADIOLIB_LORAWAN_SESSION_ENTRY_NONE) {
+    return(RADIOLIB_LORAWAN_SESSION_NOT_FOUND);
+  }
+
+  uint8_t slot = this->entries[entry].slot;
+  if(slot != RADIOLIB_LORAWAN_SESSION_SLOT_NONE) {
+    this->unlink(slot);
+    this->slots[slot].entry = RADIOLIB_LORAWAN_SESSION_ENTRY_NONE;
+    this->slots[slot].dirty = false;
+    if(this->active == slot) {
+      this->active = RADIOLIB_LORAWAN_SESSION_SLOT_NONE;
+    }
+  }
+
+  this->removeIndex(devAddr);
+  this->entries[entry].slot = RADIOLIB_LORAWAN_SESSION_SLOT_NONE;
+  this->entries[entry].used = false;
+  this->numDevices--;
+
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANSessionStore::activate(uint32_t devAddr) {
+  uint16_t entry = this->findEntry(devAddr);
+  if(entry == RADIOLIB_LORAWAN_SESSION_ENTRY_NONE) {
+    return(RADIOLIB_LORAWAN_SESSION_NOT_FOUND);
+  }
+
+  uint8_t slot = this->entries[entry].slot;
+  if((slot != RADIOLIB_LORAWAN_SESSION_SLOT_NONE) && (slot == this->active)) {
+    // already running on the node
+    this->stats.hits++;
+    return(RADIOLIB_ERR_NONE);
+  }
+
+  // save the outgoing session before the node drops it
+  this->sync();
+
+  int16_t state = RADIOLIB_ERR_NONE;
+  if(slot == RADIOLIB_LORAWAN_SESSION_SLOT_NONE) {
+    this->stats.misses++;
+    state = this->acquireSlot(entry, &slot);
+    RADIOLIB_ASSERT(state);
+
+    state = this->storage->load(entry, this->slots[slot].nonces, this->slots[slot].session);
+    if(state != RADIOLIB_ERR_NONE) {
+      this->unlink(slot);
+      this->slots[slot].entry = RADIOLIB_LORAWAN_SESSION_ENTRY_NONE;
+      this->entries[entry].slot = RADIOLIB_LORAWAN_SESSION_SLOT_NONE;
+      return(state);
+    }
+    this->slots[slot].dirty = false;
+  } else {
+    this->stats.hits++;
+    this->unlink(slot);
+    this->pushFront(slot);
+  }
+
+  // the node drops its previous session either way
+  state = this->node->switchSession(this->slots[slot].nonces, this->slots[slot].session);
+  this->active = (state == RADIOLIB_ERR_NONE) ? slot : RADIOLIB_LORAWAN_SESSION_SLOT_NONE;
+  return(state);
+}
+
+void LoRaWANSessionStore::sync() {
+  if((this->active == RADIOLIB_LORAWAN_SESSION_SLOT_NONE) || !this->node->isActivated()) {
+    return;
+  }
+
+  // make sure the node still runs the session we think it does
+  Slot_t* slot = &this->slots[this->active];
+  if((uint32_t)this->node->getDevAddr() != this->entries[slot->entry].devAddr) {
+    this->active = RADIOLIB_LORAWAN_SESSION_SLOT_NONE;
+    return;
+  }
+
+  memcpy(slot->nonces, this->node->getBufferNonces(), RADIOLIB_LORAWAN_NONCES_BUF_SIZE);
+  memcpy(slot->session, this->node->getBufferSession(), RADIOLIB_LORAWAN_SESSION_BUF_SIZE);
+  slot->dirty = true;
+}
+
+int16_t LoRaWANSessionStore::flush() {
+  this->sync();
+  if(!this->storage) {
+    return(RADIOLIB_ERR_NONE);
+  }
+
+  for(uint8_t i = 0; i < RADIOLIB_LORAWAN_SESSION_STORE_HOT_SLOTS; i++) {
+    Slot_t* slot = &this->slots[i];
+    if((slot->entry == RADIOLIB_LORAWAN_SESSION_ENTRY_NONE) || !slot->dirty) {
+      continue;
+    }
+    int16_t state = this->storage->save(slot->entry, slot->nonces, slot->session);
+    RADIOLIB_ASSERT(state);
+    slot->dirty = false;
+    this->stats.writeBacks++;
+  }
+
+  return(RADIOLIB_ERR_NONE);
+}
+
+bool LoRaWANSessionStore::contains(uint32_t devAddr) {
+  return(this->findEntry(devAddr) != RADIOLIB_LORAWAN_SESSION_ENTRY_NONE);
+}
+
+uint32_t LoRaWANSessionStore::getActive() {
+  if(this->active == RADIOLIB_LORAWAN_SESSION_SLOT_NONE) {
+    return(0);
+  }
+  return(this->entries[this->slots[this->active].entry].devAddr);
+}
+
+uint16_t LoRaWANSessionStore::getNumDevices() {
+  return(this->numDevices);
+}
+
+LoRaWANSessionStoreStats_t LoRaWANSessionStore::getStats() {
+  return(this->stats);
+}
+
+void LoRaWANSessionStore::resetStats() {
+  memset(&this->stats, 0, sizeof(this->stats));
+}
+
+uint16_t LoRaWANSessionStore::hash(uint32_t devAddr) {
+  // multiplicative hashing, DevAddr values of virtual devices are often sequential
+  return((uint16_t)((uint32_t)(devAddr * 2654435761UL) >> 16) & (RADIOLIB_LORAWAN_SESSION_STORE_INDEX_SIZE - 1));
+}
+
+uint16_t LoRaWANSessionStore::findEntry(uint32_t devAddr) {
+  uint16_t pos = LoRaWANSessionStore::hash(devAddr);
+  for(uint16_t i = 0; i < RADIOLIB_LORAWAN_SESSION_STORE_INDEX_SIZE; i++) {
+    uint16_t val = this->index[pos];
+    if(val == 0) {
+      break;
+    }
+    if(this->entries[val - 1].devAddr == devAddr) {
+      return(val - 1);
+    }
+    pos = (pos + 1) & (RADIOLIB_LORAWAN_SESSION_STORE_INDEX_SIZE - 1);
+  }
+  return(RADIOLIB_LORAWAN_SESSION_ENTRY_NONE);
+}
+
+void LoRaWANSessionStore::insertIndex(uint32_t devAddr, uint16_t entry) {
+  // index is always larger than the number of entries, so there is a free position
+  uint16_t pos = LoRaWANSessionStore::hash(devAddr);
+  while(this->index[pos] != 0) {
+    pos = (pos + 1) & (RADIOLIB_LORAWAN_SESSION_STORE_INDEX_SIZE - 1);
+  }
+  this->index[pos] = entry + 1;
+}
+
+void LoRaWANSessionStore::removeIndex(uint32_t devAddr) {
+  const uint16_t mask = RADIOLIB_LORAWAN_SESSION_STORE_INDEX_SIZE - 1;
+  uint16_t pos = LoRaWANSessionStore::hash(devAddr);
+  while(this->entries[this->index[pos] - 1].devAddr != devAddr) {
+    pos = (pos + 1) & mask;
+  }
+  this->index[pos] = 0;
+
+  // shift back the following entries of the probe sequence, so that lookups do not stop at the hole
+  uint16_t next = pos;
+  while(true) {
+    next = (next + 1) & mask;
+    if(this->index[next] == 0) {
+      break;
+    }
+    uint16_t home = LoRaWANSessionStore::hash(this->entries[this->index[next] - 1].devAddr);
+    if(((next - home) & mask) >= ((next - pos) & mask)) {
+      this->index[pos] = this->index[next];
+      this->index[next] = 0;
+      pos = next;
+    }
+  }
+}
+
+int16_t LoRaWANSessionStore::acquireSlot(uint16_t entry, uint8_t* slot) {
+  uint8_t i = 0;
+  for(; i < RADIOLIB_LORAWAN_SESSION_STORE_HOT_SLOTS; i++) {
+    if(this->slots[i].entry == RADIOLIB_LORAWAN_SESSION_ENTRY_NONE) {
+      break;
+    }
+  }
+
+  if(i == RADIOLIB_LORAWAN_SESSION_STORE_HOT_SLOTS) {
+    // working set is full, make room by dropping the least recently used session
+    i = this->tail;
+    int16_t state = this->evict(i);
+    RADIOLIB_ASSERT(state);
+  }
+
+  this->slots[i].entry = entry;
+  this->slots[i].dirty = false;
+  this->entries[entry].slot = i;
+  this->pushFront(i);
+  *slot = i;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t LoRaWANSessionStore::evict(uint8_t slot) {
+  if(!this->storage) {
+    return(RADIOLIB_LORAWAN_SESSION_STORE_FULL);
+  }
+
+  if(slot == this->active) {
+    this->sync();
+  }
+
+  Slot_t* s = &this->slots[slot];
+  if(s->dirty) {
+    int16_t state = this->storage->save(s->entry, s->nonces, s->session);
+    RADIOLIB_ASSERT(state);
+    this->stats.writeBacks++;
+  }
+
+  if(slot == this->active) {
+    this->active = RADIOLIB_LORAWAN_SESSION_SLOT_NONE;
+  }
+  this->entries[s->entry].slot = RADIOLIB_LORAWAN_SESSION_SLOT_NONE;
+  this->unlink(slot);
+  s->entry = RADIOLIB_LORAWAN_SESSION_ENTRY_NONE;
+  s->dirty = false;
+  this->stats.evictions++;
+  return(RADIOLIB_ERR_NONE);
+}
+
+void LoRaWANSessionStore::unlink(uint8_t slot) {
+  Slot_t* s = &this->slots[slot];
+  if(s->prev != RADIOLIB_LORAWAN_SESSION_SLOT_NONE) {
+    this->slots[s->prev].next = s->next;
+  } else if(this->head == slot) {
+    this->head = s->next;
+  }
+  if(s->next != RADIOLIB_LORAWAN_SESSION_SLOT_NONE) {
+    this->slots[s->next].prev = s->prev;
+  } else if(this->tail == slot) {
+    this->tail = s->prev;
+  }
+  s->prev = RADIOLIB_LORAWAN_SESSION_SLOT_NONE;
+  s->next = RADIOLIB_LORAWAN_SESSION_SLOT_NONE;
+}
+
+void LoRaWANSessionStore::pushFront(uint8_t slot) {
+  Slot_t* s = &this->slots[slot];
+  s->prev = RADIOLIB_LORAWAN_SESSION_SLOT_NONE;
+  s->next = this->head;
+  if(this->head != RADIOLIB_LORAWAN_SESSION_SLOT_NONE) {
+    this->slots[this->head].prev = slot;
+  }
+  this->head = slot;
+  if(this->tail == RADIOLIB_LORAWAN_SESSION_SLOT_NONE) {
+    this->tail = slot;
+  }
+}
+
+#endif
@@ -0,0 +1,218 @@
+#if !defined(_RADIOLIB_LORAWAN_SESSION_STORE_H) && !RADIOLIB_EXCLUDE_LORAWAN
+#define _RADIOLIB_LORAWAN_SESSION_STORE_H
+
+#include "LoRaWAN.h"
+
+// maximum number of devices that can be registered in a single store
+#if !defined(RADIOLIB_LORAWAN_SESSION_STORE_MAX_DEVICES)
+  #define RADIOLIB_LORAWAN_SESSION_STORE_MAX_DEVICES            (256)
+#endif
+
+// number of sessions kept in RAM (the working set), the rest lives in cold storage
+#if !defined(RADIOLIB_LORAWAN_SESSION_STORE_HOT_SLOTS)
+  #define RADIOLIB_LORAWAN_SESSION_STORE_HOT_SLOTS              (8)
+#endif
+
+// size of the DevAddr hash index, must be a power of 2 and larger than the maximum number of devices
+#if !defined(RADIOLIB_LORAWAN_SESSION_STORE_INDEX_SIZE)
+  #define RADIOLIB_LORAWAN_SESSION_STORE_INDEX_SIZE             (512)
+#endif
+
+#if (RADIOLIB_LORAWAN_SESSION_STORE_INDEX_SIZE & (RADIOLIB_LORAWAN_SESSION_STORE_INDEX_SIZE - 1)) != 0
+  #error "RADIOLIB_LORAWAN_SESSION_STORE_INDEX_SIZE must be a power of 2"
+#endif
+
+#if RADIOLIB_LORAWAN_SESSION_STORE_INDEX_SIZE <= RADIOLIB_LORAWAN_SESSION_STORE_MAX_DEVICES
+  #error "RADIOLIB_LORAWAN_SESSION_STORE_INDEX_SIZE must be larger than RADIOLIB_LORAWAN_SESSION_STORE_MAX_DEVICES"
+#endif
+
+#if RADIOLIB_LORAWAN_SESSION_STORE_HOT_SLOTS > 254
+  #error "RADIOLIB_LORAWAN_SESSION_STORE_HOT_SLOTS must be at most 254"
+#endif
+
+// marks an entry that is not held in RAM / an empty slot
+#define RADIOLIB_LORAWAN_SESSION_SLOT_NONE                      (0xFF)
+#define RADIOLIB_LORAWAN_SESSION_ENTRY_NONE                     (0xFFFF)
+
+/*!
+  \class LoRaWANSessionStorage
+  \brief Interface of the cold storage used by LoRaWANSessionStore (e.g. flash or SD card).
+  Every device is stored in a fixed-size record, identified by its index in the store.
+*/
+class LoRaWANSessionStorage {
+  public:
+    virtual ~LoRaWANSessionStorage() {}
+
+    /*!
+      \brief Read the record of a device.
+      \param index Record index, 0 to RADIOLIB_LORAWAN_SESSION_STORE_MAX_DEVICES - 1.
+      \param nonces Buffer of RADIOLIB_LORAWAN_NONCES_BUF_SIZE bytes to read the Nonces into.
+      \param session Buffer of RADIOLIB_LORAWAN_SESSION_BUF_SIZE bytes to read the session into.
+      \returns \ref status_codes
+    */
+    virtual int16_t load(uint16_t index, uint8_t* nonces, uint8_t* session) = 0;
+
+    /*!
+      \brief Write the record of a device.
+      \param index Record index, 0 to RADIOLIB_LORAWAN_SESSION_STORE_MAX_DEVICES - 1.
+      \param nonces Nonces buffer to store, RADIOLIB_LORAWAN_NONCES_BUF_SIZE bytes.
+      \param session Session buffer to store, RADIOLIB_LORAWAN_SESSION_BUF_SIZE bytes.
+      \returns \ref status_codes
+    */
+    virtual int16_t save(uint16_t index, const uint8_t* nonces, const uint8_t* session) = 0;
+};
+
+/*!
+  \struct LoRaWANSessionStoreStats_t
+  \brief Counters of the session store working set.
+*/
+struct LoRaWANSessionStoreStats_t {
+  /*! \brief Number of switches to a session that was held in RAM */
+  uint32_t hits;
+
+  /*! \brief Number of switches to a session that had to be loaded from cold storage */
+  uint32_t misses;
+
+  /*! \brief Number of sessions evicted from RAM */
+  uint32_t evictions;
+
+  /*! \brief Number of sessions written back to cold storage */
+  uint32_t writeBacks;
+};
+
+/*!
+  \class LoRaWANSessionStore
+  \brief Table of LoRaWAN sessions, indexed by DevAddr, that can be swapped in and out of a single LoRaWANNode.
+  This allows one radio to act as a whole fleet of (activated) devices. The most recently used sessions
+  are kept in RAM, the others are kept in an optional LoRaWANSessionStorage.
+*/
+class LoRaWANSessionStore {
+  public:
+    /*!
+      \brief Default constructor.
+      \param node Pointer to the node whose session will be switched.
+      \param storage Pointer to cold storage. If NULL, only RADIOLIB_LORAWAN_SESSION_STORE_HOT_SLOTS devices can be registered.
+    */
+    LoRaWANSessionStore(LoRaWANNode* node, LoRaWANSessionStorage* storage = NULL);
+
+    /*!
+      \brief Register the session that is currently active on the node.
+      Typically called after beginABP/activateABP or activateOTAA for every virtual device.
+      \returns \ref status_codes
+    */
+    int16_t add();
+
+    /*!
+      \brief Register a previously saved session.
+      \param nonces Nonces buffer of the session (previously extracted using getBufferNonces)
+      \param session Session buffer of the session (previously extracted using getBufferSession)
+      \returns \ref status_codes
+    */
+    int16_t add(uint8_t* nonces, uint8_t* session);
+
+    /*!
+      \brief Remove a device from the store. If it is the active one, the node keeps the session
+      but it will no longer be saved.
+      \param devAddr Device address.
+      \returns \ref status_codes
+    */
+    int16_t remove(uint32_t devAddr);
+
+    /*!
+      \brief Make the session of a device the active session of the node. The outgoing session is saved first.
+      \param devAddr Device address.
+      \returns \ref status_codes
+    */
+    int16_t activate(uint32_t devAddr);
+
+    /*!
+      \brief Copy the state of the active session from the node into the store,
+      e.g. after an uplink changed the frame counters.
+    */
+    void sync();
+
+    /*!
+      \brief Write all modified sessions held in RAM to cold storage.
+      \returns \ref status_codes
+    */
+    int16_t flush();
+
+    /*!
+      \brief Check whether a device is registered.
+      \param devAddr Device address.
+      \returns Whether the device is registered.
+    */
+    bool contains(uint32_t devAddr);
+
+    /*!
+      \brief Get the address of the device whose session is active on the node.
+      \returns Device address, 0 if no stored session is active.
+    */
+    uint32_t getActive();
+
+    /*!
+      \brief Get the number of registered devices.
+      \returns Number of devices.
+    */
+    uint16_t getNumDevices();
+
+    /*!
+      \brief Get the working set counters.
+      \returns Counters since construction or the last resetStats call.
+    */
+    LoRaWANSessionStoreStats_t getStats();
+
+    /*!
+      \brief Reset the working set counters.
+    */
+    void resetStats();
+
+#if !RADIOLIB_GODMODE
+  private:
+#endif
+    struct Entry_t {
+      uint32_t devAddr;
+      uint8_t slot;
+      bool used;
+    };
+
+    struct Slot_t {
+      uint8_t nonces[RADIOLIB_LORAWAN_NONCES_BUF_SIZE];
+      uint8_t session[RADIOLIB_LORAWAN_SESSION_BUF_SIZE];
+      uint16_t entry;
+      uint8_t prev;
+      uint8_t next;
+      bool dirty;
+    };
+
+    LoRaWANNode* node;
+    LoRaWANSessionStorage* storage;
+
+    // registered devices, position in this table is also the cold storage record index
+    Entry_t entries[RADIOLIB_LORAWAN_SESSION_STORE_MAX_DEVICES];
+    uint16_t numDevices = 0;
+
+    // open-addressing hash index of DevAddr to entry
+    uint16_t index[RADIOLIB_LORAWAN_SESSION_STORE_INDEX_SIZE];
+
+    // sessions held in RAM, linked from most (head) to least (tail) recently used
+    Slot_t slots[RADIOLIB_LORAWAN_SESSION_STORE_HOT_SLOTS];
+    uint8_t head = RADIOLIB_LORAWAN_SESSION_SLOT_NONE;
+    uint8_t tail = RADIOLIB_LORAWAN_SESSION_SLOT_NONE;
+    uint8_t active = RADIOLIB_LORAWAN_SESSION_SLOT_NONE;
+
+    LoRaWANSessionStoreStats_t stats = { 0, 0, 0, 0 };
+
+    static uint16_t hash(uint32_t devAddr);
+    uint16_t findEntry(uint32_t devAddr);
+    void insertIndex(uint32_t devAddr, uint16_t entry);
+    void removeIndex(uint32_t devAddr);
+
+    // obtain a slot for the entry, evicting the least recently used session if needed
+    int16_t acquireSlot(uint16_t entry, uint8_t* slot);
+    int16_t evict(uint8_t slot);
+    void unlink(uint8_t slot);
+    void pushFront(uint8_t slot);
+};
+
+#endif
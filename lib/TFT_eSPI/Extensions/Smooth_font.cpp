@@ -1,6 +1,9 @@
  // Coded by Bodmer 10/2/18, see license in root directory.
  // This is part of the TFT_eSPI class and is associated with anti-aliased font functions
  
+// Number of hash chains of the glyph bitmap cache
+#define GLYPH_CACHE_BUCKETS 64
+
 
 ////////////////////////////////////////////////////////////////////////////////////////
 // New anti-aliased (smoothed) font functions added below
@@ -188,6 +191,7 @@ void TFT_eSPI::loadMetrics(void)
 #endif
 
   uint16_t gNum = 0;
+  gSorted = true;
 
   while (gNum < gFont.gCount)
   {
@@ -199,6 +203,8 @@ void TFT_eSPI::loadMetrics(void)
     gdX[gNum]       =   (int8_t)readInt32(); // x delta from cursor
     readInt32(); // ignored
 
+    if (gNum && gUnicode[gNum] <= gUnicode[gNum - 1]) gSorted = false;
+
     //Serial.print("Unicode = 0x"); Serial.print(gUnicode[gNum], HEX); Serial.print(", gHeight  = "); Serial.println(gHeight[gNum]);
     //Serial.print("Unicode = 0x"); Serial.print(gUnicode[gNum], HEX); Serial.print(", gWidth  = "); Serial.println(gWidth[gNum]);
     //Serial.print("Unicode = 0x"); Serial.print(gUnicode[gNum], HEX); Serial.print(", gxAdvance  = "); Serial.println(gxAdvance[gNum]);
@@ -245,6 +251,47 @@ void TFT_eSPI::loadMetrics(void)
   gFont.yAdvance = gFont.maxAscent + gFont.maxDescent;
 
   gFont.spaceWidth = (gFont.ascent + gFont.descent) * 2/7;  // Guess at space width
+
+  // Fonts created by Processing are in Unicode order, others need an index for a binary search
+  if (!gSorted) sortUnicodeIndex();
+}
+
+
+/***************************************************************************************
+** Function name:           sortUnicodeIndex
+** Description:             Build a list of the glyph numbers in Unicode order
+*************************************************************************************x*/
+void TFT_eSPI::sortUnicodeIndex(void)
+{
+  uint16_t n = gFont.gCount;
+
+  gIndex = (uint16_t*)malloc(n * 2);
+  if (!gIndex) return; // getUnicodeIndex() falls back to a linear search
+
+  for (uint16_t i = 0; i < n; i++) gIndex[i] = i;
+
+  // Heap sort, the glyph number is part of the key so a duplicated Unicode
+  // finds the first glyph in the file, as the linear search did
+  #define GLYPH_KEY(i) (((uint32_t)gUnicode[gIndex[i]] << 16) | gIndex[i])
+
+  for (int32_t start = n / 2 - 1, end = n - 1; end > 0; )
+  {
+    int32_t root;
+    if (start >= 0) root = start--;        // Build the heap
+    else {                                 // Move the largest to the end
+      transpose(gIndex[0], gIndex[end--]);
+      root = 0;
+    }
+
+    for (int32_t child; (child = 2 * root + 1) <= end; root = child)
+    {
+      if (child < end && GLYPH_KEY(child) < GLYPH_KEY(child + 1)) child++;
+      if (GLYPH_KEY(root) >= GLYPH_KEY(child)) break;
+      transpose(gIndex[root], gIndex[child]);
+    }
+  }
+
+  #undef GLYPH_KEY
 }
 
 
@@ -296,6 +343,14 @@ void TFT_eSPI::unloadFont( void )
     gBitmap = NULL;
   }
 
+  if (gIndex)
+  {
+    free(gIndex);
+    gIndex = NULL;
+  }
+
+  clearGlyphCache();
+
   gFont.gArray = nullptr;
 
 #ifdef FONT_FS_AVAILABLE
@@ -340,16 +395,190 @@ uint32_t TFT_eSPI::readInt32(void)
 *************************************************************************************x*/
 bool TFT_eSPI::getUnicodeIndex(uint16_t unicode, uint16_t *index)
 {
-  for (uint16_t i = 0; i < gFont.gCount; i++)
+  if (!gSorted && !gIndex)
+  {
+    for (uint16_t i = 0; i < gFont.gCount; i++)
+    {
+      if (gUnicode[i] == unicode)
+      {
+        *index = i;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Binary search for the first entry not below unicode
+  uint16_t lo = 0;
+  uint16_t hi = gFont.gCount;
+  while (lo < hi)
+  {
+    uint16_t mid = (lo + hi) >> 1;
+    if (gUnicode[gIndex ? gIndex[mid] : mid] < unicode) lo = mid + 1;
+    else hi = mid;
+  }
+
+  if (lo == gFont.gCount) return false;
+
+  uint16_t i = gIndex ? gIndex[lo] : lo;
+  if (gUnicode[i] != unicode) return false;
+
+  *index = i;
+  return true;
+}
+
+
+/***************************************************************************************
+** Function name:           setGlyphCacheSize
+** Description:             Set the RAM budget of the glyph bitmap cache, 0 to disable
+*************************************************************************************x*/
+void TFT_eSPI::setGlyphCacheSize(uint32_t bytes)
+{
+  clearGlyphCache();
+  gCacheBudget = bytes;
+
+  if (bytes == 0)
+  {
+    if (gCacheBucket) free(gCacheBucket);
+    gCacheBucket = nullptr;
+  }
+  else if (!gCacheBucket)
+  {
+    gCacheBucket = (glyphCacheEntry**)calloc(GLYPH_CACHE_BUCKETS, sizeof(glyphCacheEntry*));
+    if (!gCacheBucket) gCacheBudget = 0;
+  }
+
+  gCacheHits = 0;
+  gCacheMisses = 0;
+}
+
+
+/***************************************************************************************
+** Function name:           getGlyphCacheStats
+** Description:             Get the glyph cache hit and miss counts and bytes in use
+*************************************************************************************x*/
+void TFT_eSPI::getGlyphCacheStats(uint32_t *hits, uint32_t *misses, uint32_t *used)
+{
+  if (hits)   *hits   = gCacheHits;
+  if (misses) *misses = gCacheMisses;
+  if (used)   *used   = gCacheUsed;
+}
+
+
+/***************************************************************************************
+** Function name:           clearGlyphCache
+** Description:             Discard all cached glyph bitmaps
+*************************************************************************************x*/
+void TFT_eSPI::clearGlyphCache(void)
+{
+  while (gCacheNewest)
+  {
+    glyphCacheEntry* e = gCacheNewest;
+    gCacheNewest = e->older;
+    free(e);
+  }
+  gCacheOldest = nullptr;
+  gCacheUsed = 0;
+
+  if (gCacheBucket) memset(gCacheBucket, 0, GLYPH_CACHE_BUCKETS * sizeof(glyphCacheEntry*));
+}
+
+
+#ifdef FONT_FS_AVAILABLE
+/***************************************************************************************
+** Function name:           readGlyphBitmap
+** Description:             Get a glyph bitmap from the cache or the font file
+*************************************************************************************x*/
+uint8_t* TFT_eSPI::readGlyphBitmap(uint16_t gNum, bool *cached)
+{
+  uint32_t size = gWidth[gNum] * gHeight[gNum];
+  glyphCacheEntry** bucket = nullptr;
+
+  *cached = false;
+
+  if (gCacheBucket)
+  {
+    bucket = &gCacheBucket[gNum % GLYPH_CACHE_BUCKETS];
+
+    for (glyphCacheEntry* e = *bucket; e; e = e->chain)
+    {
+      if (e->gNum != gNum) continue;
+
+      // Move to the front of the used list
+      if (e != gCacheNewest)
+      {
+        e->newer->older = e->older;
+        if (e->older) e->older->newer = e->newer;
+        else gCacheOldest = e->newer;
+        e->newer = nullptr;
+        e->older = gCacheNewest;
+        gCacheNewest->newer = e;
+        gCacheNewest = e;
+      }
+
+      gCacheHits++;
+      *cached = true;
+      return (uint8_t*)(e + 1);
+    }
+
+    gCacheMisses++;
+  }
+
+  uint32_t need = sizeof(glyphCacheEntry) + size;
+  glyphCacheEntry* e = nullptr;
+
+  if (bucket && need <= gCacheBudget)
   {
-    if (gUnicode[i] == unicode)
+    // Discard the least recently used glyphs until the new one fits
+    while (gCacheOldest && gCacheUsed + need > gCacheBudget)
     {
-      *index = i;
-      return true;
+      glyphCacheEntry* old = gCacheOldest;
+      glyphCacheEntry** link = &gCacheBucket[old->gNum % GLYPH_CACHE_BUCKETS];
+      while (*link != old) link = &(*link)->chain;
+      *link = old->chain;
+
+      gCacheOldest = old->newer;
+      if (gCacheOldest) gCacheOldest->older = nullptr;
+      else gCacheNewest = nullptr;
+
+      gCacheUsed -= sizeof(glyphCacheEntry) + old->size;
+      free(old);
     }
+
+#if defined (ESP32) && defined (CONFIG_SPIRAM_SUPPORT)
+    if ( psramFound() ) e = (glyphCacheEntry*)ps_malloc(need);
+    else
+#endif
+    e = (glyphCacheEntry*)malloc(need);
+  }
+
+  uint8_t* bitmap = e ? (uint8_t*)(e + 1) : (uint8_t*)malloc(size);
+  if (!bitmap) return nullptr;
+
+  // One read for the whole bitmap, the TFT must not hold the bus for SD card access
+  fontFile.seek(gBitmap[gNum], fs::SeekSet);
+  fontFile.read(bitmap, size);
+
+  if (e)
+  {
+    e->gNum  = gNum;
+    e->size  = size;
+    e->chain = *bucket;
+    *bucket  = e;
+
+    e->newer = nullptr;
+    e->older = gCacheNewest;
+    if (gCacheNewest) gCacheNewest->newer = e;
+    else gCacheOldest = e;
+    gCacheNewest = e;
+
+    gCacheUsed += need;
+    *cached = true;
   }
-  return false;
+
+  return bitmap;
 }
+#endif
 
 
 /***************************************************************************************
@@ -406,12 +635,15 @@ void TFT_eSPI::drawGlyph(uint16_t code)
 
     uint8_t* pbuffer = nullptr;
     const uint8_t* gPtr = (const uint8_t*) gFont.gArray;
+    int32_t gh = gHeight[gNum];
 
 #ifdef FONT_FS_AVAILABLE
+    bool cached = false;
     if (fs_font)
     {
-      fontFile.seek(gBitmap[gNum], fs::SeekSet);
-      pbuffer =  (uint8_t*)malloc(gWidth[gNum]);
+      // Read before startWrite() so an SD card can use the SPI bus
+      pbuffer = readGlyphBitmap(gNum, &cached);
+      if (!pbuffer) gh = 0;
     }
 #endif
 
@@ -458,29 +690,12 @@ void TFT_eSPI::drawGlyph(uint16_t code)
       }
     }
 
-    for (int32_t y = 0; y < gHeight[gNum]; y++)
+    for (int32_t y = 0; y < gh; y++)
     {
-#ifdef FONT_FS_AVAILABLE
-      if (fs_font) {
-        if (spiffs)
-        {
-          fontFile.read(pbuffer, gWidth[gNum]);
-          //Serial.println("SPIFFS");
-        }
-        else
-        {
-          endWrite();    // Release SPI for SD card transaction
-          fontFile.read(pbuffer, gWidth[gNum]);
-          startWrite();  // Re-start SPI for TFT transaction
-          //Serial.println("Not SPIFFS");
-        }
-      }
-#endif
-
       for (int32_t x = 0; x < gWidth[gNum]; x++)
       {
 #ifdef FONT_FS_AVAILABLE
-        if (fs_font) pixel = pbuffer[x];
+        if (fs_font) pixel = pbuffer[x + gWidth[gNum] * y];
         else
 #endif
         pixel = pgm_read_byte(gPtr + gBitmap[gNum] + x + gWidth[gNum] * y);
@@ -527,7 +742,9 @@ void TFT_eSPI::drawGlyph(uint16_t code)
       }
     }
 
-    if (pbuffer) free(pbuffer);
+#ifdef FONT_FS_AVAILABLE
+    if (pbuffer && !cached) free(pbuffer);
+#endif
     cursor_x += gxAdvance[gNum];
     endWrite();
   }
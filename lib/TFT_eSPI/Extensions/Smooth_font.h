@@ -12,6 +12,11 @@
   void     unloadFont( void );
   bool     getUnicodeIndex(uint16_t unicode, uint16_t *index);
 
+           // RAM budget in bytes for glyph bitmaps read from a font file, 0 (default) disables the cache.
+           // The least recently drawn glyphs are discarded when the budget is exceeded.
+  void     setGlyphCacheSize(uint32_t bytes);
+  void     getGlyphCacheStats(uint32_t *hits, uint32_t *misses, uint32_t *used);
+
   virtual void drawGlyph(uint16_t code);
 
   void     showFont(uint32_t td);
@@ -39,6 +44,8 @@ fontMetrics gFont = { nullptr, 0, 0, 0, 0, 0, 0, 0 };
   int16_t*  gdY = NULL;       //topExtent
   int8_t*   gdX = NULL;       //leftExtent
   uint32_t* gBitmap = NULL;   //file pointer to greyscale bitmap
+  uint16_t* gIndex = NULL;    //glyph numbers in Unicode order, NULL if the font file is already in order
+  bool      gSorted = false;  //gUnicode can be searched directly
 
   bool     fontLoaded = false; // Flags when a anti-aliased font is loaded
 
@@ -52,6 +59,12 @@ fontMetrics gFont = { nullptr, 0, 0, 0, 0, 0, 0, 0 };
   bool     fontFile = true;
 #endif
 
+#ifdef FONT_FS_AVAILABLE
+           // Get the bitmap of a glyph from the font file, from the cache if possible.
+           // If *cached is false the bitmap is not held by the cache and the caller must free it.
+  uint8_t* readGlyphBitmap(uint16_t gNum, bool *cached);
+#endif
+
   private:
 
   void     loadMetrics(void);
@@ -59,3 +72,23 @@ fontMetrics gFont = { nullptr, 0, 0, 0, 0, 0, 0, 0 };
 
   uint8_t* fontPtr = nullptr;
 
+  void     sortUnicodeIndex(void);
+  void     clearGlyphCache(void);
+
+  // Glyph bitmap cache, entries are in a most recently used list and chained in hash buckets
+  typedef struct glyphCacheEntry {
+    struct glyphCacheEntry* newer;
+    struct glyphCacheEntry* older;
+    struct glyphCacheEntry* chain;
+    uint16_t gNum;
+    uint16_t size;             // Bitmap bytes, the bitmap follows the entry
+  } glyphCacheEntry;
+
+  glyphCacheEntry** gCacheBucket = nullptr;  // GLYPH_CACHE_BUCKETS chains, allocated when the cache is enabled
+  glyphCacheEntry*  gCacheNewest = nullptr;
+  glyphCacheEntry*  gCacheOldest = nullptr;
+  uint32_t gCacheBudget = 0;
+  uint32_t gCacheUsed   = 0;
+  uint32_t gCacheHits   = 0;
+  uint32_t gCacheMisses = 0;
+
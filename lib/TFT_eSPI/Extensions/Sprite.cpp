@@ -36,6 +36,13 @@ TFT_eSprite::TFT_eSprite(TFT_eSPI *tft)
 
   _colorMap = nullptr;
 
+  _dirtyTrack  = false;
+  _dirtyWindow = false;
+  _dirtyCount  = 0;
+
+  _dmaFrame = 1;
+  resetDMAStats();
+
   _psram_enable = true;
   
   // Ensure end_tft_write() does nothing in inherited functions.
@@ -75,7 +82,8 @@ void* TFT_eSprite::createSprite(int16_t w, int16_t h, uint8_t frames)
   _img4   = _img8;
 
   if ( (_bpp == 16) && (frames > 1) ) {
-    _img8_2 = _img8 + (w * h * 2 + 1);
+    // Keep the second frame 4 byte aligned, DMA engines need word aligned buffers
+    _img8_2 = _img8 + (((w * h + 2) & ~1) << 1);
   }
 
   // ESP32 only 16bpp check
@@ -104,6 +112,8 @@ void* TFT_eSprite::createSprite(int16_t w, int16_t h, uint8_t frames)
     rotation = 0;
     setViewport(0, 0, _dwidth, _dheight);
     setPivot(_iwidth/2, _iheight/2);
+    _dirtyCount = 0;
+    markDirty(0, 0, _dwidth, _dheight);
     return _img8_1;
   }
 
@@ -165,13 +175,13 @@ void* TFT_eSprite::callocSprite(int16_t w, int16_t h, uint8_t frames)
 #if defined (ESP32) && defined (CONFIG_SPIRAM_SUPPORT)
     if ( psramFound() && _psram_enable && !_tft->DMA_Enabled)
     {
-      ptr8 = ( uint8_t*) ps_calloc(frames * w * h + frames, sizeof(uint16_t));
+      ptr8 = ( uint8_t*) ps_calloc(frames * w * h + frames + 1, sizeof(uint16_t));
       //Serial.println("PSRAM");
     }
     else
 #endif
     {
-      ptr8 = ( uint8_t*) calloc(frames * w * h + frames, sizeof(uint16_t));
+      ptr8 = ( uint8_t*) calloc(frames * w * h + frames + 1, sizeof(uint16_t)); // + 1 to align frame 2
       //Serial.println("Normal RAM");
     }
   }
@@ -891,6 +901,264 @@ bool TFT_eSprite::pushSprite(int32_t tx, int32_t ty, int32_t sx, int32_t sy, int
 }
 
 
+/***************************************************************************************
+** Function name:           setDirtyTracking
+** Description:             Enable or disable the recording of changed areas
+***************************************************************************************/
+void TFT_eSprite::setDirtyTracking(bool enable)
+{
+  _dirtyTrack = enable;
+  _dirtyWindow = false;
+  _dirtyCount = 0;
+  // Nothing is known about the TFT contents yet
+  if (_created) markDirty(0, 0, _dwidth, _dheight);
+}
+
+
+/***************************************************************************************
+** Function name:           getDirtyTracking
+** Description:             Return true if changed areas are recorded
+***************************************************************************************/
+bool TFT_eSprite::getDirtyTracking(void)
+{
+  return _dirtyTrack;
+}
+
+
+/***************************************************************************************
+** Function name:           markDirty
+** Description:             Record an area as changed, x, y are sprite memory coordinates
+***************************************************************************************/
+void TFT_eSprite::markDirty(int32_t x, int32_t y, int32_t w, int32_t h)
+{
+  if (!_dirtyTrack) return;
+
+  // Clip to the sprite
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if ((x + w) > _dwidth)  w = _dwidth  - x;
+  if ((y + h) > _dheight) h = _dheight - y;
+  if ((w < 1) || (h < 1)) return;
+
+  int32_t x1 = x + w - 1, y1 = y + h - 1;
+
+  // Most drawing lands in an area already recorded, the newest is checked first
+  for (int32_t i = _dirtyCount - 1; i >= 0; i--)
+  {
+    dirty_rect_t *r = &_dirty[i];
+    if ((x >= r->x0) && (x1 <= r->x1) && (y >= r->y0) && (y1 <= r->y1)) return;
+  }
+
+  // Add the area in the spare slot, then merge while that is cheap or the list is over
+  // full. Below the limit only the newest area can have changed, so only pairs with it
+  // are checked.
+  dirty_rect_t *r = &_dirty[_dirtyCount++];
+  r->x0 = x; r->y0 = y; r->x1 = x1; r->y1 = y1;
+
+  while (_dirtyCount > 1)
+  {
+    bool full = _dirtyCount > SPRITE_DIRTY_RECTS;
+    int32_t bi = 0, bj = 0;
+    int32_t bestGrowth = INT32_MAX;
+
+    for (int32_t j = full ? 1 : _dirtyCount - 1; j < _dirtyCount; j++)
+    {
+      dirty_rect_t *b = &_dirty[j];
+      for (int32_t i = 0; i < j; i++)
+      {
+        dirty_rect_t *a = &_dirty[i];
+        // Pixels pushed in vain if a and b are merged
+        int32_t growth = (max(a->x1, b->x1) - min(a->x0, b->x0) + 1) * (max(a->y1, b->y1) - min(a->y0, b->y0) + 1)
+                       - (a->x1 - a->x0 + 1) * (a->y1 - a->y0 + 1) - (b->x1 - b->x0 + 1) * (b->y1 - b->y0 + 1);
+        if (growth < bestGrowth) { bestGrowth = growth; bi = i; bj = j; }
+      }
+    }
+
+    if (!full && (bestGrowth > SPRITE_DIRTY_MERGE_SLACK)) break;
+
+    // Merge bj into bi and move the result to the end, it is the one that may now reach others
+    dirty_rect_t m = _dirty[bi];
+    dirty_rect_t *b = &_dirty[bj];
+    m.x0 = min(m.x0, b->x0); m.y0 = min(m.y0, b->y0);
+    m.x1 = max(m.x1, b->x1); m.y1 = max(m.y1, b->y1);
+    _dirty[bj] = _dirty[--_dirtyCount];
+    if (bi != _dirtyCount) _dirty[bi] = _dirty[_dirtyCount - 1];
+    _dirty[_dirtyCount - 1] = m;
+  }
+}
+
+
+/***************************************************************************************
+** Function name:           clearDirty
+** Description:             Forget all recorded areas
+***************************************************************************************/
+void TFT_eSprite::clearDirty(void)
+{
+  _dirtyCount = 0;
+  _dirtyWindow = false;
+}
+
+
+/***************************************************************************************
+** Function name:           getDirtyCount
+** Description:             Return the number of recorded areas
+***************************************************************************************/
+uint8_t TFT_eSprite::getDirtyCount(void)
+{
+  return _dirtyCount;
+}
+
+
+/***************************************************************************************
+** Function name:           getDirtyRect
+** Description:             Get the bounds of recorded area n
+***************************************************************************************/
+bool TFT_eSprite::getDirtyRect(uint8_t n, int32_t *x, int32_t *y, int32_t *w, int32_t *h)
+{
+  if (n >= _dirtyCount) return false;
+
+  *x = _dirty[n].x0;
+  *y = _dirty[n].y0;
+  *w = _dirty[n].x1 - _dirty[n].x0 + 1;
+  *h = _dirty[n].y1 - _dirty[n].y0 + 1;
+  return true;
+}
+
+
+/***************************************************************************************
+** Function name:           pushDirty
+** Description:             Push the changed areas of the sprite to the TFT at x, y
+***************************************************************************************/
+uint32_t TFT_eSprite::pushDirty(int32_t x, int32_t y)
+{
+  if (!_created) return 0;
+
+  // Rotated 1bpp sprites are stored rotated, send them whole
+  if (!_dirtyTrack || (_bpp == 1 && rotation))
+  {
+    pushSprite(x, y);
+    clearDirty();
+    return _dwidth * _dheight;
+  }
+
+  uint32_t pixels = 0;
+  bool oldSwapBytes = _tft->getSwapBytes();
+  _tft->setSwapBytes(false);
+  _tft->startWrite();
+
+  for (uint8_t i = 0; i < _dirtyCount; i++)
+  {
+    dirty_rect_t *r = &_dirty[i];
+    int32_t w = r->x1 - r->x0 + 1;
+    int32_t h = r->y1 - r->y0 + 1;
+
+    if (_bpp == 16)
+    { // One window per area, the rows are pushed straight from the sprite memory
+      _tft->pushSubImage(x + r->x0, y + r->y0, w, h, _img + r->x0 + r->y0 * _iwidth, _iwidth);
+    }
+    else if (_bpp == 1)
+    { // Bits are packed, send whole lines
+      w = _dwidth;
+      pushSprite(x, y + r->y0, 0, r->y0, w, h);
+    }
+    else pushSprite(x + r->x0, y + r->y0, r->x0, r->y0, w, h);
+
+    pixels += w * h;
+  }
+
+  _tft->endWrite();
+  _tft->setSwapBytes(oldSwapBytes);
+
+  clearDirty();
+  return pixels;
+}
+
+
+/***************************************************************************************
+** Function name:           pushFrameDMA
+** Description:             Render a screen area in bands, drawing one while DMA sends another
+***************************************************************************************/
+bool TFT_eSprite::pushFrameDMA(int32_t x, int32_t y, int32_t w, int32_t h, sprite_render_t render, void *arg)
+{
+  if (!_created || _bpp != 16 || render == nullptr || w != _dwidth) return false;
+
+  bool oldSwapBytes = _tft->getSwapBytes();
+  _tft->setSwapBytes(false); // Sprite memory is already byte swapped
+
+  // The bands move the origin, the caller's one is put back at the end
+  int32_t oldX = getOriginX();
+  int32_t oldY = getOriginY();
+
+  bool twoFrames = (_img8_2 != _img8_1);
+
+  for (int32_t by = 0; by < h; by += _dheight)
+  {
+    int32_t bh = min(_dheight, h - by);
+
+#if defined (ESP32_DMA) || defined (RP2040_DMA) || defined (STM32_DMA)
+    // With a single frame the band cannot be drawn until the last one has been sent
+    if (_tft->DMA_Enabled && !twoFrames)
+    {
+      uint32_t tw = micros();
+      _tft->dmaWait();
+      _dmaStats.wait_us += micros() - tw;
+    }
+#endif
+
+    // The other frame may still be on its way to the TFT, this one was sent before that started
+    frameBuffer(_dmaFrame);
+    setOrigin(-x, -(y + by));
+    uint32_t t0 = micros();
+    render(this, y + by, bh, arg);
+    uint32_t t1 = micros();
+
+#if defined (ESP32_DMA) || defined (RP2040_DMA) || defined (STM32_DMA)
+    if (_tft->DMA_Enabled)
+    {
+      _tft->dmaWait();
+      _dmaStats.wait_us += micros() - t1;
+      _tft->pushImageDMA(x, y + by, w, bh, _img);
+      if (twoFrames) _dmaFrame = (_dmaFrame == 1) ? 2 : 1;
+    }
+    else
+#endif
+    {
+      _tft->pushImage(x, y + by, w, bh, _img);
+    }
+
+    _dmaStats.render_us += t1 - t0;
+    _dmaStats.bands++;
+  }
+
+  setOrigin(oldX, oldY);
+  _tft->setSwapBytes(oldSwapBytes);
+  _dmaStats.frames++;
+  return true;
+}
+
+
+/***************************************************************************************
+** Function name:           getDMAStats
+** Description:             Get the pushFrameDMA() counters
+***************************************************************************************/
+void TFT_eSprite::getDMAStats(sprite_dma_stats_t *stats)
+{
+  *stats = _dmaStats;
+  stats->elapsed_us = micros() - _dmaStatsStart;
+}
+
+
+/***************************************************************************************
+** Function name:           resetDMAStats
+** Description:             Clear the pushFrameDMA() counters
+***************************************************************************************/
+void TFT_eSprite::resetDMAStats(void)
+{
+  memset(&_dmaStats, 0, sizeof(_dmaStats));
+  _dmaStatsStart = micros();
+}
+
+
 /***************************************************************************************
 ** Function name:           readPixelValue
 ** Description:             Read the color map index of a pixel at defined coordinates
@@ -1034,6 +1302,8 @@ void  TFT_eSprite::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_
 
   PI_CLIP;
 
+  if (_dirtyTrack) markDirty(x, y, dw, dh);
+
   if (_bpp == 16) // Plot a 16 bpp image into a 16 bpp Sprite
   {
     // Pointer within original image
@@ -1177,6 +1447,8 @@ void  TFT_eSprite::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const u
 
   PI_CLIP;
 
+  if (_dirtyTrack) markDirty(x, y, dw, dh);
+
   if (_bpp == 16) // Plot a 16 bpp image into a 16 bpp Sprite
   {
     for (int32_t yp = dy; yp < dy + dh; yp++)
@@ -1280,6 +1552,8 @@ void TFT_eSprite::setWindow(int32_t x0, int32_t y0, int32_t x1, int32_t y1)
 
   _xptr = _xs;
   _yptr = _ys;
+
+  _dirtyWindow = false;
 }
 
 
@@ -1291,6 +1565,11 @@ void TFT_eSprite::pushColor(uint16_t color)
 {
   if (!_created ) return;
 
+  if (_dirtyTrack && !_dirtyWindow) {
+    markDirty(_xs, _ys, _xe - _xs + 1, _ye - _ys + 1);
+    _dirtyWindow = true;
+  }
+
   // Write the colour to RAM in set window
   if (_bpp == 16)
     _img [_xptr + _yptr * _iwidth] = (uint16_t) (color >> 8) | (color << 8);
@@ -1355,6 +1634,11 @@ void TFT_eSprite::writeColor(uint16_t color)
 {
   if (!_created ) return;
 
+  if (_dirtyTrack && !_dirtyWindow) {
+    markDirty(_xs, _ys, _xe - _xs + 1, _ye - _ys + 1);
+    _dirtyWindow = true;
+  }
+
   // Write 16 bit RGB 565 encoded colour to RAM
   if (_bpp == 16) _img [_xptr + _yptr * _iwidth] = color;
 
@@ -1423,6 +1707,8 @@ void TFT_eSprite::scroll(int16_t dx, int16_t dy)
     return;
   }
 
+  if (_dirtyTrack) markDirty(_sx, _sy, _sw, _sh);
+
   // Fetch the scroll area width and height set by setScrollRect()
   uint32_t w  = _sw - abs(dx); // line width to copy
   uint32_t h  = _sh - abs(dy); // lines to copy
@@ -1520,6 +1806,7 @@ void TFT_eSprite::fillSprite(uint32_t color)
   // Use memset if possible as it is super fast
   if(_xDatum == 0 && _yDatum == 0  &&  _xWidth == width())
   {
+    if (_dirtyTrack) markDirty(0, 0, _dwidth, _yHeight);
     if(_bpp == 16) {
       if ( (uint8_t)color == (uint8_t)(color>>8) ) {
         memset(_img,  (uint8_t)color, _iwidth * _yHeight * 2);
@@ -1637,6 +1924,8 @@ void TFT_eSprite::drawPixel(int32_t x, int32_t y, uint32_t color)
   // Range checking
   if ((x < _vpX) || (y < _vpY) ||(x >= _vpW) || (y >= _vpH)) return;
 
+  if (_dirtyTrack) markDirty(x, y, 1, 1);
+
   if (_bpp == 16)
   {
     color = (color >> 8) | (color << 8);
@@ -1761,6 +2050,8 @@ void TFT_eSprite::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color)
 
   if (h < 1) return;
 
+  if (_dirtyTrack) markDirty(x, y, 1, h);
+
   if (_bpp == 16)
   {
     color = (color >> 8) | (color << 8);
@@ -1822,6 +2113,8 @@ void TFT_eSprite::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color)
 
   if (w < 1) return;
 
+  if (_dirtyTrack) markDirty(x, y, w, 1);
+
   if (_bpp == 16)
   {
     color = (color >> 8) | (color << 8);
@@ -1887,6 +2180,8 @@ void TFT_eSprite::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t
 
   if ((w < 1) || (h < 1)) return;
 
+  if (_dirtyTrack) markDirty(x, y, w, h);
+
   int32_t yp = _iwidth * y + x;
 
   if (_bpp == 16)
@@ -2474,11 +2769,13 @@ void TFT_eSprite::drawGlyph(uint16_t code)
 
     uint8_t* pbuffer = nullptr;
     const uint8_t* gPtr = (const uint8_t*) gFont.gArray;
+    int32_t gh = gHeight[gNum];
 
 #ifdef FONT_FS_AVAILABLE
+    bool cached = false;
     if (fs_font) {
-      fontFile.seek(gBitmap[gNum], fs::SeekSet); // This is slow for a significant position shift!
-      pbuffer =  (uint8_t*)malloc(gWidth[gNum]);
+      pbuffer = readGlyphBitmap(gNum, &cached);
+      if (!pbuffer) gh = 0;
     }
 #endif
 
@@ -2522,18 +2819,12 @@ void TFT_eSprite::drawGlyph(uint16_t code)
       }
     }
 
-    for (int32_t y = 0; y < gHeight[gNum]; y++)
+    for (int32_t y = 0; y < gh; y++)
     {
-#ifdef FONT_FS_AVAILABLE
-      if (fs_font) {
-        fontFile.read(pbuffer, gWidth[gNum]);
-      }
-#endif
-
       for (int32_t x = 0; x < gWidth[gNum]; x++)
       {
 #ifdef FONT_FS_AVAILABLE
-        if (fs_font) pixel = pbuffer[x];
+        if (fs_font) pixel = pbuffer[x + gWidth[gNum] * y];
         else
 #endif
         pixel = pgm_read_byte(gPtr + gBitmap[gNum] + x + gWidth[gNum] * y);
@@ -2580,7 +2871,9 @@ void TFT_eSprite::drawGlyph(uint16_t code)
       }
     }
 
-    if (pbuffer) free(pbuffer);
+#ifdef FONT_FS_AVAILABLE
+    if (pbuffer && !cached) free(pbuffer);
+#endif
     cursor_x += gxAdvance[gNum];
 
     if (newSprite)
@@ -5,6 +5,36 @@
 // graphics are written to the Sprite rather than the TFT.
 ***************************************************************************************/
 
+// Maximum number of separate areas kept by the dirty rectangle tracking,
+// further areas are merged into the ones that grow least
+#ifndef SPRITE_DIRTY_RECTS
+  #define SPRITE_DIRTY_RECTS 8
+#endif
+
+// Two areas are merged when their bounding box adds no more than this many
+// pixels, pushing a few extra pixels is cheaper than another setWindow()
+#ifndef SPRITE_DIRTY_MERGE_SLACK
+  #define SPRITE_DIRTY_MERGE_SLACK 64
+#endif
+
+typedef struct {
+  int16_t x0, y0, x1, y1; // Inclusive corners
+} dirty_rect_t;
+
+class TFT_eSprite;
+
+// Draws one band of a frame for pushFrameDMA(), the band covers screen lines y to y + h - 1
+typedef void (*sprite_render_t)(TFT_eSprite *spr, int32_t y, int32_t h, void *arg);
+
+// Counters of pushFrameDMA(), since the last resetDMAStats()
+typedef struct {
+  uint32_t frames;     // Frames pushed
+  uint32_t bands;      // Bands rendered and transferred
+  uint32_t render_us;  // Time spent in the render function
+  uint32_t wait_us;    // Time spent waiting for a transfer to finish, the CPU was idle
+  uint32_t elapsed_us; // Time since the reset
+} sprite_dma_stats_t;
+
 class TFT_eSprite : public TFT_eSPI {
 
  public:
@@ -126,6 +156,32 @@ class TFT_eSprite : public TFT_eSPI {
            // Push a windowed area of the sprite to the TFT at tx, ty
   bool     pushSprite(int32_t tx, int32_t ty, int32_t sx, int32_t sy, int32_t sw, int32_t sh);
 
+           // Dirty rectangle tracking, the drawing functions record the areas they change so
+           // that pushDirty() only sends those to the TFT. Enabling marks the whole sprite dirty.
+  void     setDirtyTracking(bool enable);
+  bool     getDirtyTracking(void);
+           // Record an area as changed, e.g. after writing to the getPointer() buffer directly
+  void     markDirty(int32_t x, int32_t y, int32_t w, int32_t h);
+           // Forget all recorded areas
+  void     clearDirty(void);
+           // Number of recorded areas and the bounds of area n, false if n is out of range
+  uint8_t  getDirtyCount(void);
+  bool     getDirtyRect(uint8_t n, int32_t *x, int32_t *y, int32_t *w, int32_t *h);
+           // Push the changed areas to the TFT with the sprite at x, y and clear them.
+           // Returns the number of pixels sent, the whole sprite is sent if tracking is off.
+  uint32_t pushDirty(int32_t x, int32_t y);
+
+           // Render and push a w x h area of the TFT at x, y in bands of the sprite height, the
+           // sprite must be created 16 bpp, w wide and with 2 frames, after tft.initDMA().
+           // render() is called once per band with the origin set so it can draw in screen
+           // coordinates, the previous origin is restored on return. While a band is drawn in
+           // one frame the previous one is sent from the other by DMA. Call tft.startWrite()
+           // once before the first frame, the last band is still being sent when the function
+           // returns. Without DMA support bands are pushed with pushImage().
+  bool     pushFrameDMA(int32_t x, int32_t y, int32_t w, int32_t h, sprite_render_t render, void *arg = nullptr);
+  void     getDMAStats(sprite_dma_stats_t *stats);
+  void     resetDMAStats(void);
+
            // Push the sprite to another sprite at x,y. This fn calls pushImage() in the destination sprite (dspr) class.
   bool     pushToSprite(TFT_eSprite *dspr, int32_t x, int32_t y);
   bool     pushToSprite(TFT_eSprite *dspr, int32_t x, int32_t y, uint16_t transparent);
@@ -185,4 +241,13 @@ class TFT_eSprite : public TFT_eSPI {
   int32_t  _dwidth, _dheight; // Real sprite width and height (for <8bpp Sprites)
   int32_t  _bitwidth;         // Sprite image bit width for drawPixel (for <8bpp Sprites, not swapped)
 
+  bool     _dirtyTrack;       // Record the areas changed by drawing functions
+  bool     _dirtyWindow;      // The setWindow() area has been recorded
+  uint8_t  _dirtyCount;       // Number of recorded areas
+  dirty_rect_t _dirty[SPRITE_DIRTY_RECTS + 1]; // One spare entry used while merging
+
+  uint8_t  _dmaFrame;         // Frame the next band of pushFrameDMA() is drawn in
+  sprite_dma_stats_t _dmaStats;
+  uint32_t _dmaStatsStart;    // micros() at the last resetDMAStats()
+
 };
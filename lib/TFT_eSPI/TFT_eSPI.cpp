@@ -1471,6 +1471,35 @@ void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *d
   end_tft_write();
 }
 
+/***************************************************************************************
+** Function name:           pushSubImage
+** Description:             plot an area of a larger 16 bit image, rows are stride pixels apart
+***************************************************************************************/
+void TFT_eSPI::pushSubImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data, int32_t stride)
+{
+  PI_CLIP;
+
+  begin_tft_write();
+  inTransaction = true;
+
+  setWindow(x, y, x + dw - 1, y + dh - 1);
+
+  data += dx + dy * stride;
+
+  // Rows are contiguous if the area spans the full image width
+  if (dw == stride) pushPixels(data, dw * dh);
+  else {
+    while (dh--)
+    {
+      pushPixels(data, dw);
+      data += stride;
+    }
+  }
+
+  inTransaction = lockTransaction;
+  end_tft_write();
+}
+
 /***************************************************************************************
 ** Function name:           pushImage
 ** Description:             plot 16 bit sprite or image with 1 colour being transparent
@@ -5022,6 +5051,83 @@ uint32_t TFT_eSPI::alphaBlend24(uint8_t alpha, uint32_t fgc, uint32_t bgc, uint8
   return (rxx & 0xFF0000) | (xgx & 0x00FF00) | (xxb & 0x0000FF);
 }
 
+/***************************************************************************************
+** Function name:           alphaBlendSpan
+** Description:             Blend a run of pixels between two colours, alpha per pixel
+*************************************************************************************x*/
+void TFT_eSPI::alphaBlendSpan(uint16_t* out, const uint8_t* alpha, uint32_t len, uint16_t fgc, uint16_t bgc)
+{
+  // Channel differences and background terms, the same for every pixel
+  int32_t  dR = (int32_t)(fgc >> 11) - (bgc >> 11);
+  int32_t  dG = (int32_t)((fgc >> 5) & 0x3F) - ((bgc >> 5) & 0x3F);
+  int32_t  dB = (int32_t)(fgc & 0x1F) - (bgc & 0x1F);
+  uint32_t cR = (uint32_t)(bgc >> 11) << 6;
+  uint32_t cG = (uint32_t)((bgc >> 5) & 0x3F) << 8;
+  uint32_t cB = (uint32_t)(bgc & 0x1F) << 6;
+
+  // Align the output for 32 bit writes
+  if (len && ((uintptr_t)out & 2)) {
+    *out++ = alphaBlend(pgm_read_byte(alpha++), fgc, bgc);
+    len--;
+  }
+
+  // Two pixels per 32 bit word, one 16 bit lane each. A lane holds
+  // a * fg + (scale - a) * bg for a channel, at most 63 * 256, so
+  // one multiply blends a channel of both pixels without the lanes
+  // interfering. Red and blue use alpha >> 2 and scale 64, green
+  // the full alpha and scale 256, exactly as alphaBlend() does.
+  uint32_t* out32 = (uint32_t*)out;
+  cR |= cR << 16;
+  cG |= cG << 16;
+  cB |= cB << 16;
+
+  while (len >= 2) {
+    uint32_t a0 = pgm_read_byte(alpha++);
+    uint32_t a1 = pgm_read_byte(alpha++);
+    uint32_t a8 = a0 | (a1 << 16);
+    uint32_t a6 = (a8 >> 2) & 0x003F003F;
+
+    uint32_t r = a6 * (uint32_t)dR + cR;
+    uint32_t g = a8 * (uint32_t)dG + cG;
+    uint32_t b = a6 * (uint32_t)dB + cB;
+
+    *out32++ = ((r << 5) & 0xF800F800) | ((g >> 3) & 0x07E007E0) | ((b >> 6) & 0x001F001F);
+    len -= 2;
+  }
+
+  if (len) *(uint16_t*)out32 = alphaBlend(pgm_read_byte(alpha), fgc, bgc);
+}
+
+
+/***************************************************************************************
+** Function name:           alphaBlendBuffer
+** Description:             Blend a colour into a run of pixels, alpha per pixel
+*************************************************************************************x*/
+void TFT_eSPI::alphaBlendBuffer(uint16_t* buf, const uint8_t* alpha, uint32_t len, uint16_t fgc, bool swapped)
+{
+  uint32_t fgRB = fgc & 0xF81F;
+  uint32_t fgG  = fgc & 0x07E0;
+
+  while (len--) {
+    uint8_t a = pgm_read_byte(alpha++);
+    if (a) {
+      uint16_t bgc = *buf;
+      if (swapped) bgc = (bgc >> 8) | (bgc << 8);
+
+      // As alphaBlend() with the foreground channels split out once
+      uint32_t rxb = bgc & 0xF81F;
+      rxb += (fgRB - rxb) * (a >> 2) >> 6;
+      uint32_t xgx = bgc & 0x07E0;
+      xgx += (fgG - xgx) * a >> 8;
+      bgc = (rxb & 0xF81F) | (xgx & 0x07E0);
+
+      if (swapped) bgc = (bgc >> 8) | (bgc << 8);
+      *buf = bgc;
+    }
+    buf++;
+  }
+}
+
 /***************************************************************************************
 ** Function name:           write
 ** Description:             draw characters piped through serial stream
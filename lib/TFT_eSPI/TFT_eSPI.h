@@ -605,6 +605,8 @@ class TFT_eSPI : public Print { friend class TFT_eSprite; // Sprite class has ac
            // These are used to render images or sprites stored in RAM arrays (used by Sprite class for 16bpp Sprites)
   void     pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data);
   void     pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data, uint16_t transparent);
+           // Render a w x h area of a larger RAM image, rows of the image are stride pixels apart
+  void     pushSubImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data, int32_t stride);
 
            // These are used to render images stored in FLASH (PROGMEM)
   void     pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data, uint16_t transparent);
@@ -736,6 +738,10 @@ class TFT_eSPI : public Print { friend class TFT_eSprite; // Sprite class has ac
   uint16_t alphaBlend(uint8_t alpha, uint16_t fgc, uint16_t bgc, uint8_t dither);
            // 24 bit colour alphaBlend with optional alpha dither
   uint32_t alphaBlend24(uint8_t alpha, uint32_t fgc, uint32_t bgc, uint8_t dither = 0);
+           // Blend len pixels between fgc and bgc into out, alpha[] per pixel (RAM or PROGMEM), same results as alphaBlend()
+  void     alphaBlendSpan(uint16_t* out, const uint8_t* alpha, uint32_t len, uint16_t fgc, uint16_t bgc);
+           // Blend fgc into len pixels of buf, alpha[] per pixel, swapped = true for byte swapped pixels (16 bit Sprite)
+  void     alphaBlendBuffer(uint16_t* buf, const uint8_t* alpha, uint32_t len, uint16_t fgc, bool swapped = false);
 
   // Direct Memory Access (DMA) support functions
   // These can be used for SPI writes when using the ESP32 (original) or STM32 processors.
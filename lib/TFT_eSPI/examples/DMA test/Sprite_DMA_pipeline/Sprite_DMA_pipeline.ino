@@ -0,0 +1,118 @@
+// This sketch shows the banded DMA pipeline of a Sprite. A full
+// screen frame is rendered in bands of BAND_LINES lines, while
+// one band is being drawn in one Sprite frame the previous band
+// is sent to the TFT by DMA from the other frame.
+
+// Only two bands of RAM are needed instead of a full screen
+// buffer: 2 * width * BAND_LINES * 2 bytes, 38 kBytes for
+// 240 x 40 lines.
+
+// The frame rate, the time spent rendering and the time the
+// CPU waited for DMA to finish are printed every second. A
+// high wait time means the SPI bus is the limit, a low one
+// means rendering is, then bigger bands will not help.
+
+// Processors without DMA support in the library still run the
+// sketch, the bands are then sent by the CPU with pushImage().
+
+// Example for library:
+// https://github.com/Bodmer/TFT_eSPI
+
+// Number of lines in each band
+#define BAND_LINES 40
+
+// Number of balls to draw
+#define BALLS 24
+
+#include <TFT_eSPI.h>
+
+TFT_eSPI    tft = TFT_eSPI();
+TFT_eSprite spr = TFT_eSprite(&tft);
+
+typedef struct {
+  int16_t  x, y, dx, dy, r;
+  uint16_t col;
+} ball_t;
+
+ball_t ball[BALLS];
+
+uint32_t reportTime = 0;
+
+// Called once per band, drawing is in screen coordinates and
+// anything outside the band is clipped by the Sprite
+void renderBand(TFT_eSprite *s, int32_t y, int32_t h, void *arg)
+{
+  (void)arg;
+  s->fillSprite(TFT_BLACK);
+
+  // Grid lines, only the ones crossing this band
+  for (int32_t gy = (y / 20) * 20; gy < y + h; gy += 20) s->drawFastHLine(0, gy, tft.width(), TFT_DARKGREY);
+  for (int32_t gx = 0; gx < tft.width(); gx += 20) s->drawFastVLine(gx, y, h, TFT_DARKGREY);
+
+  for (int i = 0; i < BALLS; i++) {
+    // Skip balls that do not touch the band
+    if (ball[i].y + ball[i].r < y || ball[i].y - ball[i].r >= y + h) continue;
+    s->fillCircle(ball[i].x, ball[i].y, ball[i].r, ball[i].col);
+  }
+}
+
+void moveBalls(void)
+{
+  for (int i = 0; i < BALLS; i++) {
+    ball[i].x += ball[i].dx;
+    ball[i].y += ball[i].dy;
+    if (ball[i].x < ball[i].r || ball[i].x >= tft.width()  - ball[i].r) ball[i].dx = -ball[i].dx;
+    if (ball[i].y < ball[i].r || ball[i].y >= tft.height() - ball[i].r) ball[i].dy = -ball[i].dy;
+  }
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  Serial.println();
+
+  tft.init();
+  tft.initDMA();
+  tft.fillScreen(TFT_BLACK);
+
+  // 16 bpp with 2 frames, the Sprite must be created after initDMA()
+  if (!spr.createSprite(tft.width(), BAND_LINES, 2)) {
+    Serial.println("Sprite could not be created");
+    while (1) delay(1);
+  }
+
+  for (int i = 0; i < BALLS; i++) {
+    ball[i].r   = random(6, 20);
+    ball[i].x   = random(ball[i].r, tft.width()  - ball[i].r);
+    ball[i].y   = random(ball[i].r, tft.height() - ball[i].r);
+    ball[i].dx  = random(1, 5);
+    ball[i].dy  = random(1, 5);
+    ball[i].col = random(0x10000) | 0x18E3;
+  }
+
+  // The TFT stays selected while the pipeline runs
+  tft.startWrite();
+  spr.resetDMAStats();
+}
+
+void loop()
+{
+  moveBalls();
+  spr.pushFrameDMA(0, 0, tft.width(), tft.height(), renderBand);
+
+  if (millis() - reportTime >= 1000) {
+    reportTime = millis();
+
+    sprite_dma_stats_t st;
+    spr.getDMAStats(&st);
+    if (st.frames && st.elapsed_us) {
+      Serial.printf("%.1f fps, render %lu us/frame, DMA wait %lu us/frame (%.0f%% CPU idle), %lu bands\n",
+                    st.frames * 1e6 / st.elapsed_us,
+                    (unsigned long)(st.render_us / st.frames),
+                    (unsigned long)(st.wait_us / st.frames),
+                    100.0 * st.wait_us / st.elapsed_us,
+                    (unsigned long)st.bands);
+    }
+    spr.resetDMAStats();
+  }
+}
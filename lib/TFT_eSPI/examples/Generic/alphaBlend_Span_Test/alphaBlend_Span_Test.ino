@@ -0,0 +1,127 @@
+/*
+  This tests the span alpha blending functions against alphaBlend()
+  and measures their speed:
+
+  tft.alphaBlendSpan(out, alpha, len, fg_color, bg_color);
+      out[i] = alphaBlend(alpha[i], fg_color, bg_color)
+
+  tft.alphaBlendBuffer(buf, alpha, len, fg_color);
+      buf[i] = alphaBlend(alpha[i], fg_color, buf[i])
+
+  Every alpha value is checked for a few thousand colour pairs,
+  the results must be identical. The speed of the span functions
+  and of a loop calling alphaBlend() is printed in pixels per
+  second, then a gradient drawn with alphaBlendSpan() is shown.
+
+  Example for library:
+  https://github.com/Bodmer/TFT_eSPI
+
+  #########################################################################
+  ###### DON'T FORGET TO UPDATE THE User_Setup.h FILE IN THE LIBRARY ######
+  #########################################################################
+*/
+
+#include <TFT_eSPI.h>       // Include the graphics library
+
+TFT_eSPI tft = TFT_eSPI();  // Create object "tft"
+
+#define SPAN 256
+
+uint8_t  alpha[SPAN];
+uint16_t out[SPAN + 1];
+uint16_t buf[SPAN];
+
+// -------------------------------------------------------------------------
+// Compare the span functions with alphaBlend()
+// -------------------------------------------------------------------------
+uint32_t checkResults(void) {
+  uint32_t errors = 0;
+
+  for (uint32_t i = 0; i < SPAN; i++) alpha[i] = i;
+
+  for (uint32_t n = 0; n < 4096; n++) {
+    uint16_t fg = random(0x10000);
+    uint16_t bg = random(0x10000);
+
+    // Odd start address checks the 16 bit alignment path
+    uint16_t* dst = out + (n & 1);
+    tft.alphaBlendSpan(dst, alpha, SPAN, fg, bg);
+    for (uint32_t i = 0; i < SPAN; i++) {
+      if (dst[i] != tft.alphaBlend(alpha[i], fg, bg)) errors++;
+    }
+
+    for (uint32_t i = 0; i < SPAN; i++) buf[i] = bg + i * 251;
+    tft.alphaBlendBuffer(buf, alpha, SPAN, fg);
+    for (uint32_t i = 0; i < SPAN; i++) {
+      if (buf[i] != tft.alphaBlend(alpha[i], fg, (uint16_t)(bg + i * 251))) errors++;
+    }
+
+    if ((n & 255) == 0) yield();
+  }
+
+  return errors;
+}
+
+// -------------------------------------------------------------------------
+// Print a speed in pixels per second
+// -------------------------------------------------------------------------
+void printRate(const char* name, uint32_t pixels, uint32_t us) {
+  Serial.print(name);
+  Serial.print(pixels * 1.0 / us, 2);
+  Serial.println(" Mpixels/s");
+}
+
+// -------------------------------------------------------------------------
+// Setup
+// -------------------------------------------------------------------------
+void setup(void) {
+  Serial.begin(115200);
+  Serial.println();
+
+  tft.init();
+  tft.setRotation(0);
+  tft.fillScreen(TFT_DARKGREY);
+  tft.setSwapBytes(true);     // The span holds colour values, not byte swapped image data
+
+  uint32_t errors = checkResults();
+  Serial.print("Mismatches against alphaBlend(): ");
+  Serial.println(errors);
+
+  // Anti-aliased pixels have random alpha values
+  for (uint32_t i = 0; i < SPAN; i++) alpha[i] = random(256);
+
+  const uint32_t loops = 1000;
+  uint32_t t;
+
+  t = micros();
+  for (uint32_t n = 0; n < loops; n++) {
+    for (uint32_t i = 0; i < SPAN; i++) out[i] = tft.alphaBlend(alpha[i], TFT_WHITE, n);
+  }
+  printRate("alphaBlend() loop: ", loops * SPAN, micros() - t);
+
+  t = micros();
+  for (uint32_t n = 0; n < loops; n++) tft.alphaBlendSpan(out, alpha, SPAN, TFT_WHITE, n);
+  printRate("alphaBlendSpan():  ", loops * SPAN, micros() - t);
+
+  t = micros();
+  for (uint32_t n = 0; n < loops; n++) tft.alphaBlendBuffer(buf, alpha, SPAN, n);
+  printRate("alphaBlendBuffer(): ", loops * SPAN, micros() - t);
+}
+
+// -------------------------------------------------------------------------
+// Loop
+// -------------------------------------------------------------------------
+void loop() {
+  // Horizontal gradients, one span per line
+  for (uint32_t i = 0; i < SPAN; i++) alpha[i] = i;
+
+  uint16_t colors[] = { TFT_RED, TFT_GREEN, TFT_BLUE, TFT_WHITE, TFT_YELLOW, TFT_CYAN };
+  int32_t  w = min((int32_t)tft.width(), (int32_t)SPAN);
+
+  for (uint32_t c = 0; c < sizeof(colors) / sizeof(colors[0]); c++) {
+    tft.alphaBlendSpan(out, alpha, w, colors[c], TFT_BLACK);
+    for (int32_t y = 0; y < 40; y++) tft.pushImage(0, c * 40 + y, w, 1, out);
+  }
+
+  delay(5000);
+}
@@ -0,0 +1,133 @@
+/*
+  Smooth font benchmark
+
+  Renders the same paragraph with a font held in memory (as a
+  font array in FLASH would be) and with the font read from the
+  LittleFS file, without and with the glyph bitmap cache, and
+  prints the time per paragraph to the serial port.
+
+  The glyph index is searched with a binary search, the time per
+  lookup is printed too. Fonts with thousands of glyphs (e.g.
+  CJK) benefit most from the index and the cache.
+
+  Upload the data folder with the LittleFS upload tool first.
+
+  Example for library:
+  https://github.com/Bodmer/TFT_eSPI
+*/
+
+#include <FS.h>
+#include <LittleFS.h>
+
+#include <TFT_eSPI.h>
+
+TFT_eSPI tft = TFT_eSPI();
+
+#define FONT_NAME "Latin-Hiragana-24"
+
+// Size of the glyph cache in bytes
+#define CACHE_SIZE (16 * 1024)
+
+const char paragraph[] =
+  "The quick brown fox jumps over the lazy dog. "
+  "いろはにほへと ちりぬるを わかよたれそ つねならむ "
+  "Pack my box with five dozen liquor jugs. "
+  "うゐのおくやま けふこえて あさきゆめみし ゑひもせす";
+
+uint8_t* fontArray = nullptr;
+
+// Render the paragraph a few times and print the average time
+void run(const char* title)
+{
+  const int passes = 5;
+
+  uint32_t t = micros();
+  for (int i = 0; i < passes; i++) {
+    tft.fillScreen(TFT_BLACK);
+    tft.setCursor(0, 0);
+    tft.print(paragraph);
+  }
+  t = (micros() - t) / passes;
+
+  Serial.print(title);
+  Serial.print(": ");
+  Serial.print(t / 1000.0, 1);
+  Serial.println(" ms per paragraph");
+}
+
+// Average time to find a glyph in the index
+void lookup(void)
+{
+  const uint32_t n = 10000;
+  uint16_t index;
+  uint32_t found = 0;
+
+  uint32_t t = micros();
+  for (uint32_t i = 0; i < n; i++) {
+    found += tft.getUnicodeIndex(0x3042 + (i % 80), &index); // Hiragana block
+  }
+  t = micros() - t;
+
+  Serial.print("Glyph lookup: ");
+  Serial.print(t * 1000.0 / n, 0);
+  Serial.print(" ns, ");
+  Serial.print(found);
+  Serial.println(" found");
+}
+
+void setup()
+{
+  Serial.begin(115200);
+
+  if (!LittleFS.begin()) {
+    Serial.println("Flash FS initialisation failed!");
+    while (1) yield();
+  }
+
+  tft.begin();
+  tft.setRotation(1);
+  tft.setTextColor(TFT_WHITE, TFT_BLACK);
+  tft.setTextWrap(true);
+
+  // Copy the font file into RAM to use it like a font array
+  File f = LittleFS.open("/" FONT_NAME ".vlw", "r");
+  if (f) {
+    fontArray = (uint8_t*)malloc(f.size());
+    if (fontArray) f.read(fontArray, f.size());
+    f.close();
+  }
+}
+
+void loop()
+{
+  Serial.println();
+
+  if (fontArray) {
+    tft.loadFont(fontArray);
+    run("Font array");
+    lookup();
+    tft.unloadFont();
+  }
+
+  tft.setGlyphCacheSize(0);
+  tft.loadFont(FONT_NAME, LittleFS);
+  run("LittleFS, no cache");
+  tft.unloadFont();
+
+  tft.setGlyphCacheSize(CACHE_SIZE);
+  tft.loadFont(FONT_NAME, LittleFS);
+  run("LittleFS, glyph cache");
+
+  uint32_t hits, misses, used;
+  tft.getGlyphCacheStats(&hits, &misses, &used);
+  Serial.print("Cache hits: ");
+  Serial.print(hits);
+  Serial.print(", misses: ");
+  Serial.print(misses);
+  Serial.print(", bytes used: ");
+  Serial.println(used);
+  tft.unloadFont();
+  tft.setGlyphCacheSize(0);
+
+  delay(5000);
+}
@@ -0,0 +1,83 @@
+/*
+
+  Sketch to show dirty rectangle tracking in a Sprite.
+
+  Example for library:
+  https://github.com/Bodmer/TFT_eSPI
+
+  A full screen Sprite is used as a frame buffer. Once tracking
+  is enabled the drawing functions record the areas they change
+  and pushDirty() only sends those areas to the TFT, so a clock
+  that changes a few digits per second costs a few kBytes of
+  SPI traffic instead of the whole frame.
+
+  The time and the number of pixels sent by pushSprite() and
+  pushDirty() are printed to the serial port.
+
+  A 320 x 240 16 bit Sprite needs 150 kBytes of RAM, use a
+  board with PSRAM or reduce the Sprite colour depth to 8 bits.
+
+*/
+
+#include <TFT_eSPI.h>                 // Include the graphics library (this includes the sprite functions)
+
+TFT_eSPI    tft = TFT_eSPI();         // Declare object "tft"
+
+TFT_eSprite spr = TFT_eSprite(&tft);  // Declare Sprite object "spr" with pointer to "tft" object
+
+uint32_t frame = 0;
+
+void setup()
+{
+  Serial.begin(115200);
+  Serial.println();
+
+  tft.init();
+  tft.setRotation(1);
+
+  if (!spr.createSprite(tft.width(), tft.height())) {
+    Serial.println("Sprite could not be created");
+    while (1) delay(1);
+  }
+
+  // Static background, drawn once
+  spr.fillSprite(TFT_NAVY);
+  spr.fillRoundRect(20, 60, tft.width() - 40, 100, 10, TFT_DARKGREY);
+  spr.setTextColor(TFT_WHITE, TFT_NAVY);
+  spr.drawString("Dirty rectangle demo", 20, 20, 4);
+
+  // Enabling marks the whole Sprite dirty, the first pushDirty() sends all of it
+  spr.setDirtyTracking(true);
+  spr.pushDirty(0, 0);
+}
+
+void loop()
+{
+  uint32_t s = millis() / 1000;
+  char buf[12];
+  snprintf(buf, sizeof(buf), "%02u:%02u:%02u", (unsigned)(s / 3600 % 24), (unsigned)(s / 60 % 60), (unsigned)(s % 60));
+
+  // Only the clock and the spinner change
+  spr.setTextColor(TFT_YELLOW, TFT_DARKGREY);
+  spr.drawString(buf, 50, 90, 7);
+  spr.fillCircle(tft.width() - 30, tft.height() - 30, 12, TFT_NAVY);
+  spr.drawLine(tft.width() - 30, tft.height() - 30, tft.width() - 30 + 10 * cos(frame * 0.2), tft.height() - 30 + 10 * sin(frame * 0.2), TFT_WHITE);
+
+  uint8_t areas = spr.getDirtyCount();
+  uint32_t t = micros();
+  uint32_t pixels = spr.pushDirty(0, 0);
+  t = micros() - t;
+
+  if (frame % 50 == 0) {
+    // The whole frame for comparison
+    uint32_t tf = micros();
+    spr.pushSprite(0, 0);
+    tf = micros() - tf;
+
+    Serial.printf("pushDirty: %u areas, %u pixels, %u bytes, %u us   pushSprite: %u bytes, %u us\n",
+                  areas, pixels, pixels * 2, t, spr.width() * spr.height() * 2, tf);
+  }
+
+  frame++;
+  delay(20);
+}
@@ -0,0 +1,105 @@
+#include <TinyGPS++.h>
+/*
+   This sample sketch compares the character-at-a-time and the block versions of encode()
+   and checks the integer (E7) distance and course helpers against the floating point ones.
+   The integer helpers are meant for MCUs without an FPU, or for builds with
+   _GPS_FIXED_POINT set to 1.  No device needed.
+*/
+
+// A sample NMEA stream.
+const char *gpsStream =
+  "$GPRMC,045103.000,A,3014.1984,N,09749.2872,W,0.67,161.46,030913,,,A*7C\r\n"
+  "$GPGGA,045104.000,3014.1985,N,09749.2873,W,1,09,1.2,211.6,M,-22.5,M,,0000*62\r\n"
+  "$GPRMC,045200.000,A,3014.3820,N,09748.9514,W,36.88,65.02,030913,,,A*77\r\n"
+  "$GPGGA,045201.000,3014.3864,N,09748.9411,W,1,10,1.2,200.8,M,-22.5,M,,0000*6C\r\n"
+  "$GPRMC,045251.000,A,3014.4275,N,09749.0626,W,0.51,217.94,030913,,,A*7D\r\n"
+  "$GPGGA,045252.000,3014.4273,N,09749.0628,W,1,09,1.3,206.9,M,-22.5,M,,0000*6F\r\n";
+
+// How often the stream is fed to each parser
+static const int REPEAT = 2000;
+
+// Pairs of positions in 1e-7 degrees: lat1, long1, lat2, long2
+static const int32_t pairs[][4] =
+{
+  {  302366400, -977548120,  302397100, -977490230 }, // a few hundred meters
+  {  515007300,   -1246000,  488583700,   22944800 }, // London - Paris
+  {  407127800, -740059700,  516535000,   -1262100 }, // New York - London
+  { -338688000, 1512093000,  353667000, 1398283000 }, // Sydney - Tokyo
+  {  900000000,          0, -899000000,          0 }, // pole to pole
+};
+
+void setup()
+{
+  Serial.begin(115200);
+
+  Serial.println(F("FixedPointExample.ino"));
+  Serial.println(F("Block encode() and integer distance/course helpers (no device needed)"));
+  Serial.print(F("Testing TinyGPS++ library v. ")); Serial.println(TinyGPSPlus::libraryVersion());
+  Serial.println();
+
+  size_t len = strlen(gpsStream);
+
+  TinyGPSPlus perChar;
+  uint32_t start = micros();
+  for (int i=0; i<REPEAT; ++i)
+    for (size_t j=0; j<len; ++j)
+      perChar.encode(gpsStream[j]);
+  uint32_t perCharTime = micros() - start;
+
+  TinyGPSPlus block;
+  start = micros();
+  for (int i=0; i<REPEAT; ++i)
+    block.encode(gpsStream, len);
+  uint32_t blockTime = micros() - start;
+
+  printRate(F("encode(char):         "), perChar, perCharTime);
+  printRate(F("encode(buffer, len):  "), block, blockTime);
+  Serial.print(F("Same fix: "));
+  Serial.println(perChar.location.latE7() == block.location.latE7() &&
+                 perChar.location.lngE7() == block.location.lngE7() ? F("yes") : F("NO"));
+  Serial.println();
+
+  for (size_t i=0; i<sizeof(pairs)/sizeof(pairs[0]); ++i)
+  {
+    const int32_t *p = pairs[i];
+    start = micros();
+    uint32_t dist = TinyGPSPlus::distanceBetweenE7(p[0], p[1], p[2], p[3]);
+    uint16_t course = TinyGPSPlus::courseToE7(p[0], p[1], p[2], p[3]);
+    uint32_t intTime = micros() - start;
+
+    Serial.print(F("Distance: ")); Serial.print(dist);
+    Serial.print(F(" m  Course: ")); Serial.print(course / 100.0, 2);
+    Serial.print(F("  (")); Serial.print(intTime); Serial.print(F(" us)"));
+
+#if !_GPS_FIXED_POINT
+    double lat1 = p[0] / 1e7, long1 = p[1] / 1e7, lat2 = p[2] / 1e7, long2 = p[3] / 1e7;
+    start = micros();
+    double fdist = TinyGPSPlus::distanceBetween(lat1, long1, lat2, long2);
+    double fcourse = TinyGPSPlus::courseTo(lat1, long1, lat2, long2);
+    uint32_t floatTime = micros() - start;
+
+    Serial.print(F("  double: ")); Serial.print(fdist, 1);
+    Serial.print(F(" m ")); Serial.print(fcourse, 2);
+    Serial.print(F("  (")); Serial.print(floatTime); Serial.print(F(" us)"));
+#endif
+    Serial.println();
+  }
+
+  Serial.println();
+  Serial.println(F("Done."));
+}
+
+void loop()
+{
+}
+
+void printRate(const __FlashStringHelper *label, TinyGPSPlus &gps, uint32_t us)
+{
+  Serial.print(label);
+  Serial.print(gps.passedChecksum());
+  Serial.print(F(" sentences in "));
+  Serial.print(us);
+  Serial.print(F(" us, "));
+  Serial.print(gps.passedChecksum() * 1000000.0 / us, 0);
+  Serial.println(F(" sentences/s"));
+}
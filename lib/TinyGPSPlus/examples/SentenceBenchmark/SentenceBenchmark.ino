@@ -0,0 +1,92 @@
+#include <TinyGPS++.h>
+/*
+   This sample sketch times the built-in GSV and GSA decoding against the same
+   fields extracted with TinyGPSCustom objects (the way SatelliteTracker does it),
+   then lists the satellites in view of all talkers.  No device needed.
+*/
+
+// A sample multi-talker NMEA stream.
+const char *gpsStream =
+  "$GPRMC,045103.000,A,3014.1984,N,09749.2872,W,0.67,161.46,030913,,,A*7C\r\n"
+  "$GPGGA,045104.000,3014.1985,N,09749.2873,W,1,09,1.2,211.6,M,-22.5,M,,0000*62\r\n"
+  "$GPGSA,A,3,03,06,13,16,,,,,,,,,2.5,1.3,2.1*34\r\n"
+  "$GPGSV,2,1,06,03,03,111,00,04,15,270,,06,01,010,12,13,06,292,40*74\r\n"
+  "$GPGSV,2,2,06,14,25,170,00,16,57,208,39*7E\r\n"
+  "$GLGSV,1,1,02,65,10,100,33,66,20,200,44*64\r\n"
+  "$GPVTG,161.46,T,,M,0.67,N,1.24,K,A*3F\r\n";
+
+// How often the stream is fed to each parser
+static const int REPEAT = 500;
+
+TinyGPSPlus builtIn;
+
+TinyGPSPlus custom;
+TinyGPSCustom totalGPGSVMessages(custom, "GPGSV", 1);
+TinyGPSCustom messageNumber(custom, "GPGSV", 2);
+TinyGPSCustom satsInView(custom, "GPGSV", 3);
+TinyGPSCustom satNumber[4], elevation[4], azimuth[4], snr[4];
+TinyGPSCustom pdop(custom, "GPGSA", 15), hdop(custom, "GPGSA", 16), vdop(custom, "GPGSA", 17);
+
+void setup()
+{
+  Serial.begin(115200);
+
+  Serial.println(F("SentenceBenchmark.ino"));
+  Serial.println(F("Built-in GSV/GSA decoding versus TinyGPSCustom (no device needed)"));
+  Serial.print(F("Testing TinyGPS++ library v. ")); Serial.println(TinyGPSPlus::libraryVersion());
+  Serial.println();
+
+  for (int i=0; i<4; ++i)
+  {
+    satNumber[i].begin(custom, "GPGSV", 4 + 4 * i);
+    elevation[i].begin(custom, "GPGSV", 5 + 4 * i);
+    azimuth[i].begin(custom, "GPGSV", 6 + 4 * i);
+    snr[i].begin(custom, "GPGSV", 7 + 4 * i);
+  }
+
+  size_t len = strlen(gpsStream);
+
+  uint32_t start = micros();
+  for (int i=0; i<REPEAT; ++i)
+    builtIn.encode(gpsStream, len);
+  printRate(F("Built-in:      "), builtIn, micros() - start);
+
+  start = micros();
+  for (int i=0; i<REPEAT; ++i)
+    custom.encode(gpsStream, len);
+  printRate(F("TinyGPSCustom: "), custom, micros() - start);
+  Serial.println();
+
+  Serial.print(F("Fix type: ")); Serial.print(builtIn.fixType.value());
+  Serial.print(F("  PDOP: ")); Serial.print(builtIn.pdop.value() / 100.0);
+  Serial.print(F("  HDOP: ")); Serial.print(builtIn.hdop.hdop());
+  Serial.print(F("  VDOP: ")); Serial.println(builtIn.vdop.value() / 100.0);
+
+  uint8_t count = builtIn.satellitesInView.count();
+  Serial.print(count); Serial.println(F(" satellites in view"));
+  for (uint8_t i=0; i<count; ++i)
+  {
+    const TinyGPSSatellite &sat = builtIn.satellitesInView[i];
+    Serial.print(F("  G")); Serial.print(sat.talker);
+    Serial.print(F(" PRN ")); Serial.print(sat.prn);
+    Serial.print(F(" elevation ")); Serial.print(sat.elevation);
+    Serial.print(F(" azimuth ")); Serial.print(sat.azimuth);
+    Serial.print(F(" SNR ")); Serial.println(sat.snr);
+  }
+
+  Serial.println();
+  Serial.println(F("Done."));
+}
+
+void loop()
+{
+}
+
+void printRate(const __FlashStringHelper *label, TinyGPSPlus &gps, uint32_t us)
+{
+  Serial.print(label);
+  Serial.print(gps.charsProcessed() * 1000.0 / us, 0);
+  Serial.print(F(" chars/ms, "));
+  Serial.print((float)us / gps.passedChecksum(), 1);
+  Serial.println(F(" us/sentence"));
+}
@@ -27,20 +27,44 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include <ctype.h>
 #include <stdlib.h>
 
-#define _GPRMCterm   "GPRMC"
-#define _GPGGAterm   "GPGGA"
-#define _GNRMCterm   "GNRMC"
-#define _GNGGAterm   "GNGGA"
+// Sentences are identified by their three letter formatter, the talker ID
+// in front of it is kept apart so every constellation shares one entry
+#define _GPS_FORMATTER(a, b, c) (((uint32_t)(a) << 16) | ((uint32_t)(b) << 8) | (uint32_t)(c))
+#define _RMCformatter _GPS_FORMATTER('R', 'M', 'C')
+#define _GGAformatter _GPS_FORMATTER('G', 'G', 'A')
+#define _GSVformatter _GPS_FORMATTER('G', 'S', 'V')
+#define _GSAformatter _GPS_FORMATTER('G', 'S', 'A')
+#define _VTGformatter _GPS_FORMATTER('V', 'T', 'G')
+
+#define _UBX_SYNC_CHAR1 0xB5
+#define _UBX_SYNC_CHAR2 0x62
+#define _UBX_CLASS_NAV 0x01
+#define _UBX_ID_NAV_PVT 0x07
+#define _UBX_NAV_PVT_MIN_LENGTH 78 // up to pDOP, older receivers send 84 bytes
 
 TinyGPSPlus::TinyGPSPlus()
   :  parity(0)
   ,  isChecksumTerm(false)
   ,  curSentenceType(GPS_SENTENCE_OTHER)
+  ,  curTalker(0)
   ,  curTermNumber(0)
   ,  curTermOffset(0)
   ,  sentenceHasFix(false)
+  ,  gsvMessages(0)
+  ,  gsvMessageNumber(0)
+  ,  gsvSlots(0)
+  ,  ubxState(UBX_IDLE)
+  ,  ubxClass(0)
+  ,  ubxId(0)
+  ,  ubxLength(0)
+  ,  ubxOffset(0)
+  ,  ubxCkA(0)
+  ,  ubxCkB(0)
+  ,  ubxChecksumOk(false)
   ,  customElts(0)
   ,  customCandidates(0)
+  ,  customCandidatesEnd(0)
+  ,  customCursor(0)
   ,  encodedCharCount(0)
   ,  sentencesWithFixCount(0)
   ,  failedChecksumCount(0)
@@ -57,6 +81,10 @@ bool TinyGPSPlus::encode(char c)
 {
   ++encodedCharCount;
 
+  // UBX frames start with a byte that never shows up in NMEA
+  if (ubxState != UBX_IDLE || (uint8_t)c == _UBX_SYNC_CHAR1)
+    return ubxEncode((uint8_t)c);
+
   switch(c)
   {
   case ',': // term terminators
@@ -97,9 +125,63 @@ bool TinyGPSPlus::encode(char c)
   return false;
 }
 
+// Process a block of characters. Runs of ordinary characters are copied into the
+// term in one go, only the delimiters go through encode(char).
+size_t TinyGPSPlus::encode(const char *buffer, size_t length)
+{
+  size_t validSentences = 0;
+  const char *end = buffer + length;
+
+  while (buffer < end)
+  {
+    const char *run = buffer;
+    // digits, letters, '.' and '-' are all above ','. Binary (UBX) data
+    // goes through encode(char) byte by byte.
+    if (ubxState == UBX_IDLE)
+      while (buffer < end && (uint8_t)*buffer > ',' && (uint8_t)*buffer < 0x80)
+        ++buffer;
+    if (buffer > run)
+      appendTerm(run, buffer - run);
+    if (buffer < end && encode(*buffer++))
+      ++validSentences;
+  }
+
+  return validSentences;
+}
+
 //
 // internal utilities
 //
+void TinyGPSPlus::appendTerm(const char *run, size_t length)
+{
+  encodedCharCount += length;
+
+  if (curTermOffset < sizeof(term) - 1)
+  {
+    size_t n = sizeof(term) - 1 - curTermOffset;
+    if (n > length)
+      n = length;
+    memcpy(term + curTermOffset, run, n);
+    curTermOffset += n;
+  }
+
+  if (!isChecksumTerm)
+  {
+    // xor four characters at a time, then fold
+    uint32_t x = 0, w;
+    for (; length >= 4; run += 4, length -= 4)
+    {
+      memcpy(&w, run, 4);
+      x ^= w;
+    }
+    while (length--)
+      x ^= (uint8_t)*run++;
+    x ^= x >> 16;
+    x ^= x >> 8;
+    parity ^= (uint8_t)x;
+  }
+}
+
 int TinyGPSPlus::fromHex(char a)
 {
   if (a >= 'A' && a <= 'F')
@@ -190,10 +272,31 @@ bool TinyGPSPlus::endOfTermHandler()
         satellites.commit();
         hdop.commit();
         break;
+      case GPS_SENTENCE_GSV:
+        satellitesInView.newCnt += gsvSlots;
+        if (gsvMessageNumber == gsvMessages)
+          satellitesInView.commit();
+        break;
+      case GPS_SENTENCE_GSA:
+        fixType.commit();
+        if (sentenceHasFix)
+        {
+          pdop.commit();
+          hdop.commit();
+          vdop.commit();
+        }
+        break;
+      case GPS_SENTENCE_VTG:
+        if (sentenceHasFix)
+        {
+          speed.commit();
+          course.commit();
+        }
+        break;
       }
 
       // Commit all custom listeners of this sentence type
-      for (TinyGPSCustom *p = customCandidates; p != NULL && strcmp(p->sentenceName, customCandidates->sentenceName) == 0; p = p->next)
+      for (TinyGPSCustom *p = customCandidates; p != customCandidatesEnd; p = p->next)
          p->commit();
       return true;
     }
@@ -209,22 +312,41 @@ bool TinyGPSPlus::endOfTermHandler()
   // the first term determines the sentence type
   if (curTermNumber == 0)
   {
-    if (!strcmp(term, _GPRMCterm) || !strcmp(term, _GNRMCterm))
-      curSentenceType = GPS_SENTENCE_GPRMC;
-    else if (!strcmp(term, _GPGGAterm) || !strcmp(term, _GNGGAterm))
-      curSentenceType = GPS_SENTENCE_GPGGA;
-    else
-      curSentenceType = GPS_SENTENCE_OTHER;
+    // talker ID (any but proprietary 'P' sentences) followed by the formatter
+    curSentenceType = GPS_SENTENCE_OTHER;
+    curTalker = term[1];
+    if (curTermOffset == 5 && term[0] != 'P')
+      switch(_GPS_FORMATTER(term[2], term[3], term[4]))
+      {
+      case _RMCformatter: curSentenceType = GPS_SENTENCE_GPRMC; break;
+      case _GGAformatter: curSentenceType = GPS_SENTENCE_GPGGA; break;
+      case _GSVformatter: curSentenceType = GPS_SENTENCE_GSV; gsvSlots = 0; break;
+      case _GSAformatter: curSentenceType = GPS_SENTENCE_GSA; break;
+      case _VTGformatter: curSentenceType = GPS_SENTENCE_VTG; break;
+      }
 
-    // Any custom candidates of this sentence type?
-    for (customCandidates = customElts; customCandidates != NULL && strcmp(customCandidates->sentenceName, term) < 0; customCandidates = customCandidates->next);
-    if (customCandidates != NULL && strcmp(customCandidates->sentenceName, term) > 0)
-       customCandidates = NULL;
+    // Any custom candidates of this sentence type? The list is sorted by name,
+    // so they are adjacent; the hash saves most of the string compares.
+    customCandidates = customCandidatesEnd = NULL;
+    if (customElts != NULL)
+    {
+      uint16_t hash = sentenceHash(term);
+      TinyGPSCustom *p = customElts;
+      while (p != NULL && (p->sentenceHash != hash || strcmp(p->sentenceName, term)))
+        p = p->next;
+      customCandidates = p;
+      while (p != NULL && p->sentenceHash == hash && !strcmp(p->sentenceName, term))
+        p = p->next;
+      customCandidatesEnd = p;
+    }
+    customCursor = customCandidates;
 
     return false;
   }
 
-  if (curSentenceType != GPS_SENTENCE_OTHER && term[0])
+  if (curSentenceType == GPS_SENTENCE_GSV)
+    gsvTermHandler();
+  else if (curSentenceType != GPS_SENTENCE_OTHER && term[0])
     switch(COMBINE(curSentenceType, curTermNumber))
   {
     case COMBINE(GPS_SENTENCE_GPRMC, 1): // Time in both sentences
@@ -271,16 +393,210 @@ bool TinyGPSPlus::endOfTermHandler()
     case COMBINE(GPS_SENTENCE_GPGGA, 9): // Altitude (GPGGA)
       altitude.set(term);
       break;
+    case COMBINE(GPS_SENTENCE_GSA, 2): // Fix type (GSA)
+      fixType.set(term);
+      sentenceHasFix = term[0] > '1';
+      break;
+    case COMBINE(GPS_SENTENCE_GSA, 15): // PDOP
+      pdop.set(term);
+      break;
+    case COMBINE(GPS_SENTENCE_GSA, 16): // HDOP
+      hdop.set(term);
+      break;
+    case COMBINE(GPS_SENTENCE_GSA, 17): // VDOP
+      vdop.set(term);
+      break;
+    case COMBINE(GPS_SENTENCE_VTG, 1): // Course over ground, true (VTG)
+      course.set(term);
+      break;
+    case COMBINE(GPS_SENTENCE_VTG, 5): // Speed in knots (VTG)
+      speed.set(term);
+      sentenceHasFix = true;
+      break;
+    case COMBINE(GPS_SENTENCE_VTG, 9): // Mode (VTG, NMEA 2.3 and later)
+      sentenceHasFix = sentenceHasFix && term[0] != 'N';
+      break;
   }
 
-  // Set custom values as needed
-  for (TinyGPSCustom *p = customCandidates; p != NULL && strcmp(p->sentenceName, customCandidates->sentenceName) == 0 && p->termNumber <= curTermNumber; p = p->next)
-    if (p->termNumber == curTermNumber)
-         p->set(term);
+  // Set custom values as needed, the candidates are sorted by term number
+  while (customCursor != customCandidatesEnd && customCursor->termNumber < curTermNumber)
+    customCursor = customCursor->next;
+  for (TinyGPSCustom *p = customCursor; p != customCandidatesEnd && p->termNumber == curTermNumber; p = p->next)
+    p->set(term);
 
   return false;
 }
 
+// Terms of a GSV sentence: number of messages, message number, satellites in view,
+// then up to four satellites of prn, elevation, azimuth and SNR
+void TinyGPSPlus::gsvTermHandler()
+{
+  TinyGPSSatellitesInView &sv = satellitesInView;
+
+  switch(curTermNumber)
+  {
+  case 1:
+    gsvMessages = (uint8_t)atoi(term);
+    return;
+  case 2:
+    gsvMessageNumber = (uint8_t)atoi(term);
+    if (gsvMessageNumber == 1)
+      sv.removeTalker(curTalker);
+    return;
+  case 3:
+    {
+      // satellites in this message; NMEA 4.1 appends a signal ID that must not be taken for one
+      int left = atoi(term) - 4 * (gsvMessageNumber - 1);
+      gsvSlots = left <= 0 ? 0 : left > 4 ? 4 : (uint8_t)left;
+      if (gsvSlots > _GPS_MAX_SATELLITES - sv.newCnt)
+        gsvSlots = _GPS_MAX_SATELLITES - sv.newCnt;
+      for (uint8_t i = 0; i < gsvSlots; ++i)
+      {
+        TinyGPSSatellite &sat = sv.newSats[sv.newCnt + i];
+        memset(&sat, 0, sizeof(sat));
+        sat.talker = curTalker;
+      }
+    }
+    return;
+  }
+
+  uint8_t slot = (curTermNumber - 4) / 4;
+  if (slot >= gsvSlots || !term[0])
+    return;
+
+  TinyGPSSatellite &sat = sv.newSats[sv.newCnt + slot];
+  switch((curTermNumber - 4) % 4)
+  {
+  case 0: sat.prn = (uint8_t)atoi(term); break;
+  case 1: sat.elevation = (uint8_t)atoi(term); break;
+  case 2: sat.azimuth = (uint16_t)atoi(term); break;
+  case 3: sat.snr = (uint8_t)atoi(term); break;
+  }
+}
+
+// UBX frame: sync chars, class, id, little endian length, payload, Fletcher checksum
+bool TinyGPSPlus::ubxEncode(uint8_t c)
+{
+  switch(ubxState)
+  {
+  case UBX_IDLE:
+    ubxState = UBX_SYNC2;
+    return false;
+  case UBX_SYNC2:
+    ubxState = c == _UBX_SYNC_CHAR2 ? UBX_CLASS : UBX_IDLE;
+    ubxCkA = ubxCkB = 0;
+    return false;
+  case UBX_CK_A:
+    ubxChecksumOk = c == ubxCkA;
+    ubxState = UBX_CK_B;
+    return false;
+  case UBX_CK_B:
+    ubxState = UBX_IDLE;
+    if (!ubxChecksumOk || c != ubxCkB)
+    {
+      ++failedChecksumCount;
+      return false;
+    }
+    passedChecksumCount++;
+    if (ubxClass == _UBX_CLASS_NAV && ubxId == _UBX_ID_NAV_PVT && ubxLength >= _UBX_NAV_PVT_MIN_LENGTH)
+      ubxNavPvt();
+    return true;
+  }
+
+  ubxCkA += c;
+  ubxCkB += ubxCkA;
+
+  switch(ubxState)
+  {
+  case UBX_CLASS:
+    ubxClass = c;
+    ubxState = UBX_ID;
+    break;
+  case UBX_ID:
+    ubxId = c;
+    ubxState = UBX_LENGTH1;
+    break;
+  case UBX_LENGTH1:
+    ubxLength = c;
+    ubxState = UBX_LENGTH2;
+    break;
+  case UBX_LENGTH2:
+    ubxLength |= (uint16_t)c << 8;
+    ubxOffset = 0;
+    ubxState = ubxLength ? UBX_PAYLOAD : UBX_CK_A;
+    break;
+  case UBX_PAYLOAD:
+    if (ubxOffset < sizeof(ubxPayload))
+      ubxPayload[ubxOffset] = c;
+    if (++ubxOffset == ubxLength)
+      ubxState = UBX_CK_A;
+    break;
+  }
+
+  return false;
+}
+
+static uint16_t ubxU2(const uint8_t *p)
+{
+  return p[0] | ((uint16_t)p[1] << 8);
+}
+
+static int32_t ubxI4(const uint8_t *p)
+{
+  return (int32_t)(p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24));
+}
+
+static void setDegreesE7(RawDegrees &deg, int32_t e7)
+{
+  deg.negative = e7 < 0;
+  uint32_t v = deg.negative ? -(uint32_t)e7 : (uint32_t)e7;
+  deg.deg = (uint16_t)(v / 10000000UL);
+  deg.billionths = (v % 10000000UL) * 100;
+}
+
+// Commits a UBX-NAV-PVT payload to the same objects the NMEA sentences use
+void TinyGPSPlus::ubxNavPvt()
+{
+  const uint8_t *p = ubxPayload;
+  uint8_t validFlags = p[11];
+  uint8_t gnssFix = p[20];
+  sentenceHasFix = (p[21] & 0x01) && gnssFix >= 2 && gnssFix <= 4; // 5 is time only
+
+  if (validFlags & 0x01)
+  {
+    date.newDate = p[7] * 10000UL + p[6] * 100UL + ubxU2(p + 4) % 100;
+    date.commit();
+  }
+  if (validFlags & 0x02)
+  {
+    int32_t nano = ubxI4(p + 16);
+    time.newTime = p[8] * 1000000UL + p[9] * 10000UL + p[10] * 100UL + (nano > 0 ? nano / 10000000L : 0);
+    time.commit();
+  }
+
+  satellites.newval = p[23];
+  satellites.commit();
+  fixType.newval = !sentenceHasFix ? 1 : gnssFix == 2 ? 2 : 3;
+  fixType.commit();
+  pdop.newval = ubxU2(p + 76);
+  pdop.commit();
+
+  if (sentenceHasFix)
+  {
+    ++sentencesWithFixCount;
+    setDegreesE7(location.rawNewLngData, ubxI4(p + 24));
+    setDegreesE7(location.rawNewLatData, ubxI4(p + 28));
+    location.commit();
+    altitude.newval = ubxI4(p + 36) / 10;                         // mm to cm
+    altitude.commit();
+    speed.newval = (int32_t)(((int64_t)ubxI4(p + 60) * 180 + 463) / 926); // mm/s to 1/100 knot
+    speed.commit();
+    course.newval = ubxI4(p + 64) / 1000;                         // 1e-5 to 1/100 degree
+    course.commit();
+  }
+}
+
+#if !_GPS_FIXED_POINT
 /* static */
 double TinyGPSPlus::distanceBetween(double lat1, double long1, double lat2, double long2)
 {
@@ -326,6 +642,207 @@ double TinyGPSPlus::courseTo(double lat1, double long1, double lat2, double long
   }
   return degrees(a2);
 }
+#endif
+
+//
+// Integer trigonometry for the E7 functions. Angles are binary angles
+// (2^32 = one turn), sines and cosines are Q30 (1 << 30 = 1.0).
+//
+
+// sin() over a quarter turn in 256 steps
+static const int32_t sinTable[257] = {
+  0, 6588356, 13176464, 19764076, 26350943, 32936819, 39521455, 46104602,
+  52686014, 59265442, 65842639, 72417357, 78989349, 85558366, 92124163, 98686491,
+  105245103, 111799753, 118350194, 124896179, 131437462, 137973796, 144504935, 151030634,
+  157550647, 164064728, 170572633, 177074115, 183568930, 190056834, 196537583, 203010932,
+  209476638, 215934457, 222384147, 228825464, 235258165, 241682010, 248096755, 254502159,
+  260897982, 267283981, 273659918, 280025552, 286380643, 292724951, 299058239, 305380268,
+  311690799, 317989595, 324276419, 330551034, 336813204, 343062693, 349299266, 355522689,
+  361732726, 367929144, 374111709, 380280190, 386434353, 392573967, 398698801, 404808624,
+  410903207, 416982319, 423045732, 429093217, 435124548, 441139496, 447137835, 453119340,
+  459083786, 465030947, 470960600, 476872522, 482766489, 488642281, 494499676, 500338453,
+  506158392, 511959275, 517740883, 523502998, 529245404, 534967884, 540670223, 546352205,
+  552013618, 557654248, 563273883, 568872310, 574449320, 580004702, 585538248, 591049748,
+  596538995, 602005783, 607449906, 612871159, 618269338, 623644239, 628995660, 634323400,
+  639627258, 644907034, 650162530, 655393548, 660599890, 665781362, 670937767, 676068911,
+  681174602, 686254647, 691308855, 696337036, 701339000, 706314559, 711263525, 716185713,
+  721080937, 725949013, 730789757, 735602987, 740388522, 745146182, 749875788, 754577161,
+  759250125, 763894504, 768510122, 773096806, 777654384, 782182683, 786681534, 791150767,
+  795590213, 799999706, 804379079, 808728167, 813046808, 817334838, 821592095, 825818421,
+  830013654, 834177638, 838310216, 842411232, 846480531, 850517961, 854523370, 858496606,
+  862437520, 866345964, 870221790, 874064853, 877875009, 881652112, 885396022, 889106597,
+  892783698, 896427186, 900036924, 903612776, 907154608, 910662286, 914135678, 917574653,
+  920979082, 924348837, 927683790, 930983817, 934248793, 937478595, 940673101, 943832191,
+  946955747, 950043650, 953095785, 956112036, 959092290, 962036435, 964944360, 967815955,
+  970651112, 973449725, 976211688, 978936898, 981625251, 984276646, 986890984, 989468165,
+  992008094, 994510675, 996975812, 999403415, 1001793390, 1004145648, 1006460100, 1008736660,
+  1010975242, 1013175761, 1015338134, 1017462281, 1019548121, 1021595575, 1023604567, 1025575020,
+  1027506862, 1029400018, 1031254418, 1033069992, 1034846671, 1036584389, 1038283080, 1039942680,
+  1041563127, 1043144360, 1044686319, 1046188946, 1047652185, 1049075980, 1050460278, 1051805027,
+  1053110176, 1054375676, 1055601479, 1056787540, 1057933813, 1059040255, 1060106826, 1061133483,
+  1062120190, 1063066909, 1063973603, 1064840240, 1065666786, 1066453210, 1067199483, 1067905576,
+  1068571464, 1069197120, 1069782521, 1070327646, 1070832474, 1071296985, 1071721163, 1072104991,
+  1072448455, 1072751542, 1073014240, 1073236540, 1073418433, 1073559913, 1073660973, 1073721611,
+  1073741824
+};
+
+// atan(2^-i) for the CORDIC iterations
+static const uint32_t atanTable[30] = {
+  536870912, 316933406, 167458907, 85004756, 42667331, 21354465, 10679838, 5340245,
+  2670163, 1335087, 667544, 333772, 166886, 83443, 41722, 20861,
+  10430, 5215, 2608, 1304, 652, 326, 163, 81,
+  41, 20, 10, 5, 3, 1
+};
+
+// Legs shorter than this in both directions are taken as flat by courseToE7(), about 1 km
+#define _GPS_SHORT_LEG_E7 100000
+
+static uint32_t angleE7(int64_t e7)
+{
+  // 3600000000 E7 units per turn, 2^32 / 3600000000 = 2^24 / 14062500, rounded
+  return (uint32_t)((e7 * 16777216LL + (e7 < 0 ? -7031250LL : 7031250LL)) / 14062500LL);
+}
+
+static int32_t sinQ30(uint32_t angle)
+{
+  uint32_t quadrant = angle >> 30;
+  uint32_t p = angle & 0x3FFFFFFF;
+  if (quadrant & 1)
+    p = 0x40000000 - p;
+  uint32_t i = p >> 22;
+  // Taylor expansion around the table entry, cos() comes from the same table
+  int64_t s0 = sinTable[i], c0 = sinTable[256 - i];
+  int64_t d = ((int64_t)(p & 0x3FFFFF) * 1686629713) >> 30; // radians, Q30
+  int64_t d2 = (d * d) >> 30;
+  int64_t d3 = (d2 * d) >> 30;
+  int32_t ret = (int32_t)(s0 + ((c0 * d) >> 30) - ((s0 * d2) >> 31) - ((c0 * d3) >> 30) / 6);
+  return quadrant & 2 ? -ret : ret;
+}
+
+static int32_t cosQ30(uint32_t angle)
+{
+  return sinQ30(angle + 0x40000000);
+}
+
+static uint32_t sqrt64(uint64_t v)
+{
+  uint64_t ret = 0, bit = (uint64_t)1 << 62;
+  while (bit > v)
+    bit >>= 2;
+  while (bit)
+  {
+    if (v >= ret + bit)
+    {
+      v -= ret + bit;
+      ret = (ret >> 1) + bit;
+    }
+    else
+      ret >>= 1;
+    bit >>= 2;
+  }
+  return (uint32_t)ret;
+}
+
+// atan2(y, x) as a binary angle, CORDIC vectoring. x and y are at most 2^31,
+// they are scaled up so the truncation of the shifts does not add up.
+static uint32_t atan2Angle(int64_t y, int64_t x)
+{
+  // the iterations never settle on an axis, they would end a few units either side of it
+  if (y == 0)
+    return x < 0 ? 0x80000000 : 0;
+  if (x == 0)
+    return y < 0 ? 0xC0000000 : 0x40000000;
+  bool negative = y < 0;
+  uint32_t angle = 0;
+  x *= 1 << 30;
+  y *= 1 << 30;
+  if (x < 0)
+  {
+    x = -x;
+    y = -y;
+    angle = 0x80000000;
+  }
+  for (int i = 0; i < 30; ++i)
+  {
+    int64_t nx;
+    if (y > 0)
+    {
+      nx = x + (y >> i);
+      y -= x >> i;
+      angle += atanTable[i];
+    }
+    else
+    {
+      nx = x - (y >> i);
+      y += x >> i;
+      angle -= atanTable[i];
+    }
+    x = nx;
+  }
+  // close to the x axis the result may end up on the wrong side of it, clamp to the half plane of y
+  if (negative != (angle > 0x80000000))
+    angle = (angle - 0x40000000) < 0x80000000 ? 0x80000000 : 0;
+  return angle;
+}
+
+/* static */
+uint32_t TinyGPSPlus::distanceBetweenE7(int32_t lat1, int32_t long1, int32_t lat2, int32_t long2)
+{
+  // Haversine on the same sphere as distanceBetween(), see the accuracy note in the header.
+  // a = sin^2(dlat/2) + cos(lat1)cos(lat2)sin^2(dlong/2) and 1 - a are both written as sums
+  // of squares, with the half sum of the latitudes, so neither cancels near 0 or the antipode.
+  uint32_t hdlat = (uint32_t)((int32_t)angleE7((int64_t)lat2 - lat1) / 2);
+  uint32_t hslat = (uint32_t)((int32_t)angleE7((int64_t)lat2 + lat1) / 2);
+  uint32_t hdlong = angleE7((int64_t)long2 - long1) / 2;
+  int64_t sdlat = sinQ30(hdlat), cdlat = cosQ30(hdlat);
+  int64_t sslat = sinQ30(hslat), cslat = cosQ30(hslat);
+  int64_t sdlong = sinQ30(hdlong), cdlong = cosQ30(hdlong);
+  // Q60, short distances would vanish in Q30
+  uint64_t a = (uint64_t)((sdlat * cdlong) >> 30) * (uint64_t)((sdlat * cdlong) >> 30) +
+               (uint64_t)((cslat * sdlong) >> 30) * (uint64_t)((cslat * sdlong) >> 30);
+  uint64_t b = (uint64_t)((cdlat * cdlong) >> 30) * (uint64_t)((cdlat * cdlong) >> 30) +
+               (uint64_t)((sslat * sdlong) >> 30) * (uint64_t)((sslat * sdlong) >> 30);
+  uint32_t c = 2 * atan2Angle(sqrt64(a), sqrt64(b));
+  // meters per binary angle unit is 2 * pi * R / 2^32
+  return (uint32_t)(((uint64_t)c * 40041452ULL + 0x80000000ULL) >> 32);
+}
+
+/* static */
+uint16_t TinyGPSPlus::courseToE7(int32_t lat1, int32_t long1, int32_t lat2, int32_t long2)
+{
+  int64_t dlatE7 = (int64_t)lat2 - lat1;
+  int64_t dlonE7 = (int64_t)long2 - long1;
+  if (dlonE7 > 1800000000)
+    dlonE7 -= 3600000000LL;
+  else if (dlonE7 < -1800000000)
+    dlonE7 += 3600000000LL;
+  uint32_t dlat = angleE7(dlatE7), dlon = angleE7(dlonE7);
+  uint32_t a1 = angleE7(lat1), a2 = a1 + dlat;
+  int64_t clat2 = cosQ30(a2);
+  int64_t y, x;
+  if (dlatE7 > -_GPS_SHORT_LEG_E7 && dlatE7 < _GPS_SHORT_LEG_E7 &&
+      dlonE7 > -_GPS_SHORT_LEG_E7 && dlonE7 < _GPS_SHORT_LEG_E7)
+  {
+    // A leg of a few meters is only a few hundred binary angle units, too coarse for its
+    // course. Short legs are flat: work on the E7 differences, there sin(d) = d and the
+    // sin^2(dlon / 2) term below is far below the resolution.
+    y = (dlonE7 * clat2) >> 16;
+    x = dlatE7 << 14;
+  }
+  else
+  {
+    int64_t hdlon = sinQ30((uint32_t)((int32_t)dlon / 2));
+    y = ((int64_t)sinQ30(dlon) * clat2) >> 30;
+    // cos(lat1)sin(lat2) - sin(lat1)cos(lat2)cos(dlon), rewritten as
+    // sin(lat2 - lat1) + 2 sin(lat1)cos(lat2)sin^2(dlon / 2) to keep short legs accurate
+    x = (((((sinQ30(a1) * clat2) >> 30) * hdlon) >> 30) * hdlon) >> 29;
+    x += sinQ30(dlat);
+  }
+  if (x == 0 && y == 0)
+    return 0; // same point, or both on a pole
+  uint32_t course = atan2Angle(y, x);
+  return (uint16_t)(((uint64_t)course * 36000 + 0x80000000ULL) >> 32) % 36000;
+}
 
 const char *TinyGPSPlus::cardinal(double course)
 {
@@ -352,6 +869,21 @@ void TinyGPSLocation::setLongitude(const char *term)
    TinyGPSPlus::parseDegrees(term, rawNewLngData);
 }
 
+int32_t TinyGPSLocation::latE7()
+{
+   updated = false;
+   int32_t ret = rawLatData.deg * 10000000L + (rawLatData.billionths + 50) / 100;
+   return rawLatData.negative ? -ret : ret;
+}
+
+int32_t TinyGPSLocation::lngE7()
+{
+   updated = false;
+   int32_t ret = rawLngData.deg * 10000000L + (rawLngData.billionths + 50) / 100;
+   return rawLngData.negative ? -ret : ret;
+}
+
+#if !_GPS_FIXED_POINT
 double TinyGPSLocation::lat()
 {
    updated = false;
@@ -365,6 +897,7 @@ double TinyGPSLocation::lng()
    double ret = rawLngData.deg + rawLngData.billionths / 1000000000.0;
    return rawLngData.negative ? -ret : ret;
 }
+#endif
 
 void TinyGPSDate::commit()
 {
@@ -475,6 +1008,23 @@ void TinyGPSCustom::begin(TinyGPSPlus &gps, const char *_sentenceName, int _term
    gps.insertCustom(this, _sentenceName, _termNumber);
 }
 
+void TinyGPSSatellitesInView::commit()
+{
+   memcpy(sats, newSats, newCnt * sizeof(sats[0]));
+   cnt = newCnt;
+   lastCommitTime = millis();
+   valid = updated = true;
+}
+
+void TinyGPSSatellitesInView::removeTalker(char talker)
+{
+   uint8_t n = 0;
+   for (uint8_t i = 0; i < newCnt; ++i)
+      if (newSats[i].talker != talker)
+         newSats[n++] = newSats[i];
+   newCnt = n;
+}
+
 void TinyGPSCustom::commit()
 {
    strcpy(this->buffer, this->stagingBuffer);
@@ -491,6 +1041,8 @@ void TinyGPSPlus::insertCustom(TinyGPSCustom *pElt, const char *sentenceName, in
 {
    TinyGPSCustom **ppelt;
 
+   pElt->sentenceHash = sentenceHash(sentenceName);
+
    for (ppelt = &this->customElts; *ppelt != NULL; ppelt = &(*ppelt)->next)
    {
       int cmp = strcmp(sentenceName, (*ppelt)->sentenceName);
@@ -501,3 +1053,13 @@ void TinyGPSPlus::insertCustom(TinyGPSCustom *pElt, const char *sentenceName, in
    pElt->next = *ppelt;
    *ppelt = pElt;
 }
+
+// static
+// Cheap hash of a sentence name, used to skip most string compares
+uint16_t TinyGPSPlus::sentenceHash(const char *name)
+{
+   uint16_t hash = 5381;
+   while (*name)
+      hash = ((hash << 5) + hash) ^ (uint8_t)*name++;
+   return hash;
+}
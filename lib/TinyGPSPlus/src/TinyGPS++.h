@@ -39,6 +39,24 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #define _GPS_KM_PER_METER 0.001
 #define _GPS_FEET_PER_METER 3.2808399
 #define _GPS_MAX_FIELD_SIZE 15
+#define _GPS_EARTH_MEAN_RADIUS 6372795 // meters, the sphere used by distanceBetween()
+
+// Set to 1 to build without the floating point helpers (lat(), lng(), distanceBetween(),
+// courseTo() and the unit conversions). The integer E7 variants are always available.
+#ifndef _GPS_FIXED_POINT
+#define _GPS_FIXED_POINT 0
+#endif
+
+// Satellites kept from the GSV sentences of all talkers
+#ifndef _GPS_MAX_SATELLITES
+#if defined(__AVR__)
+#define _GPS_MAX_SATELLITES 12
+#else
+#define _GPS_MAX_SATELLITES 32
+#endif
+#endif
+
+#define _GPS_UBX_MAX_PAYLOAD 92 // size of UBX-NAV-PVT, longer frames are only checksummed
 
 struct RawDegrees
 {
@@ -59,8 +77,12 @@ public:
    uint32_t age() const    { return valid ? millis() - lastCommitTime : (uint32_t)ULONG_MAX; }
    const RawDegrees &rawLat()     { updated = false; return rawLatData; }
    const RawDegrees &rawLng()     { updated = false; return rawLngData; }
+   int32_t latE7(); // signed, in 1e-7 degrees
+   int32_t lngE7();
+#if !_GPS_FIXED_POINT
    double lat();
    double lng();
+#endif
 
    TinyGPSLocation() : valid(false), updated(false)
    {}
@@ -163,30 +185,72 @@ private:
    void set(const char *term);
 };
 
+// In fixed point builds use value(), in hundredths of the base unit
 struct TinyGPSSpeed : TinyGPSDecimal
 {
+#if !_GPS_FIXED_POINT
    double knots()    { return value() / 100.0; }
    double mph()      { return _GPS_MPH_PER_KNOT * value() / 100.0; }
    double mps()      { return _GPS_MPS_PER_KNOT * value() / 100.0; }
    double kmph()     { return _GPS_KMPH_PER_KNOT * value() / 100.0; }
+#endif
 };
 
 struct TinyGPSCourse : public TinyGPSDecimal
 {
+#if !_GPS_FIXED_POINT
    double deg()      { return value() / 100.0; }
+#endif
 };
 
 struct TinyGPSAltitude : TinyGPSDecimal
 {
+#if !_GPS_FIXED_POINT
    double meters()       { return value() / 100.0; }
    double miles()        { return _GPS_MILES_PER_METER * value() / 100.0; }
    double kilometers()   { return _GPS_KM_PER_METER * value() / 100.0; }
    double feet()         { return _GPS_FEET_PER_METER * value() / 100.0; }
+#endif
 };
 
 struct TinyGPSHDOP : TinyGPSDecimal
 {
+#if !_GPS_FIXED_POINT
    double hdop() { return value() / 100.0; }
+#endif
+};
+
+struct TinyGPSSatellite
+{
+   uint16_t azimuth;   // degrees
+   uint8_t prn;
+   uint8_t elevation;  // degrees
+   uint8_t snr;        // dB-Hz, 0 when not tracked
+   char talker;        // second letter of the talker ID: 'P' GPS, 'L' GLONASS, 'A' Galileo, 'B'/'D' BeiDou, 'Q' QZSS
+};
+
+// Satellites in view, updated after the last GSV sentence of a talker.
+// Each talker keeps the satellites of its most recent GSV cycle.
+struct TinyGPSSatellitesInView
+{
+   friend class TinyGPSPlus;
+public:
+   bool isValid() const    { return valid; }
+   bool isUpdated() const  { return updated; }
+   uint32_t age() const    { return valid ? millis() - lastCommitTime : (uint32_t)ULONG_MAX; }
+   uint8_t count()         { updated = false; return cnt; }
+   const TinyGPSSatellite &operator[](uint8_t i) const { return sats[i]; }
+
+   TinyGPSSatellitesInView() : valid(false), updated(false), cnt(0), newCnt(0)
+   {}
+
+private:
+   bool valid, updated;
+   uint32_t lastCommitTime;
+   uint8_t cnt, newCnt;
+   TinyGPSSatellite sats[_GPS_MAX_SATELLITES], newSats[_GPS_MAX_SATELLITES];
+   void commit();
+   void removeTalker(char talker);
 };
 
 class TinyGPSPlus;
@@ -211,6 +275,7 @@ private:
    unsigned long lastCommitTime;
    bool valid, updated;
    const char *sentenceName;
+   uint16_t sentenceHash;
    int termNumber;
    friend class TinyGPSPlus;
    TinyGPSCustom *next;
@@ -221,6 +286,7 @@ class TinyGPSPlus
 public:
   TinyGPSPlus();
   bool encode(char c); // process one character received from GPS
+  size_t encode(const char *buffer, size_t length); // process a block, returns the number of valid sentences
   TinyGPSPlus &operator << (char c) {encode(c); return *this;}
 
   TinyGPSLocation location;
@@ -231,13 +297,28 @@ public:
   TinyGPSAltitude altitude;
   TinyGPSInteger satellites;
   TinyGPSHDOP hdop;
+  TinyGPSDecimal pdop;  // hundredths, from GSA or UBX-NAV-PVT
+  TinyGPSDecimal vdop;  // hundredths, from GSA
+  TinyGPSInteger fixType; // 1 = no fix, 2 = 2D, 3 = 3D
+  TinyGPSSatellitesInView satellitesInView;
 
   static const char *libraryVersion() { return _GPS_VERSION; }
 
+#if !_GPS_FIXED_POINT
   static double distanceBetween(double lat1, double long1, double lat2, double long2);
   static double courseTo(double lat1, double long1, double lat2, double long2);
+#endif
   static const char *cardinal(double course);
 
+  // integer versions, positions in 1e-7 degrees (see TinyGPSLocation::latE7()).
+  // distanceBetweenE7() stays within a meter of distanceBetween() for any two points, the
+  // antipode included. courseToE7() stays within 0.02 degrees of courseTo() on legs of 5 m
+  // and more that end at least 500 m from the antipode of the start. Shorter legs are below
+  // the 1e-7 degree resolution of the positions, and next to the antipode the course is ill
+  // defined, about 0.15 degrees off between 5 and 50 m from it. It is 0 for identical points.
+  static uint32_t distanceBetweenE7(int32_t lat1, int32_t long1, int32_t lat2, int32_t long2); // meters
+  static uint16_t courseToE7(int32_t lat1, int32_t long1, int32_t lat2, int32_t long2); // hundredths of a degree
+
   static int32_t parseDecimal(const char *term);
   static void parseDegrees(const char *term, RawDegrees &deg);
 
@@ -247,22 +328,40 @@ public:
   uint32_t passedChecksum()   const { return passedChecksumCount; }
 
 private:
-  enum {GPS_SENTENCE_GPGGA, GPS_SENTENCE_GPRMC, GPS_SENTENCE_OTHER};
+  enum {GPS_SENTENCE_GPGGA, GPS_SENTENCE_GPRMC, GPS_SENTENCE_GSV, GPS_SENTENCE_GSA, GPS_SENTENCE_VTG, GPS_SENTENCE_OTHER};
+  enum {UBX_IDLE, UBX_SYNC2, UBX_CLASS, UBX_ID, UBX_LENGTH1, UBX_LENGTH2, UBX_PAYLOAD, UBX_CK_A, UBX_CK_B};
 
   // parsing state variables
   uint8_t parity;
   bool isChecksumTerm;
   char term[_GPS_MAX_FIELD_SIZE];
   uint8_t curSentenceType;
+  char curTalker;
   uint8_t curTermNumber;
   uint8_t curTermOffset;
   bool sentenceHasFix;
 
+  // GSV state
+  uint8_t gsvMessages;
+  uint8_t gsvMessageNumber;
+  uint8_t gsvSlots;
+
+  // UBX state
+  uint8_t ubxState;
+  uint8_t ubxClass, ubxId;
+  uint16_t ubxLength, ubxOffset;
+  uint8_t ubxCkA, ubxCkB;
+  bool ubxChecksumOk;
+  uint8_t ubxPayload[_GPS_UBX_MAX_PAYLOAD];
+
   // custom element support
   friend class TinyGPSCustom;
   TinyGPSCustom *customElts;
-  TinyGPSCustom *customCandidates;
+  TinyGPSCustom *customCandidates;    // first element of the current sentence
+  TinyGPSCustom *customCandidatesEnd; // first element past them
+  TinyGPSCustom *customCursor;        // first element not behind the current term
   void insertCustom(TinyGPSCustom *pElt, const char *sentenceName, int index);
+  static uint16_t sentenceHash(const char *name);
 
   // statistics
   uint32_t encodedCharCount;
@@ -272,7 +371,11 @@ private:
 
   // internal utilities
   int fromHex(char a);
+  void appendTerm(const char *run, size_t length);
   bool endOfTermHandler();
+  void gsvTermHandler();
+  bool ubxEncode(uint8_t c);
+  void ubxNavPvt();
 };
 
 #endif // def(__TinyGPSPlus_h)
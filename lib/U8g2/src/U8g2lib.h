@@ -211,6 +211,14 @@ class U8G2
       { u8g2_UpdateDisplay(&u8g2); }
     void refreshDisplay(void)
       { u8x8_RefreshDisplay(u8g2_GetU8x8(&u8g2)); }
+
+#ifdef U8G2_WITH_DIRTY_TILES
+    void setDirtyTracking(uint8_t is_enable) { u8g2_SetDirtyTracking(&u8g2, is_enable); }
+    uint8_t getDirtyTracking(void) { return u8g2_GetDirtyTracking(&u8g2); }
+    void markDirtyTiles(uint8_t tx0, uint8_t ty0, uint8_t tx1, uint8_t ty1)
+      { u8g2_MarkDirtyTiles(&u8g2, tx0, ty0, tx1, ty1); }
+    void sendDirtyBuffer(void) { u8g2_SendDirtyBuffer(&u8g2); }
+#endif
     
 
 
@@ -120,6 +120,27 @@
 #define U8G2_WITH_CLIP_WINDOW_SUPPORT
 #endif
 
+/*
+  Dirty tile tracking for the full buffer mode:
+    void u8g2_SetDirtyTracking(u8g2_t *u8g2, uint8_t is_enable)
+    void u8g2_SendDirtyBuffer(u8g2_t *u8g2)
+  Once enabled, the draw procedures record which tiles of the buffer have been
+  modified and u8g2_SendDirtyBuffer() will only transfer these tiles.
+  Requires U8G2_DIRTY_TILE_ROWS*2+3 bytes RAM in the u8g2 structure, so it is
+  disabled by default on AVR systems.
+*/
+#if !defined(U8G2_WITHOUT_DIRTY_TILES) && !defined(__AVR__)
+#define U8G2_WITH_DIRTY_TILES
+#endif
+
+/*
+  Number of rows of the dirty tile bitmap. Each row has 16 bits. If the display is 
+  larger than 16x16 tiles (128x128 pixel), one bit covers more than one tile.
+*/
+#ifndef U8G2_DIRTY_TILE_ROWS
+#define U8G2_DIRTY_TILE_ROWS 16
+#endif
+
 /*
   The following macro enables all four drawing directions for glyphs and strings.
   If this macro is not defined, than a string can be drawn only in horizontal direction.
@@ -382,6 +403,13 @@ struct u8g2_struct
 					
 	// the following variable should be renamed to is_buffer_auto_clear
   uint8_t is_auto_page_clear; 		/* set to 0 to disable automatic clear of the buffer in firstPage() and nextPage() */
+
+#ifdef U8G2_WITH_DIRTY_TILES
+  uint16_t dirty_tiles[U8G2_DIRTY_TILE_ROWS];	/* one bit for each modified group of tiles */
+  uint8_t dirty_col_shift;		/* one bit covers 1<<dirty_col_shift tile columns */
+  uint8_t dirty_row_shift;		/* one row covers 1<<dirty_row_shift tile rows */
+  uint8_t is_dirty_tracking;		/* set by u8g2_SetDirtyTracking() */
+#endif /* U8G2_WITH_DIRTY_TILES */
   
 };
 
@@ -1569,6 +1597,13 @@ uint8_t u8g2_NextPage(u8g2_t *u8g2);
 void u8g2_UpdateDisplayArea(u8g2_t *u8g2, uint8_t  tx, uint8_t ty, uint8_t tw, uint8_t th);
 void u8g2_UpdateDisplay(u8g2_t *u8g2);
 
+#ifdef U8G2_WITH_DIRTY_TILES
+void u8g2_SetDirtyTracking(u8g2_t *u8g2, uint8_t is_enable);
+void u8g2_MarkDirtyTiles(u8g2_t *u8g2, uint8_t tx0, uint8_t ty0, uint8_t tx1, uint8_t ty1);
+void u8g2_SendDirtyBuffer(u8g2_t *u8g2);
+#define u8g2_GetDirtyTracking(u8g2) ((u8g2)->is_dirty_tracking)
+#endif /* U8G2_WITH_DIRTY_TILES */
+
 void u8g2_WriteBufferPBM(u8g2_t *u8g2, void (*out)(const char *s));
 void u8g2_WriteBufferXBM(u8g2_t *u8g2, void (*out)(const char *s));
 /* SH1122, LD7032, ST7920, ST7986, LC7981, T6963, SED1330, RA8835, MAX7219, LS0 */ 
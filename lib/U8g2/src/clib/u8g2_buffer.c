@@ -37,9 +37,50 @@
 #include <string.h>
 
 /*============================================*/
+#ifdef U8G2_WITH_DIRTY_TILES
+/*
+  Tiles which are not empty will change when the buffer is cleared. 
+  For the horizontal memory architecture the complete tile row is marked.
+*/
+static void u8g2_mark_used_tiles(u8g2_t *u8g2)
+{
+  uint8_t *ptr = u8g2->tile_buf_ptr;
+  uint8_t w = u8g2_GetU8x8(u8g2)->display_info->tile_width;
+  uint8_t tx, ty, i;
+  
+  for( ty = 0; ty < u8g2->tile_buf_height; ty++ )
+  {
+    for( tx = 0; tx < w; tx++ )
+    {
+      for( i = 0; i < 8; i++ )
+	if ( ptr[i] != 0 )
+	  break;
+      ptr += 8;
+      if ( i < 8 )
+      {
+	if ( u8g2->ll_hvline == u8g2_ll_hvline_vertical_top_lsb )
+	{
+	  u8g2_MarkDirtyTiles(u8g2, tx, ty, tx, ty);
+	}
+	else
+	{
+	  u8g2_MarkDirtyTiles(u8g2, 0, ty, w-1, ty);
+	  ptr += (w-tx-1)*8;
+	  break;
+	}
+      }
+    }
+  }
+}
+#endif /* U8G2_WITH_DIRTY_TILES */
+
 void u8g2_ClearBuffer(u8g2_t *u8g2)
 {
   size_t cnt;
+#ifdef U8G2_WITH_DIRTY_TILES
+  if ( u8g2->is_dirty_tracking )
+    u8g2_mark_used_tiles(u8g2);
+#endif /* U8G2_WITH_DIRTY_TILES */
   cnt = u8g2_GetU8x8(u8g2)->display_info->tile_width;
   cnt *= u8g2->tile_buf_height;
   cnt *= 8;
@@ -87,6 +128,12 @@ static void u8g2_send_buffer(u8g2_t *u8g2)
     src_row++;
     dest_row++;
   } while( src_row < src_max && dest_row < dest_max );
+
+#ifdef U8G2_WITH_DIRTY_TILES
+  /* the display is up to date */
+  if ( u8g2->is_dirty_tracking )
+    memset(u8g2->dirty_tiles, 0, sizeof(u8g2->dirty_tiles));
+#endif /* U8G2_WITH_DIRTY_TILES */
 }
 
 /* same as u8g2_send_buffer but also send the DISPLAY_REFRESH message (used by SSD1606) */
@@ -181,6 +228,134 @@ void u8g2_UpdateDisplay(u8g2_t *u8g2)
 }
 
 
+/*============================================*/
+#ifdef U8G2_WITH_DIRTY_TILES
+/*
+  Description:
+    Enable or disable the recording of modified tiles by the draw procedures.
+    Enabling will mark all tiles as modified, so that the next 
+    u8g2_SendDirtyBuffer() will transfer the complete buffer.
+    u8g2_ClearBuffer() will mark all tiles which are not empty.
+
+  Limitations:
+    - Only available in full buffer mode (will not do anything in page mode)
+    - Direct writes to the buffer are not recorded, use u8g2_MarkDirtyTiles()
+*/
+void u8g2_SetDirtyTracking(u8g2_t *u8g2, uint8_t is_enable)
+{
+  uint8_t tw = u8g2_GetU8x8(u8g2)->display_info->tile_width;
+  uint8_t th = u8g2_GetU8x8(u8g2)->display_info->tile_height;
+  
+  /* check, whether we are in full buffer mode */
+  if ( u8g2->tile_buf_height != th )
+    return;
+  
+  u8g2->dirty_col_shift = 0;
+  while( ((tw-1) >> u8g2->dirty_col_shift) >= 16 )
+    u8g2->dirty_col_shift++;
+  u8g2->dirty_row_shift = 0;
+  while( ((th-1) >> u8g2->dirty_row_shift) >= U8G2_DIRTY_TILE_ROWS )
+    u8g2->dirty_row_shift++;
+  
+  u8g2->is_dirty_tracking = is_enable;
+  memset(u8g2->dirty_tiles, 0, sizeof(u8g2->dirty_tiles));
+  u8g2_MarkDirtyTiles(u8g2, 0, 0, tw-1, th-1);
+}
+
+/*
+  Description:
+    Mark the tiles tx0..tx1, ty0..ty1 (included) as modified. 
+    There is no error checking for the arguments.
+    Does nothing while dirty tracking is disabled.
+*/
+void u8g2_MarkDirtyTiles(u8g2_t *u8g2, uint8_t tx0, uint8_t ty0, uint8_t tx1, uint8_t ty1)
+{
+  uint16_t mask;
+  
+  if ( u8g2->is_dirty_tracking == 0 )
+    return;
+  
+  tx0 >>= u8g2->dirty_col_shift;
+  tx1 >>= u8g2->dirty_col_shift;
+  ty0 >>= u8g2->dirty_row_shift;
+  ty1 >>= u8g2->dirty_row_shift;
+  
+  mask = (uint16_t)(0xffff << tx0);
+  mask &= (uint16_t)(0xffff >> (15-tx1));
+  do
+  {
+    u8g2->dirty_tiles[ty0] |= mask;
+    ty0++;
+  } while( ty0 <= ty1 );
+}
+
+/*
+  Description:
+    Same as u8g2_SendBuffer(), but only the tiles which have been modified since the
+    last transfer are sent. Without dirty tracking or in page mode the complete
+    buffer is sent.
+    Consecutive modified tiles of a tile row are sent with one u8x8_DrawTile() call.
+    Displays with the horizontal memory architecture (SH1122, ST7920, ...) will 
+    receive complete tile rows.
+*/
+void u8g2_SendDirtyBuffer(u8g2_t *u8g2)
+{
+  uint8_t tw = u8g2_GetU8x8(u8g2)->display_info->tile_width;
+  uint8_t th = u8g2_GetU8x8(u8g2)->display_info->tile_height;
+  uint8_t is_vertical = u8g2->ll_hvline == u8g2_ll_hvline_vertical_top_lsb;
+  uint8_t is_sent = 0;
+  uint16_t mask;
+  uint16_t x0, x1;
+  uint8_t ty, tx, tx1;
+  
+  if ( u8g2->is_dirty_tracking == 0 || u8g2->tile_buf_height != th )
+  {
+    u8g2_SendBuffer(u8g2);
+    return;
+  }
+  
+  for( ty = 0; ty < th; ty++ )
+  {
+    mask = u8g2->dirty_tiles[ty >> u8g2->dirty_row_shift];
+    if ( mask == 0 )
+      continue;
+    is_sent = 1;
+    if ( is_vertical == 0 )
+    {
+      u8g2_send_tile_row(u8g2, ty, ty);
+      continue;
+    }
+    tx = 0;
+    while( mask != 0 )
+    {
+      /* find the next run of modified tiles, in units of the bitmap */
+      while( (mask & 1) == 0 )
+      {
+	mask >>= 1;
+	tx++;
+      }
+      tx1 = tx;
+      while( (mask & 1) != 0 )
+      {
+	mask >>= 1;
+	tx1++;
+      }
+      x0 = tx << u8g2->dirty_col_shift;
+      x1 = tx1 << u8g2->dirty_col_shift;
+      if ( x1 > tw )
+	x1 = tw;
+      u8g2_UpdateDisplayArea(u8g2, x0, ty, x1-x0, 1);
+      tx = tx1;
+    }
+  }
+  
+  memset(u8g2->dirty_tiles, 0, sizeof(u8g2->dirty_tiles));
+  if ( is_sent )
+    u8x8_RefreshDisplay( u8g2_GetU8x8(u8g2) );
+}
+#endif /* U8G2_WITH_DIRTY_TILES */
+
+
 /*============================================*/
 
 /* vertical_top memory architecture */
@@ -138,6 +138,16 @@ void u8g2_draw_hv_line_2dir(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uin
   y -= u8g2->pixel_curr_row;
   
   u8g2->ll_hvline(u8g2, x, y, len, dir);
+#ifdef U8G2_WITH_DIRTY_TILES
+  if ( u8g2->is_dirty_tracking )
+  {
+    len--;
+    if ( dir == 0 )
+      u8g2_MarkDirtyTiles(u8g2, x>>3, y>>3, (x+len)>>3, y>>3);
+    else
+      u8g2_MarkDirtyTiles(u8g2, x>>3, y>>3, x>>3, (y+len)>>3);
+  }
+#endif /* U8G2_WITH_DIRTY_TILES */
 }
 
 
@@ -88,6 +88,11 @@ void u8g2_SetupBuffer(u8g2_t *u8g2, uint8_t *buf, uint8_t tile_buf_height, u8g2_
   u8g2->font_height_mode = 0; /* issue 2046 */
   u8g2->draw_color = 1;
   u8g2->is_auto_page_clear = 1;
+#ifdef U8G2_WITH_DIRTY_TILES
+  u8g2->is_dirty_tracking = 0;
+  u8g2->dirty_col_shift = 0;
+  u8g2->dirty_row_shift = 0;
+#endif
   
   u8g2->cb = u8g2_cb;
   u8g2->cb->update_dimension(u8g2);